@@ -28,7 +28,6 @@ The manual and changelog are in the header file "lodepng.h"
 Rename this file to lodepng.cpp to use it for C++, or to lodepng.c to use it for C.
 */
 
-#include "stdafx.h"
 #include "lodepng.h"
 
 #include <stdio.h>
@@ -0,0 +1,183 @@
+/**
+ * AsyncOutputQueue.cpp
+ *
+ * Copyright (C) 2009-2015 by MegaMol Team
+ * Copyright (C) 2015 by Richard Hhne, TU Dresden
+ * Alle Rechte vorbehalten.
+ */
+
+#include "AsyncOutputQueue.h"
+
+#include <exception>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+
+using namespace megamol;
+
+/**
+ * mmvis_static::AsyncOutputQueue::AsyncOutputQueue
+ */
+mmvis_static::AsyncOutputQueue::AsyncOutputQueue(const size_t capacity) : jobs(), queuedBytes(0), capacity(capacity),
+	busy(false), stop(false), writtenFiles(), errorCallback() {
+	this->thread = std::thread(&AsyncOutputQueue::run, this);
+}
+
+
+/**
+ * mmvis_static::AsyncOutputQueue::~AsyncOutputQueue
+ */
+mmvis_static::AsyncOutputQueue::~AsyncOutputQueue(void) {
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		this->stop = true;
+	}
+	this->jobAvailable.notify_all();
+	if (this->thread.joinable())
+		this->thread.join();
+}
+
+
+/**
+ * mmvis_static::AsyncOutputQueue::Push
+ */
+void mmvis_static::AsyncOutputQueue::Push(const std::function<void(void)>& job, const size_t bytes) {
+	std::unique_lock<std::mutex> lock(this->mutex);
+	this->jobDone.wait(lock, [this, bytes]() {
+		return this->queuedBytes == 0 || this->queuedBytes + bytes <= this->capacity;
+	});
+
+	Job queued;
+	queued.run = job;
+	queued.bytes = bytes;
+	this->jobs.push_back(queued);
+	this->queuedBytes += bytes;
+	lock.unlock();
+	this->jobAvailable.notify_one();
+}
+
+
+/**
+ * mmvis_static::AsyncOutputQueue::Write
+ */
+void mmvis_static::AsyncOutputQueue::Write(const std::string& filename, const std::string& text, const std::ios_base::openmode mode) {
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		this->writtenFiles.insert(filename);
+	}
+
+	// Shared, since the job has to be copyable.
+	std::shared_ptr<const std::string> data = std::make_shared<const std::string>(text);
+	this->Push([filename, data, mode]() {
+		std::ofstream file(filename.c_str(), mode | std::ios_base::out);
+		file << *data;
+		if (!file)
+			throw std::runtime_error("Unable to write \"" + filename + "\".");
+	}, text.size());
+}
+
+
+/**
+ * mmvis_static::AsyncOutputQueue::IsNewFile
+ */
+bool mmvis_static::AsyncOutputQueue::IsNewFile(const std::string& filename) {
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		if (this->writtenFiles.count(filename) > 0)
+			return false;
+	}
+	std::ifstream peekTest(filename.c_str());
+	return peekTest.peek() == std::ifstream::traits_type::eof();
+}
+
+
+/**
+ * mmvis_static::AsyncOutputQueue::Wait
+ */
+void mmvis_static::AsyncOutputQueue::Wait(void) {
+	std::unique_lock<std::mutex> lock(this->mutex);
+	this->jobDone.wait(lock, [this]() {
+		return this->jobs.empty() && !this->busy;
+	});
+}
+
+
+/**
+ * mmvis_static::AsyncOutputQueue::SetErrorCallback
+ */
+void mmvis_static::AsyncOutputQueue::SetErrorCallback(const std::function<void(const std::string&)>& callback) {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	this->errorCallback = callback;
+}
+
+
+/**
+ * mmvis_static::AsyncOutputQueue::run
+ */
+void mmvis_static::AsyncOutputQueue::run(void) {
+	std::unique_lock<std::mutex> lock(this->mutex);
+	while (true) {
+		this->jobAvailable.wait(lock, [this]() {
+			return this->stop || !this->jobs.empty();
+		});
+		if (this->jobs.empty())
+			break; // Stopped and all jobs are done.
+
+		Job job = this->jobs.front();
+		this->jobs.pop_front();
+		this->busy = true;
+		std::function<void(const std::string&)> onError = this->errorCallback;
+		lock.unlock();
+
+		try {
+			job.run();
+		}
+		catch (const std::exception& e) {
+			if (onError)
+				onError(std::string("Output: ") + e.what());
+		}
+
+		lock.lock();
+		this->busy = false;
+		this->queuedBytes -= job.bytes;
+		this->jobDone.notify_all();
+	}
+}
+
+
+/**
+ * mmvis_static::AsyncOutputFile::AsyncOutputFile
+ */
+mmvis_static::AsyncOutputFile::AsyncOutputFile(AsyncOutputQueue& queue) : std::ostringstream(), queue(queue), filename(), mode(std::ios_base::out) {
+}
+
+
+/**
+ * mmvis_static::AsyncOutputFile::~AsyncOutputFile
+ */
+mmvis_static::AsyncOutputFile::~AsyncOutputFile(void) {
+	this->close();
+}
+
+
+/**
+ * mmvis_static::AsyncOutputFile::open
+ */
+void mmvis_static::AsyncOutputFile::open(const char *filename, const std::ios_base::openmode mode) {
+	this->close();
+	this->filename = filename;
+	this->mode = mode;
+}
+
+
+/**
+ * mmvis_static::AsyncOutputFile::close
+ */
+void mmvis_static::AsyncOutputFile::close(void) {
+	if (this->filename.empty())
+		return;
+	this->queue.Write(this->filename, this->str(), this->mode);
+	this->str(std::string());
+	this->clear();
+	this->filename.clear();
+}
@@ -0,0 +1,150 @@
+/**
+ * AsyncOutputQueue.h
+ *
+ * Copyright (C) 2009-2015 by MegaMol Team
+ * Copyright (C) 2015 by Richard Hhne, TU Dresden
+ * Alle Rechte vorbehalten.
+ */
+
+#ifndef MMVISSTATIC_AsyncOutputQueue_H_INCLUDED
+#define MMVISSTATIC_AsyncOutputQueue_H_INCLUDED
+#if (defined(_MSC_VER) && (_MSC_VER > 1000))
+#pragma once
+#endif /* (defined(_MSC_VER) && (_MSC_VER > 1000)) */
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+
+namespace megamol {
+	namespace mmvis_static {
+
+		/**
+		 * Runs output jobs in order on a dedicated writer thread.
+		 *
+		 * Jobs own immutable snapshots of their data, so the calculation
+		 * continues while the disk is busy. The memory of queued jobs is
+		 * bounded, Push blocks while the queue is full.
+		 */
+		class AsyncOutputQueue {
+		public:
+
+			/// Default bound of the queued job memory in byte.
+			static const size_t DEFAULT_CAPACITY = 64 * 1024 * 1024;
+
+			/// Ctor, starts the writer thread.
+			AsyncOutputQueue(const size_t capacity = DEFAULT_CAPACITY);
+
+			/// Dtor, finishes all queued jobs.
+			virtual ~AsyncOutputQueue(void);
+
+			///
+			/// Queues a job. Blocks while the queued jobs exceed the capacity,
+			/// a single job bigger than the capacity is queued when the queue is empty.
+			///
+			/// @param bytes Memory held by the job.
+			///
+			void Push(const std::function<void(void)>& job, const size_t bytes);
+
+			/// Queues writing the text to the file, std::ios_base::app appends it, std::ios_base::binary writes it unchanged.
+			void Write(const std::string& filename, const std::string& text, const std::ios_base::openmode mode);
+
+			/// True if the file is empty or missing and no text for it has been queued, e.g. to write a CSV header.
+			bool IsNewFile(const std::string& filename);
+
+			/// Blocks until all queued jobs are done.
+			void Wait(void);
+
+			/// Sets the function receiving the messages of failed jobs, called on the writer thread. Failures are dropped without one.
+			void SetErrorCallback(const std::function<void(const std::string&)>& callback);
+
+		private:
+
+			/// A queued job.
+			struct Job {
+				std::function<void(void)> run;
+				size_t bytes;
+			};
+
+			/// Forbidden copy ctor.
+			AsyncOutputQueue(const AsyncOutputQueue& src);
+
+			/// Forbidden assignment.
+			AsyncOutputQueue& operator=(const AsyncOutputQueue& rhs);
+
+			/// Writer thread loop.
+			void run(void);
+
+			/// Queued jobs, oldest first.
+			std::deque<Job> jobs;
+
+			/// Memory of the queued jobs and the running job in byte.
+			size_t queuedBytes;
+
+			/// Bound of queuedBytes.
+			size_t capacity;
+
+			/// Flag that a job is running.
+			bool busy;
+
+			/// Flag that the thread has to end after the queued jobs.
+			bool stop;
+
+			/// Files that text has been queued for.
+			std::set<std::string> writtenFiles;
+
+			/// Receives the messages of failed jobs.
+			std::function<void(const std::string&)> errorCallback;
+
+			std::mutex mutex;
+			std::condition_variable jobAvailable;
+			std::condition_variable jobDone;
+			std::thread thread;
+		};
+
+
+		/**
+		 * Text file with the interface of std::ofstream, the text is collected
+		 * in memory and handed to an AsyncOutputQueue on close.
+		 */
+		class AsyncOutputFile : public std::ostringstream {
+		public:
+
+			/// Ctor.
+			AsyncOutputFile(AsyncOutputQueue& queue);
+
+			/// Dtor, closes the file.
+			virtual ~AsyncOutputFile(void);
+
+			/// Starts a new text for the file, the mode is used when the queue writes it.
+			void open(const char *filename, const std::ios_base::openmode mode = std::ios_base::out);
+
+			inline bool is_open(void) const {
+				return !this->filename.empty();
+			}
+
+			/// Queues the text.
+			void close(void);
+
+		private:
+
+			/// The queue.
+			AsyncOutputQueue& queue;
+
+			/// The file name, empty if not open.
+			std::string filename;
+
+			/// Mode of the file.
+			std::ios_base::openmode mode;
+		};
+
+	} /* namespace mmvis_static */
+} /* namespace megamol */
+
+#endif /* MMVISSTATIC_AsyncOutputQueue_H_INCLUDED */
@@ -0,0 +1,114 @@
+/**
+ * BoundedQueue.h
+ *
+ * Copyright (C) 2009-2015 by MegaMol Team
+ * Copyright (C) 2015 by Richard Hhne, TU Dresden
+ * Alle Rechte vorbehalten.
+ */
+
+#ifndef MMVISSTATIC_BoundedQueue_H_INCLUDED
+#define MMVISSTATIC_BoundedQueue_H_INCLUDED
+#if (defined(_MSC_VER) && (_MSC_VER > 1000))
+#pragma once
+#endif /* (defined(_MSC_VER) && (_MSC_VER > 1000)) */
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <utility>
+
+namespace megamol {
+	namespace mmvis_static {
+
+		/**
+		 * FIFO between the threads of two pipeline stages.
+		 *
+		 * Push blocks while the queue holds capacity items, so a fast
+		 * producer waits for its consumer instead of filling the memory.
+		 * After Close the queue takes no more items, the queued ones can
+		 * still be popped.
+		 */
+		template<typename T>
+		class BoundedQueue {
+		public:
+
+			/// Ctor, capacity is at least 1.
+			BoundedQueue(const size_t capacity) : items(), capacity(capacity > 0 ? capacity : 1), closed(false) {
+			}
+
+			/// Dtor.
+			virtual ~BoundedQueue(void) {
+			}
+
+			///
+			/// Appends the item, blocks while the queue is full.
+			/// @return False if the queue is closed, the item is not moved then.
+			///
+			bool Push(T&& item) {
+				std::unique_lock<std::mutex> lock(this->mutex);
+				this->notFull.wait(lock, [this]() {
+					return this->closed || this->items.size() < this->capacity;
+				});
+				if (this->closed)
+					return false;
+				this->items.push_back(std::move(item));
+				lock.unlock();
+				this->notEmpty.notify_one();
+				return true;
+			}
+
+			///
+			/// Takes the oldest item, blocks while the queue is empty and open.
+			/// @return False if the queue is closed and empty.
+			///
+			bool Pop(T& item) {
+				std::unique_lock<std::mutex> lock(this->mutex);
+				this->notEmpty.wait(lock, [this]() {
+					return this->closed || !this->items.empty();
+				});
+				if (this->items.empty())
+					return false;
+				item = std::move(this->items.front());
+				this->items.pop_front();
+				lock.unlock();
+				this->notFull.notify_one();
+				return true;
+			}
+
+			/// Ends the input, wakes all waiting threads.
+			void Close(void) {
+				{
+					std::lock_guard<std::mutex> lock(this->mutex);
+					this->closed = true;
+				}
+				this->notFull.notify_all();
+				this->notEmpty.notify_all();
+			}
+
+		private:
+
+			/// Forbidden copy ctor.
+			BoundedQueue(const BoundedQueue& src);
+
+			/// Forbidden assignment.
+			BoundedQueue& operator=(const BoundedQueue& rhs);
+
+			/// Queued items, oldest first.
+			std::deque<T> items;
+
+			/// Bound of items.
+			size_t capacity;
+
+			/// Flag that no more items are pushed.
+			bool closed;
+
+			std::mutex mutex;
+			std::condition_variable notFull;
+			std::condition_variable notEmpty;
+		};
+
+	} /* namespace mmvis_static */
+} /* namespace megamol */
+
+#endif /* MMVISSTATIC_BoundedQueue_H_INCLUDED */
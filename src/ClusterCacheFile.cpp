@@ -0,0 +1,289 @@
+/**
+ * ClusterCacheFile.cpp
+ *
+ * Copyright (C) 2009-2015 by MegaMol Team
+ * Copyright (C) 2015 by Richard Hhne, TU Dresden
+ * Alle Rechte vorbehalten.
+ */
+
+#include "stdafx.h"
+#include "ClusterCacheFile.h"
+
+#include "vislib/sys/Log.h"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace megamol;
+
+#define ASSERT_READ(A, S) if (this->file.Read((A), (S)) != (S)) { \
+		vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_ERROR, "MMSC: Read error %d", __LINE__); \
+		return false; \
+	}
+#define ASSERT_WRITEOUT(A, S) if (this->file.Write((A), (S)) != (S)) { \
+		vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_ERROR, "MMSC: Write error %d", __LINE__); \
+		return false; \
+	}
+
+/**
+ * mmvis_static::ClusterCacheFile::ClusterCacheFile
+ */
+mmvis_static::ClusterCacheFile::ClusterCacheFile(void) : file(), filename(), frameIndex(), frameIndexOffset(HEADER_SIZE),
+	isOpen(false), writing(false) {
+	this->settings.radiusMultiplier = 0;
+	this->settings.minClusterSize = 0;
+	this->settings.periodicBoundary = false;
+}
+
+
+/**
+ * mmvis_static::ClusterCacheFile::~ClusterCacheFile
+ */
+mmvis_static::ClusterCacheFile::~ClusterCacheFile(void) {
+	this->Close();
+}
+
+
+/**
+ * mmvis_static::ClusterCacheFile::OpenWrite
+ */
+bool mmvis_static::ClusterCacheFile::OpenWrite(const vislib::TString& filename, const Settings& settings) {
+	using vislib::sys::File;
+	this->Close();
+
+	if (!this->file.Open(filename, File::READ_WRITE, File::SHARE_READ, File::CREATE_OVERWRITE)) {
+		vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_ERROR,
+			"MMSC: Unable to create file \"%s\".", vislib::StringA(filename).PeekBuffer());
+		return false;
+	}
+	this->filename = filename;
+	this->settings = settings;
+	this->frameIndexOffset = HEADER_SIZE;
+	this->isOpen = true;
+	this->writing = true;
+
+	this->file.Seek(this->frameIndexOffset);
+	if (!this->writeIndexAndHeader(0) || !this->writeVersion(VERSION)) {
+		this->Close();
+		return false;
+	}
+	return true;
+}
+
+
+/**
+ * mmvis_static::ClusterCacheFile::OpenRead
+ */
+bool mmvis_static::ClusterCacheFile::OpenRead(const vislib::TString& filename) {
+	using vislib::sys::File;
+	using vislib::sys::Log;
+	this->Close();
+
+	if (!this->file.Open(filename, File::READ_ONLY, File::SHARE_READ, File::OPEN_ONLY)) {
+		Log::DefaultLog.WriteMsg(Log::LEVEL_ERROR, "MMSC: Unable to open file \"%s\".", vislib::StringA(filename).PeekBuffer());
+		return false;
+	}
+	this->isOpen = true;
+
+	char magicID[4];
+	uint32_t version, periodicBoundary, frameCount;
+	if (this->file.Read(magicID, 4) != 4 || ::memcmp(magicID, "MMSC", 4) != 0
+		|| this->file.Read(&version, 4) != 4 || version != VERSION
+		|| this->file.Read(&this->settings.radiusMultiplier, 4) != 4
+		|| this->file.Read(&this->settings.minClusterSize, 4) != 4
+		|| this->file.Read(&periodicBoundary, 4) != 4
+		|| this->file.Read(&frameCount, 4) != 4
+		|| this->file.Read(&this->frameIndexOffset, 8) != 8) {
+		Log::DefaultLog.WriteMsg(Log::LEVEL_ERROR, "MMSC: \"%s\" is no complete cluster cache file.", vislib::StringA(filename).PeekBuffer());
+		this->Close();
+		return false;
+	}
+	this->settings.periodicBoundary = periodicBoundary != 0;
+
+	this->file.Seek(this->frameIndexOffset);
+	this->frameIndex.resize(frameCount);
+	for (auto & entry : this->frameIndex) {
+		uint32_t reserved;
+		if (this->file.Read(&entry.frameID, 4) != 4 || this->file.Read(&reserved, 4) != 4
+			|| this->file.Read(&entry.offset, 8) != 8 || this->file.Read(&entry.particleCount, 8) != 8
+			|| this->file.Read(&entry.clusterCount, 8) != 8) {
+			Log::DefaultLog.WriteMsg(Log::LEVEL_ERROR, "MMSC: Unable to read frame index of \"%s\".", vislib::StringA(filename).PeekBuffer());
+			this->Close();
+			return false;
+		}
+	}
+
+	this->filename = filename;
+	return true;
+}
+
+
+/**
+ * mmvis_static::ClusterCacheFile::Close
+ */
+void mmvis_static::ClusterCacheFile::Close(void) {
+	if (this->isOpen)
+		this->file.Close();
+	this->isOpen = false;
+	this->writing = false;
+	this->filename.Clear();
+	this->frameIndex.clear();
+	this->frameIndexOffset = HEADER_SIZE;
+}
+
+
+/**
+ * mmvis_static::ClusterCacheFile::GetParticleCount
+ */
+uint64_t mmvis_static::ClusterCacheFile::GetParticleCount(const unsigned int frameID) const {
+	const FrameEntry *entry = this->findFrame(frameID);
+	return entry == NULL ? 0 : entry->particleCount;
+}
+
+
+/**
+ * mmvis_static::ClusterCacheFile::WriteFrame
+ */
+bool mmvis_static::ClusterCacheFile::WriteFrame(const unsigned int frameID, const std::vector<int>& clusterIDs,
+	const std::vector<ClusterEntry>& clusters) {
+
+	if (!this->IsWriting())
+		return false;
+
+	// Flag the file as incomplete until the new index and header are written.
+	if (!this->writeVersion(0)) {
+		this->Close();
+		return false;
+	}
+
+	///
+	/// Chunk in one write, replacing the old frame index.
+	///
+	std::vector<uint8_t> chunk(clusterIDs.size() * 4 + clusters.size() * CLUSTER_ENTRY_SIZE);
+	if (!clusterIDs.empty())
+		::memcpy(chunk.data(), clusterIDs.data(), clusterIDs.size() * 4);
+	uint8_t *clusterPtr = chunk.data() + clusterIDs.size() * 4;
+	for (auto & cluster : clusters) {
+		::memcpy(clusterPtr, &cluster.rootParticleID, 8);
+		::memcpy(clusterPtr + 8, &cluster.numberOfParticles, 8);
+		::memcpy(clusterPtr + 16, &cluster.id, 4);
+		clusterPtr += CLUSTER_ENTRY_SIZE;
+	}
+
+	FrameEntry entry;
+	entry.frameID = frameID;
+	entry.offset = this->frameIndexOffset;
+	entry.particleCount = clusterIDs.size();
+	entry.clusterCount = clusters.size();
+
+	this->file.Seek(this->frameIndexOffset);
+	if (!chunk.empty() && this->file.Write(chunk.data(), chunk.size()) != chunk.size()) {
+		vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_ERROR, "MMSC: Write error %d", __LINE__);
+		this->Close();
+		return false;
+	}
+	this->frameIndexOffset = this->file.Tell();
+
+	auto it = std::lower_bound(this->frameIndex.begin(), this->frameIndex.end(), entry.frameID,
+		[](const FrameEntry& lhs, const uint32_t frameID) {
+		return lhs.frameID < frameID;
+	});
+	if (it != this->frameIndex.end() && it->frameID == entry.frameID)
+		*it = entry;
+	else
+		this->frameIndex.insert(it, entry);
+
+	if (!this->writeIndexAndHeader(0) || !this->writeVersion(VERSION)) {
+		this->Close();
+		return false;
+	}
+	return true;
+}
+
+
+/**
+ * mmvis_static::ClusterCacheFile::ReadFrame
+ */
+bool mmvis_static::ClusterCacheFile::ReadFrame(const unsigned int frameID, std::vector<int>& clusterIDs,
+	std::vector<ClusterEntry>& clusters) {
+
+	const FrameEntry *entry = this->findFrame(frameID);
+	if (!this->isOpen || this->writing || entry == NULL)
+		return false;
+
+	clusterIDs.resize(static_cast<size_t>(entry->particleCount));
+	std::vector<uint8_t> table(static_cast<size_t>(entry->clusterCount) * CLUSTER_ENTRY_SIZE);
+
+	this->file.Seek(entry->offset);
+	if (!clusterIDs.empty()) {
+		ASSERT_READ(clusterIDs.data(), clusterIDs.size() * 4);
+	}
+	if (!table.empty()) {
+		ASSERT_READ(table.data(), table.size());
+	}
+
+	clusters.resize(static_cast<size_t>(entry->clusterCount));
+	const uint8_t *clusterPtr = table.data();
+	for (auto & cluster : clusters) {
+		::memcpy(&cluster.rootParticleID, clusterPtr, 8);
+		::memcpy(&cluster.numberOfParticles, clusterPtr + 8, 8);
+		::memcpy(&cluster.id, clusterPtr + 16, 4);
+		clusterPtr += CLUSTER_ENTRY_SIZE;
+	}
+	return true;
+}
+
+
+/**
+ * mmvis_static::ClusterCacheFile::findFrame
+ */
+const mmvis_static::ClusterCacheFile::FrameEntry* mmvis_static::ClusterCacheFile::findFrame(const unsigned int frameID) const {
+	auto it = std::lower_bound(this->frameIndex.begin(), this->frameIndex.end(), frameID,
+		[](const FrameEntry& lhs, const unsigned int frameID) {
+		return lhs.frameID < frameID;
+	});
+	return (it != this->frameIndex.end() && it->frameID == frameID) ? &(*it) : NULL;
+}
+
+
+/**
+ * mmvis_static::ClusterCacheFile::writeIndexAndHeader
+ */
+bool mmvis_static::ClusterCacheFile::writeIndexAndHeader(const uint32_t version) {
+	for (auto & entry : this->frameIndex) {
+		uint32_t reserved = 0;
+		ASSERT_WRITEOUT(&entry.frameID, 4);
+		ASSERT_WRITEOUT(&reserved, 4);
+		ASSERT_WRITEOUT(&entry.offset, 8);
+		ASSERT_WRITEOUT(&entry.particleCount, 8);
+		ASSERT_WRITEOUT(&entry.clusterCount, 8);
+	}
+
+	uint32_t periodicBoundary = this->settings.periodicBoundary ? 1 : 0;
+	uint32_t frameCount = static_cast<uint32_t>(this->frameIndex.size());
+	this->file.Seek(0);
+	ASSERT_WRITEOUT("MMSC", 4);
+	ASSERT_WRITEOUT(&version, 4);
+	ASSERT_WRITEOUT(&this->settings.radiusMultiplier, 4);
+	ASSERT_WRITEOUT(&this->settings.minClusterSize, 4);
+	ASSERT_WRITEOUT(&periodicBoundary, 4);
+	ASSERT_WRITEOUT(&frameCount, 4);
+	ASSERT_WRITEOUT(&this->frameIndexOffset, 8);
+	return true;
+}
+
+
+/**
+ * mmvis_static::ClusterCacheFile::writeVersion
+ */
+bool mmvis_static::ClusterCacheFile::writeVersion(const uint32_t version) {
+	// Everything before has to be on disk before the version changes.
+	this->file.Flush();
+	this->file.Seek(4);
+	ASSERT_WRITEOUT(&version, 4);
+	this->file.Flush();
+	return true;
+}
+
+#undef ASSERT_WRITEOUT
+#undef ASSERT_READ
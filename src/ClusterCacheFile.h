@@ -0,0 +1,168 @@
+/**
+ * ClusterCacheFile.h
+ *
+ * Copyright (C) 2009-2015 by MegaMol Team
+ * Copyright (C) 2015 by Richard Hhne, TU Dresden
+ * Alle Rechte vorbehalten.
+ */
+
+#ifndef MMVISSTATIC_ClusterCacheFile_H_INCLUDED
+#define MMVISSTATIC_ClusterCacheFile_H_INCLUDED
+#if (defined(_MSC_VER) && (_MSC_VER > 1000))
+#pragma once
+#endif /* (defined(_MSC_VER) && (_MSC_VER > 1000)) */
+
+#include "vislib/String.h"
+#include "vislib/sys/FastFile.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace megamol {
+	namespace mmvis_static {
+
+		///
+		/// MMSC file, the cluster assignment of steps 1 and 2 per frame, so
+		/// steps 3 and 4 can be replayed without neighbour search and clustering.
+		///
+		/// Header:
+		/// 0..3 char* MagicIdentifier "MMSC"
+		/// 4..7 uint32_t Version, 0 while the file is written
+		/// 8..11 int32_t Radius multiplier of the neighbour search
+		/// 12..15 int32_t Minimal cluster size
+		/// 16..19 uint32_t Periodic boundary condition (0 or 1)
+		/// 20..23 uint32_t Number of frames
+		/// 24..31 uint64_t Offset of the frame index
+		///
+		/// Body: one chunk per frame, then the frame index.
+		/// Chunk: Number of particles x int32_t cluster id, then
+		/// number of clusters x (uint64_t root particle id, uint64_t number of particles, int32_t id).
+		/// Frame index entry (32 byte): uint32_t frame id, uint32_t reserved,
+		/// uint64_t chunk offset, uint64_t number of particles, uint64_t number of clusters.
+		///
+		class ClusterCacheFile {
+		public:
+
+			/// Version of complete files.
+			static const uint32_t VERSION = 1;
+
+			/// Header size in byte.
+			static const unsigned int HEADER_SIZE = 32;
+
+			/// Size of a cluster table entry in byte.
+			static const unsigned int CLUSTER_ENTRY_SIZE = 20;
+
+			/// Parameters of steps 1 and 2, a cache is only valid for the same settings.
+			struct Settings {
+				int radiusMultiplier;
+				int minClusterSize;
+				bool periodicBoundary;
+
+				bool operator==(const Settings& rhs) const {
+					return this->radiusMultiplier == rhs.radiusMultiplier
+						&& this->minClusterSize == rhs.minClusterSize
+						&& this->periodicBoundary == rhs.periodicBoundary;
+				}
+			};
+
+			/// Cluster table entry.
+			struct ClusterEntry {
+				uint64_t rootParticleID;
+				uint64_t numberOfParticles;
+				int id;
+			};
+
+			/// Ctor.
+			ClusterCacheFile(void);
+
+			/// Dtor, closes the file.
+			virtual ~ClusterCacheFile(void);
+
+			/// Creates or overwrites the file, a complete file without frames.
+			bool OpenWrite(const vislib::TString& filename, const Settings& settings);
+
+			/// Opens a complete file and reads its frame index.
+			bool OpenRead(const vislib::TString& filename);
+
+			/// Closes the file.
+			void Close(void);
+
+			inline bool IsOpen(void) const {
+				return this->isOpen;
+			}
+
+			inline bool IsWriting(void) const {
+				return this->isOpen && this->writing;
+			}
+
+			inline const vislib::TString& GetFilename(void) const {
+				return this->filename;
+			}
+
+			inline const Settings& GetSettings(void) const {
+				return this->settings;
+			}
+
+			/// Number of particles of the frame, 0 if the frame is not in the file.
+			uint64_t GetParticleCount(const unsigned int frameID) const;
+
+			///
+			/// Appends the cluster assignment of a frame. A frame that is in the
+			/// file already is replaced, its old chunk stays unreferenced.
+			///
+			/// @param clusterIDs Cluster id of each particle, index = particle id.
+			///
+			bool WriteFrame(const unsigned int frameID, const std::vector<int>& clusterIDs, const std::vector<ClusterEntry>& clusters);
+
+			/// Reads the cluster assignment of a frame.
+			bool ReadFrame(const unsigned int frameID, std::vector<int>& clusterIDs, std::vector<ClusterEntry>& clusters);
+
+		private:
+
+			/// Entry of the frame index.
+			struct FrameEntry {
+				uint32_t frameID;
+				uint64_t offset;
+				uint64_t particleCount;
+				uint64_t clusterCount;
+			};
+
+			/// Forbidden copy ctor.
+			ClusterCacheFile(const ClusterCacheFile& src);
+
+			/// Forbidden assignment.
+			ClusterCacheFile& operator=(const ClusterCacheFile& rhs);
+
+			/// Entry of the frame, NULL if the frame is not in the file.
+			const FrameEntry* findFrame(const unsigned int frameID) const;
+
+			/// Writes the frame index at the current position and the header with the given version.
+			bool writeIndexAndHeader(const uint32_t version);
+
+			/// Overwrites only the version field and flushes.
+			bool writeVersion(const uint32_t version);
+
+			/// The opened file.
+			vislib::sys::FastFile file;
+
+			/// The file name of the opened file.
+			vislib::TString filename;
+
+			/// Settings of the clusters in the file.
+			Settings settings;
+
+			/// Frame index, ordered by frame id.
+			std::vector<FrameEntry> frameIndex;
+
+			/// Offset of the frame index, new chunks are written there.
+			uint64_t frameIndexOffset;
+
+			/// Flag that the file is opened, and for writing.
+			bool isOpen;
+			bool writing;
+		};
+
+	} /* namespace mmvis_static */
+} /* namespace megamol */
+
+#endif /* MMVISSTATIC_ClusterCacheFile_H_INCLUDED */
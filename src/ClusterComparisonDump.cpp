@@ -0,0 +1,307 @@
+/**
+ * ClusterComparisonDump.cpp
+ *
+ * Copyright (C) 2009-2015 by MegaMol Team
+ * Copyright (C) 2015 by Richard Hhne, TU Dresden
+ * Alle Rechte vorbehalten.
+ */
+
+#include "ClusterComparisonDump.h"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace megamol;
+
+namespace {
+
+	/// Common particles in percent of the cluster size, computed like PartnerClusters.
+	double getCommonPercentage(const int commonParticles, const uint64_t size) {
+		return (static_cast<float> (commonParticles) / static_cast<float> (size)) * 100;
+	}
+
+	/// Appends a value to the buffer.
+	template<class T> void append(std::vector<char>& buffer, const T& value) {
+		const char *bytes = reinterpret_cast<const char*>(&value);
+		buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+	}
+
+	/// Reads a value from the buffer at the position and advances the position.
+	template<class T> void extract(const std::vector<char>& buffer, size_t& position, T& value) {
+		::memcpy(&value, buffer.data() + position, sizeof(T));
+		position += sizeof(T);
+	}
+
+} /* end anonymous namespace */
+
+
+/**
+ * mmvis_static::ClusterComparisonDump::ClusterComparisonDump
+ */
+mmvis_static::ClusterComparisonDump::ClusterComparisonDump(void) : frameID(0), particleCount(0), gasCountPrevious(0), gasCountCurrent(0),
+	edges(), lastDirection(-1) {
+}
+
+
+/**
+ * mmvis_static::ClusterComparisonDump::~ClusterComparisonDump
+ */
+mmvis_static::ClusterComparisonDump::~ClusterComparisonDump(void) {
+}
+
+
+/**
+ * mmvis_static::ClusterComparisonDump::Reset
+ */
+void mmvis_static::ClusterComparisonDump::Reset(const uint32_t frameID, const uint64_t particleCount,
+	const uint64_t gasCountPrevious, const uint64_t gasCountCurrent) {
+	this->frameID = frameID;
+	this->particleCount = particleCount;
+	this->gasCountPrevious = gasCountPrevious;
+	this->gasCountCurrent = gasCountCurrent;
+	this->clusters[FORWARD].clear();
+	this->clusters[BACKWARDS].clear();
+	this->edges.clear();
+	this->lastDirection = -1;
+}
+
+
+/**
+ * mmvis_static::ClusterComparisonDump::AddCluster
+ */
+void mmvis_static::ClusterComparisonDump::AddCluster(const Direction direction, const int id, const uint64_t numberOfParticles) {
+	ClusterEntry cluster;
+	cluster.id = id;
+	cluster.partnerCount = 0;
+	cluster.numberOfParticles = numberOfParticles;
+	cluster.firstEdge = this->edges.size();
+	this->clusters[direction].push_back(cluster);
+	this->lastDirection = direction;
+}
+
+
+/**
+ * mmvis_static::ClusterComparisonDump::AddEdge
+ */
+void mmvis_static::ClusterComparisonDump::AddEdge(const int partnerID, const uint64_t partnerSize, const int commonParticles) {
+	if (this->lastDirection < 0)
+		return;
+	Edge edge;
+	edge.partnerID = partnerID;
+	edge.commonParticles = commonParticles;
+	edge.partnerSize = partnerSize;
+	this->edges.push_back(edge);
+	this->clusters[this->lastDirection].back().partnerCount++;
+}
+
+
+/**
+ * mmvis_static::ClusterComparisonDump::Write
+ */
+bool mmvis_static::ClusterComparisonDump::Write(std::ostream& out) const {
+	const uint32_t version = VERSION;
+	const uint32_t reserved = 0;
+	const uint32_t forwardCount = static_cast<uint32_t>(this->clusters[FORWARD].size());
+	const uint32_t backwardsCount = static_cast<uint32_t>(this->clusters[BACKWARDS].size());
+	const uint64_t edgeCount = this->edges.size();
+
+	std::vector<char> buffer;
+	buffer.reserve(HEADER_SIZE + (forwardCount + backwardsCount) * 24 + edgeCount * 16);
+	buffer.insert(buffer.end(), "SECC", "SECC" + 4);
+	append(buffer, version);
+	append(buffer, this->frameID);
+	append(buffer, reserved);
+	append(buffer, this->particleCount);
+	append(buffer, this->gasCountPrevious);
+	append(buffer, this->gasCountCurrent);
+	append(buffer, forwardCount);
+	append(buffer, backwardsCount);
+	append(buffer, edgeCount);
+
+	for (int direction = FORWARD; direction <= BACKWARDS; ++direction) {
+		for (auto & cluster : this->clusters[direction]) {
+			append(buffer, cluster.id);
+			append(buffer, cluster.partnerCount);
+			append(buffer, cluster.numberOfParticles);
+			append(buffer, cluster.firstEdge);
+		}
+	}
+	for (auto & edge : this->edges) {
+		append(buffer, edge.partnerID);
+		append(buffer, edge.commonParticles);
+		append(buffer, edge.partnerSize);
+	}
+
+	out.write(buffer.data(), buffer.size());
+	return static_cast<bool>(out);
+}
+
+
+/**
+ * mmvis_static::ClusterComparisonDump::Read
+ */
+bool mmvis_static::ClusterComparisonDump::Read(std::istream& in) {
+	std::vector<char> buffer(HEADER_SIZE);
+	if (!in.read(buffer.data(), HEADER_SIZE) || ::memcmp(buffer.data(), "SECC", 4) != 0)
+		return false;
+
+	size_t position = 4;
+	uint32_t version, reserved, forwardCount, backwardsCount;
+	uint64_t edgeCount;
+	extract(buffer, position, version);
+	if (version != VERSION)
+		return false;
+	uint32_t frameID;
+	uint64_t particleCount, gasCountPrevious, gasCountCurrent;
+	extract(buffer, position, frameID);
+	extract(buffer, position, reserved);
+	extract(buffer, position, particleCount);
+	extract(buffer, position, gasCountPrevious);
+	extract(buffer, position, gasCountCurrent);
+	extract(buffer, position, forwardCount);
+	extract(buffer, position, backwardsCount);
+	extract(buffer, position, edgeCount);
+	this->Reset(frameID, particleCount, gasCountPrevious, gasCountCurrent);
+
+	buffer.resize(static_cast<size_t>((static_cast<uint64_t>(forwardCount) + backwardsCount) * 24 + edgeCount * 16));
+	if (!buffer.empty() && !in.read(buffer.data(), buffer.size()))
+		return false;
+
+	position = 0;
+	const uint32_t counts[2] = { forwardCount, backwardsCount };
+	for (int direction = FORWARD; direction <= BACKWARDS; ++direction) {
+		this->clusters[direction].resize(counts[direction]);
+		for (auto & cluster : this->clusters[direction]) {
+			extract(buffer, position, cluster.id);
+			extract(buffer, position, cluster.partnerCount);
+			extract(buffer, position, cluster.numberOfParticles);
+			extract(buffer, position, cluster.firstEdge);
+			if (cluster.firstEdge + cluster.partnerCount > edgeCount)
+				return false;
+		}
+	}
+	this->edges.resize(static_cast<size_t>(edgeCount));
+	for (auto & edge : this->edges) {
+		extract(buffer, position, edge.partnerID);
+		extract(buffer, position, edge.commonParticles);
+		extract(buffer, position, edge.partnerSize);
+	}
+	return true;
+}
+
+
+/**
+ * mmvis_static::ClusterComparisonDump::WriteText
+ */
+void mmvis_static::ClusterComparisonDump::WriteText(std::ostream& out) const {
+	const char *clusterNames[2] = { "Previous cluster ", "Cluster " };
+	const char *partnerNames[2] = { "Cluster ", "Previous cluster " };
+
+	for (int direction = FORWARD; direction <= BACKWARDS; ++direction) {
+		for (auto & cluster : this->clusters[direction]) {
+			const Summary summary = this->summarize(cluster);
+			out
+				<< clusterNames[direction] << cluster.id
+				<< ", " << cluster.numberOfParticles << " particles"
+				<< ", " << summary.totalCommonParticles << " common particles (" << summary.totalCommonPercentage << "%)"
+				<< ", " << (summary.totalCommonPercentage == 0 ? -1 : (summary.maxCommonPercentage / summary.totalCommonPercentage) * 100) << " % max to total ratio"
+				<< ", common particles min/max (" << summary.minCommonParticles << ", " << summary.maxCommonParticles << ")"
+				<< ", percentage min/max (" << summary.minCommonPercentage << "%, " << summary.maxCommonPercentage << "%)"
+				<< ", " << cluster.partnerCount << " partner clusters"
+				<< "\n";
+
+			// Partners with most common particles first.
+			std::vector<Edge> partners(this->edges.begin() + static_cast<size_t>(cluster.firstEdge),
+				this->edges.begin() + static_cast<size_t>(cluster.firstEdge + cluster.partnerCount));
+			std::stable_sort(partners.begin(), partners.end(), [](const Edge& lhs, const Edge& rhs) {
+				return lhs.commonParticles > rhs.commonParticles;
+			});
+			for (auto & partner : partners) {
+				out
+					<< partnerNames[direction] << partner.partnerID << " (size " << partner.partnerSize << "): " << partner.commonParticles << " common"
+					<< ", ratio this/global (" << getCommonPercentage(partner.commonParticles, partner.partnerSize) << "%, "
+					<< getCommonPercentage(partner.commonParticles, cluster.numberOfParticles) << "%)"
+					<< "\n";
+			}
+			out << "\n";
+		}
+	}
+}
+
+
+/**
+ * mmvis_static::ClusterComparisonDump::WriteCSV
+ */
+void mmvis_static::ClusterComparisonDump::WriteCSV(std::ostream& out, const Direction direction) const {
+	out << "Cluster id; Cluster size [#]; Common particles [#]; Common particles [%]; Partners [#]; Average partner common particles [%]; "
+		<< "LocalMaxTotal [%]; "
+		<< "75 % bp; 50 % bp; 45 % bp; 40 % bp; 35 % bp; 30 % bp; 25 % bp; 20 % bp; 10 % sp; 1 % sp; "
+		<< "bp = big partners, sp = small partners"
+		<< "\n";
+
+	const double bigPercentages[] = { 75, 50, 45, 40, 35, 30, 25, 20 };
+	for (auto & cluster : this->clusters[direction]) {
+		const Summary summary = this->summarize(cluster);
+		out << cluster.id << ";"
+			<< cluster.numberOfParticles << ";"
+			<< summary.totalCommonParticles << ";"
+			<< summary.totalCommonPercentage << ";"
+			<< cluster.partnerCount << ";"
+			<< summary.totalCommonPercentage / static_cast<double>(cluster.partnerCount) << ";"
+			<< (summary.totalCommonPercentage == 0 ? -1 : (summary.maxCommonPercentage / summary.totalCommonPercentage) * 100) << ";";
+		for (const double percentage : bigPercentages)
+			out << this->getPartnerAmount(cluster, summary, percentage, true) << ";";
+		out << this->getPartnerAmount(cluster, summary, 10, false) << ";"
+			<< this->getPartnerAmount(cluster, summary, 1, false)
+			<< "\n";
+	}
+}
+
+
+/**
+ * mmvis_static::ClusterComparisonDump::summarize
+ */
+mmvis_static::ClusterComparisonDump::Summary mmvis_static::ClusterComparisonDump::summarize(const ClusterEntry& cluster) const {
+	Summary summary;
+	summary.minCommonParticles = -1;
+	summary.maxCommonParticles = -1;
+	summary.totalCommonParticles = 0;
+	summary.minCommonPercentage = -1;
+	summary.maxCommonPercentage = -1;
+
+	for (uint64_t ei = cluster.firstEdge; ei < cluster.firstEdge + cluster.partnerCount; ++ei) {
+		const Edge& edge = this->edges[static_cast<size_t>(ei)];
+		const double percentage = getCommonPercentage(edge.commonParticles, cluster.numberOfParticles);
+		summary.totalCommonParticles += edge.commonParticles;
+		if (summary.minCommonParticles < 0 || summary.minCommonParticles > edge.commonParticles)
+			summary.minCommonParticles = edge.commonParticles;
+		if (summary.maxCommonParticles < 0 || summary.maxCommonParticles < edge.commonParticles)
+			summary.maxCommonParticles = edge.commonParticles;
+		if (summary.minCommonPercentage < 0 || summary.minCommonPercentage > percentage)
+			summary.minCommonPercentage = percentage;
+		if (summary.maxCommonPercentage < 0 || summary.maxCommonPercentage < percentage)
+			summary.maxCommonPercentage = percentage;
+	}
+	summary.totalCommonPercentage = getCommonPercentage(summary.totalCommonParticles, cluster.numberOfParticles);
+	return summary;
+}
+
+
+/**
+ * mmvis_static::ClusterComparisonDump::getPartnerAmount
+ */
+int mmvis_static::ClusterComparisonDump::getPartnerAmount(const ClusterEntry& cluster, const Summary& summary,
+	const double percentage, const bool big) const {
+	if (summary.totalCommonPercentage == 0)
+		return -1;
+
+	const double ratio = percentage / 100;
+	int count = 0;
+	for (uint64_t ei = cluster.firstEdge; ei < cluster.firstEdge + cluster.partnerCount; ++ei) {
+		const double partnerRatio = getCommonPercentage(this->edges[static_cast<size_t>(ei)].commonParticles, cluster.numberOfParticles)
+			/ summary.totalCommonPercentage;
+		if (big ? partnerRatio >= ratio : partnerRatio <= ratio)
+			count++;
+	}
+	return count;
+}
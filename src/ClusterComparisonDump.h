@@ -0,0 +1,147 @@
+/**
+ * ClusterComparisonDump.h
+ *
+ * Copyright (C) 2009-2015 by MegaMol Team
+ * Copyright (C) 2015 by Richard Hhne, TU Dresden
+ * Alle Rechte vorbehalten.
+ */
+
+#ifndef MMVISSTATIC_ClusterComparisonDump_H_INCLUDED
+#define MMVISSTATIC_ClusterComparisonDump_H_INCLUDED
+#if (defined(_MSC_VER) && (_MSC_VER > 1000))
+#pragma once
+#endif /* (defined(_MSC_VER) && (_MSC_VER > 1000)) */
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <vector>
+
+namespace megamol {
+	namespace mmvis_static {
+
+		///
+		/// SECC file, the partner graph of the cluster comparison (step 3) of one frame.
+		/// Written in one piece instead of the SECC text logs, the converter
+		/// secc_convert creates the text and CSV views offline.
+		/// Uses the standard library only, so the converter does not need MegaMol.
+		///
+		/// Header (56 byte):
+		/// 0..3 char* MagicIdentifier "SECC"
+		/// 4..7 uint32_t Version
+		/// 8..11 uint32_t Frame id
+		/// 12..15 uint32_t Reserved
+		/// 16..23 uint64_t Number of particles
+		/// 24..31 uint64_t Gas particles of the previous frame
+		/// 32..39 uint64_t Gas particles of the current frame
+		/// 40..43 uint32_t Number of forward clusters (previous -> current)
+		/// 44..47 uint32_t Number of backwards clusters (current -> previous)
+		/// 48..55 uint64_t Number of edges
+		///
+		/// Cluster table, forward then backwards (24 byte each): int32_t cluster id,
+		/// uint32_t number of partners, uint64_t cluster size, uint64_t index of the first edge.
+		/// Edge list (16 byte each): int32_t partner cluster id, int32_t common particles,
+		/// uint64_t partner cluster size.
+		///
+		class ClusterComparisonDump {
+		public:
+
+			/// Version of the format.
+			static const uint32_t VERSION = 1;
+
+			/// Header size in byte.
+			static const unsigned int HEADER_SIZE = 56;
+
+			/// Comparison direction.
+			enum Direction {
+				FORWARD = 0, // Previous -> current.
+				BACKWARDS = 1 // Current -> previous.
+			};
+
+			/// Cluster with its partners.
+			struct ClusterEntry {
+				int32_t id;
+				uint32_t partnerCount;
+				uint64_t numberOfParticles;
+				uint64_t firstEdge;
+			};
+
+			/// Partner of a cluster.
+			struct Edge {
+				int32_t partnerID;
+				int32_t commonParticles;
+				uint64_t partnerSize;
+			};
+
+			/// Ctor.
+			ClusterComparisonDump(void);
+
+			/// Dtor.
+			virtual ~ClusterComparisonDump(void);
+
+			/// Removes all clusters and sets the frame properties.
+			void Reset(const uint32_t frameID, const uint64_t particleCount, const uint64_t gasCountPrevious, const uint64_t gasCountCurrent);
+
+			/// Adds a cluster, the following edges are its partners.
+			void AddCluster(const Direction direction, const int id, const uint64_t numberOfParticles);
+
+			/// Adds a partner to the last added cluster.
+			void AddEdge(const int partnerID, const uint64_t partnerSize, const int commonParticles);
+
+			inline const std::vector<ClusterEntry>& GetClusters(const Direction direction) const {
+				return this->clusters[direction];
+			}
+
+			inline const std::vector<Edge>& GetEdges(void) const {
+				return this->edges;
+			}
+
+			/// Writes the dump with one write.
+			bool Write(std::ostream& out) const;
+
+			/// Reads a dump.
+			bool Read(std::istream& in);
+
+			/// Writes the text view of both directions, like the former "SECC All" log.
+			void WriteText(std::ostream& out) const;
+
+			/// Writes the CSV view of one direction, like the former "SECC forward/backwards" CSV.
+			void WriteCSV(std::ostream& out, const Direction direction) const;
+
+		private:
+
+			/// Values of a cluster derived from its partners, same as PartnerClusters of the calculation.
+			struct Summary {
+				int minCommonParticles;
+				int maxCommonParticles;
+				int totalCommonParticles;
+				double minCommonPercentage;
+				double maxCommonPercentage;
+				double totalCommonPercentage;
+			};
+
+			/// Derives the values of the cluster.
+			Summary summarize(const ClusterEntry& cluster) const;
+
+			/// Amount of partners with a share of at least (big) or at most (!big) percentage % of the common particles.
+			int getPartnerAmount(const ClusterEntry& cluster, const Summary& summary, const double percentage, const bool big) const;
+
+			uint32_t frameID;
+			uint64_t particleCount;
+			uint64_t gasCountPrevious;
+			uint64_t gasCountCurrent;
+
+			/// Clusters per direction.
+			std::vector<ClusterEntry> clusters[2];
+
+			/// Partners of all clusters.
+			std::vector<Edge> edges;
+
+			/// Direction of the last added cluster, the next edge belongs to it. -1 before the first cluster.
+			int lastDirection;
+		};
+
+	} /* namespace mmvis_static */
+} /* namespace megamol */
+
+#endif /* MMVISSTATIC_ClusterComparisonDump_H_INCLUDED */
@@ -0,0 +1,81 @@
+/**
+ * FrameArena.cpp
+ *
+ * Copyright (C) 2009-2015 by MegaMol Team
+ * Copyright (C) 2015 by Richard Hhne, TU Dresden
+ * Alle Rechte vorbehalten.
+ */
+
+#include "FrameArena.h"
+
+#include <algorithm>
+#include <cstdint>
+
+using namespace megamol;
+
+/**
+ * mmvis_static::FrameArena::FrameArena
+ */
+mmvis_static::FrameArena::FrameArena(void) : blocks(), offset(0), usedBytes(0), capacity(0), heapAllocations(0) {
+}
+
+
+/**
+ * mmvis_static::FrameArena::~FrameArena
+ */
+mmvis_static::FrameArena::~FrameArena(void) {
+}
+
+
+/**
+ * mmvis_static::FrameArena::Allocate
+ */
+void *mmvis_static::FrameArena::Allocate(const size_t bytes, const size_t alignment) {
+	if (!this->blocks.empty()) {
+		Block& block = this->blocks.back();
+		const uintptr_t address = reinterpret_cast<uintptr_t>(block.data.get()) + this->offset;
+		const size_t padding = static_cast<size_t>((alignment - (address % alignment)) % alignment);
+		if (this->offset + padding + bytes <= block.size) {
+			this->offset += padding + bytes;
+			this->usedBytes += padding + bytes;
+			return block.data.get() + this->offset - bytes;
+		}
+	}
+
+	///
+	/// New block, at least twice the last one to keep the number of blocks small.
+	///
+	const size_t lastSize = this->blocks.empty() ? MIN_BLOCK_SIZE / 2 : this->blocks.back().size;
+	this->addBlock(std::max(bytes + alignment, 2 * lastSize));
+	return this->Allocate(bytes, alignment);
+}
+
+
+/**
+ * mmvis_static::FrameArena::Reset
+ */
+void mmvis_static::FrameArena::Reset(void) {
+	if (this->blocks.size() > 1) {
+		const size_t total = this->capacity;
+		this->blocks.clear();
+		this->capacity = 0;
+		this->addBlock(total);
+	}
+
+	this->offset = 0;
+	this->usedBytes = 0;
+}
+
+
+/**
+ * mmvis_static::FrameArena::addBlock
+ */
+void mmvis_static::FrameArena::addBlock(const size_t bytes) {
+	Block block;
+	block.data.reset(new unsigned char[bytes]);
+	block.size = bytes;
+	this->blocks.push_back(std::move(block));
+	this->offset = 0;
+	this->capacity += bytes;
+	this->heapAllocations++;
+}
@@ -0,0 +1,123 @@
+/**
+ * FrameArena.h
+ *
+ * Copyright (C) 2009-2015 by MegaMol Team
+ * Copyright (C) 2015 by Richard Hhne, TU Dresden
+ * Alle Rechte vorbehalten.
+ */
+
+#ifndef MMVISSTATIC_FrameArena_H_INCLUDED
+#define MMVISSTATIC_FrameArena_H_INCLUDED
+#if (defined(_MSC_VER) && (_MSC_VER > 1000))
+#pragma once
+#endif /* (defined(_MSC_VER) && (_MSC_VER > 1000)) */
+
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace megamol {
+	namespace mmvis_static {
+
+		/**
+		 * Monotonic allocator for the temporaries of a frame, e.g. the point
+		 * arrays of the kD-tree and the cluster comparison matrix.
+		 *
+		 * Allocations only advance a pointer in the current block, nothing is
+		 * freed before Reset. Reset keeps the memory: if the frame needed
+		 * several blocks they are replaced by one block of their total size,
+		 * so frames of similar size do not allocate from the heap anymore.
+		 *
+		 * Not thread safe, used by the thread of the frame.
+		 */
+		class FrameArena {
+		public:
+
+			/// Size of the first block in byte.
+			static const size_t MIN_BLOCK_SIZE = static_cast<size_t>(1) << 20;
+
+			/// Ctor, allocates no memory.
+			FrameArena(void);
+
+			/// Dtor.
+			virtual ~FrameArena(void);
+
+			///
+			/// Returns uninitialized memory, valid until Reset.
+			/// @param alignment Power of two.
+			///
+			void *Allocate(const size_t bytes, const size_t alignment);
+
+			/// Returns an uninitialized array, valid until Reset. Only for trivial types.
+			template<typename T>
+			T *AllocateArray(const size_t count) {
+				static_assert(std::is_trivially_destructible<T>::value, "FrameArena does not call destructors.");
+				return static_cast<T*>(this->Allocate(count * sizeof(T), std::alignment_of<T>::value));
+			}
+
+			/// Frees all allocations of the frame, keeps the memory for the next frame.
+			void Reset(void);
+
+			/// Memory used by the allocations of the frame in byte.
+			inline size_t GetUsedBytes(void) const {
+				return this->usedBytes;
+			}
+
+			/// Memory of all blocks in byte.
+			inline size_t GetCapacity(void) const {
+				return this->capacity;
+			}
+
+			/// Number of blocks allocated from the heap since the construction.
+			inline size_t GetHeapAllocations(void) const {
+				return this->heapAllocations;
+			}
+
+		private:
+
+			/// Memory block, move only. The move members are explicit since VS2013 does not generate them.
+			struct Block {
+				std::unique_ptr<unsigned char[]> data;
+				size_t size;
+
+				Block(void) : data(), size(0) {}
+
+				Block(Block&& src) : data(std::move(src.data)), size(src.size) {}
+
+				Block& operator=(Block&& rhs) {
+					this->data = std::move(rhs.data);
+					this->size = rhs.size;
+					return *this;
+				}
+
+			private:
+				Block(const Block& src);
+				Block& operator=(const Block& rhs);
+			};
+
+			/// Forbidden copy ctor.
+			FrameArena(const FrameArena& src);
+
+			/// Forbidden assignment.
+			FrameArena& operator=(const FrameArena& rhs);
+
+			/// Appends a block with at least bytes.
+			void addBlock(const size_t bytes);
+
+			/// Blocks, allocations are taken from the last one.
+			std::vector<Block> blocks;
+
+			/// Offset of the free memory in the last block.
+			size_t offset;
+
+			size_t usedBytes;
+			size_t capacity;
+			size_t heapAllocations;
+		};
+
+	} /* namespace mmvis_static */
+} /* namespace megamol */
+
+#endif /* MMVISSTATIC_FrameArena_H_INCLUDED */
@@ -0,0 +1,236 @@
+/**
+ * FrameMetrics.cpp
+ *
+ * Copyright (C) 2009-2015 by MegaMol Team
+ * Copyright (C) 2015 by Richard Hhne, TU Dresden
+ * Alle Rechte vorbehalten.
+ */
+
+#include "FrameMetrics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace megamol;
+
+namespace {
+
+	/// Name and unit of a metric.
+	struct MetricDescription {
+		const char *name;
+		const char *unit;
+	};
+
+	/// Same order as FrameMetrics::Metric.
+	const MetricDescription metricDescriptions[mmvis_static::FrameMetrics::METRIC_COUNT] = {
+		{ "Particles", "#particles" },
+		{ "ParticleList", "ms" },
+		{ "kdTree", "ms" },
+		{ "kDSearch radius multiplier", "#radiusMult" },
+		{ "kDSearch max neighbours", "#neighbours" },
+		{ "Neighbours", "ms" },
+		{ "Clusters", "#clusters" },
+		{ "MinCluster", "#particles" },
+		{ "MaxCluster", "#particles" },
+		{ "SizeOneClusters for Fast Depth debug", "#clusters" },
+		{ "MinSizeClusters for Fast Depth debug", "#clusters" },
+		{ "Particles in clusters", "#particles" },
+		{ "Particles in gas", "#particles" },
+		{ "Fast Depth", "ms" },
+		{ "Minimum cluster limit", "#particles" },
+		{ "Particles merged", "#particles" },
+		{ "Clusters removed", "#clusters" },
+		{ "SizeOneClusters for Merge Clusters debug", "#clusters" },
+		{ "MinSizeClusters for Merge Clusters debug", "#clusters" },
+		{ "Merge Clusters", "ms" },
+		{ "Forward min common particle ratio", "%minCommonParts" },
+		{ "Forward mean common particle ratio", "%meanCommonParts" },
+		{ "Forward common particle ratio std deviation", "%devCommonParts" },
+		{ "Forward max common particle ratio", "%maxCommonParts" },
+		{ "Backwards min common particle ratio", "%minCommonParts" },
+		{ "Backwards mean common particle ratio", "%meanCommonParts" },
+		{ "Backwards common particle ratio std deviation", "%devCommonParts" },
+		{ "Backwards max common particle ratio", "%maxCommonParts" },
+		{ "Compare Clusters", "ms" },
+		{ "Minimal number of big partner clusters for merge / split", "#cluster" },
+		{ "Minimal common particles ratio limit of big partners for merge / split", "%minCommonParts" },
+		{ "Maximum total common particles ratio limit for birth / death", "%maxCommonParts" },
+		{ "Births", "#events" },
+		{ "Deaths", "#events" },
+		{ "Merges", "#events" },
+		{ "Splits", "#events" },
+		{ "Total events", "#events" },
+		{ "Determine structure events", "ms" },
+		{ "Complete calculation", "ms" },
+		{ "ParticleList", "kiB" },
+		{ "Previous particleList", "kiB" },
+		{ "kdTree", "kiB" },
+		{ "ClusterList", "kiB" },
+		{ "Previous clusterList", "kiB" },
+		{ "Comparison partnersList", "kiB" },
+		{ "StructureEventsList", "kiB" },
+		{ "Total list memory", "kiB" },
+		{ "Frame arena", "kiB" },
+		{ "Heap allocations of frame temporaries", "#allocations" }
+	};
+
+	/// Writes a length prefixed string.
+	void writeString(std::ostream& out, const std::string& text) {
+		const uint32_t length = static_cast<uint32_t>(text.size());
+		out.write(reinterpret_cast<const char*>(&length), 4);
+		out.write(text.data(), text.size());
+	}
+
+} /* end anonymous namespace */
+
+
+/**
+ * mmvis_static::FrameMetrics::RunningStats::RunningStats
+ */
+mmvis_static::FrameMetrics::RunningStats::RunningStats(void) : count(0), mean(0), m2(0), min(0), max(0) {
+}
+
+
+/**
+ * mmvis_static::FrameMetrics::RunningStats::Add
+ */
+void mmvis_static::FrameMetrics::RunningStats::Add(const double value) {
+	this->count++;
+	const double delta = value - this->mean;
+	this->mean += delta / this->count;
+	this->m2 += delta * (value - this->mean);
+	this->min = this->count == 1 ? value : std::min(this->min, value);
+	this->max = this->count == 1 ? value : std::max(this->max, value);
+}
+
+
+/**
+ * mmvis_static::FrameMetrics::RunningStats::GetDeviation
+ */
+double mmvis_static::FrameMetrics::RunningStats::GetDeviation(void) const {
+	return this->count == 0 ? 0 : std::sqrt(this->m2 / this->count);
+}
+
+
+/**
+ * mmvis_static::FrameMetrics::FrameMetrics
+ */
+mmvis_static::FrameMetrics::FrameMetrics(void) : frameID(0), time(0), timeString() {
+	this->Reset(0, 0, "");
+}
+
+
+/**
+ * mmvis_static::FrameMetrics::~FrameMetrics
+ */
+mmvis_static::FrameMetrics::~FrameMetrics(void) {
+}
+
+
+/**
+ * mmvis_static::FrameMetrics::Reset
+ */
+void mmvis_static::FrameMetrics::Reset(const unsigned int frameID, const time_t time, const std::string& timeString) {
+	for (auto & value : this->values)
+		value.store(std::numeric_limits<double>::quiet_NaN(), std::memory_order_relaxed);
+	this->frameID = frameID;
+	this->time = time;
+	this->timeString = timeString;
+}
+
+
+/**
+ * mmvis_static::FrameMetrics::Add
+ */
+void mmvis_static::FrameMetrics::Add(const Metric metric, const double value) {
+	double expected = this->values[metric].load(std::memory_order_relaxed);
+	double sum;
+	do {
+		sum = (std::isnan(expected) ? 0 : expected) + value;
+	} while (!this->values[metric].compare_exchange_weak(expected, sum, std::memory_order_relaxed));
+}
+
+
+/**
+ * mmvis_static::FrameMetrics::IsSet
+ */
+bool mmvis_static::FrameMetrics::IsSet(const Metric metric) const {
+	return !std::isnan(this->Get(metric));
+}
+
+
+/**
+ * mmvis_static::FrameMetrics::GetName
+ */
+const char* mmvis_static::FrameMetrics::GetName(const Metric metric) {
+	return metricDescriptions[metric].name;
+}
+
+
+/**
+ * mmvis_static::FrameMetrics::GetUnit
+ */
+const char* mmvis_static::FrameMetrics::GetUnit(const Metric metric) {
+	return metricDescriptions[metric].unit;
+}
+
+
+/**
+ * mmvis_static::FrameMetrics::WriteCSVHeader
+ */
+void mmvis_static::FrameMetrics::WriteCSVHeader(std::ostream& out) const {
+	out << "Label; Time [y-m-d h:m:s]; Frame ID [#frame]";
+	for (int metric = 0; metric < METRIC_COUNT; ++metric)
+		out << "; " << metricDescriptions[metric].name << " [" << metricDescriptions[metric].unit << "]";
+	out << "\n";
+
+	out << "; y-m-d h:m:s; #frame";
+	for (int metric = 0; metric < METRIC_COUNT; ++metric)
+		out << "; " << metricDescriptions[metric].unit;
+	out << "\n";
+}
+
+
+/**
+ * mmvis_static::FrameMetrics::WriteCSV
+ */
+void mmvis_static::FrameMetrics::WriteCSV(std::ostream& out, const std::string& label) const {
+	out << label << "; " << this->timeString << "; " << this->frameID;
+	for (int metric = 0; metric < METRIC_COUNT; ++metric) {
+		out << "; ";
+		if (this->IsSet(static_cast<Metric>(metric)))
+			out << this->Get(static_cast<Metric>(metric));
+	}
+	out << "\n";
+}
+
+
+/**
+ * mmvis_static::FrameMetrics::WriteBinaryHeader
+ */
+void mmvis_static::FrameMetrics::WriteBinaryHeader(std::ostream& out, const std::string& label) const {
+	const uint32_t version = BINARY_VERSION;
+	const uint32_t metricCount = METRIC_COUNT;
+	out.write("SECM", 4);
+	out.write(reinterpret_cast<const char*>(&version), 4);
+	out.write(reinterpret_cast<const char*>(&metricCount), 4);
+	writeString(out, label);
+	for (int metric = 0; metric < METRIC_COUNT; ++metric)
+		writeString(out, std::string(metricDescriptions[metric].name) + " [" + metricDescriptions[metric].unit + "]");
+}
+
+
+/**
+ * mmvis_static::FrameMetrics::WriteBinary
+ */
+void mmvis_static::FrameMetrics::WriteBinary(std::ostream& out) const {
+	const uint32_t frameID = this->frameID;
+	const int64_t time = static_cast<int64_t>(this->time);
+	double record[METRIC_COUNT];
+	for (int metric = 0; metric < METRIC_COUNT; ++metric)
+		record[metric] = this->Get(static_cast<Metric>(metric));
+	out.write(reinterpret_cast<const char*>(&frameID), 4);
+	out.write(reinterpret_cast<const char*>(&time), 8);
+	out.write(reinterpret_cast<const char*>(record), sizeof(record));
+}
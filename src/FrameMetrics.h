@@ -0,0 +1,203 @@
+/**
+ * FrameMetrics.h
+ *
+ * Copyright (C) 2009-2015 by MegaMol Team
+ * Copyright (C) 2015 by Richard Hhne, TU Dresden
+ * Alle Rechte vorbehalten.
+ */
+
+#ifndef MMVISSTATIC_FrameMetrics_H_INCLUDED
+#define MMVISSTATIC_FrameMetrics_H_INCLUDED
+#if (defined(_MSC_VER) && (_MSC_VER > 1000))
+#pragma once
+#endif /* (defined(_MSC_VER) && (_MSC_VER > 1000)) */
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <ostream>
+#include <string>
+
+namespace megamol {
+	namespace mmvis_static {
+
+		///
+		/// Quantitative data of one calculated frame. The steps record named
+		/// values, the frame is serialized once after all steps.
+		/// Values of skipped steps stay unset and are written as empty fields.
+		///
+		/// Recording is lock-free, so counters can be added from parallel loops.
+		///
+		/// Binary file (SECM):
+		/// Header: char[4] "SECM", uint32_t version, uint32_t number of metrics,
+		/// uint32_t label length, label, then per metric uint32_t name length and "name [unit]".
+		/// Record per frame: uint32_t frame id, int64_t time (s since epoch),
+		/// number of metrics x double (NaN if unset).
+		///
+		class FrameMetrics {
+		public:
+
+			/// Version of the binary format.
+			static const uint32_t BINARY_VERSION = 1;
+
+			/// The metrics, in output order.
+			enum Metric {
+				PARTICLES = 0,
+				PARTICLE_LIST_MS,
+				KDTREE_MS,
+				RADIUS_MULTIPLIER,
+				MAX_NEIGHBOURS,
+				NEIGHBOURS_MS,
+				CLUSTERS,
+				MIN_CLUSTER,
+				MAX_CLUSTER,
+				FAST_DEPTH_SIZE_ONE_CLUSTERS,
+				FAST_DEPTH_MIN_SIZE_CLUSTERS,
+				PARTICLES_IN_CLUSTERS,
+				PARTICLES_IN_GAS,
+				FAST_DEPTH_MS,
+				MIN_CLUSTER_SIZE,
+				PARTICLES_MERGED,
+				CLUSTERS_REMOVED,
+				MERGE_SIZE_ONE_CLUSTERS,
+				MERGE_MIN_SIZE_CLUSTERS,
+				MERGE_CLUSTERS_MS,
+				FORWARD_MIN_CP_PERCENTAGE,
+				FORWARD_MEAN_CP_PERCENTAGE,
+				FORWARD_DEVIATION_CP_PERCENTAGE,
+				FORWARD_MAX_CP_PERCENTAGE,
+				BACKWARDS_MIN_CP_PERCENTAGE,
+				BACKWARDS_MEAN_CP_PERCENTAGE,
+				BACKWARDS_DEVIATION_CP_PERCENTAGE,
+				BACKWARDS_MAX_CP_PERCENTAGE,
+				COMPARE_CLUSTERS_MS,
+				MS_MIN_CLUSTER_AMOUNT,
+				MS_MIN_CP_PERCENTAGE,
+				BD_MAX_CP_PERCENTAGE,
+				BIRTHS,
+				DEATHS,
+				MERGES,
+				SPLITS,
+				TOTAL_EVENTS,
+				DETERMINE_EVENTS_MS,
+				COMPLETE_CALCULATION_MS,
+				PARTICLE_LIST_KIB,
+				PREVIOUS_PARTICLE_LIST_KIB,
+				KDTREE_KIB,
+				CLUSTER_LIST_KIB,
+				PREVIOUS_CLUSTER_LIST_KIB,
+				PARTNERS_LIST_KIB,
+				STRUCTURE_EVENTS_KIB,
+				TOTAL_KIB,
+				FRAME_ARENA_KIB,
+				HEAP_ALLOCATIONS,
+				METRIC_COUNT
+			};
+
+			///
+			/// Streaming mean, standard deviation, minimum and maximum (Welford),
+			/// the values are not stored.
+			///
+			class RunningStats {
+			public:
+				RunningStats(void);
+
+				void Add(const double value);
+
+				inline uint64_t GetCount(void) const {
+					return this->count;
+				}
+
+				/// 0 if no value was added.
+				inline double GetMean(void) const {
+					return this->mean;
+				}
+
+				/// Population standard deviation, 0 if no value was added.
+				double GetDeviation(void) const;
+
+				inline double GetMin(void) const {
+					return this->min;
+				}
+
+				inline double GetMax(void) const {
+					return this->max;
+				}
+
+			private:
+				uint64_t count;
+				double mean;
+				double m2; // Sum of squared differences to the mean.
+				double min;
+				double max;
+			};
+
+			/// Ctor.
+			FrameMetrics(void);
+
+			/// Dtor.
+			virtual ~FrameMetrics(void);
+
+			/// Unsets all values and starts a new frame.
+			void Reset(const unsigned int frameID, const time_t time, const std::string& timeString);
+
+			/// Sets the value.
+			inline void Set(const Metric metric, const double value) {
+				this->values[metric].store(value, std::memory_order_relaxed);
+			}
+
+			/// Sets the milliseconds since start.
+			inline void SetDuration(const Metric metric, const std::chrono::system_clock::time_point& start) {
+				this->Set(metric, static_cast<double>(std::chrono::duration_cast<std::chrono::milliseconds>(
+					std::chrono::system_clock::now() - start).count()));
+			}
+
+			/// Adds to the value, an unset value counts as 0. Safe from several threads.
+			void Add(const Metric metric, const double value);
+
+			/// NaN if unset.
+			inline double Get(const Metric metric) const {
+				return this->values[metric].load(std::memory_order_relaxed);
+			}
+
+			bool IsSet(const Metric metric) const;
+
+			/// Name of the metric.
+			static const char* GetName(const Metric metric);
+
+			/// Unit of the metric.
+			static const char* GetUnit(const Metric metric);
+
+			/// Writes the two header lines: names with units, units.
+			void WriteCSVHeader(std::ostream& out) const;
+
+			/// Writes the frame as one line.
+			void WriteCSV(std::ostream& out, const std::string& label) const;
+
+			/// Writes the header of a binary file.
+			void WriteBinaryHeader(std::ostream& out, const std::string& label) const;
+
+			/// Writes the frame as one binary record.
+			void WriteBinary(std::ostream& out) const;
+
+		private:
+
+			/// Forbidden copy ctor.
+			FrameMetrics(const FrameMetrics& src);
+
+			/// Forbidden assignment.
+			FrameMetrics& operator=(const FrameMetrics& rhs);
+
+			/// Values of the frame, NaN if unset.
+			std::atomic<double> values[METRIC_COUNT];
+
+			unsigned int frameID;
+			time_t time;
+			std::string timeString;
+		};
+
+	} /* namespace mmvis_static */
+} /* namespace megamol */
+
+#endif /* MMVISSTATIC_FrameMetrics_H_INCLUDED */
@@ -0,0 +1,199 @@
+/**
+ * FrameResultCache.cpp
+ *
+ * Copyright (C) 2009-2015 by MegaMol Team
+ * Copyright (C) 2015 by Richard Hhne, TU Dresden
+ * Alle Rechte vorbehalten.
+ */
+
+#include "FrameResultCache.h"
+
+#include <tuple>
+
+using namespace megamol;
+
+namespace {
+
+	/// Memory of a partner list in byte.
+	size_t getPartnerBytes(const std::vector<mmvis_static::StructureEventsPipeline::PartnerClusters>& list) {
+		size_t bytes = list.size() * sizeof(mmvis_static::StructureEventsPipeline::PartnerClusters);
+		for (auto & partnerClusters : list)
+			bytes += partnerClusters.getNumberOfPartners() * sizeof(mmvis_static::StructureEventsPipeline::PartnerClusters::PartnerCluster);
+		return bytes;
+	}
+
+} /* end anonymous namespace */
+
+
+/**
+ * mmvis_static::FrameResultCache::Key::operator<
+ */
+bool mmvis_static::FrameResultCache::Key::operator<(const Key& rhs) const {
+	return std::tie(this->frameID, this->dataHash, this->neighbourSearch, this->radiusMultiplier, this->minClusterSize, this->periodicBoundary, this->clusterColoring)
+		< std::tie(rhs.frameID, rhs.dataHash, rhs.neighbourSearch, rhs.radiusMultiplier, rhs.minClusterSize, rhs.periodicBoundary, rhs.clusterColoring);
+}
+
+
+/**
+ * mmvis_static::FrameResultCache::Entry::GetBytes
+ */
+size_t mmvis_static::FrameResultCache::Entry::GetBytes(void) const {
+	return sizeof(Entry)
+		+ this->particles.capacity() * sizeof(CachedParticle)
+		+ this->clusterList.capacity() * sizeof(StructureEventsPipeline::Cluster)
+		+ getPartnerBytes(this->partnerClustersList.forwardList)
+		+ getPartnerBytes(this->partnerClustersList.backwardsList)
+		+ this->events.capacity() * sizeof(StructureEventsPipeline::Event);
+}
+
+
+/**
+ * mmvis_static::FrameResultCache::FrameResultCache
+ */
+mmvis_static::FrameResultCache::FrameResultCache(const size_t capacity) : entries(), lru(), bytes(0), capacity(capacity) {
+}
+
+
+/**
+ * mmvis_static::FrameResultCache::~FrameResultCache
+ */
+mmvis_static::FrameResultCache::~FrameResultCache(void) {
+}
+
+
+/**
+ * mmvis_static::FrameResultCache::SetCapacity
+ */
+void mmvis_static::FrameResultCache::SetCapacity(const size_t capacity) {
+	this->capacity = capacity;
+	this->evict();
+}
+
+
+/**
+ * mmvis_static::FrameResultCache::Put
+ */
+void mmvis_static::FrameResultCache::Put(const Key& key, const StructureEventsPipeline& pipeline, const bool compared,
+		const std::vector<StructureEventsPipeline::Event>& events, const StructureEventsPipeline::Parameters& parameters) {
+	std::shared_ptr<Entry> entry = std::make_shared<Entry>();
+
+	entry->particles.resize(pipeline.particleList.size());
+	for (size_t i = 0; i < pipeline.particleList.size(); ++i) {
+		const StructureEventsPipeline::Particle& particle = pipeline.particleList[i];
+		CachedParticle& cached = entry->particles[i];
+		cached.x = particle.x;
+		cached.y = particle.y;
+		cached.z = particle.z;
+		cached.r = particle.r;
+		cached.g = particle.g;
+		cached.b = particle.b;
+		cached.clusterID = particle.clusterID;
+	}
+	entry->clusterList = pipeline.clusterList;
+	entry->compared = compared;
+	if (compared) {
+		entry->partnerClustersList = pipeline.partnerClustersList;
+		entry->events = events;
+		entry->parameters = parameters;
+	}
+
+	///
+	/// Replace the result of the key.
+	///
+	auto existing = this->entries.find(key);
+	if (existing != this->entries.end()) {
+		this->bytes -= existing->second.bytes;
+		this->lru.erase(existing->second.lruPosition);
+		this->entries.erase(existing);
+	}
+
+	const size_t entryBytes = entry->GetBytes();
+	if (entryBytes > this->capacity)
+		return;
+
+	this->lru.push_front(key);
+	Slot& slot = this->entries[key];
+	slot.entry = entry;
+	slot.bytes = entryBytes;
+	slot.lruPosition = this->lru.begin();
+	this->bytes += entryBytes;
+	this->evict();
+}
+
+
+/**
+ * mmvis_static::FrameResultCache::Get
+ */
+std::shared_ptr<const mmvis_static::FrameResultCache::Entry> mmvis_static::FrameResultCache::Get(const Key& key) {
+	auto slot = this->entries.find(key);
+	if (slot == this->entries.end())
+		return std::shared_ptr<const Entry>();
+
+	this->lru.splice(this->lru.begin(), this->lru, slot->second.lruPosition);
+	return slot->second.entry;
+}
+
+
+/**
+ * mmvis_static::FrameResultCache::Clear
+ */
+void mmvis_static::FrameResultCache::Clear(void) {
+	this->entries.clear();
+	this->lru.clear();
+	this->bytes = 0;
+}
+
+
+/**
+ * mmvis_static::FrameResultCache::Restore
+ */
+bool mmvis_static::FrameResultCache::Restore(const Entry& entry, StructureEventsPipeline& pipeline) {
+	if (entry.particles.size() != pipeline.particleList.size())
+		return false;
+
+	for (size_t i = 0; i < entry.particles.size(); ++i) {
+		const CachedParticle& cached = entry.particles[i];
+		StructureEventsPipeline::Particle& particle = pipeline.particleList[i];
+		particle.r = cached.r;
+		particle.g = cached.g;
+		particle.b = cached.b;
+		particle.clusterID = cached.clusterID;
+	}
+	pipeline.clusterList = entry.clusterList;
+	return true;
+}
+
+
+/**
+ * mmvis_static::FrameResultCache::RestorePrevious
+ */
+void mmvis_static::FrameResultCache::RestorePrevious(const Entry& entry, StructureEventsPipeline& pipeline) {
+	pipeline.previousParticleList.clear();
+	pipeline.previousParticleList.resize(entry.particles.size());
+	for (size_t i = 0; i < entry.particles.size(); ++i) {
+		const CachedParticle& cached = entry.particles[i];
+		StructureEventsPipeline::Particle& particle = pipeline.previousParticleList[i];
+		particle.x = cached.x;
+		particle.y = cached.y;
+		particle.z = cached.z;
+		particle.r = cached.r;
+		particle.g = cached.g;
+		particle.b = cached.b;
+		particle.id = i;
+		particle.clusterID = cached.clusterID;
+	}
+	pipeline.previousClusterList = entry.clusterList;
+}
+
+
+/**
+ * mmvis_static::FrameResultCache::evict
+ */
+void mmvis_static::FrameResultCache::evict(void) {
+	while (this->bytes > this->capacity && !this->lru.empty()) {
+		auto slot = this->entries.find(this->lru.back());
+		this->bytes -= slot->second.bytes;
+		this->entries.erase(slot);
+		this->lru.pop_back();
+	}
+}
@@ -0,0 +1,155 @@
+/**
+ * FrameResultCache.h
+ *
+ * Copyright (C) 2009-2015 by MegaMol Team
+ * Copyright (C) 2015 by Richard Hhne, TU Dresden
+ * Alle Rechte vorbehalten.
+ */
+
+#ifndef MMVISSTATIC_FrameResultCache_H_INCLUDED
+#define MMVISSTATIC_FrameResultCache_H_INCLUDED
+#if (defined(_MSC_VER) && (_MSC_VER > 1000))
+#pragma once
+#endif /* (defined(_MSC_VER) && (_MSC_VER > 1000)) */
+
+#include "StructureEventsPipeline.h"
+
+#include <cstddef>
+#include <list>
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace megamol {
+	namespace mmvis_static {
+
+		/**
+		 * In-memory LRU cache of the results of calculated frames, bounded by
+		 * byte. Holds what steps 3 and 4 and the output need: positions,
+		 * colours and cluster assignment of the particles, the cluster table,
+		 * the partner lists of the comparison with the previous frame and the
+		 * events. The neighbours are not kept.
+		 *
+		 * Not thread safe, used by the thread that calculates.
+		 */
+		class FrameResultCache {
+		public:
+
+			/// Default bound of the cached results in byte.
+			static const size_t DEFAULT_CAPACITY = static_cast<size_t>(512) * 1024 * 1024;
+
+			/// A frame and the settings of steps 1 and 2 that its clusters depend on, and the colouring of the cached colours.
+			struct Key {
+				unsigned int frameID;
+				size_t dataHash;
+				int neighbourSearch;
+				int radiusMultiplier;
+				int minClusterSize;
+				bool periodicBoundary;
+				int clusterColoring;
+
+				bool operator<(const Key& rhs) const;
+
+				bool operator==(const Key& rhs) const {
+					return !(*this < rhs) && !(rhs < *this);
+				}
+			};
+
+			/// Particle of a cached frame.
+			struct CachedParticle {
+				float x, y, z;
+				float r, g, b;
+				int clusterID;
+			};
+
+			/// Result of a frame.
+			struct Entry {
+				std::vector<CachedParticle> particles; // Same order as the particle list.
+				std::vector<StructureEventsPipeline::Cluster> clusterList;
+				bool compared; // Steps 3 and 4 ran, partner lists and events are set.
+				StructureEventsPipeline::PartnerClustersList partnerClustersList;
+				std::vector<StructureEventsPipeline::Event> events;
+				StructureEventsPipeline::Parameters parameters; // Step 4 thresholds of the events.
+
+				/// Memory of the entry in byte.
+				size_t GetBytes(void) const;
+			};
+
+			/// Ctor.
+			FrameResultCache(const size_t capacity = DEFAULT_CAPACITY);
+
+			/// Dtor.
+			virtual ~FrameResultCache(void);
+
+			/// Sets the bound, evicts the least recently used results. 0 switches the cache off.
+			void SetCapacity(const size_t capacity);
+
+			///
+			/// Stores the current frame of the pipeline, replaces a result with the
+			/// same key. Results bigger than the capacity are not stored.
+			/// @param events Events of step 4 and their parameters, only used if compared.
+			///
+			void Put(const Key& key, const StructureEventsPipeline& pipeline, const bool compared,
+				const std::vector<StructureEventsPipeline::Event>& events, const StructureEventsPipeline::Parameters& parameters);
+
+			///
+			/// The result of the key, the most recently used one afterwards.
+			/// @return NULL if the result is not cached.
+			///
+			std::shared_ptr<const Entry> Get(const Key& key);
+
+			/// Removes all results.
+			void Clear(void);
+
+			///
+			/// Sets cluster assignment, colours and cluster table of the current
+			/// frame of the pipeline, whose particle list has been built from the
+			/// same data (step 1a).
+			/// @return False if the particle counts differ, nothing is changed then.
+			///
+			static bool Restore(const Entry& entry, StructureEventsPipeline& pipeline);
+
+			/// Sets the previous lists of the pipeline to the cached frame, for step 3.
+			static void RestorePrevious(const Entry& entry, StructureEventsPipeline& pipeline);
+
+			inline size_t GetBytes(void) const {
+				return this->bytes;
+			}
+
+			inline size_t GetCount(void) const {
+				return this->entries.size();
+			}
+
+		private:
+
+			/// Cached result and its position in the LRU list.
+			struct Slot {
+				std::shared_ptr<const Entry> entry;
+				size_t bytes;
+				std::list<Key>::iterator lruPosition;
+			};
+
+			/// Forbidden copy ctor.
+			FrameResultCache(const FrameResultCache& src);
+
+			/// Forbidden assignment.
+			FrameResultCache& operator=(const FrameResultCache& rhs);
+
+			/// Removes least recently used results until bytes fits the capacity.
+			void evict(void);
+
+			std::map<Key, Slot> entries;
+
+			/// Keys, most recently used first.
+			std::list<Key> lru;
+
+			/// Memory of all entries in byte.
+			size_t bytes;
+
+			size_t capacity;
+		};
+
+	} /* namespace mmvis_static */
+} /* namespace megamol */
+
+#endif /* MMVISSTATIC_FrameResultCache_H_INCLUDED */
@@ -0,0 +1,249 @@
+/**
+ * FrameScheduler.cpp
+ *
+ * Copyright (C) 2009-2015 by MegaMol Team
+ * Copyright (C) 2015 by Richard Hhne, TU Dresden
+ * Alle Rechte vorbehalten.
+ */
+
+#include "FrameScheduler.h"
+
+#include <algorithm>
+#include <thread>
+
+using namespace megamol;
+
+/**
+ * mmvis_static::FrameScheduler::FrameScheduler
+ */
+mmvis_static::FrameScheduler::FrameScheduler(const unsigned int workerCount, const size_t memoryBudget) :
+	workerCount(workerCount > 0 ? workerCount : std::max(1u, std::thread::hardware_concurrency())),
+	memoryBudget(memoryBudget), logCallback(),
+	framesInFlight(0), bytesInFlight(0), frameBytesEstimate(0), failed(false), endFrame(0), runningSearches(0), finishedFrames() {
+}
+
+
+/**
+ * mmvis_static::FrameScheduler::~FrameScheduler
+ */
+mmvis_static::FrameScheduler::~FrameScheduler(void) {
+}
+
+
+/**
+ * mmvis_static::FrameScheduler::Run
+ */
+bool mmvis_static::FrameScheduler::Run(const unsigned int firstFrame, const unsigned int frameCount,
+		const StructureEventsPipeline::Parameters& parameters, const FrameSource& source, const FrameSink& sink) {
+	///
+	/// The parallel loops of the workers of both stages share the default
+	/// TaskPool, a worker waiting for its loop runs its own ranges.
+	///
+	const unsigned int searchWorkers = std::max(1u, (this->workerCount + 1) / 2);
+	const unsigned int clusterWorkers = std::max(1u, this->workerCount / 2);
+
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		this->framesInFlight = 0;
+		this->bytesInFlight = 0;
+		this->frameBytesEstimate = 0;
+		this->failed = false;
+		this->endFrame = firstFrame + frameCount;
+		this->runningSearches = searchWorkers;
+		this->finishedFrames.clear();
+	}
+
+	// Enough pipelines for every worker, the queues, the load stage and the sink.
+	const size_t poolSize = searchWorkers + clusterWorkers + 2 * QUEUE_CAPACITY + 2;
+	Stages stages(poolSize);
+	for (size_t i = 0; i < poolSize; ++i) {
+		PipelinePtr pipeline(new StructureEventsPipeline());
+		if (this->logCallback)
+			pipeline->SetLogCallback(std::bind(&FrameScheduler::logSerialized, this, std::placeholders::_1, std::placeholders::_2));
+		stages.freePipelines.Push(std::move(pipeline));
+	}
+
+	std::vector<std::thread> threads;
+	threads.push_back(std::thread(&FrameScheduler::load, this, firstFrame, frameCount, std::cref(source), &stages));
+	for (unsigned int i = 0; i < searchWorkers; ++i)
+		threads.push_back(std::thread(&FrameScheduler::findNeighbours, this, std::cref(parameters), &stages));
+	for (unsigned int i = 0; i < clusterWorkers; ++i)
+		threads.push_back(std::thread(&FrameScheduler::createClusters, this, std::cref(parameters), &stages));
+
+	///
+	/// Sink stage: hand the frames to the sink in frame order.
+	///
+	bool result = true;
+	for (unsigned int frameID = firstFrame; frameID < firstFrame + frameCount; ++frameID) {
+		StageFrame frame;
+		{
+			std::unique_lock<std::mutex> lock(this->mutex);
+			this->frameFinished.wait(lock, [this, frameID]() {
+				return this->failed || this->finishedFrames.count(frameID) > 0 || frameID >= this->endFrame;
+			});
+			auto finished = this->finishedFrames.find(frameID);
+			if (finished == this->finishedFrames.end()) {
+				result = false; // A stage or the source failed.
+				break;
+			}
+			frame = std::move(finished->second);
+			this->finishedFrames.erase(finished);
+		}
+
+		const bool consumed = sink(*frame.pipeline);
+
+		// Recycle the pipeline, the lists and particles keep their memory.
+		frame.pipeline->Recycle();
+		stages.freePipelines.Push(std::move(frame.pipeline));
+
+		{
+			std::lock_guard<std::mutex> lock(this->mutex);
+			this->framesInFlight--;
+			this->bytesInFlight -= frame.bytes;
+		}
+		this->frameConsumed.notify_all();
+
+		if (!consumed) {
+			result = false;
+			break;
+		}
+	}
+
+	///
+	/// Stop the stages, frames that have not been consumed are dropped.
+	///
+	if (!result)
+		this->fail(&stages);
+	for (auto & thread : threads)
+		thread.join();
+
+	std::lock_guard<std::mutex> lock(this->mutex);
+	this->finishedFrames.clear();
+	return result;
+}
+
+
+/**
+ * mmvis_static::FrameScheduler::GetFrameBytes
+ */
+size_t mmvis_static::FrameScheduler::GetFrameBytes(const StructureEventsPipeline& pipeline) {
+	size_t bytes = pipeline.particleList.capacity() * sizeof(StructureEventsPipeline::Particle)
+		+ pipeline.clusterList.capacity() * sizeof(StructureEventsPipeline::Cluster);
+	for (auto & particle : pipeline.particleList)
+		bytes += particle.neighbourIDs.capacity() * sizeof(uint64_t);
+	return bytes;
+}
+
+
+/**
+ * mmvis_static::FrameScheduler::load
+ */
+void mmvis_static::FrameScheduler::load(const unsigned int firstFrame, const unsigned int frameCount, const FrameSource& source,
+		Stages *stages) {
+	std::vector<StructureEventsPipeline::ParticleSpan> spans;
+	for (unsigned int frameID = firstFrame; frameID < firstFrame + frameCount; ++frameID) {
+		StageFrame frame;
+		{
+			std::unique_lock<std::mutex> lock(this->mutex);
+			this->frameConsumed.wait(lock, [this]() {
+				return this->failed || this->framesInFlight == 0
+					|| this->bytesInFlight + this->frameBytesEstimate <= this->memoryBudget;
+			});
+			if (this->failed)
+				break;
+			frame.bytes = this->frameBytesEstimate;
+			this->framesInFlight++;
+			this->bytesInFlight += frame.bytes;
+		}
+
+		if (!stages->freePipelines.Pop(frame.pipeline))
+			break; // Failed.
+
+		if (!source(frameID, spans)) {
+			// The frames before are still calculated and consumed.
+			{
+				std::lock_guard<std::mutex> lock(this->mutex);
+				this->endFrame = frameID;
+			}
+			this->frameFinished.notify_all();
+			break;
+		}
+		frame.pipeline->BeginFrame(frameID);
+		for (auto & span : spans)
+			frame.pipeline->AddParticles(span);
+
+		if (!stages->loaded.Push(std::move(frame)))
+			break;
+	}
+	stages->loaded.Close();
+}
+
+
+/**
+ * mmvis_static::FrameScheduler::findNeighbours
+ */
+void mmvis_static::FrameScheduler::findNeighbours(const StructureEventsPipeline::Parameters& parameters, Stages *stages) {
+	StageFrame frame;
+	while (stages->loaded.Pop(frame)) {
+		frame.pipeline->FindNeighbours(parameters);
+		if (!stages->searched.Push(std::move(frame)))
+			break;
+	}
+
+	bool last;
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		last = (--this->runningSearches == 0);
+	}
+	if (last)
+		stages->searched.Close();
+}
+
+
+/**
+ * mmvis_static::FrameScheduler::createClusters
+ */
+void mmvis_static::FrameScheduler::createClusters(const StructureEventsPipeline::Parameters& parameters, Stages *stages) {
+	StageFrame frame;
+	while (stages->searched.Pop(frame)) {
+		frame.pipeline->CreateClustersFastDepth(parameters);
+		frame.pipeline->MergeSmallClusters(parameters);
+		const size_t bytes = GetFrameBytes(*frame.pipeline);
+
+		{
+			std::lock_guard<std::mutex> lock(this->mutex);
+			this->bytesInFlight = this->bytesInFlight - frame.bytes + bytes;
+			this->frameBytesEstimate = bytes;
+			frame.bytes = bytes;
+			const unsigned int frameID = frame.pipeline->GetFrameID();
+			this->finishedFrames[frameID] = std::move(frame);
+		}
+		this->frameFinished.notify_all();
+		this->frameConsumed.notify_all(); // The estimate changed.
+	}
+}
+
+
+/**
+ * mmvis_static::FrameScheduler::fail
+ */
+void mmvis_static::FrameScheduler::fail(Stages *stages) {
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		this->failed = true;
+	}
+	stages->freePipelines.Close();
+	stages->loaded.Close();
+	stages->searched.Close();
+	this->frameFinished.notify_all();
+	this->frameConsumed.notify_all();
+}
+
+
+/**
+ * mmvis_static::FrameScheduler::logSerialized
+ */
+void mmvis_static::FrameScheduler::logSerialized(const StructureEventsPipeline::LogLevel level, const std::string& message) {
+	std::lock_guard<std::mutex> lock(this->logMutex);
+	this->logCallback(level, message);
+}
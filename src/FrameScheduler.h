@@ -0,0 +1,186 @@
+/**
+ * FrameScheduler.h
+ *
+ * Copyright (C) 2009-2015 by MegaMol Team
+ * Copyright (C) 2015 by Richard Hhne, TU Dresden
+ * Alle Rechte vorbehalten.
+ */
+
+#ifndef MMVISSTATIC_FrameScheduler_H_INCLUDED
+#define MMVISSTATIC_FrameScheduler_H_INCLUDED
+#if (defined(_MSC_VER) && (_MSC_VER > 1000))
+#pragma once
+#endif /* (defined(_MSC_VER) && (_MSC_VER > 1000)) */
+
+#include "BoundedQueue.h"
+#include "StructureEventsPipeline.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace megamol {
+	namespace mmvis_static {
+
+		/**
+		 * Calculates a time series as a pipeline of stages, so loading,
+		 * calculation and output of neighbouring frames overlap:
+		 *
+		 *   load -> neighbours -> clusters -> sink (steps 3 and 4, output)
+		 *
+		 * The load stage reads the frames in order on one thread and builds
+		 * the particle lists. Steps 1 and 2 of a frame do not depend on other
+		 * frames, so the neighbour and cluster stages have several workers,
+		 * whose parallel loops share the default TaskPool. The sink gets the frames
+		 * in frame order on the thread of Run, it typically compares them and
+		 * hands the output to an AsyncOutputQueue, the write stage.
+		 *
+		 * The stages are connected by bounded queues. The pipelines are taken
+		 * from a pool and recycled after the sink, so their lists keep their
+		 * memory from frame to frame.
+		 *
+		 * Frames are loaded while the memory of the frames in flight (in a
+		 * stage or waiting for the sink) stays within the budget, estimated by
+		 * the last clustered frame. One frame is always loaded, so a single
+		 * frame bigger than the budget is calculated alone.
+		 *
+		 * Use StructureEventsPipeline::NEIGHBOURSEARCH_GRID, the kD-tree
+		 * search runs one frame at a time.
+		 */
+		class FrameScheduler {
+		public:
+
+			/// Default bound of the memory of the frames in flight in byte.
+			static const size_t DEFAULT_MEMORY_BUDGET = static_cast<size_t>(2048) * 1024 * 1024;
+
+			/// Frames queued between two stages.
+			static const size_t QUEUE_CAPACITY = 2;
+
+			///
+			/// Fills the particle spans of the frame. Called on the load thread
+			/// in frame order, the spans have to stay valid until the next call.
+			/// @return False on error, the frames before are still passed to the sink.
+			///
+			typedef std::function<bool(const unsigned int frameID, std::vector<StructureEventsPipeline::ParticleSpan>& spans)> FrameSource;
+
+			///
+			/// Receives the pipeline of a frame after step 2, in frame order on
+			/// the thread of Run. Typically adopted by a sequential pipeline
+			/// for steps 3 and 4 (StructureEventsPipeline::AdoptFrame).
+			/// @return False to stop.
+			///
+			typedef std::function<bool(StructureEventsPipeline& clustered)> FrameSink;
+
+			///
+			/// Ctor.
+			/// @param workerCount Workers of the neighbour and cluster stages together, 0 for one per hardware thread.
+			///
+			FrameScheduler(const unsigned int workerCount = 0, const size_t memoryBudget = DEFAULT_MEMORY_BUDGET);
+
+			/// Dtor.
+			virtual ~FrameScheduler(void);
+
+			/// Sets the log callback of the worker pipelines, the calls are serialized.
+			inline void SetLogCallback(const StructureEventsPipeline::LogCallback& callback) {
+				this->logCallback = callback;
+			}
+
+			inline unsigned int GetWorkerCount(void) const {
+				return this->workerCount;
+			}
+
+			///
+			/// Calculates the frames firstFrame to firstFrame + frameCount - 1.
+			/// @return False if the source or the sink failed.
+			///
+			bool Run(const unsigned int firstFrame, const unsigned int frameCount, const StructureEventsPipeline::Parameters& parameters,
+				const FrameSource& source, const FrameSink& sink);
+
+			/// Memory of the particle and cluster lists of the pipeline in byte.
+			static size_t GetFrameBytes(const StructureEventsPipeline& pipeline);
+
+		private:
+
+			typedef std::unique_ptr<StructureEventsPipeline> PipelinePtr;
+
+			/// A frame passed from stage to stage.
+			/// Move only, the move members are explicit since VS2013 does not generate them.
+			struct StageFrame {
+				PipelinePtr pipeline;
+				size_t bytes; // Accounted in bytesInFlight.
+
+				StageFrame(void) : pipeline(), bytes(0) {}
+
+				StageFrame(StageFrame&& src) : pipeline(std::move(src.pipeline)), bytes(src.bytes) {}
+
+				StageFrame& operator=(StageFrame&& rhs) {
+					this->pipeline = std::move(rhs.pipeline);
+					this->bytes = rhs.bytes;
+					return *this;
+				}
+
+			private:
+				StageFrame(const StageFrame& src);
+				StageFrame& operator=(const StageFrame& rhs);
+			};
+
+			/// Pool and queues of a run.
+			struct Stages {
+				BoundedQueue<PipelinePtr> freePipelines;
+				BoundedQueue<StageFrame> loaded;
+				BoundedQueue<StageFrame> searched;
+
+				Stages(const size_t poolSize) : freePipelines(poolSize), loaded(QUEUE_CAPACITY), searched(QUEUE_CAPACITY) {}
+			};
+
+			/// Forbidden copy ctor.
+			FrameScheduler(const FrameScheduler& src);
+
+			/// Forbidden assignment.
+			FrameScheduler& operator=(const FrameScheduler& rhs);
+
+			/// Load stage, reads the frames and builds the particle lists.
+			void load(const unsigned int firstFrame, const unsigned int frameCount, const FrameSource& source, Stages *stages);
+
+			/// Neighbour stage worker, step 1.
+			void findNeighbours(const StructureEventsPipeline::Parameters& parameters, Stages *stages);
+
+			/// Cluster stage worker, step 2, hands the frames over to Run.
+			void createClusters(const StructureEventsPipeline::Parameters& parameters, Stages *stages);
+
+			/// Stops the run, the queues are closed.
+			void fail(Stages *stages);
+
+			/// Log callback of the pipelines, serializes the calls.
+			void logSerialized(const StructureEventsPipeline::LogLevel level, const std::string& message);
+
+			unsigned int workerCount;
+
+			size_t memoryBudget;
+
+			StructureEventsPipeline::LogCallback logCallback;
+
+			/// State of the run, guarded by mutex.
+			size_t framesInFlight;
+			size_t bytesInFlight;
+			size_t frameBytesEstimate;
+			bool failed;
+			unsigned int endFrame; // Frames from here on are not loaded.
+			unsigned int runningSearches; // Neighbour workers, the last one closes the searched queue.
+			std::map<unsigned int, StageFrame> finishedFrames;
+
+			std::mutex mutex;
+			std::mutex logMutex;
+			std::condition_variable frameFinished;
+			std::condition_variable frameConsumed;
+		};
+
+	} /* namespace mmvis_static */
+} /* namespace megamol */
+
+#endif /* MMVISSTATIC_FrameScheduler_H_INCLUDED */
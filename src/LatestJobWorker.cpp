@@ -0,0 +1,116 @@
+/**
+ * LatestJobWorker.cpp
+ *
+ * Copyright (C) 2009-2015 by MegaMol Team
+ * Copyright (C) 2015 by Richard Hhne, TU Dresden
+ * Alle Rechte vorbehalten.
+ */
+
+#include "stdafx.h"
+#include "LatestJobWorker.h"
+
+#include "vislib/sys/Log.h"
+
+#include <exception>
+
+using namespace megamol;
+
+/**
+ * mmvis_static::LatestJobWorker::LatestJobWorker
+ */
+mmvis_static::LatestJobWorker::LatestJobWorker(void) : waitingJob(), busy(false), stop(false), droppedCount(0) {
+	this->thread = std::thread(&LatestJobWorker::run, this);
+}
+
+
+/**
+ * mmvis_static::LatestJobWorker::~LatestJobWorker
+ */
+mmvis_static::LatestJobWorker::~LatestJobWorker(void) {
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		this->stop = true;
+		this->waitingJob = nullptr;
+	}
+	this->jobAvailable.notify_all();
+	if (this->thread.joinable())
+		this->thread.join();
+}
+
+
+/**
+ * mmvis_static::LatestJobWorker::Submit
+ */
+bool mmvis_static::LatestJobWorker::Submit(const std::function<void(void)>& job) {
+	bool dropped;
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		dropped = static_cast<bool>(this->waitingJob);
+		if (dropped)
+			this->droppedCount++;
+		this->waitingJob = job;
+	}
+	this->jobAvailable.notify_one();
+	return dropped;
+}
+
+
+/**
+ * mmvis_static::LatestJobWorker::IsIdle
+ */
+bool mmvis_static::LatestJobWorker::IsIdle(void) {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	return !this->waitingJob && !this->busy;
+}
+
+
+/**
+ * mmvis_static::LatestJobWorker::Wait
+ */
+void mmvis_static::LatestJobWorker::Wait(void) {
+	std::unique_lock<std::mutex> lock(this->mutex);
+	this->jobDone.wait(lock, [this]() {
+		return !this->waitingJob && !this->busy;
+	});
+}
+
+
+/**
+ * mmvis_static::LatestJobWorker::GetDroppedCount
+ */
+size_t mmvis_static::LatestJobWorker::GetDroppedCount(void) {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	return this->droppedCount;
+}
+
+
+/**
+ * mmvis_static::LatestJobWorker::run
+ */
+void mmvis_static::LatestJobWorker::run(void) {
+	std::unique_lock<std::mutex> lock(this->mutex);
+	while (true) {
+		this->jobAvailable.wait(lock, [this]() {
+			return this->stop || static_cast<bool>(this->waitingJob);
+		});
+		if (this->stop)
+			break;
+
+		std::function<void(void)> job;
+		job.swap(this->waitingJob);
+		this->busy = true;
+		lock.unlock();
+
+		try {
+			job();
+		}
+		catch (const std::exception& e) {
+			vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_ERROR, "Worker: Job failed: %s", e.what());
+		}
+
+		lock.lock();
+		this->busy = false;
+		this->jobDone.notify_all();
+	}
+	this->jobDone.notify_all();
+}
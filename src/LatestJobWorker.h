@@ -0,0 +1,86 @@
+/**
+ * LatestJobWorker.h
+ *
+ * Copyright (C) 2009-2015 by MegaMol Team
+ * Copyright (C) 2015 by Richard Hhne, TU Dresden
+ * Alle Rechte vorbehalten.
+ */
+
+#ifndef MMVISSTATIC_LatestJobWorker_H_INCLUDED
+#define MMVISSTATIC_LatestJobWorker_H_INCLUDED
+#if (defined(_MSC_VER) && (_MSC_VER > 1000))
+#pragma once
+#endif /* (defined(_MSC_VER) && (_MSC_VER > 1000)) */
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace megamol {
+	namespace mmvis_static {
+
+		/**
+		 * Runs jobs on a worker thread, only the latest submitted job waits.
+		 *
+		 * A job submitted while another one waits replaces it, e.g. the
+		 * calculation of a frame the user already scrubbed past. The running
+		 * job is always finished.
+		 */
+		class LatestJobWorker {
+		public:
+
+			/// Ctor, starts the worker thread.
+			LatestJobWorker(void);
+
+			/// Dtor, finishes the running job, drops the waiting one.
+			virtual ~LatestJobWorker(void);
+
+			///
+			/// Queues the job, replacing the waiting job.
+			/// @return True if a waiting job has been dropped.
+			///
+			bool Submit(const std::function<void(void)>& job);
+
+			/// True if no job runs or waits.
+			bool IsIdle(void);
+
+			/// Blocks until no job runs or waits.
+			void Wait(void);
+
+			/// Number of dropped jobs since the start.
+			size_t GetDroppedCount(void);
+
+		private:
+
+			/// Forbidden copy ctor.
+			LatestJobWorker(const LatestJobWorker& src);
+
+			/// Forbidden assignment.
+			LatestJobWorker& operator=(const LatestJobWorker& rhs);
+
+			/// Worker thread loop.
+			void run(void);
+
+			/// The waiting job, empty if none.
+			std::function<void(void)> waitingJob;
+
+			/// Flag that a job is running.
+			bool busy;
+
+			/// Flag that the thread has to end.
+			bool stop;
+
+			size_t droppedCount;
+
+			std::mutex mutex;
+			std::condition_variable jobAvailable;
+			std::condition_variable jobDone;
+			std::thread thread;
+		};
+
+	} /* namespace mmvis_static */
+} /* namespace megamol */
+
+#endif /* MMVISSTATIC_LatestJobWorker_H_INCLUDED */
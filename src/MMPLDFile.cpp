@@ -0,0 +1,226 @@
+/**
+ * MMPLDFile.cpp
+ *
+ * Copyright (C) 2009-2015 by MegaMol Team
+ * Copyright (C) 2015 by Richard Hhne, TU Dresden
+ * Alle Rechte vorbehalten.
+ */
+
+#include "MMPLDFile.h"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace megamol;
+
+namespace {
+
+	/// Reads a value from the mapping, false if it would exceed the end.
+	template<typename T>
+	bool readValue(const uint8_t *& position, const uint8_t *end, T& value) {
+		if (static_cast<size_t>(end - position) < sizeof(T))
+			return false;
+		::memcpy(&value, position, sizeof(T));
+		position += sizeof(T);
+		return true;
+	}
+
+} /* end anonymous namespace */
+
+
+/**
+ * mmvis_static::MMPLDFile::MMPLDFile
+ */
+mmvis_static::MMPLDFile::MMPLDFile(void) : file(), version(0), frameCount(0), frameTable() {
+	std::fill(this->bbox, this->bbox + 6, 0.f);
+	std::fill(this->cbox, this->cbox + 6, 0.f);
+}
+
+
+/**
+ * mmvis_static::MMPLDFile::~MMPLDFile
+ */
+mmvis_static::MMPLDFile::~MMPLDFile(void) {
+	this->Close();
+}
+
+
+/**
+ * mmvis_static::MMPLDFile::Open
+ */
+bool mmvis_static::MMPLDFile::Open(const std::string& filename) {
+	this->Close();
+
+	if (!this->file.Open(filename.c_str()))
+		return false;
+
+	const uint8_t *position = this->file.GetData();
+	const uint8_t *end = position + this->file.GetSize();
+	char magic[6];
+	uint16_t version;
+	uint32_t frameCount;
+	bool valid = readValue(position, end, magic) && readValue(position, end, version) && readValue(position, end, frameCount)
+		&& readValue(position, end, this->bbox) && readValue(position, end, this->cbox);
+	if (!valid || ::memcmp(magic, "MMPLD", 6) != 0 || version < 100 || version > 103
+		|| static_cast<uint64_t>(end - position) / sizeof(uint64_t) <= frameCount) {
+		this->Close();
+		return false;
+	}
+	this->version = version;
+	this->frameCount = frameCount;
+
+	this->frameTable.resize(static_cast<size_t>(frameCount) + 1);
+	::memcpy(this->frameTable.data(), position, this->frameTable.size() * sizeof(uint64_t));
+	if (!std::is_sorted(this->frameTable.begin(), this->frameTable.end()) || this->frameTable.back() > this->file.GetSize()) {
+		this->Close();
+		return false;
+	}
+	return true;
+}
+
+
+/**
+ * mmvis_static::MMPLDFile::Close
+ */
+void mmvis_static::MMPLDFile::Close(void) {
+	this->file.Close();
+	this->version = 0;
+	this->frameCount = 0;
+	this->frameTable.clear();
+}
+
+
+/**
+ * mmvis_static::MMPLDFile::GetFrame
+ */
+bool mmvis_static::MMPLDFile::GetFrame(const unsigned int frameID, Frame& frame, const bool prefetchNext) const {
+	frame.frameID = frameID;
+	frame.time = static_cast<float>(frameID);
+	frame.lists.clear();
+	if (!this->IsOpen() || frameID >= this->frameCount)
+		return false;
+
+	// The lists are read once front to back, the next frame while this one is calculated.
+	this->file.Advise(this->frameTable[frameID], this->GetFrameSize(frameID), MappedFile::ACCESS_SEQUENTIAL);
+	if (prefetchNext)
+		this->Prefetch(frameID + 1);
+
+	const uint8_t *position = this->file.GetData() + this->frameTable[frameID];
+	const uint8_t *end = this->file.GetData() + this->frameTable[frameID + 1];
+
+	if (this->version == 102 || this->version == 103) {
+		if (!readValue(position, end, frame.time))
+			return false;
+	}
+
+	uint32_t listCount;
+	if (!readValue(position, end, listCount))
+		return false;
+
+	frame.lists.reserve(listCount);
+	for (uint32_t listIndex = 0; listIndex < listCount; ++listIndex) {
+		ParticleList list;
+		uint8_t vertexType, colourType;
+		if (!readValue(position, end, vertexType) || !readValue(position, end, colourType))
+			return false;
+		list.vertexType = static_cast<VertexType>(vertexType);
+		list.colourType = static_cast<ColourType>(colourType);
+		if (vertexType > VERTEX_SHORT_XYZ || colourType > COLOUR_FLOAT_RGBA)
+			return false; // Unknown types, the size of the list is unknown.
+
+		list.globalRadius = 0;
+		if (list.vertexType == VERTEX_FLOAT_XYZ || list.vertexType == VERTEX_SHORT_XYZ) {
+			if (!readValue(position, end, list.globalRadius))
+				return false;
+		}
+
+		std::fill(list.globalColour, list.globalColour + 4, static_cast<uint8_t>(255));
+		list.minIntensity = 0;
+		list.maxIntensity = 1;
+		if (list.colourType == COLOUR_NONE) {
+			if (!readValue(position, end, list.globalColour))
+				return false;
+		}
+		else if (list.colourType == COLOUR_FLOAT_I) {
+			if (!readValue(position, end, list.minIntensity) || !readValue(position, end, list.maxIntensity))
+				return false;
+		}
+
+		if (!readValue(position, end, list.count))
+			return false;
+
+		if (this->version == 103) {
+			float listBBox[6];
+			if (!readValue(position, end, listBBox))
+				return false;
+		}
+
+		list.colourOffset = GetVertexSize(list.vertexType);
+		list.stride = list.colourOffset + GetColourSize(list.colourType);
+		list.data = position;
+		if (list.stride > 0 && static_cast<uint64_t>(end - position) / list.stride < list.count)
+			return false;
+		position += static_cast<size_t>(list.count * list.stride);
+
+		frame.lists.push_back(list);
+	}
+	return true;
+}
+
+
+/**
+ * mmvis_static::MMPLDFile::Prefetch
+ */
+void mmvis_static::MMPLDFile::Prefetch(const unsigned int frameID) const {
+	if (this->IsOpen() && frameID < this->frameCount)
+		this->file.Advise(this->frameTable[frameID], this->GetFrameSize(frameID), MappedFile::ACCESS_WILLNEED);
+}
+
+
+/**
+ * mmvis_static::MMPLDFile::GetFrameSize
+ */
+uint64_t mmvis_static::MMPLDFile::GetFrameSize(const unsigned int frameID) const {
+	if (!this->IsOpen() || frameID >= this->frameCount)
+		return 0;
+	return this->frameTable[frameID + 1] - this->frameTable[frameID];
+}
+
+
+/**
+ * mmvis_static::MMPLDFile::GetVertexSize
+ */
+unsigned int mmvis_static::MMPLDFile::GetVertexSize(const VertexType type) {
+	switch (type) {
+	case VERTEX_FLOAT_XYZ:
+		return 12;
+	case VERTEX_FLOAT_XYZR:
+		return 16;
+	case VERTEX_SHORT_XYZ:
+		return 6;
+	default:
+		return 0;
+	}
+}
+
+
+/**
+ * mmvis_static::MMPLDFile::GetColourSize
+ */
+unsigned int mmvis_static::MMPLDFile::GetColourSize(const ColourType type) {
+	switch (type) {
+	case COLOUR_UINT8_RGB:
+		return 3;
+	case COLOUR_UINT8_RGBA:
+		return 4;
+	case COLOUR_FLOAT_I:
+		return 4;
+	case COLOUR_FLOAT_RGB:
+		return 12;
+	case COLOUR_FLOAT_RGBA:
+		return 16;
+	default:
+		return 0;
+	}
+}
+
@@ -0,0 +1,192 @@
+/**
+ * MMPLDFile.h
+ *
+ * Copyright (C) 2009-2015 by MegaMol Team
+ * Copyright (C) 2015 by Richard Hhne, TU Dresden
+ * Alle Rechte vorbehalten.
+ */
+
+#ifndef MMVISSTATIC_MMPLDFile_H_INCLUDED
+#define MMVISSTATIC_MMPLDFile_H_INCLUDED
+#if (defined(_MSC_VER) && (_MSC_VER > 1000))
+#pragma once
+#endif /* (defined(_MSC_VER) && (_MSC_VER > 1000)) */
+
+#include "MappedFile.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace megamol {
+	namespace mmvis_static {
+
+		///
+		/// Reader of MMPLD particle files (versions 100 to 103), the format of
+		/// the MegaMol MMPLDDataSource. Uses the standard library only, so the
+		/// batch calculation reads frames without the MegaMol runtime.
+		///
+		/// The file is memory mapped, the particle lists of a frame are strided
+		/// views into the mapping without a copy. Getting a frame hints the
+		/// operating system to read the next one ahead, so the disk works
+		/// while the frame is calculated.
+		///
+		/// Header (60 byte):
+		/// 0..5 char* MagicIdentifier "MMPLD\0"
+		/// 6..7 uint16_t Version
+		/// 8..11 uint32_t Number of frames
+		/// 12..35 6x float (32 bit) Data set bounding box
+		/// 36..59 6x float (32 bit) Data set clipping box
+		/// Frame table: Number of frames + 1 x uint64_t frame offset, the last one is the file end.
+		///
+		/// Frame: float time stamp (versions 102 and 103), uint32_t number of lists, per list:
+		/// uint8_t vertex type, uint8_t colour type, float global radius (vertex types without radius),
+		/// 4x uint8_t global colour (no colour type) or 2x float intensity range (COLOUR_FLOAT_I),
+		/// uint64_t number of particles, 6x float list bounding box (version 103),
+		/// number of particles x interleaved vertex and colour.
+		/// The cluster infos of version 101 follow the lists and are ignored.
+		///
+		class MMPLDFile {
+		public:
+
+			/// Header size in byte.
+			static const unsigned int HEADER_SIZE = 60;
+
+			/// Vertex data types, same values as in the file.
+			enum VertexType : uint8_t {
+				VERTEX_NONE = 0,
+				VERTEX_FLOAT_XYZ = 1,
+				VERTEX_FLOAT_XYZR = 2,
+				VERTEX_SHORT_XYZ = 3
+			};
+
+			/// Colour data types, same values as in the file.
+			enum ColourType : uint8_t {
+				COLOUR_NONE = 0,
+				COLOUR_UINT8_RGB = 1,
+				COLOUR_UINT8_RGBA = 2,
+				COLOUR_FLOAT_I = 3,
+				COLOUR_FLOAT_RGB = 4,
+				COLOUR_FLOAT_RGBA = 5
+			};
+
+			/// Particle list of a frame, the data points into the mapping.
+			struct ParticleList {
+				VertexType vertexType;
+				ColourType colourType;
+				float globalRadius;
+				uint8_t globalColour[4];
+				float minIntensity, maxIntensity;
+				uint64_t count;
+				const uint8_t *data; // Interleaved vertex and colour.
+				unsigned int stride; // Byte per particle.
+				unsigned int colourOffset; // Byte from the vertex to the colour of a particle.
+
+				/// True for float vertices with the signed distance in COLOUR_FLOAT_I, the lists of the calculation.
+				inline bool HasSignedDistances(void) const {
+					return (this->vertexType == VERTEX_FLOAT_XYZ || this->vertexType == VERTEX_FLOAT_XYZR)
+						&& this->colourType == COLOUR_FLOAT_I;
+				}
+
+				/// Vertex of the particle, 3 or 4 (VERTEX_FLOAT_XYZR) floats.
+				inline const float* GetVertex(const uint64_t index) const {
+					return reinterpret_cast<const float*>(this->data + index * this->stride);
+				}
+
+				/// Signed distance of the particle in COLOUR_FLOAT_I lists.
+				inline const float* GetSignedDistance(const uint64_t index) const {
+					return reinterpret_cast<const float*>(this->data + index * this->stride + this->colourOffset);
+				}
+			};
+
+			/// One frame, its lists are valid while the file is open.
+			struct Frame {
+				unsigned int frameID;
+				float time; // Time stamp, frame id for versions without.
+				std::vector<ParticleList> lists;
+			};
+
+			/// Ctor.
+			MMPLDFile(void);
+
+			/// Dtor, closes the file.
+			virtual ~MMPLDFile(void);
+
+			/// Maps the file and parses the header and the frame table. Closes a previously opened file.
+			/// @return False if the file can not be mapped or is no MMPLD file.
+			bool Open(const std::string& filename);
+
+			/// Unmaps the file, the lists of all frames become invalid.
+			void Close(void);
+
+			inline bool IsOpen(void) const {
+				return this->frameTable.size() > 0;
+			}
+
+			inline unsigned int GetVersion(void) const {
+				return this->version;
+			}
+
+			inline unsigned int GetFrameCount(void) const {
+				return this->frameCount;
+			}
+
+			/// Left, bottom, back, right, top, front.
+			inline const float* GetBoundingBox(void) const {
+				return this->bbox;
+			}
+
+			/// Left, bottom, back, right, top, front.
+			inline const float* GetClipBox(void) const {
+				return this->cbox;
+			}
+
+			///
+			/// Parses the lists of one frame. Thread safe, any frame can be
+			/// parsed at any time.
+			///
+			/// @param prefetchNext Hints the operating system to read the next frame.
+			/// @return False if the frame id is out of range or the frame is corrupt.
+			///
+			bool GetFrame(const unsigned int frameID, Frame& frame, const bool prefetchNext = true) const;
+
+			/// Hints the operating system to read the frame ahead. Ignored for invalid frame ids.
+			void Prefetch(const unsigned int frameID) const;
+
+			/// Size of the frame in the file in byte, 0 for invalid frame ids.
+			uint64_t GetFrameSize(const unsigned int frameID) const;
+
+			/// Size of one vertex in byte.
+			static unsigned int GetVertexSize(const VertexType type);
+
+			/// Size of one colour in byte.
+			static unsigned int GetColourSize(const ColourType type);
+
+		private:
+
+			/// Forbidden copy ctor.
+			MMPLDFile(const MMPLDFile& src);
+
+			/// Forbidden assignment.
+			MMPLDFile& operator=(const MMPLDFile& rhs);
+
+			/// The mapped file.
+			MappedFile file;
+
+			unsigned int version;
+
+			unsigned int frameCount;
+
+			float bbox[6];
+
+			float cbox[6];
+
+			/// Offsets of the frames, frameCount + 1 entries.
+			std::vector<uint64_t> frameTable;
+		};
+
+	} /* namespace mmvis_static */
+} /* namespace megamol */
+
+#endif /* MMVISSTATIC_MMPLDFile_H_INCLUDED */
@@ -0,0 +1,166 @@
+/**
+ * MMSEAppendWriter.cpp
+ *
+ * Copyright (C) 2009-2015 by MegaMol Team
+ * Copyright (C) 2015 by Richard Hhne, TU Dresden
+ * Alle Rechte vorbehalten.
+ */
+
+#include "MMSEAppendWriter.h"
+
+#include <algorithm>
+
+using namespace megamol;
+
+/**
+ * mmvis_static::MMSEAppendWriter::MMSEAppendWriter
+ */
+mmvis_static::MMSEAppendWriter::MMSEAppendWriter(void) : file(), filename(), frameTable(), compressionLevel(0), isOpen(false) {
+	this->header.version = 0;
+	this->header.flags = 0;
+	this->header.eventCount = 0;
+	this->header.maxTime = 0;
+	this->header.frameCount = 0;
+	this->header.frameTableOffset = 0;
+}
+
+
+/**
+ * mmvis_static::MMSEAppendWriter::~MMSEAppendWriter
+ */
+mmvis_static::MMSEAppendWriter::~MMSEAppendWriter(void) {
+	this->Close();
+}
+
+
+/**
+ * mmvis_static::MMSEAppendWriter::Open
+ */
+bool mmvis_static::MMSEAppendWriter::Open(const std::string& filename, const bool withSideColumns, const unsigned int compressionLevel) {
+	this->Close();
+
+	this->file.open(filename.c_str(), std::ios_base::in | std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+	if (!this->file.is_open())
+		return false;
+	this->filename = filename;
+	this->compressionLevel = compressionLevel;
+	this->isOpen = true;
+
+	this->header.version = 0;
+	this->header.flags = withSideColumns ? MMSEFormat::FLAG_SIDE_COLUMNS : 0;
+	const float defaultBox[6] = { -1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f };
+	std::copy(defaultBox, defaultBox + 6, this->header.bbox);
+	std::copy(defaultBox, defaultBox + 6, this->header.cbox);
+	this->header.eventCount = 0;
+	this->header.maxTime = 0;
+	this->header.frameCount = 0;
+	this->header.frameTableOffset = MMSEFormat::HEADER_SIZE_V2;
+	this->frameTable.clear();
+
+	this->file.seekp(static_cast<std::streamoff>(this->header.frameTableOffset));
+	if (!this->writeTableAndHeader(0) || !this->writeVersion(MMSEFormat::VERSION_2)) {
+		this->Close();
+		return false;
+	}
+	return true;
+}
+
+
+/**
+ * mmvis_static::MMSEAppendWriter::Append
+ */
+bool mmvis_static::MMSEAppendWriter::Append(const StructureEvents& events, const float bbox[6], const float cbox[6],
+	const float maxTime) {
+
+	if (!this->isOpen)
+		return false;
+
+	// Flag the file as incomplete until the new table and header are written.
+	if (!this->writeVersion(0)) {
+		this->Close();
+		return false;
+	}
+
+	///
+	/// New chunks replace the old frame table.
+	///
+	std::vector<MMSEFormat::FrameEntry> newEntries;
+	this->file.seekp(static_cast<std::streamoff>(this->header.frameTableOffset));
+	if (!MMSEFormat::WriteFrameChunks(this->file, events, this->HasSideColumns(), newEntries, this->compressionLevel)) {
+		this->Close();
+		return false;
+	}
+	this->header.frameTableOffset = static_cast<uint64_t>(this->file.tellp());
+
+	///
+	/// Merge into the table, replaced frames lose their old entries.
+	///
+	for (auto & entry : newEntries) {
+		auto it = std::lower_bound(this->frameTable.begin(), this->frameTable.end(), entry.frameID,
+			[](const MMSEFormat::FrameEntry& lhs, const uint32_t frameID) {
+			return lhs.frameID < frameID;
+		});
+		if (it != this->frameTable.end() && it->frameID == entry.frameID) {
+			this->header.eventCount -= it->eventCount;
+			*it = entry;
+		}
+		else {
+			this->frameTable.insert(it, entry);
+		}
+		this->header.eventCount += entry.eventCount;
+	}
+
+	std::copy(bbox, bbox + 6, this->header.bbox);
+	std::copy(cbox, cbox + 6, this->header.cbox);
+	this->header.maxTime = maxTime;
+	this->header.frameCount = static_cast<uint32_t>(this->frameTable.size());
+
+	if (!this->writeTableAndHeader(0) || !this->writeVersion(MMSEFormat::VERSION_2)) {
+		this->Close();
+		return false;
+	}
+	return true;
+}
+
+
+/**
+ * mmvis_static::MMSEAppendWriter::Close
+ */
+void mmvis_static::MMSEAppendWriter::Close(void) {
+	if (this->isOpen)
+		this->file.close();
+	this->file.clear();
+	this->isOpen = false;
+	this->filename.clear();
+	this->frameTable.clear();
+	this->header.eventCount = 0;
+	this->header.frameCount = 0;
+}
+
+
+/**
+ * mmvis_static::MMSEAppendWriter::writeTableAndHeader
+ */
+bool mmvis_static::MMSEAppendWriter::writeTableAndHeader(const uint32_t version) {
+	this->header.version = version;
+	return MMSEFormat::WriteFrameTable(this->file, this->frameTable)
+		&& MMSEFormat::WriteHeader(this->file, this->header);
+}
+
+
+/**
+ * mmvis_static::MMSEAppendWriter::writeVersion
+ */
+bool mmvis_static::MMSEAppendWriter::writeVersion(const uint32_t version) {
+	// Everything before has to be on disk before the version changes.
+	this->file.flush();
+	this->file.seekp(4);
+	const uint32_t versionTag = MMSEFormat::VERSION_TAG | version;
+	if (!this->file.write(reinterpret_cast<const char*>(&versionTag), 4))
+		return false;
+	this->file.flush();
+	if (!this->file)
+		return false;
+	this->header.version = version;
+	return true;
+}
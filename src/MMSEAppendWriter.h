@@ -0,0 +1,118 @@
+/**
+ * MMSEAppendWriter.h
+ *
+ * Copyright (C) 2009-2015 by MegaMol Team
+ * Copyright (C) 2015 by Richard Hhne, TU Dresden
+ * Alle Rechte vorbehalten.
+ */
+
+#ifndef MMVISSTATIC_MMSEAppendWriter_H_INCLUDED
+#define MMVISSTATIC_MMSEAppendWriter_H_INCLUDED
+#if (defined(_MSC_VER) && (_MSC_VER > 1000))
+#pragma once
+#endif /* (defined(_MSC_VER) && (_MSC_VER > 1000)) */
+
+#include "MMSEFormat.h"
+#include "StructureEvents.h"
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace megamol {
+	namespace mmvis_static {
+
+		/**
+		 * Writes a MMSE version 2 file frame by frame.
+		 *
+		 * The file stays open, every append writes the new chunks over the
+		 * old frame table, followed by the new table and the header. The
+		 * version field is zero during an append and set last, so a file
+		 * of an aborted append is read as incomplete instead of corrupt.
+		 */
+		class MMSEAppendWriter {
+		public:
+
+			/// Ctor.
+			MMSEAppendWriter(void);
+
+			/// Dtor, closes the file.
+			virtual ~MMSEAppendWriter(void);
+
+			///
+			/// Creates or overwrites the file, a complete file without events.
+			/// @param withSideColumns Write the side columns of all appended events.
+			/// @param compressionLevel 0 for raw chunks, 1 to 9 for deflated chunks.
+			///
+			bool Open(const std::string& filename, const bool withSideColumns, const unsigned int compressionLevel = 0);
+
+			///
+			/// Appends one chunk per frame of the events. Frames that are in the
+			/// file already are replaced, their old chunks stay unreferenced.
+			///
+			/// @param bbox Left, bottom, back, right, top, front, as cbox.
+			/// @param maxTime Maximum time of all events in the file after the append.
+			///
+			bool Append(const StructureEvents& events, const float bbox[6], const float cbox[6], const float maxTime);
+
+			/// Closes the file, it is complete after every append already.
+			void Close(void);
+
+			inline bool IsOpen(void) const {
+				return this->isOpen;
+			}
+
+			inline const std::string& GetFilename(void) const {
+				return this->filename;
+			}
+
+			inline bool HasSideColumns(void) const {
+				return (this->header.flags & MMSEFormat::FLAG_SIDE_COLUMNS) != 0;
+			}
+
+			inline unsigned int GetCompressionLevel(void) const {
+				return this->compressionLevel;
+			}
+
+			/// Number of events referenced by the frame table.
+			inline uint64_t GetEventCount(void) const {
+				return this->header.eventCount;
+			}
+
+		private:
+
+			/// Forbidden copy ctor.
+			MMSEAppendWriter(const MMSEAppendWriter& src);
+
+			/// Forbidden assignment.
+			MMSEAppendWriter& operator=(const MMSEAppendWriter& rhs);
+
+			/// Writes the frame table at the current position and the header with the given version.
+			bool writeTableAndHeader(const uint32_t version);
+
+			/// Overwrites only the version field and flushes.
+			bool writeVersion(const uint32_t version);
+
+			/// The opened file.
+			std::fstream file;
+
+			/// The file name of the opened file.
+			std::string filename;
+
+			/// Header as written last.
+			MMSEFormat::Header header;
+
+			/// Frame table as written last, ordered by frame id.
+			std::vector<MMSEFormat::FrameEntry> frameTable;
+
+			/// Compression level of appended chunks.
+			unsigned int compressionLevel;
+
+			/// Flag that the file is opened.
+			bool isOpen;
+		};
+
+	} /* namespace mmvis_static */
+} /* namespace megamol */
+
+#endif /* MMVISSTATIC_MMSEAppendWriter_H_INCLUDED */
@@ -0,0 +1,487 @@
+/**
+ * MMSEFormat.cpp
+ *
+ * Copyright (C) 2009-2015 by MegaMol Team
+ * Copyright (C) 2015 by Richard Hhne, TU Dresden
+ * Alle Rechte vorbehalten.
+ */
+
+#include "MMSEFormat.h"
+
+#include "TaskPool.h"
+
+#include "lodepng/lodepng.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <functional>
+
+using namespace megamol;
+
+#define ASSERT_READ(A, S) if (!file.read(reinterpret_cast<char*>(A), static_cast<std::streamsize>(S))) { \
+		return false; \
+	}
+#define ASSERT_WRITEOUT(A, S) if (!file.write(reinterpret_cast<const char*>(A), static_cast<std::streamsize>(S))) { \
+		return false; \
+	}
+
+namespace {
+
+	///
+	/// Collects small writes in an aligned buffer of several MiB,
+	/// so the file sees few large writes.
+	///
+	class StagingBuffer {
+	public:
+
+		/// Capacity and alignment in byte.
+		static const size_t CAPACITY = 8 * 1024 * 1024;
+		static const size_t ALIGNMENT = 4096;
+
+		StagingBuffer(std::ostream& file) : file(file), storage(CAPACITY + ALIGNMENT), used(0) {
+			const uintptr_t address = reinterpret_cast<uintptr_t>(this->storage.data());
+			this->buffer = this->storage.data() + (ALIGNMENT - address % ALIGNMENT) % ALIGNMENT;
+		}
+
+		/// Appends data, writes the buffer whenever it is full.
+		bool Add(const void *data, size_t size) {
+			const uint8_t *bytes = static_cast<const uint8_t*>(data);
+			while (size > 0) {
+				const size_t part = std::min(size, CAPACITY - this->used);
+				::memcpy(this->buffer + this->used, bytes, part);
+				this->used += part;
+				bytes += part;
+				size -= part;
+				if (this->used == CAPACITY && !this->Flush())
+					return false;
+			}
+			return true;
+		}
+
+		/// Writes the buffered data.
+		bool Flush(void) {
+			if (this->used > 0 && !this->file.write(reinterpret_cast<const char*>(this->buffer), static_cast<std::streamsize>(this->used)))
+				return false;
+			this->used = 0;
+			return true;
+		}
+
+	private:
+		std::ostream& file;
+		std::vector<uint8_t> storage;
+		uint8_t *buffer;
+		size_t used;
+	};
+
+
+	/// Deflate settings for the compression levels 1 to 9.
+	LodePNGCompressSettings GetCompressSettings(const unsigned int level) {
+		LodePNGCompressSettings settings;
+		lodepng_compress_settings_init(&settings);
+		settings.windowsize = 2048u << std::min(4u, level > 0 ? level - 1 : 0u); // Up to 32768.
+		settings.lazymatching = level >= 5 ? 1 : 0;
+		settings.nicematch = level >= 7 ? 258 : 128;
+		return settings;
+	}
+
+	///
+	/// Location of the 4 byte columns of a raw chunk: the 5 event fields
+	/// with the event stride and the side columns one after another.
+	///
+	inline size_t ColumnStart(const size_t column, const size_t eventCount) {
+		return column < 5 ? column * 4 : (5 * 4 * eventCount) + (column - 5) * 4 * eventCount;
+	}
+	inline size_t ColumnStride(const size_t column) {
+		return column < 5 ? sizeof(mmvis_static::StructureEvents::StructureEvent) : 4;
+	}
+
+	///
+	/// Deflates a raw chunk. Each 4 byte column is delta encoded on its bit
+	/// pattern and split into byte planes, so slowly changing positions and
+	/// constant times per frame become long runs.
+	///
+	bool EncodeChunk(const uint8_t *raw, const size_t eventCount, const bool withSideColumns,
+		const LodePNGCompressSettings& settings, std::vector<uint8_t>& out) {
+
+		const size_t columnAmount = withSideColumns ? 9 : 5;
+		std::vector<uint8_t> planes(columnAmount * 4 * eventCount);
+		for (size_t column = 0; column < columnAmount; ++column) {
+			const uint8_t *values = raw + ColumnStart(column, eventCount);
+			const size_t stride = ColumnStride(column);
+			uint8_t *columnPlanes = planes.data() + column * 4 * eventCount;
+			uint32_t previous = 0;
+			for (size_t i = 0; i < eventCount; ++i) {
+				uint32_t value;
+				::memcpy(&value, values + i * stride, 4);
+				const uint32_t delta = value - previous;
+				previous = value;
+				for (size_t b = 0; b < 4; ++b)
+					columnPlanes[b * eventCount + i] = static_cast<uint8_t>(delta >> (8 * b));
+			}
+		}
+
+		out.clear();
+		return lodepng::compress(out, planes.data(), planes.size(), settings) == 0;
+	}
+
+} /* end anonymous namespace */
+
+
+/**
+ * mmvis_static::MMSEFormat::ReadHeader
+ */
+bool mmvis_static::MMSEFormat::ReadHeader(std::istream& file, Header& header) {
+	file.seekg(0);
+
+	char magicid[4];
+	ASSERT_READ(magicid, 4);
+	if (::memcmp(magicid, "MMSE", 4) != 0)
+		return false;
+
+	uint32_t versionTag;
+	ASSERT_READ(&versionTag, 4);
+	if ((versionTag & 0xFFFF0000) == VERSION_TAG) {
+		header.version = versionTag & 0x0000FFFF;
+		ASSERT_READ(&header.flags, 4);
+		ASSERT_READ(header.bbox, 4 * 6);
+	}
+	else { // Version 1, the tag is the first bounding box value.
+		header.version = 1;
+		header.flags = 0;
+		::memcpy(header.bbox, &versionTag, 4);
+		ASSERT_READ(header.bbox + 1, 4 * 5);
+	}
+	ASSERT_READ(header.cbox, 4 * 6);
+	ASSERT_READ(&header.eventCount, 8);
+	ASSERT_READ(&header.maxTime, 4);
+
+	if (header.version == 1) {
+		header.frameCount = 0;
+		header.frameTableOffset = 0;
+		return true;
+	}
+
+	ASSERT_READ(&header.frameCount, 4);
+	ASSERT_READ(&header.frameTableOffset, 8);
+	return true;
+}
+
+
+/**
+ * mmvis_static::MMSEFormat::WriteHeader
+ */
+bool mmvis_static::MMSEFormat::WriteHeader(std::ostream& file, const Header& header) {
+	file.seekp(0);
+
+	ASSERT_WRITEOUT("MMSE", 4);
+	uint32_t versionTag = VERSION_TAG | header.version;
+	ASSERT_WRITEOUT(&versionTag, 4);
+	ASSERT_WRITEOUT(&header.flags, 4);
+	ASSERT_WRITEOUT(header.bbox, 6 * 4); // 6 * float.
+	ASSERT_WRITEOUT(header.cbox, 6 * 4); // 6 * float.
+	ASSERT_WRITEOUT(&header.eventCount, 8);
+	ASSERT_WRITEOUT(&header.maxTime, 4);
+	ASSERT_WRITEOUT(&header.frameCount, 4);
+	ASSERT_WRITEOUT(&header.frameTableOffset, 8);
+	return true;
+}
+
+
+/**
+ * mmvis_static::MMSEFormat::ReadFrameTable
+ */
+bool mmvis_static::MMSEFormat::ReadFrameTable(std::istream& file, const Header& header, std::vector<FrameEntry>& frameTable) {
+	frameTable.resize(header.frameCount);
+	if (header.frameCount == 0)
+		return true;
+
+	file.seekg(static_cast<std::streamoff>(header.frameTableOffset));
+	for (auto & entry : frameTable) {
+		ASSERT_READ(&entry.frameID, 4);
+		ASSERT_READ(&entry.encoding, 4);
+		ASSERT_READ(&entry.offset, 8);
+		ASSERT_READ(&entry.eventCount, 8);
+		ASSERT_READ(&entry.byteSize, 8);
+	}
+	return true;
+}
+
+
+/**
+ * mmvis_static::MMSEFormat::WriteFrameTable
+ */
+bool mmvis_static::MMSEFormat::WriteFrameTable(std::ostream& file, const std::vector<FrameEntry>& frameTable) {
+	for (auto & entry : frameTable) {
+		ASSERT_WRITEOUT(&entry.frameID, 4);
+		ASSERT_WRITEOUT(&entry.encoding, 4);
+		ASSERT_WRITEOUT(&entry.offset, 8);
+		ASSERT_WRITEOUT(&entry.eventCount, 8);
+		ASSERT_WRITEOUT(&entry.byteSize, 8);
+	}
+	return true;
+}
+
+
+/**
+ * mmvis_static::MMSEFormat::WriteFrameChunks
+ */
+bool mmvis_static::MMSEFormat::WriteFrameChunks(std::ostream& file, const StructureEvents& events, const bool withSideColumns,
+	std::vector<FrameEntry>& frameTable, const unsigned int compressionLevel) {
+
+	const size_t count = events.getCount();
+	if (count == 0)
+		return true;
+
+	const unsigned int stride = events.getStride();
+	const uint8_t *base = static_cast<const uint8_t*>(events.getLocation());
+	auto eventAt = [base, stride](const size_t index) -> const StructureEvents::StructureEvent& {
+		return *reinterpret_cast<const StructureEvents::StructureEvent*>(base + index * stride);
+	};
+	const StructureEvents::SideColumns& side = events.getSideColumns();
+	const bool writeSide = withSideColumns && events.hasSideColumns();
+
+	///
+	/// Events of the calculation are ordered by frame already,
+	/// other lists are ordered by an index list.
+	///
+	bool ordered = true;
+	for (size_t i = 1; i < count && ordered; ++i)
+		ordered = GetFrame(eventAt(i - 1).time) <= GetFrame(eventAt(i).time);
+
+	std::vector<size_t> order;
+	if (!ordered) {
+		order.resize(count);
+		for (size_t i = 0; i < count; ++i)
+			order[i] = i;
+		std::stable_sort(order.begin(), order.end(), [&eventAt](const size_t lhs, const size_t rhs) {
+			return GetFrame(eventAt(lhs).time) < GetFrame(eventAt(rhs).time);
+		});
+	}
+	auto indexAt = [&order, ordered](const size_t position) {
+		return ordered ? position : order[position];
+	};
+
+	///
+	/// One chunk per frame.
+	///
+	const size_t eventSize = sizeof(StructureEvents::StructureEvent);
+	const size_t chunkEventSize = eventSize + (writeSide ? SIDE_COLUMNS_SIZE : 0);
+	const bool contiguous = ordered && stride == eventSize;
+	const size_t firstEntry = frameTable.size();
+	std::vector<size_t> chunkBegins;
+	size_t begin = 0;
+	while (begin < count) {
+		const uint32_t frame = GetFrame(eventAt(indexAt(begin)).time);
+		size_t end = begin + 1;
+		while (end < count && GetFrame(eventAt(indexAt(end)).time) == frame)
+			++end;
+
+		FrameEntry entry;
+		entry.frameID = frame;
+		entry.encoding = compressionLevel > 0 ? ENCODING_DEFLATE : ENCODING_RAW;
+		entry.offset = 0;
+		entry.eventCount = end - begin;
+		entry.byteSize = entry.eventCount * chunkEventSize;
+		frameTable.push_back(entry);
+		chunkBegins.push_back(begin);
+
+		begin = end;
+	}
+	const size_t chunkAmount = chunkBegins.size();
+
+	/// Appends the raw chunk of the events in [chunkBegin, chunkBegin + chunkCount) to the target.
+	auto gatherChunk = [&](const size_t chunkBegin, const size_t chunkCount, const std::function<bool(const void*, size_t)>& add) -> bool {
+		if (contiguous) {
+			if (!add(base + chunkBegin * eventSize, chunkCount * eventSize))
+				return false;
+		}
+		else {
+			for (size_t i = 0; i < chunkCount; ++i)
+				if (!add(&eventAt(indexAt(chunkBegin + i)), eventSize))
+					return false;
+		}
+
+		if (!writeSide)
+			return true;
+
+		const void *columns[4] = { side.triggerClusterIDs, side.triggerClusterSizes, side.partnerCounts, side.commonPercentages };
+		for (const void *column : columns) {
+			const uint8_t *values = static_cast<const uint8_t*>(column);
+			if (ordered) {
+				if (!add(values + chunkBegin * 4, chunkCount * 4))
+					return false;
+			}
+			else {
+				for (size_t i = 0; i < chunkCount; ++i)
+					if (!add(values + indexAt(chunkBegin + i) * 4, 4))
+						return false;
+			}
+		}
+		return true;
+	};
+
+	StagingBuffer staging(file);
+	uint64_t offset = static_cast<uint64_t>(file.tellp());
+
+	if (compressionLevel == 0) {
+		// Raw chunks follow each other, so their offsets are known before they are written.
+		for (size_t chunk = 0; chunk < chunkAmount; ++chunk) {
+			frameTable[firstEntry + chunk].offset = offset;
+			offset += frameTable[firstEntry + chunk].byteSize;
+		}
+
+		///
+		/// Without side columns the chunks of contiguous events are the event
+		/// list itself, so it is written in one piece.
+		///
+		if (contiguous && !writeSide) {
+			ASSERT_WRITEOUT(base, count * eventSize);
+			return true;
+		}
+
+		///
+		/// Otherwise the chunks are gathered in a staging buffer that is written
+		/// whenever it is full, independent of the chunk sizes.
+		///
+		auto add = [&staging](const void *data, const size_t size) {
+			return staging.Add(data, size);
+		};
+		for (size_t chunk = 0; chunk < chunkAmount; ++chunk) {
+			if (!gatherChunk(chunkBegins[chunk], static_cast<size_t>(frameTable[firstEntry + chunk].eventCount), add))
+				return false;
+		}
+		return staging.Flush();
+	}
+
+	///
+	/// Compressed chunks are encoded in parallel, a batch at a time to bound the memory.
+	///
+	const LodePNGCompressSettings settings = GetCompressSettings(compressionLevel);
+	const int batchSize = 64;
+	std::vector<std::vector<uint8_t>> encoded(batchSize);
+	for (size_t batchBegin = 0; batchBegin < chunkAmount; batchBegin += batchSize) {
+		const int batchAmount = static_cast<int>(std::min(static_cast<size_t>(batchSize), chunkAmount - batchBegin));
+		std::atomic<bool> batchSuccess(true);
+
+		// Chunks differ in size, one per range lets the pool balance them.
+		TaskPool::GetDefault()->ParallelFor(0, static_cast<size_t>(batchAmount), 1, [&](size_t begin, size_t end, unsigned int) {
+			for (size_t i = begin; i < end; ++i) {
+				const size_t chunk = batchBegin + i;
+				const size_t chunkCount = static_cast<size_t>(frameTable[firstEntry + chunk].eventCount);
+				std::vector<uint8_t> raw;
+				raw.reserve(chunkCount * chunkEventSize);
+				gatherChunk(chunkBegins[chunk], chunkCount, [&raw](const void *data, const size_t size) {
+					const uint8_t *bytes = static_cast<const uint8_t*>(data);
+					raw.insert(raw.end(), bytes, bytes + size);
+					return true;
+				});
+				if (!EncodeChunk(raw.data(), chunkCount, writeSide, settings, encoded[i]))
+					batchSuccess = false;
+			}
+		});
+		if (!batchSuccess)
+			return false;
+
+		for (int i = 0; i < batchAmount; ++i) {
+			FrameEntry& entry = frameTable[firstEntry + batchBegin + i];
+			entry.offset = offset;
+			entry.byteSize = encoded[i].size();
+			offset += entry.byteSize;
+			if (!staging.Add(encoded[i].data(), encoded[i].size()))
+				return false;
+		}
+	}
+	return staging.Flush();
+}
+
+
+/**
+ * mmvis_static::MMSEFormat::DecodeChunk
+ */
+bool mmvis_static::MMSEFormat::DecodeChunk(const uint8_t *data, const Header& header, const FrameEntry& entry,
+	StructureEvents::StructureEvent *events,
+	int *triggerClusterIDs, int *triggerClusterSizes, int *partnerCounts, float *commonPercentages) {
+
+	const size_t n = static_cast<size_t>(entry.eventCount);
+	const bool fileSide = (header.flags & FLAG_SIDE_COLUMNS) != 0;
+	void *sideTargets[4] = { triggerClusterIDs, triggerClusterSizes, partnerCounts, commonPercentages };
+	const bool readSide = fileSide && triggerClusterIDs != NULL;
+
+	if (entry.encoding == ENCODING_RAW) {
+		if (entry.byteSize < n * (sizeof(StructureEvents::StructureEvent) + (fileSide ? SIDE_COLUMNS_SIZE : 0)))
+			return false;
+		::memcpy(events, data, n * sizeof(StructureEvents::StructureEvent));
+		for (size_t column = 0; column < 4 && readSide; ++column)
+			::memcpy(sideTargets[column], data + ColumnStart(column + 5, n), n * 4);
+		return true;
+	}
+
+	if (entry.encoding != ENCODING_DEFLATE)
+		return false; // Unknown encoding.
+
+	const size_t columnAmount = fileSide ? 9 : 5;
+	std::vector<unsigned char> planes;
+	if (lodepng::decompress(planes, data, static_cast<size_t>(entry.byteSize)) != 0 || planes.size() != columnAmount * 4 * n)
+		return false;
+
+	///
+	/// Undo byte planes and deltas, writing each column to its target.
+	///
+	for (size_t column = 0; column < columnAmount; ++column) {
+		uint8_t *target;
+		size_t stride;
+		if (column < 5) {
+			target = reinterpret_cast<uint8_t*>(events) + column * 4;
+			stride = sizeof(StructureEvents::StructureEvent);
+		}
+		else {
+			if (!readSide)
+				break;
+			target = static_cast<uint8_t*>(sideTargets[column - 5]);
+			stride = 4;
+		}
+
+		const uint8_t *columnPlanes = planes.data() + column * 4 * n;
+		uint32_t value = 0;
+		for (size_t i = 0; i < n; ++i) {
+			uint32_t delta = 0;
+			for (size_t b = 0; b < 4; ++b)
+				delta |= static_cast<uint32_t>(columnPlanes[b * n + i]) << (8 * b);
+			value += delta;
+			::memcpy(target + i * stride, &value, 4);
+		}
+	}
+	return true;
+}
+
+
+/**
+ * mmvis_static::MMSEFormat::ReadFrameChunk
+ */
+bool mmvis_static::MMSEFormat::ReadFrameChunk(std::istream& file, const Header& header, const FrameEntry& entry,
+	StructureEvents::StructureEvent *events,
+	int *triggerClusterIDs, int *triggerClusterSizes, int *partnerCounts, float *commonPercentages) {
+
+	file.seekg(static_cast<std::streamoff>(entry.offset));
+	const size_t n = static_cast<size_t>(entry.eventCount);
+
+	if (entry.encoding == ENCODING_RAW) {
+		ASSERT_READ(events, n * sizeof(StructureEvents::StructureEvent));
+		if ((header.flags & FLAG_SIDE_COLUMNS) && triggerClusterIDs != NULL) {
+			ASSERT_READ(triggerClusterIDs, n * 4);
+			ASSERT_READ(triggerClusterSizes, n * 4);
+			ASSERT_READ(partnerCounts, n * 4);
+			ASSERT_READ(commonPercentages, n * 4);
+		}
+		return true;
+	}
+
+	std::vector<uint8_t> data(static_cast<size_t>(entry.byteSize));
+	ASSERT_READ(data.data(), data.size());
+	return DecodeChunk(data.data(), header, entry, events, triggerClusterIDs, triggerClusterSizes, partnerCounts, commonPercentages);
+}
+
+
+#undef ASSERT_WRITEOUT
+#undef ASSERT_READ
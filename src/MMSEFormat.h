@@ -0,0 +1,170 @@
+/**
+ * MMSEFormat.h
+ *
+ * Copyright (C) 2009-2015 by MegaMol Team
+ * Copyright (C) 2015 by Richard Hhne, TU Dresden
+ * Alle Rechte vorbehalten.
+ */
+
+#ifndef MMVISSTATIC_MMSEFormat_H_INCLUDED
+#define MMVISSTATIC_MMSEFormat_H_INCLUDED
+#if (defined(_MSC_VER) && (_MSC_VER > 1000))
+#pragma once
+#endif /* (defined(_MSC_VER) && (_MSC_VER > 1000)) */
+
+#include "StructureEvents.h"
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+
+#include <vector>
+
+namespace megamol {
+	namespace mmvis_static {
+
+		///
+		/// MMSE file format, shared by the writers and the data source. Part
+		/// of the MegaMol independent core, errors are only returned, the
+		/// callers log them.
+		///
+		/// Version 1 (no version field):
+		/// 0..3 char* MagicIdentifier "MMSE"
+		/// 4..27 6x float (32 bit) Data set bounding box
+		/// 28..51 6x float (32 bit) Data set clipping box
+		/// 52..59 uint64_t Number of events
+		/// 60..63 float Maximum time of all events
+		/// Body: Number of events x StructureEvent (20 byte), optional "MMSD" side block.
+		///
+		/// Version 2 header:
+		/// 0..3 char* MagicIdentifier "MMSE"
+		/// 4..7 uint32_t Version tag (VERSION_TAG | version). Read as float it is NaN,
+		///      so it can not be mistaken for the first bounding box value of version 1.
+		/// 8..11 uint32_t Flags (Flags enum)
+		/// 12..35 6x float (32 bit) Data set bounding box
+		/// 36..59 6x float (32 bit) Data set clipping box
+		/// 60..67 uint64_t Number of events
+		/// 68..71 float Maximum time of all events
+		/// 72..75 uint32_t Number of frame chunks
+		/// 76..83 uint64_t Offset of the frame table
+		///
+		/// Version 2 body: one chunk per frame, then the frame table.
+		/// Chunk: Number of events x StructureEvent, with FLAG_SIDE_COLUMNS followed by
+		/// Number of events x int cluster id, x int cluster size, x int partner count,
+		/// x float common particles ratio.
+		/// Frame table entry (32 byte): uint32_t frame id, uint32_t encoding,
+		/// uint64_t chunk offset, uint64_t number of events, uint64_t chunk size in byte.
+		///
+		/// ENCODING_DEFLATE chunks hold the same columns as raw chunks (the 5 event
+		/// fields, then the side columns), each delta encoded on its 32 bit pattern,
+		/// split into 4 byte planes and zlib compressed as one stream.
+		///
+		class MMSEFormat {
+		public:
+
+			/// Upper bits of the version tag.
+			static const uint32_t VERSION_TAG = 0x7FFF0000;
+
+			/// Version of complete version 2 files.
+			static const uint32_t VERSION_2 = 200;
+
+			/// Header sizes in byte.
+			static const unsigned int HEADER_SIZE_V1 = 64;
+			static const unsigned int HEADER_SIZE_V2 = 84;
+
+			/// Size of a frame table entry in byte.
+			static const unsigned int FRAME_ENTRY_SIZE = 32;
+
+			/// Size of the side columns of one event in byte.
+			static const unsigned int SIDE_COLUMNS_SIZE = 16;
+
+			/// Header flags.
+			enum Flags : uint32_t {
+				FLAG_SIDE_COLUMNS = 1 << 0
+			};
+
+			/// Chunk encodings.
+			enum Encoding : uint32_t {
+				ENCODING_RAW = 0,
+				ENCODING_DEFLATE = 1
+			};
+
+			/// Highest compression level of the writers, 0 writes raw chunks.
+			static const unsigned int MAX_COMPRESSION_LEVEL = 9;
+
+			/// Header of both versions, version is 1 for files without version field.
+			struct Header {
+				uint32_t version;
+				uint32_t flags;
+				float bbox[6]; // Left, bottom, back, right, top, front.
+				float cbox[6];
+				uint64_t eventCount;
+				float maxTime;
+				uint32_t frameCount;
+				uint64_t frameTableOffset;
+			};
+
+			/// Entry of the frame table.
+			struct FrameEntry {
+				uint32_t frameID;
+				uint32_t encoding;
+				uint64_t offset;
+				uint64_t eventCount;
+				uint64_t byteSize;
+			};
+
+			/// Frame of an event, its time rounded down.
+			static inline uint32_t GetFrame(const float time) {
+				return time <= 0 ? 0 : static_cast<uint32_t>(time);
+			}
+
+			/// Reads the header of a version 1 or 2 file from the file start.
+			static bool ReadHeader(std::istream& file, Header& header);
+
+			/// Writes a version 2 header at the file start.
+			static bool WriteHeader(std::ostream& file, const Header& header);
+
+			/// Reads the frame table of a version 2 file.
+			static bool ReadFrameTable(std::istream& file, const Header& header, std::vector<FrameEntry>& frameTable);
+
+			/// Writes the frame table at the current file position.
+			static bool WriteFrameTable(std::ostream& file, const std::vector<FrameEntry>& frameTable);
+
+			///
+			/// Writes one chunk per frame at the current file position and
+			/// appends the chunks to the frame table. Contiguous events without
+			/// side columns are written in one piece, other lists are gathered
+			/// in a staging buffer of several MiB.
+			///
+			/// @param compressionLevel 0 for raw chunks, 1 to 9 for deflated chunks.
+			///
+			static bool WriteFrameChunks(std::ostream& file, const StructureEvents& events, const bool withSideColumns,
+				std::vector<FrameEntry>& frameTable, const unsigned int compressionLevel = 0);
+
+			///
+			/// Reads one chunk. Side columns are only read if the file has them
+			/// and the pointers are not NULL.
+			///
+			/// @param events Space for entry.eventCount events.
+			///
+			static bool ReadFrameChunk(std::istream& file, const Header& header, const FrameEntry& entry,
+				StructureEvents::StructureEvent *events,
+				int *triggerClusterIDs, int *triggerClusterSizes, int *partnerCounts, float *commonPercentages);
+
+			///
+			/// Decodes one chunk that is in memory already, e.g. mapped or read
+			/// in one piece. Thread safe, so chunks can be decoded in parallel.
+			/// Side columns are only decoded if the file has them and the
+			/// pointers are not NULL.
+			///
+			/// @param data entry.byteSize bytes of the chunk.
+			///
+			static bool DecodeChunk(const uint8_t *data, const Header& header, const FrameEntry& entry,
+				StructureEvents::StructureEvent *events,
+				int *triggerClusterIDs, int *triggerClusterSizes, int *partnerCounts, float *commonPercentages);
+		};
+
+	} /* namespace mmvis_static */
+} /* namespace megamol */
+
+#endif /* MMVISSTATIC_MMSEFormat_H_INCLUDED */
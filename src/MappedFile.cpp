@@ -0,0 +1,150 @@
+/**
+ * MappedFile.cpp
+ *
+ * Copyright (C) 2009-2015 by MegaMol Team
+ * Copyright (C) 2015 by Richard Hhne, TU Dresden
+ * Alle Rechte vorbehalten.
+ */
+
+#include "MappedFile.h"
+
+#include <algorithm>
+
+#ifdef _WIN32
+#include <windows.h>
+#else /* _WIN32 */
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif /* _WIN32 */
+
+using namespace megamol;
+
+/**
+ * mmvis_static::MappedFile::MappedFile
+ */
+mmvis_static::MappedFile::MappedFile(void) : data(NULL), size(0)
+#ifdef _WIN32
+	, fileHandle(INVALID_HANDLE_VALUE), mappingHandle(NULL)
+#endif /* _WIN32 */
+{
+}
+
+
+/**
+ * mmvis_static::MappedFile::~MappedFile
+ */
+mmvis_static::MappedFile::~MappedFile(void) {
+	this->Close();
+}
+
+
+/**
+ * mmvis_static::MappedFile::Open
+ */
+bool mmvis_static::MappedFile::Open(const char *filename) {
+	this->Close();
+
+#ifdef _WIN32
+	this->fileHandle = ::CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (this->fileHandle == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER fileSize;
+	if (!::GetFileSizeEx(this->fileHandle, &fileSize) || fileSize.QuadPart == 0) {
+		this->Close();
+		return false;
+	}
+	this->size = static_cast<uint64_t>(fileSize.QuadPart);
+
+	this->mappingHandle = ::CreateFileMappingA(this->fileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (this->mappingHandle == NULL) {
+		this->Close();
+		return false;
+	}
+
+	this->data = static_cast<const uint8_t*>(::MapViewOfFile(this->mappingHandle, FILE_MAP_READ, 0, 0, 0));
+	if (this->data == NULL) {
+		this->Close();
+		return false;
+	}
+#else /* _WIN32 */
+	int fd = ::open(filename, O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	struct stat fileStat;
+	if (::fstat(fd, &fileStat) != 0 || fileStat.st_size == 0) {
+		::close(fd);
+		return false;
+	}
+	this->size = static_cast<uint64_t>(fileStat.st_size);
+
+	void *mapping = ::mmap(NULL, static_cast<size_t>(this->size), PROT_READ, MAP_SHARED, fd, 0);
+	::close(fd); // The mapping keeps its own reference to the file.
+	if (mapping == MAP_FAILED) {
+		this->size = 0;
+		return false;
+	}
+	this->data = static_cast<const uint8_t*>(mapping);
+#endif /* _WIN32 */
+
+	return true;
+}
+
+
+/**
+ * mmvis_static::MappedFile::Close
+ */
+void mmvis_static::MappedFile::Close(void) {
+#ifdef _WIN32
+	if (this->data != NULL)
+		::UnmapViewOfFile(this->data);
+	if (this->mappingHandle != NULL)
+		::CloseHandle(this->mappingHandle);
+	if (this->fileHandle != INVALID_HANDLE_VALUE)
+		::CloseHandle(this->fileHandle);
+	this->mappingHandle = NULL;
+	this->fileHandle = INVALID_HANDLE_VALUE;
+#else /* _WIN32 */
+	if (this->data != NULL)
+		::munmap(const_cast<uint8_t*>(this->data), static_cast<size_t>(this->size));
+#endif /* _WIN32 */
+	this->data = NULL;
+	this->size = 0;
+}
+
+
+/**
+ * mmvis_static::MappedFile::Advise
+ */
+void mmvis_static::MappedFile::Advise(const uint64_t offset, const uint64_t length, const AccessHint hint) const {
+	if (this->data == NULL || offset >= this->size)
+		return;
+
+#ifdef _WIN32
+	// PrefetchVirtualMemory requires Windows 8, the page cache handles the other hints.
+#else /* _WIN32 */
+	// madvise requires a page aligned start.
+	const uint64_t pageSize = static_cast<uint64_t>(::sysconf(_SC_PAGESIZE));
+	const uint64_t alignedOffset = offset - offset % pageSize;
+	const uint64_t end = std::min(offset + length, this->size);
+
+	int advice = MADV_NORMAL;
+	switch (hint) {
+	case ACCESS_SEQUENTIAL:
+		advice = MADV_SEQUENTIAL;
+		break;
+	case ACCESS_RANDOM:
+		advice = MADV_RANDOM;
+		break;
+	case ACCESS_WILLNEED:
+		advice = MADV_WILLNEED;
+		break;
+	default:
+		break;
+	}
+	::madvise(const_cast<uint8_t*>(this->data) + alignedOffset, static_cast<size_t>(end - alignedOffset), advice);
+#endif /* _WIN32 */
+}
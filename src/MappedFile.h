@@ -0,0 +1,98 @@
+/**
+ * MappedFile.h
+ *
+ * Copyright (C) 2009-2015 by MegaMol Team
+ * Copyright (C) 2015 by Richard Hhne, TU Dresden
+ * Alle Rechte vorbehalten.
+ */
+
+#ifndef MMVISSTATIC_MappedFile_H_INCLUDED
+#define MMVISSTATIC_MappedFile_H_INCLUDED
+#if (defined(_MSC_VER) && (_MSC_VER > 1000))
+#pragma once
+#endif /* (defined(_MSC_VER) && (_MSC_VER > 1000)) */
+
+#include <cstddef>
+#include <cstdint>
+
+namespace megamol {
+	namespace mmvis_static {
+
+		/**
+		 * Read only memory mapping of a whole file.
+		 *
+		 * Pages are loaded lazily by the operating system on first access
+		 * and are shared with all other mappings of the same file, so
+		 * opening is independent of the file size.
+		 * Uses the operating system only, so it is part of the core library.
+		 */
+		class MappedFile {
+		public:
+
+			/// Access pattern hints for a region of the mapping.
+			enum AccessHint {
+				ACCESS_NORMAL,
+				ACCESS_SEQUENTIAL,
+				ACCESS_RANDOM,
+				ACCESS_WILLNEED
+			};
+
+			/// Ctor.
+			MappedFile(void);
+
+			/// Dtor, unmaps the file.
+			virtual ~MappedFile(void);
+
+			/// Maps the whole file read only. Unmaps a previously mapped file.
+			/// @return False if the file can not be opened or is empty.
+			bool Open(const char *filename);
+
+			/// Unmaps the file.
+			void Close(void);
+
+			inline bool IsOpen(void) const {
+				return this->data != NULL;
+			}
+
+			/// Start of the mapping, NULL if not open.
+			inline const uint8_t* GetData(void) const {
+				return this->data;
+			}
+
+			/// Start of the mapping plus offset, NULL if the offset is outside of the file.
+			inline const uint8_t* GetDataAt(const uint64_t offset) const {
+				return (this->data == NULL || offset > this->size) ? NULL : this->data + offset;
+			}
+
+			inline uint64_t GetSize(void) const {
+				return this->size;
+			}
+
+			/// Hints the operating system how a region will be accessed. Ignored where unsupported.
+			void Advise(const uint64_t offset, const uint64_t length, const AccessHint hint) const;
+
+		private:
+
+			/// Forbidden copy ctor.
+			MappedFile(const MappedFile& src);
+
+			/// Forbidden assignment.
+			MappedFile& operator=(const MappedFile& rhs);
+
+			/// The mapped file content.
+			const uint8_t *data;
+
+			/// The file size in byte.
+			uint64_t size;
+
+#ifdef _WIN32
+			/// File and mapping handles.
+			void *fileHandle;
+			void *mappingHandle;
+#endif /* _WIN32 */
+		};
+
+	} /* namespace mmvis_static */
+} /* namespace megamol */
+
+#endif /* MMVISSTATIC_MappedFile_H_INCLUDED */
@@ -0,0 +1,175 @@
+/**
+ * NeighbourGrid.cpp
+ *
+ * Copyright (C) 2009-2015 by MegaMol Team
+ * Copyright (C) 2015 by Richard Hhne, TU Dresden
+ * Alle Rechte vorbehalten.
+ */
+
+#include "NeighbourGrid.h"
+
+#include <algorithm>
+#include <limits>
+
+using namespace megamol;
+
+/**
+ * mmvis_static::NeighbourGrid::NeighbourGrid
+ */
+mmvis_static::NeighbourGrid::NeighbourGrid(void) : cellSize(1), cellStart(), sortedPositions(), sortedIndices() {
+	std::fill(this->origin, this->origin + 3, 0.0);
+	std::fill(this->cellCount, this->cellCount + 3, 1LL);
+}
+
+
+/**
+ * mmvis_static::NeighbourGrid::~NeighbourGrid
+ */
+mmvis_static::NeighbourGrid::~NeighbourGrid(void) {
+}
+
+
+/**
+ * mmvis_static::NeighbourGrid::Build
+ */
+void mmvis_static::NeighbourGrid::Build(const float *positions, const size_t stride, const size_t count, const double radius, TaskPool& pool) {
+	const uint8_t *base = reinterpret_cast<const uint8_t*>(positions);
+
+	///
+	/// Bounds of the points, particles may lie outside of the data set bounding box.
+	///
+	double minimum[3] = { 0, 0, 0 };
+	double maximum[3] = { 0, 0, 0 };
+	for (size_t i = 0; i < count; ++i) {
+		const float *position = reinterpret_cast<const float*>(base + i * stride);
+		for (int d = 0; d < 3; ++d) {
+			minimum[d] = (i == 0) ? position[d] : std::min(minimum[d], static_cast<double>(position[d]));
+			maximum[d] = (i == 0) ? position[d] : std::max(maximum[d], static_cast<double>(position[d]));
+		}
+	}
+	std::copy(minimum, minimum + 3, this->origin);
+
+	///
+	/// Cells of at least the search radius, so a search visits at most 3x3x3 cells.
+	/// Sparse data sets get bigger cells instead of more empty ones.
+	///
+	const double extent = std::max(std::max(maximum[0] - minimum[0], maximum[1] - minimum[1]), maximum[2] - minimum[2]);
+	this->cellSize = radius > 0 ? radius : std::max(extent, 1.0);
+	const double maxCells = 4.0 * static_cast<double>(count) + 64.0;
+	for (;;) {
+		double cells = 1;
+		for (int d = 0; d < 3; ++d) {
+			this->cellCount[d] = static_cast<long long>((maximum[d] - minimum[d]) / this->cellSize) + 1;
+			cells *= static_cast<double>(this->cellCount[d]);
+		}
+		if (cells <= maxCells)
+			break;
+		this->cellSize *= 2;
+	}
+
+	///
+	/// Counting sort of the points by cell.
+	///
+	const size_t totalCells = static_cast<size_t>(this->cellCount[0] * this->cellCount[1] * this->cellCount[2]);
+	std::vector<size_t> pointCells(count);
+	pool.ParallelFor(0, count, 4096, [&](size_t begin, size_t end, unsigned int) {
+		for (size_t i = begin; i < end; ++i) {
+			const float *position = reinterpret_cast<const float*>(base + i * stride);
+			long long cell[3];
+			for (int d = 0; d < 3; ++d)
+				cell[d] = std::min(std::max(this->getCell(position[d], d), 0LL), this->cellCount[d] - 1);
+			pointCells[i] = static_cast<size_t>((cell[2] * this->cellCount[1] + cell[1]) * this->cellCount[0] + cell[0]);
+		}
+	});
+
+	// Points per cell, then their offsets.
+	this->cellStart.assign(totalCells + 1, 0);
+	for (size_t i = 0; i < count; ++i)
+		this->cellStart[pointCells[i]]++;
+	this->cellStart[totalCells] = pool.ExclusiveScan(this->cellStart.data(), this->cellStart.data(), totalCells, 16384);
+
+	std::vector<size_t> next(this->cellStart.begin(), this->cellStart.end() - 1);
+	this->sortedPositions.resize(3 * count);
+	this->sortedIndices.resize(count);
+	for (size_t i = 0; i < count; ++i) {
+		const float *position = reinterpret_cast<const float*>(base + i * stride);
+		const size_t target = next[pointCells[i]]++;
+		this->sortedPositions[3 * target + 0] = position[0];
+		this->sortedPositions[3 * target + 1] = position[1];
+		this->sortedPositions[3 * target + 2] = position[2];
+		this->sortedIndices[target] = static_cast<int>(i);
+	}
+}
+
+
+/**
+ * mmvis_static::NeighbourGrid::Search
+ */
+int mmvis_static::NeighbourGrid::Search(const double (&query)[3], const double sqrRadius, const int k,
+		int *indices, double *sqrDistances, std::vector<Candidate>& candidates) const {
+	candidates.clear();
+
+	///
+	/// Cells overlapping the search sphere, none if the sphere is outside of the grid.
+	///
+	const double radius = std::sqrt(sqrRadius);
+	long long first[3], last[3];
+	bool inside = !this->sortedIndices.empty();
+	for (int d = 0; d < 3; ++d) {
+		first[d] = std::max(this->getCell(query[d] - radius, d), 0LL);
+		last[d] = std::min(this->getCell(query[d] + radius, d), this->cellCount[d] - 1);
+		inside = inside && first[d] <= last[d];
+	}
+
+	if (inside) {
+		for (long long z = first[2]; z <= last[2]; ++z) {
+			for (long long y = first[1]; y <= last[1]; ++y) {
+				// Cells along x are contiguous.
+				const size_t rowCell = static_cast<size_t>((z * this->cellCount[1] + y) * this->cellCount[0]);
+				const size_t end = this->cellStart[rowCell + last[0] + 1];
+				for (size_t i = this->cellStart[rowCell + first[0]]; i < end; ++i) {
+					// Same summation and early exit as the ANN fixed radius search.
+					const double *position = &this->sortedPositions[3 * i];
+					double sqrDistance = 0;
+					int d = 0;
+					for (; d < 3; ++d) {
+						const double t = query[d] - position[d];
+						if ((sqrDistance = sqrDistance + t * t) > sqrRadius)
+							break;
+					}
+					if (d < 3)
+						continue;
+					Candidate candidate;
+					candidate.sqrDistance = sqrDistance;
+					candidate.index = this->sortedIndices[i];
+					candidates.push_back(candidate);
+				}
+			}
+		}
+	}
+
+	///
+	/// k nearest, sorted by distance.
+	///
+	const int found = std::min(k, static_cast<int>(candidates.size()));
+	std::partial_sort(candidates.begin(), candidates.begin() + found, candidates.end());
+	for (int i = 0; i < found; ++i) {
+		indices[i] = candidates[i].index;
+		sqrDistances[i] = candidates[i].sqrDistance;
+	}
+	for (int i = found; i < k; ++i) {
+		indices[i] = NULL_INDEX;
+		sqrDistances[i] = std::numeric_limits<double>::max();
+	}
+	return found;
+}
+
+
+/**
+ * mmvis_static::NeighbourGrid::GetBytes
+ */
+size_t mmvis_static::NeighbourGrid::GetBytes(void) const {
+	return this->cellStart.size() * sizeof(size_t)
+		+ this->sortedPositions.size() * sizeof(double)
+		+ this->sortedIndices.size() * sizeof(int);
+}
@@ -0,0 +1,117 @@
+/**
+ * NeighbourGrid.h
+ *
+ * Copyright (C) 2009-2015 by MegaMol Team
+ * Copyright (C) 2015 by Richard Hhne, TU Dresden
+ * Alle Rechte vorbehalten.
+ */
+
+#ifndef MMVISSTATIC_NeighbourGrid_H_INCLUDED
+#define MMVISSTATIC_NeighbourGrid_H_INCLUDED
+#if (defined(_MSC_VER) && (_MSC_VER > 1000))
+#pragma once
+#endif /* (defined(_MSC_VER) && (_MSC_VER > 1000)) */
+
+#include "TaskPool.h"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace megamol {
+	namespace mmvis_static {
+
+		///
+		/// Uniform grid for the fixed radius neighbour search of step 1.
+		///
+		/// Same results as ANNkd_tree::annkFRSearch (self matches included,
+		/// the k nearest points within the radius sorted by distance), but the
+		/// search has no shared state, so several searches run concurrently,
+		/// in one frame and in frames calculated at the same time.
+		/// Equal distances are ordered by point index.
+		///
+		/// The points are sorted by cell (counting sort), so the points of a
+		/// cell are contiguous in memory.
+		///
+		class NeighbourGrid {
+		public:
+
+			/// Index of unused result entries, same value as ANN_NULL_IDX.
+			static const int NULL_INDEX = -1;
+
+			/// Point in the search radius, scratch memory of a search.
+			struct Candidate {
+				double sqrDistance;
+				int index;
+
+				bool operator<(const Candidate& rhs) const {
+					return this->sqrDistance < rhs.sqrDistance
+						|| (this->sqrDistance == rhs.sqrDistance && this->index < rhs.index);
+				}
+			};
+
+			/// Ctor.
+			NeighbourGrid(void);
+
+			/// Dtor.
+			virtual ~NeighbourGrid(void);
+
+			///
+			/// Sorts the points into cells with at least the edge length radius.
+			/// The cells of the points and the cell offsets (scan) are computed
+			/// on the pool, the points are sorted in order.
+			///
+			/// @param positions x, y, z floats of the first point.
+			/// @param stride Byte from one point to the next.
+			///
+			void Build(const float *positions, const size_t stride, const size_t count, const double radius, TaskPool& pool);
+
+			///
+			/// Finds the k nearest points within the radius of the query point.
+			/// Thread safe, each thread passes its own candidates.
+			///
+			/// @param indices Receives k point indices, NULL_INDEX after the found points.
+			/// @param sqrDistances Receives k squared distances.
+			/// @param candidates Scratch memory, reused across calls.
+			/// @return Number of found points.
+			///
+			int Search(const double (&query)[3], const double sqrRadius, const int k,
+				int *indices, double *sqrDistances, std::vector<Candidate>& candidates) const;
+
+			/// Memory of the grid in byte.
+			size_t GetBytes(void) const;
+
+		private:
+
+			/// Forbidden copy ctor.
+			NeighbourGrid(const NeighbourGrid& src);
+
+			/// Forbidden assignment.
+			NeighbourGrid& operator=(const NeighbourGrid& rhs);
+
+			/// Cell of the coordinate in the dimension, not clamped.
+			inline long long getCell(const double coordinate, const int dimension) const {
+				return static_cast<long long>(std::floor((coordinate - this->origin[dimension]) / this->cellSize));
+			}
+
+			double origin[3];
+
+			double cellSize;
+
+			long long cellCount[3];
+
+			/// First point of each cell in the sorted lists, number of cells + 1 entries.
+			std::vector<size_t> cellStart;
+
+			/// Positions sorted by cell, 3 doubles per point.
+			std::vector<double> sortedPositions;
+
+			/// Index of each sorted point in the input.
+			std::vector<int> sortedIndices;
+		};
+
+	} /* namespace mmvis_static */
+} /* namespace megamol */
+
+#endif /* MMVISSTATIC_NeighbourGrid_H_INCLUDED */
@@ -9,6 +9,7 @@
 #include "stdafx.h"
 #include "StaticRenderer.h"
 
+#include "TaskPool.h"
 #include "lodepng/lodepng.h"
 #include "mmcore/CoreInstance.h"
 #include "mmcore/misc/PngBitmapCodec.h"
@@ -21,9 +22,6 @@
 #include "vislib/assert.h"
 #include "vislib/graphics/gl/IncludeAllGL.h"
 
-#include <omp.h>
-#include <thread>
-
 using namespace megamol;
 using namespace megamol::core;
 
@@ -460,37 +458,18 @@ bool mmvis_static::StaticRenderer::Render(Call& call) {
 		// Resize vertex to be able to use concurrency for following loop. Currently not implemented, see below.
 		vertexList.resize(events.getCount() * 4); // 4 vertices needed for each event to create billboard. Uses constructor of Vertex.
 
-		// Return 0 when detection not possible: http://en.cppreference.com/w/cpp/thread/thread/hardware_concurrency
-		int supportedThreads = std::thread::hardware_concurrency();
-
-		if (supportedThreads == 0)
-			supportedThreads = 1; // Important for loop and conditional statements.
-
-		size_t concurrentDivideEvents = 0;
-		if (supportedThreads > 1)
-			concurrentDivideEvents = static_cast<size_t>(static_cast<float>(events.getCount()) / static_cast<float>(supportedThreads)); // Cast likely rounds down.
-
-		#pragma omp parallel for
-		for (int thread = 0; thread < supportedThreads; ++thread) {
-
-			/// Set upper bound.
-			size_t concurrentMaxEvent;
-			if (thread == supportedThreads - 1)	// Avoid missing events due to round down.
-				concurrentMaxEvent = events.getCount();
-			else
-				concurrentMaxEvent = concurrentDivideEvents * (thread + 1);
-
-			/// Set lower bound.
-			size_t concurrentStartEvent = 0;
-			if (thread > 0)
-				concurrentStartEvent = concurrentDivideEvents * thread + 1;
+		///
+		/// The events are independent, the pool splits them into ranges. Each
+		/// range advances its own pointers from its first event.
+		///
+		TaskPool::GetDefault()->ParallelFor(0, events.getCount(), 4096, [&](size_t concurrentStartEvent, size_t concurrentMaxEvent, unsigned int thread) {
 
 			const uint8_t *concurrentLocationPtr = locationPtr + concurrentStartEvent * events.getStride();
 			const uint8_t *concurrentTimePtr = timePtr + concurrentStartEvent * events.getStride();
 			const uint8_t *concurrentTypePtr = typePtr + concurrentStartEvent * events.getStride();
 
 			//vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_INFO, // vislib::sys::log causes crash in concurrency.
-			//printf("SERenderer Concurrency: Retrieve event thread %d reading events %d - %d.\n", omp_get_thread_num(), concurrentStartEvent, concurrentMaxEvent); // Debug.
+			//printf("SERenderer Concurrency: Retrieve event thread %d reading events %d - %d.\n", thread, concurrentStartEvent, concurrentMaxEvent); // Debug.
 
 			// No concurrency here (incrementation of pointers has to be sync'ed) so outer loop created.
 			for (size_t eventCounter = concurrentStartEvent; eventCounter < concurrentMaxEvent; ++eventCounter,
@@ -687,7 +666,7 @@ bool mmvis_static::StaticRenderer::Render(Call& call) {
 				}
 				*/
 			}
-		}
+		});
 
 		// Set dummy data to avoid crash.
 		if (vertexList.size() == 0) {
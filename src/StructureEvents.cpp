@@ -0,0 +1,69 @@
+/**
+ * StructureEvents.cpp
+ *
+ * Copyright (C) 2009-2015 by MegaMol Team
+ * Copyright (C) 2015 by Richard Hhne, TU Dresden
+ * Alle Rechte vorbehalten.
+ */
+
+#include "StructureEvents.h"
+
+using namespace megamol;
+
+/**
+ * mmvis_static::StructureEvents::StructureEvents
+ */
+mmvis_static::StructureEvents::StructureEvents(void) :
+		locationPtr(NULL),
+		timePtr(NULL),
+		typePtr(NULL),
+		stride(0),
+		count(0),
+		maxTime(0),
+		columnBuilder(NULL) {
+	for (auto & c : this->columns) {
+		c.positions = NULL;
+		c.times = NULL;
+		c.count = 0;
+		c.frameOffsets = NULL;
+		c.frameCount = 0;
+	}
+	this->setSideColumns(NULL, NULL, NULL, NULL);
+	//printf("Structure Events alive!\n");
+}
+
+
+/**
+ * mmvis_static::StructureEvents::~StructureEvents
+ */
+mmvis_static::StructureEvents::~StructureEvents(void) {
+}
+
+
+/**
+ * mmvis_static::StructureEvent::StructureEvent
+ */
+mmvis_static::StructureEvents::StructureEvents(const mmvis_static::StructureEvents& src) {
+	*this = src;
+}
+
+
+/**
+ * mmvis_static::StructureEvent::operator=
+ */
+mmvis_static::StructureEvents&
+mmvis_static::StructureEvents::operator=(
+	const mmvis_static::StructureEvents& rhs) {
+	//this->agglomeration = rhs.agglomeration;
+	this->count = rhs.count;
+	this->locationPtr = rhs.locationPtr;
+	this->maxTime = rhs.maxTime;
+	this->stride = rhs.stride;
+	this->timePtr = rhs.timePtr;
+	this->typePtr = rhs.typePtr;
+	for (int type = 0; type < 4; ++type)
+		this->columns[type] = rhs.columns[type];
+	this->columnBuilder = rhs.columnBuilder;
+	this->sideColumns = rhs.sideColumns;
+	return *this;
+}
@@ -0,0 +1,307 @@
+/**
+ * StructureEvents.h
+ *
+ * Copyright (C) 2009-2015 by MegaMol Team
+ * Copyright (C) 2015 by Richard Hhne, TU Dresden
+ * Alle Rechte vorbehalten.
+ */
+
+#ifndef MMVISSTATIC_StructureEvents_H_INCLUDED
+#define MMVISSTATIC_StructureEvents_H_INCLUDED
+#if (defined(_MSC_VER) && (_MSC_VER > 1000))
+#pragma once
+#endif /* (defined(_MSC_VER) && (_MSC_VER > 1000)) */
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <stdexcept>
+
+namespace megamol {
+	namespace mmvis_static {
+
+		/**
+		 * Container for all events.
+		 * The event attributes are the position, the time, the type
+		 * as well as an agglomeration matrix.
+		 *
+		 * Besides the interleaved events the producer can set columns per
+		 * event type (positions and times sorted by time, frame offsets),
+		 * so a single type or time window is a contiguous slice.
+		 */
+
+		class StructureEvents {
+		public:
+
+			/// Possible values for the event type.
+			enum EventType : int {
+				BIRTH,
+				DEATH,
+				MERGE,
+				SPLIT
+			};
+
+			///
+			/// Dichtgepacktes struct.
+			/// It is important that no automatic padding is inserted by compiler
+			/// therefore all datatypes have sizes of 4 or 8.
+			///
+			/// Stride = (4 byte * (3 + 1)) + 4 byte = 20.
+			///
+			struct StructureEvent {
+				float x, y, z;
+				float time;
+				StructureEvents::EventType type; // 4 byte.
+				// Cluster properties are kept in SideColumns so this struct stays small for rendering.
+			};
+
+			///
+			/// Optional per event data of the cluster that triggered the event,
+			/// same index as the event. Gives the user additional filter control,
+			/// e.g. if only big clusters are important.
+			///
+			struct SideColumns {
+				const int *triggerClusterIDs;
+				const int *triggerClusterSizes;
+				const int *partnerCounts;
+				const float *commonPercentages; // Total common particles ratio (%).
+			};
+
+			/// Ctor.
+			StructureEvents(void);
+
+			/// Dtor.
+			virtual ~StructureEvents(void);
+
+			/// Ctor.
+			StructureEvents(const StructureEvents& src);
+
+			inline const void* getLocation(void) const {
+				return this->locationPtr;
+			}
+
+			inline const void* getTime(void) const {
+				return this->timePtr;
+			}
+
+			inline const void* getType(void) const {
+				return this->typePtr;
+			}
+
+			inline unsigned int getStride(void) const {
+				if (this->stride == 0)
+					return getCalculatedStride();
+				return this->stride;
+			}
+
+			inline void setStride(unsigned int stride) {
+				printf("Data call set stride %d.\n\n", stride); // Debug.
+				this->stride = stride;
+			}
+
+			/// Only use an array of struct StructureEvent.
+			/// Stride is added automatically.
+			inline void setEvents(
+				const float *location,
+				const float *time,
+				//const uint8_t *type,
+				const EventType *type,
+				const float maxTime,
+				const size_t count) {
+				this->locationPtr = location;
+				this->timePtr = time;
+				this->typePtr = type;
+				this->stride = getCalculatedStride();
+				this->maxTime = maxTime;
+				this->count = count;
+			}
+
+			/**
+			 * Answer the event type.
+			 *
+			 * @return The event type as EventType.
+			 * @throws std::out_of_range for codes other than 0 to 3.
+			 */
+			inline static EventType getEventType(int typeCode) {
+				switch (typeCode){
+				case 0:
+					return EventType::BIRTH;
+				case 1:
+					return EventType::DEATH;
+				case 2:
+					return EventType::MERGE;
+				case 3:
+					return EventType::SPLIT;
+				}
+				throw std::out_of_range("mmvis_static::StructureEvents: Invalid EventType code");
+			};
+
+			inline const size_t getCount(void) const {
+				return this->count;
+			};
+
+			inline const float getMaxTime() const {
+				return maxTime;
+			};
+
+			/// Sets the side columns, NULL pointers if the producer has none.
+			inline void setSideColumns(
+				const int *triggerClusterIDs,
+				const int *triggerClusterSizes,
+				const int *partnerCounts,
+				const float *commonPercentages) {
+				this->sideColumns.triggerClusterIDs = triggerClusterIDs;
+				this->sideColumns.triggerClusterSizes = triggerClusterSizes;
+				this->sideColumns.partnerCounts = partnerCounts;
+				this->sideColumns.commonPercentages = commonPercentages;
+			}
+
+			inline const SideColumns& getSideColumns(void) const {
+				return this->sideColumns;
+			}
+
+			inline bool hasSideColumns(void) const {
+				return this->sideColumns.triggerClusterIDs != NULL;
+			}
+
+			/// Columns of one event type, owned by the producer.
+			struct TypeColumns {
+				const float *positions; // 3x float per event.
+				const float *times; // Sorted ascending.
+				size_t count;
+				const size_t *frameOffsets; // frameCount + 1 entries, frame f: f <= time < f + 1.
+				size_t frameCount;
+			};
+
+			///
+			/// Producer that builds the columns on the first request instead of
+			/// with the events, e.g. a reader that should not scan a whole file
+			/// on open. Has to outlive the events it is set to.
+			///
+			class ColumnBuilder {
+			public:
+				virtual ~ColumnBuilder(void) {}
+
+				/// Sets the columns of all types to the events.
+				virtual void buildColumns(StructureEvents& events) = 0;
+			};
+
+			/// Defers the columns to the builder until they are requested, NULL if they are set directly.
+			inline void setColumnBuilder(ColumnBuilder *builder) {
+				this->columnBuilder = builder;
+			}
+
+			/// Sets the columns of one event type.
+			inline void setColumns(
+				const EventType type,
+				const float *positions,
+				const float *times,
+				const size_t count,
+				const size_t *frameOffsets,
+				const size_t frameCount) {
+				this->columns[type].positions = positions;
+				this->columns[type].times = times;
+				this->columns[type].count = count;
+				this->columns[type].frameOffsets = frameOffsets;
+				this->columns[type].frameCount = frameCount;
+			}
+
+			/// Columns of one event type. Count is 0 if the producer has not set them.
+			inline const TypeColumns& getColumns(const EventType type) const {
+				this->requireColumns();
+				return this->columns[type];
+			}
+
+			///
+			/// Slice of the events of one type in one frame.
+			/// @return False if the columns are not set or the frame has no events.
+			///
+			inline bool getFrameSlice(const EventType type, const size_t frame, size_t& first, size_t& sliceCount) const {
+				this->requireColumns();
+				const TypeColumns& c = this->columns[type];
+				if (c.frameOffsets == NULL || frame >= c.frameCount)
+					return false;
+				first = c.frameOffsets[frame];
+				sliceCount = c.frameOffsets[frame + 1] - first;
+				return sliceCount > 0;
+			}
+
+			///
+			/// Slice of the events of one type with minTime <= time <= maxTime.
+			/// Binary search on the sorted times.
+			/// @return False if the columns are not set or the window has no events.
+			///
+			inline bool getTimeWindowSlice(const EventType type, const float minTime, const float maxTime, size_t& first, size_t& sliceCount) const {
+				this->requireColumns();
+				const TypeColumns& c = this->columns[type];
+				if (c.times == NULL)
+					return false;
+				const float *begin = std::lower_bound(c.times, c.times + c.count, minTime);
+				const float *end = std::upper_bound(begin, c.times + c.count, maxTime);
+				first = begin - c.times;
+				sliceCount = end - begin;
+				return sliceCount > 0;
+			}
+
+			/**
+			 * Assignment operator.
+			 * Makes a deep copy of all members. While for data these are only
+			 * pointers, the pointer to the unlocker object is also copied.
+			 *
+			 * @param rhs The right hand side operand
+			 *
+			 * @return A reference to this
+			 */
+			StructureEvents& operator=(const StructureEvents& rhs);
+
+		private:
+
+			inline unsigned int getCalculatedStride(void) const {
+				return sizeof(StructureEvent);
+			}
+
+			/// Runs a pending column builder once.
+			inline void requireColumns(void) const {
+				if (this->columnBuilder == NULL)
+					return;
+				ColumnBuilder *builder = this->columnBuilder;
+				this->columnBuilder = NULL;
+				builder->buildColumns(const_cast<StructureEvents&>(*this));
+			}
+
+			// The location pointer, 4 byte
+			const float *locationPtr;
+
+			// The time pointer, 4 byte
+			const float *timePtr;
+
+			// The type pointer, 1 byte. 0 := Birth, 1 := Death, 2 := Merge, 3 := Split as in shader.
+			const EventType *typePtr;
+
+			// The stride.
+			unsigned int stride = 0; // Bad style, too lazy for constructor.
+
+			// The agglomeration.
+			//glm::mat4 agglomeration;
+
+			// The number of objects stored.
+			size_t count;
+
+			// Maximum time of events.
+			float maxTime = 0; // Bad style, too lazy for constructor.
+
+			// Columns per event type, index = EventType. Mutable, a pending builder sets them on request.
+			mutable TypeColumns columns[4];
+
+			// Builds the columns on the first request, NULL if they are set.
+			mutable ColumnBuilder *columnBuilder;
+
+			// Cluster properties per event.
+			SideColumns sideColumns;
+
+		};
+
+	} /* namespace mmvis_static */
+} /* namespace megamol */
+
+#endif /* MMVISSTATIC_StructureEvents_H_INCLUDED */
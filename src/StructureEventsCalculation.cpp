@@ -9,7 +9,8 @@
 #include "stdafx.h"
 #include "StructureEventsCalculation.h"
 
-#include "ANN/ANN.h"
+#include "MMSEFormat.h"
+#include "TaskPool.h"
 #include "mmcore/param/BoolParam.h"
 #include "mmcore/param/EnumParam.h"
 #include "mmcore/param/FilePathParam.h"
@@ -22,8 +23,10 @@
 
 #include <chrono>
 #include <functional>
+#include <memory>
 #include <numeric>
 #include <random>
+#include <sstream>
 #include <string>
 #include <time.h>
 
@@ -35,26 +38,135 @@
 using namespace megamol;
 using namespace megamol::core;
 
+namespace {
+
+	///
+	/// Copy of events for a job of the output queue, the event store
+	/// may change while the job waits.
+	///
+	struct EventsSnapshot {
+		std::vector<mmvis_static::StructureEvents::StructureEvent> events;
+		std::vector<int> triggerClusterIDs;
+		std::vector<int> triggerClusterSizes;
+		std::vector<int> partnerCounts;
+		std::vector<float> commonPercentages;
+		float maxTime;
+
+		/// Copies count events from offset, with the side columns if set.
+		EventsSnapshot(const mmvis_static::StructureEvents::StructureEvent *events, const mmvis_static::StructureEvents::SideColumns& side,
+			const size_t offset, const size_t count, const float maxTime) : events(events + offset, events + offset + count), maxTime(maxTime) {
+			if (side.triggerClusterIDs != NULL) {
+				this->triggerClusterIDs.assign(side.triggerClusterIDs + offset, side.triggerClusterIDs + offset + count);
+				this->triggerClusterSizes.assign(side.triggerClusterSizes + offset, side.triggerClusterSizes + offset + count);
+				this->partnerCounts.assign(side.partnerCounts + offset, side.partnerCounts + offset + count);
+				this->commonPercentages.assign(side.commonPercentages + offset, side.commonPercentages + offset + count);
+			}
+		}
+
+		/// Sets the copy to the call data.
+		void setTo(mmvis_static::StructureEvents& target) const {
+			const mmvis_static::StructureEvents::StructureEvent *first = this->events.data();
+			target.setEvents(&first->x, &first->time, &first->type, this->maxTime, this->events.size());
+			if (!this->triggerClusterIDs.empty()) {
+				target.setSideColumns(this->triggerClusterIDs.data(), this->triggerClusterSizes.data(),
+					this->partnerCounts.data(), this->commonPercentages.data());
+			}
+		}
+
+		/// Memory of the copy in byte.
+		size_t getBytes(void) const {
+			return this->events.size() * sizeof(mmvis_static::StructureEvents::StructureEvent)
+				+ this->triggerClusterIDs.size() * (3 * sizeof(int) + sizeof(float));
+		}
+	};
+
+	/// Spans of the particle lists buildParticleList uses.
+	void getParticleSpans(megamol::core::moldyn::MultiParticleDataCall& data, std::vector<mmvis_static::StructureEventsPipeline::ParticleSpan>& spans) {
+		using megamol::core::moldyn::MultiParticleDataCall;
+		spans.clear();
+		for (unsigned int particleListIndex = 0; particleListIndex < data.GetParticleListCount(); ++particleListIndex) {
+			MultiParticleDataCall::Particles& particles = data.AccessParticles(particleListIndex);
+			if (particles.GetCount() == 0
+				|| (particles.GetVertexDataType() != MultiParticleDataCall::Particles::VERTDATA_FLOAT_XYZ
+					&& particles.GetVertexDataType() != MultiParticleDataCall::Particles::VERTDATA_FLOAT_XYZR)
+				|| particles.GetColourDataType() != MultiParticleDataCall::Particles::COLDATA_FLOAT_I)
+				continue;
+
+			mmvis_static::StructureEventsPipeline::ParticleSpan span;
+			span.positions = particles.GetVertexData();
+			span.positionStride = particles.GetVertexDataStride();
+			span.hasRadius = particles.GetVertexDataType() == MultiParticleDataCall::Particles::VERTDATA_FLOAT_XYZR;
+			span.globalRadius = particles.GetGlobalRadius();
+			span.signedDistances = particles.GetColourData();
+			span.signedDistanceStride = particles.GetColourDataStride();
+			span.count = particles.GetCount();
+			spans.push_back(span);
+		}
+	}
+
+	/// True if the parameters give the same clusters in steps 1 and 2.
+	bool haveSameClusterParameters(const mmvis_static::StructureEventsPipeline::Parameters& a, const mmvis_static::StructureEventsPipeline::Parameters& b) {
+		return a.neighbourSearch == b.neighbourSearch
+			&& a.radiusMultiplier == b.radiusMultiplier
+			&& a.minClusterSize == b.minClusterSize
+			&& a.periodicBoundary == b.periodicBoundary
+			&& std::equal(a.bboxMin, a.bboxMin + 3, b.bboxMin)
+			&& std::equal(a.bboxMax, a.bboxMax + 3, b.bboxMax);
+	}
+
+} /* end anonymous namespace */
+
 /**
  * mmvis_static::StructureEventsCalculation::StructureEventsCalculation
  */
 mmvis_static::StructureEventsCalculation::StructureEventsCalculation() : Module(),
+	outputQueue(), logFile(this->outputQueue), debugFile(this->outputQueue),
 	inDataSlot("in data", "Connects to the data source. Expects signed distance particles"),
 	outDataSlot("out data", "Slot to request data from this calculation."),
 	outSEDataSlot("out SE data", "Slot to request StructureEvents data from this calculation."),
 	calculationActiveSlot("active", "Switch the calculation on/off (once started it will last until finished)."),
+	asynchronousSlot("asynchronous", "Calculate on a worker thread, the last finished frame is shown meanwhile."),
+	speculationSlot("speculation", "Calculate steps 1 and 2 of the next frame in the background during playback."),
 	createDummyTestDataSlot("createDummyTestData", "Creates random previous and current data. For I/O tests. Skips steps 1 and 2."),
 	outputLabelSlot("output::label", "A label to tag data in output files."),
 	quantitativeDataOutputSlot("output::quantitativeData", "Create log files with quantitative data."),
+	metricsFormatSlot("output::metricsFormat", "Format of the per frame quantitative data file."),
+	comparisonFormatSlot("output::comparisonFormat", "Format of the per frame cluster comparison files (SECC)."),
 	mmseFilenameSlot("output::mmseFilename", "The path to the MMSE file to be written"),
+	mmseCompressionLevelSlot("output::mmseCompressionLevel", "0 writes raw frame chunks, 1 to 9 deflated chunks (slower, smaller)."),
 	clusterColoringSlot("output::clusterColoring", "The mode for coloring clusters."),
 	periodicBoundaryConditionSlot("NeighbourSearch::periodicBoundary", "Periodic boundary condition for dataset."),
 	radiusMultiplierSlot("NeighbourSearch::radiusMultiplier", "The multiplicator for the particle radius definining the area for the neighbours search."),
+	neighbourSearchMethodSlot("NeighbourSearch::method", "The search structure, the grid searches in parallel."),
 	minClusterSizeSlot("ClusterCreation::minClusterSize", "Minimal allowed cluster size in connected components, smaller clusters will be merged with bigger clusters if possible."),
 	msMinClusterAmountSlot("StructureEvents::msMinClusterAmount", "Minimal number of clusters for merge/split event detection."),
 	msMinCPPercentageSlot("StructureEvents::msMinCPPercentage", "Minimal ratio of common particles of each cluster for merge/split event detection."),
 	bdMaxCPPercentageSlot("StructureEvents::bdMaxCPPercentage", "Maximal ratio of common particles for birth/death event detection."),
-	dataHash(0), sedcHash(0), seMaxTimeCache(0), frameId(0), treeSizeOutputCache(0), gasColor({ .98f, .78f, 0.f }) {
+	sweepMsMinCPPercentagesSlot("StructureEvents::sweep::msMinCPPercentages", "Semicolon separated msMinCPPercentage values for the threshold sweep."),
+	sweepMsMinClusterAmountsSlot("StructureEvents::sweep::msMinClusterAmounts", "Semicolon separated msMinClusterAmount values for the threshold sweep."),
+	sweepBdMaxCPPercentagesSlot("StructureEvents::sweep::bdMaxCPPercentages", "Semicolon separated bdMaxCPPercentage values for the threshold sweep."),
+	clusterCacheModeSlot("ClusterCache::mode", "Write the clusters of steps 1 and 2 to the MMSC file or read them from it."),
+	clusterCacheFilenameSlot("ClusterCache::filename", "The path to the MMSC file."),
+	resultCacheSizeSlot("ResultCache::sizeMiB", "Memory for the results of calculated frames, revisited frames are restored. 0 switches the cache off."),
+	taskPoolThreadsSlot("TaskPool::threads", "Threads of the parallel loops of all stages, 0 for one per hardware thread."),
+	dataHash(0), sedcHash(0), frameId(0), gasColor({ .98f, .78f, 0.f }) {
+
+	this->mmseQueuedOpen = false;
+	this->mmseQueuedSideColumns = false;
+	this->mmseQueuedCompressionLevel = 0;
+	this->mmseWriteFailed = false;
+
+	this->requestedFrameValid = false;
+	this->requestedFrameId = 0;
+	this->requestedDataHash = 0;
+	this->publishedResultCount = 0;
+	this->speculationRequestedValid = false;
+	this->speculationRequestedFrameId = 0;
+	this->listKey = FrameResultCache::Key();
+	this->listKeyValid = false;
+	this->pipelineCompared = false;
+
+	this->pipeline.SetLogCallback(std::bind(&StructureEventsCalculation::logPipelineMessage, this, std::placeholders::_1, std::placeholders::_2));
 
 	this->inDataSlot.SetCompatibleCall<core::moldyn::MultiParticleDataCallDescription>();
 	this->MakeSlotAvailable(&this->inDataSlot);
@@ -70,6 +182,12 @@ mmvis_static::StructureEventsCalculation::StructureEventsCalculation() : Module(
 	this->calculationActiveSlot.SetParameter(new param::BoolParam(false));
 	this->MakeSlotAvailable(&this->calculationActiveSlot);
 
+	this->asynchronousSlot.SetParameter(new param::BoolParam(false));
+	this->MakeSlotAvailable(&this->asynchronousSlot);
+
+	this->speculationSlot.SetParameter(new param::BoolParam(false));
+	this->MakeSlotAvailable(&this->speculationSlot);
+
 	this->createDummyTestDataSlot.SetParameter(new param::BoolParam(false));
 	this->MakeSlotAvailable(&this->createDummyTestDataSlot);
 
@@ -82,9 +200,24 @@ mmvis_static::StructureEventsCalculation::StructureEventsCalculation() : Module(
 	this->quantitativeDataOutputSlot.SetParameter(new param::BoolParam(true));
 	this->MakeSlotAvailable(&this->quantitativeDataOutputSlot);
 
+	core::param::EnumParam *metricsFormatParam = new core::param::EnumParam(0);
+	metricsFormatParam->SetTypePair(0, "CSV (SECalc.csv).");
+	metricsFormatParam->SetTypePair(1, "Binary (SECalc.secm).");
+	this->metricsFormatSlot << metricsFormatParam;
+	this->MakeSlotAvailable(&this->metricsFormatSlot);
+
+	core::param::EnumParam *comparisonFormatParam = new core::param::EnumParam(0);
+	comparisonFormatParam->SetTypePair(0, "Text (SECC All.log, SECC forward/backwards.csv).");
+	comparisonFormatParam->SetTypePair(1, "Binary dump (SECC.secc), convert with secc_convert.");
+	this->comparisonFormatSlot << comparisonFormatParam;
+	this->MakeSlotAvailable(&this->comparisonFormatSlot);
+
 	this->mmseFilenameSlot.SetParameter(new param::FilePathParam(""));
 	this->MakeSlotAvailable(&this->mmseFilenameSlot);
 
+	this->mmseCompressionLevelSlot.SetParameter(new param::IntParam(0, 0, MMSEFormat::MAX_COMPRESSION_LEVEL));
+	this->MakeSlotAvailable(&this->mmseCompressionLevelSlot);
+
 	core::param::EnumParam *clusterColoringSlotParam = new core::param::EnumParam(0);
 	clusterColoringSlotParam->SetTypePair(0, "Root particle properties and frame-inherited colors.");
 	clusterColoringSlotParam->SetTypePair(1, "Random and frame-inherited colors.");
@@ -101,6 +234,12 @@ mmvis_static::StructureEventsCalculation::StructureEventsCalculation() : Module(
 	this->radiusMultiplierSlot.SetParameter(new core::param::IntParam(5, 2, 10));
 	this->MakeSlotAvailable(&this->radiusMultiplierSlot);
 
+	core::param::EnumParam *neighbourSearchMethodParam = new core::param::EnumParam(StructureEventsPipeline::NEIGHBOURSEARCH_KDTREE);
+	neighbourSearchMethodParam->SetTypePair(StructureEventsPipeline::NEIGHBOURSEARCH_KDTREE, "kD-tree (ANN).");
+	neighbourSearchMethodParam->SetTypePair(StructureEventsPipeline::NEIGHBOURSEARCH_GRID, "Uniform grid (parallel).");
+	this->neighbourSearchMethodSlot << neighbourSearchMethodParam;
+	this->MakeSlotAvailable(&this->neighbourSearchMethodSlot);
+
 	///
 	/// Cluster creation.
 	///
@@ -118,6 +257,51 @@ mmvis_static::StructureEventsCalculation::StructureEventsCalculation() : Module(
 
 	this->bdMaxCPPercentageSlot.SetParameter(new core::param::FloatParam(2, 2, 10));
 	this->MakeSlotAvailable(&this->bdMaxCPPercentageSlot);
+
+	///
+	/// Threshold sweep, only with quantitative data output.
+	///
+	this->sweepMsMinCPPercentagesSlot.SetParameter(new core::param::StringParam("25;30;35;40;45"));
+	this->MakeSlotAvailable(&this->sweepMsMinCPPercentagesSlot);
+
+	this->sweepMsMinClusterAmountsSlot.SetParameter(new core::param::StringParam("2;3"));
+	this->MakeSlotAvailable(&this->sweepMsMinClusterAmountsSlot);
+
+	this->sweepBdMaxCPPercentagesSlot.SetParameter(new core::param::StringParam("1;2;3;4;5"));
+	this->MakeSlotAvailable(&this->sweepBdMaxCPPercentagesSlot);
+
+	///
+	/// Cluster cache.
+	///
+	core::param::EnumParam *clusterCacheModeParam = new core::param::EnumParam(0);
+	clusterCacheModeParam->SetTypePair(0, "Off.");
+	clusterCacheModeParam->SetTypePair(1, "Write clusters.");
+	clusterCacheModeParam->SetTypePair(2, "Read clusters, skip steps 1b and 2.");
+	this->clusterCacheModeSlot << clusterCacheModeParam;
+	this->MakeSlotAvailable(&this->clusterCacheModeSlot);
+
+	this->clusterCacheFilenameSlot.SetParameter(new param::FilePathParam(""));
+	this->MakeSlotAvailable(&this->clusterCacheFilenameSlot);
+
+	///
+	/// Result cache.
+	///
+	this->resultCacheSizeSlot.SetParameter(new core::param::IntParam(
+		static_cast<int>(FrameResultCache::DEFAULT_CAPACITY / (1024 * 1024)), 0));
+	this->MakeSlotAvailable(&this->resultCacheSizeSlot);
+
+	///
+	/// Task pool.
+	///
+	this->taskPoolThreadsSlot.SetParameter(new core::param::IntParam(0, 0));
+	this->MakeSlotAvailable(&this->taskPoolThreadsSlot);
+
+	///
+	/// Output errors.
+	///
+	this->outputQueue.SetErrorCallback([](const std::string& message) {
+		vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_ERROR, "%s", message.c_str());
+	});
 }
 
 
@@ -125,6 +309,11 @@ mmvis_static::StructureEventsCalculation::StructureEventsCalculation() : Module(
  * mmvis_static::StructureEventsCalculation::~StructureEventsCalculation
  */
 mmvis_static::StructureEventsCalculation::~StructureEventsCalculation(void) {
+	// The workers queue output jobs and use the pipelines.
+	this->stopCalculation();
+	this->speculationWorker.Wait();
+	// Queued jobs use the mmseWriter, which is destroyed before the outputQueue.
+	this->outputQueue.Wait();
 }
 
 
@@ -141,6 +330,13 @@ bool mmvis_static::StructureEventsCalculation::create(void) {
  * mmvis_static::StructureEventsCalculation::release
  */
 void mmvis_static::StructureEventsCalculation::release(void) {
+	this->stopCalculation();
+	this->speculationWorker.Wait();
+	this->outputQueue.Wait();
+	this->mmseWriter.Close();
+	this->mmseQueuedOpen = false;
+	this->mmseQueuedFrameCounts.clear();
+	this->clusterCache.Close();
 }
 
 
@@ -174,6 +370,10 @@ bool mmvis_static::StructureEventsCalculation::getDataCallback(Call& caller) {
 
 	inMpdc->Unlock();
 
+	// After the current frame has been served, the request of the next one must not delay it.
+	if (this->calculationActiveSlot.Param<param::BoolParam>()->Value() && this->speculationSlot.Param<param::BoolParam>()->Value())
+		this->speculateNextFrame(*inMpdc);
+
 	return true;
 }
 
@@ -184,20 +384,36 @@ bool mmvis_static::StructureEventsCalculation::getSEDataCallback(Call& caller) {
 	StructureEventsDataCall* outSedc = dynamic_cast<StructureEventsDataCall*>(&caller);
 	if (outSedc == NULL) return false;
 
+	// Asynchronous mode: the events of the served result, the worker changes the store.
+	if (this->asynchronousSlot.Param<param::BoolParam>()->Value()) {
+		if (this->servedResult && this->servedResult->structureEvents->getCount() > 0) {
+			const StructureEventsStore& served = *this->servedResult->structureEvents;
+			StructureEvents* events = &outSedc->getEvents();
+			events->setEvents(&served.getEvents()->x, &served.getEvents()->time, &served.getEvents()->type,
+				served.getMaxTime(), served.getCount());
+			served.getBuiltColumns().setTo(*events);
+			served.setSideColumnsTo(*events);
+		}
+		return true;
+	}
+
 	//printf("Calc: Structure Events: %d, location: %p, time: %p, type: %p\n",
 	//	this->structureEvents.size(), &this->structureEvents.front().x, &this->structureEvents.front().time, &this->structureEvents.front().type);
 
-	if (this->structureEvents.size() > 0) {
+	const StructureEventsStore& store = this->structureEvents.GetStore();
+	if (store.getCount() > 0) {
 		// Debug.
 		//vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_INFO, "Calculator: Sent %d events.", this->structureEvents.size());
 
 		// Send data to the call.
 		StructureEvents* events = &outSedc->getEvents();
-		events->setEvents(&this->structureEvents.front().x,
-			&this->structureEvents.front().time,
-			&this->structureEvents.front().type,
-			this->seMaxTimeCache,
-			this->structureEvents.size());
+		events->setEvents(&store.getEvents()->x,
+			&store.getEvents()->time,
+			&store.getEvents()->type,
+			store.getMaxTime(),
+			store.getCount());
+		this->structureEvents.GetColumns().setTo(*events);
+		store.setSideColumnsTo(*events);
 	}
 
 	return true;
@@ -244,7 +460,10 @@ bool mmvis_static::StructureEventsCalculation::getSEExtentCallback(Call& caller)
 	/// Frame has to be set by MPDC data call, so using MPDC outData is mandatory!
 
 	outSedc->SetExtent(inMpdc->FrameCount(), inMpdc->AccessBoundingBoxes());
-	outSedc->SetDataHash(this->sedcHash); // To track changes in Renderer.
+	if (this->asynchronousSlot.Param<param::BoolParam>()->Value())
+		outSedc->SetDataHash(this->servedResult ? this->servedResult->sedcHash : 0);
+	else
+		outSedc->SetDataHash(this->sedcHash); // To track changes in Renderer.
 
 	//printf("%d\n", inMpdc->FrameCount());
 	
@@ -284,12 +503,9 @@ bool mmvis_static::StructureEventsCalculation::manipulateData (
 			this->radiusMultiplierSlot.ResetDirty();
 			reCalculate = true;
 		}
-
-		// Only calculate when inData has changed frame or hash (data has been manipulated).
-		if ((this->frameId != inData.FrameID()) || (this->dataHash != inData.DataHash()) || (inData.DataHash() == 0) || reCalculate) {
-			this->frameId = inData.FrameID();
-			this->dataHash = inData.DataHash();
-			this->setData(inData);
+		if (this->neighbourSearchMethodSlot.IsDirty()) {
+			this->neighbourSearchMethodSlot.ResetDirty();
+			reCalculate = true;
 		}
 
 		// Recalculate StructureEvents if dirty slots.
@@ -306,10 +522,47 @@ bool mmvis_static::StructureEventsCalculation::manipulateData (
 			this->bdMaxCPPercentageSlot.ResetDirty();
 			reCalculateSE = true;
 		}
-		if (reCalculateSE) {
-			// No previous and partner list size detection here, since
-			// method itself catches this.
-			determineStructureEvents();
+
+		// A changed grid makes the series totals incomparable, restart them.
+		bool reSweep = false;
+		if (this->sweepMsMinCPPercentagesSlot.IsDirty()) {
+			this->sweepMsMinCPPercentagesSlot.ResetDirty();
+			reSweep = true;
+		}
+		if (this->sweepMsMinClusterAmountsSlot.IsDirty()) {
+			this->sweepMsMinClusterAmountsSlot.ResetDirty();
+			reSweep = true;
+		}
+		if (this->sweepBdMaxCPPercentagesSlot.IsDirty()) {
+			this->sweepBdMaxCPPercentagesSlot.ResetDirty();
+			reSweep = true;
+		}
+
+		if (this->asynchronousSlot.Param<param::BoolParam>()->Value()) {
+			// Compare with the last request, the worker may still calculate it.
+			// Data without hash is requested again when the worker is idle.
+			const bool calculateFrame = !this->requestedFrameValid
+				|| (this->requestedFrameId != inData.FrameID()) || (this->requestedDataHash != inData.DataHash())
+				|| (inData.DataHash() == 0 && this->calculationWorker.IsIdle()) || reCalculate;
+			if (calculateFrame || reCalculateSE || reSweep)
+				this->requestCalculation(inData, this->getCalculationSettings(), calculateFrame, reCalculateSE, reSweep);
+		}
+		else {
+			// The lists belong to this thread again.
+			this->stopCalculation();
+			this->requestedFrameValid = false;
+			this->servedResult.reset();
+			this->previousServedResult.reset();
+			this->applySettings(this->getCalculationSettings());
+
+			// Only calculate when inData has changed frame or hash (data has been manipulated).
+			if ((this->frameId != inData.FrameID()) || (this->dataHash != inData.DataHash()) || (inData.DataHash() == 0) || reCalculate) {
+				this->frameId = inData.FrameID();
+				this->dataHash = inData.DataHash();
+				this->setData(inData);
+			}
+
+			this->updateStructureEvents(reCalculateSE, reSweep);
 		}
 	}
 
@@ -317,6 +570,30 @@ bool mmvis_static::StructureEventsCalculation::manipulateData (
 
 	inData.Unlock();
 
+	// Asynchronous mode: serve the last finished frame.
+	if (this->asynchronousSlot.Param<param::BoolParam>()->Value()) {
+		{
+			std::lock_guard<std::mutex> lock(this->resultMutex);
+			if (this->finishedResult) {
+				this->previousServedResult = this->servedResult;
+				this->servedResult = std::move(this->finishedResult);
+			}
+		}
+		if (this->servedResult) {
+			outData.SetDataHash(this->servedResult->dataHash);
+			outData.SetFrameID(this->servedResult->frameId);
+			outData.SetParticleListCount(1);
+			outData.AccessParticles(0) = this->servedResult->particles;
+		}
+		else {
+			outData.SetDataHash(0);
+			outData.SetFrameID(inData.FrameID());
+			outData.SetParticleListCount(0); // Nothing finished yet.
+		}
+		outData.SetUnlocker(nullptr);
+		return true;
+	}
+
 	// Output the data.
 	outData.SetDataHash(this->dataHash);
 	outData.SetFrameID(this->frameId);
@@ -350,8 +627,8 @@ void mmvis_static::StructureEventsCalculation::setData(megamol::core::moldyn::Mu
 	///
 	/// Log output.
 	///
-	if (this->quantitativeDataOutputSlot.Param<param::BoolParam>()->Value()) {
-		vislib::StringA label(this->outputLabelSlot.Param<param::StringParam>()->Value());
+	if (this->settings.quantitativeDataOutput) {
+		vislib::StringA label(this->settings.outputLabel);
 		std::string filenameEnd;
 		if (!label.IsEmpty()) {
 			std::string labelStr = label;
@@ -359,126 +636,14 @@ void mmvis_static::StructureEventsCalculation::setData(megamol::core::moldyn::Mu
 		}
 		std::string filenameLog = "SECalc" + filenameEnd + ".log";
 		this->logFile.open(filenameLog.c_str(), std::ios_base::app | std::ios_base::out);
-		std::string filenameCSV = "SECalc" + filenameEnd + ".csv";
-		this->csvLogFile.open(filenameCSV.c_str(), std::ios_base::app | std::ios_base::out);
-		std::ifstream csvLogFilePeekTest;
-		csvLogFilePeekTest.open(filenameCSV.c_str()); // Attention to use correct filename.
 		this->debugFile.open("SECalcDebug.log", std::ios_base::app | std::ios_base::out);
 
-		// Set header to csv if not set.
-		if (csvLogFilePeekTest.peek() == std::ifstream::traits_type::eof()) {
-			this->csvLogFile
-				<< "Label; "
-				<< "Time [y-m-d h:m:s]; "
-				<< "Frame ID [#frame]; "
-				<< "Particles [#particles]; "
-				<< "ParticleList [ms]; "
-				<< "kdTree [ms]; "
-				<< "kDSearch radius multiplier [#radiusMult]; "
-				<< "kDSearch max neighbours [#neighbours]; "
-				<< "Neighbours [ms]; "
-				<< "Clusters [#clusters]; "
-				<< "MinCluster [#particles]; "
-				<< "MaxCluster [#particles]; "
-				<< "SizeOneClusters for Fast Depth debug [#clusters]; "
-				<< "MinSizeClusters for Fast Depth debug [#clusters]; "
-				<< "Particles in clusters [#particles]; "
-				<< "Particles in gas [#particles]; "
-				<< "Fast Depth [ms]; "
-				<< "Minimum cluster limit [#particles]; "
-				<< "Particles merged [#particles]; "
-				<< "Clusters removed [#clusters]; "
-				<< "SizeOneClusters for Merge Clusters debug [#clusters]; "
-				<< "MinSizeClusters for Merge Clusters debug [#clusters]; "
-				<< "Merge Clusters [ms]; "
-				<< "Forward min common particle ratio [%minCommonParts]; "
-				<< "Forward mean common particle ratio [%meanCommonParts]; "
-				<< "Forward common particle ratio std deviation [%devCommonParts]; "
-				<< "Forward max common particle ratio [%maxCommonParts]; "
-				<< "Backwards min common particle ratio [%minCommonParts]; "
-				<< "Backwards mean common particle ratio [%meanCommonParts]; "
-				<< "Backwards common particle ratio std deviation [%devCommonParts]; "
-				<< "Backwards max common particle ratio [%maxCommonParts]; "
-				<< "Compare Clusters [ms]; "
-				<< "Minimal number of big partner clusters for merge / split [#cluster]; "
-				<< "Minimal common particles ratio limit of big partners for merge / split [%minCommonParts]; "
-				<< "Maximum total common particles ratio limit for birth / death [%maxCommonParts]; "
-				<< "Births [#events]; "
-				<< "Deaths [#events]; "
-				<< "Merges [#events]; "
-				<< "Splits [#events]; "
-				<< "Total events [#events]; "
-				<< "Determine structure events [ms]; "
-				<< "Complete calculation [ms]; "
-				<< "ParticleList [kiB]; "
-				<< "Previous particleList [kiB]; "
-				<< "kdTree [kiB]; "
-				<< "ClusterList [kiB]; "
-				<< "Previous clusterList [kiB]; "
-				<< "Comparison partnersList [kiB]; "
-				<< "StructureEventsList [kiB]; "
-				<< "Total list memory [kiB]"
-				<< "\n";
-			this->csvLogFile
-				<< "; " // Label.
-				<< "y-m-d h:m:s; "
-				<< "#frame; "
-				<< "#particles; "
-				<< "ms; "
-				<< "ms; "
-				<< "#radius; "
-				<< "#neighbours; "
-				<< "ms; "
-				<< "#clusters; "
-				<< "#particles; "
-				<< "#particles; "
-				<< "#clusters; "
-				<< "#clusters; "
-				<< "#particles; "
-				<< "#particles; "
-				<< "ms; "
-				<< "#particles; "
-				<< "#particles; "
-				<< "#clusters; "
-				<< "#clusters; "
-				<< "#clusters; "
-				<< "ms; "
-				<< "%minCommonParts; "
-				<< "%meanCommonParts; "
-				<< "%devCommonParts; "
-				<< "%maxCommonParts; "
-				<< "%minCommonParts; "
-				<< "%meanCommonParts; "
-				<< "%devCommonParts; "
-				<< "%maxCommonParts; "
-				<< "ms; "
-				<< "#cluster; "
-				<< "%minCommonParts; "
-				<< "%maxCommonParts; "
-				<< "#events; "
-				<< "#events; "
-				<< "#events; "
-				<< "#events; "
-				<< "#events; "
-				<< "ms; "
-				<< "ms; "
-				<< "kiB; "
-				<< "kiB; "
-				<< "kiB; "
-				<< "kiB; "
-				<< "kiB; "
-				<< "kiB; "
-				<< "kiB; "
-				<< "kiB"
-				<< "\n";
-		}
-		csvLogFilePeekTest.close();
-
 		// Get current time in readable format. http://stackoverflow.com/a/10467633/4566599, http://stackoverflow.com/a/14387042/4566599
 		time_t     now = time(0);
 		struct tm  timezone;
 		localtime_s(&timezone, &now);
 		strftime(this->timeOutputCache, sizeof(this->timeOutputCache), "%Y-%m-%d %X", &timezone); // http://en.cppreference.com/w/cpp/chrono/c/strftime
+		this->metrics.Reset(this->frameId, now, this->timeOutputCache);
 
 		// Create horizontal line of correct length.
 		const int sizeOfHead = 6 + (this->frameId < 10 ? 1 : (this->frameId < 100 ? 2 : (this->frameId < 1000 ? 3 : 10))) // Frame.
@@ -494,11 +659,6 @@ void mmvis_static::StructureEventsCalculation::setData(megamol::core::moldyn::Mu
 			<< ", Kennzeichen " << label.PeekBuffer()
 			<< "\n"
 			<< splitLine << "\n";
-
-		this->csvLogFile
-			<< label.PeekBuffer() << "; " // Label
-			<< this->timeOutputCache << "; " // Time
-			<< this->frameId << "; "; // Frame ID
 	}
 
 	///
@@ -513,51 +673,109 @@ void mmvis_static::StructureEventsCalculation::setData(megamol::core::moldyn::Mu
 
 	auto time_completeCalculation = std::chrono::system_clock::now();
 
-	if (this->createDummyTestDataSlot.Param<param::BoolParam>()->Value())
+	this->pipelineEvents.clear();
+	this->pipelineCompared = false;
+
+	// Result of the frame from the result cache, NULL if calculated.
+	std::shared_ptr<const FrameResultCache::Entry> cached;
+
+	if (this->settings.createDummyTestData) {
 		this->setDummyLists(20000, 500, 50);
+		this->listKeyValid = false;
+	}
 	else {
 		///
 		/// 1st step.
 		///
 		this->buildParticleList(data, globalParticleIndex, globalRadius, globalColor, globalColorIndexMin, globalColorIndexMax);
-		this->findNeighboursWithKDTree(data);
 
-		///
-		/// 2nd step.
-		///
-		this->createClustersFastDepth();
-		this->mergeSmallClusters();
+		const FrameResultCache::Key key = this->getResultCacheKey(this->frameId);
+		this->setTruePreviousFrame(key);
+
+		// Data without hash may change without a new hash, never restored.
+		if (this->dataHash != 0) {
+			cached = this->resultCache.Get(key);
+			if (cached && !FrameResultCache::Restore(*cached, this->pipeline))
+				cached.reset();
+		}
+		this->listKey = key;
+		this->listKeyValid = this->dataHash != 0;
+
+		if (cached) {
+			vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_INFO,
+				"SECalc: Restored %d clusters of frame %u from the result cache.", static_cast<int>(this->pipeline.clusterList.size()), this->frameId);
+			if (this->settings.quantitativeDataOutput)
+				this->logFile << "Restored steps 1 and 2 from the result cache.\n";
+			this->storeClusterCache();
+		}
+		else if (this->adoptSpeculativeClusters(data))
+			this->storeClusterCache();
+		else if (!this->loadClusterCache()) {
+			this->findNeighboursWithKDTree(data);
+
+			///
+			/// 2nd step.
+			///
+			this->createClustersFastDepth();
+			this->mergeSmallClusters();
+			this->storeClusterCache();
+		}
 	}
 
 	
 	///
 	/// 3rd and 4th step and output to SEDC.
 	/// testEventsCSVFile
-	if (this->previousClusterList.size() > 0 && this->previousParticleList.size() > 0) {
+	const bool hasPrevious = this->pipeline.previousClusterList.size() > 0 && this->pipeline.previousParticleList.size() > 0;
+	const bool restored = cached && cached->compared && hasPrevious;
+	bool eventsRestored = false; // False if the events of the frame are determined again.
+	if (restored) {
+		this->pipeline.partnerClustersList = cached->partnerClustersList;
+		this->pipelineCompared = true;
+
+		// Events of other thresholds are determined again, step 4 is cheap.
+		const StructureEventsPipeline::Parameters parameters = this->getPipelineParameters();
+		if (cached->parameters.msMinCPPercentage == parameters.msMinCPPercentage
+			&& cached->parameters.msMinClusterAmount == parameters.msMinClusterAmount
+			&& cached->parameters.bdMaxCPPercentage == parameters.bdMaxCPPercentage) {
+			this->pipelineEvents = cached->events;
+			this->setFrameEvents(this->pipelineEvents);
+			eventsRestored = true;
+		}
+		else {
+			this->determineStructureEvents();
+			this->storeResult();
+		}
+	}
+	else if (hasPrevious) {
 		this->compareClusters();
 		this->determineStructureEvents();
-		this->setClusterColor(false);
+		if (!cached)
+			this->setClusterColor(false);
+		this->storeResult();
 	}
 	else {
 		///
 		/// Log output.
 		///
-		if (this->quantitativeDataOutputSlot.Param<param::BoolParam>()->Value()) {
+		if (this->settings.quantitativeDataOutput) {
 			this->logFile << "Skipped step 3 and step 4 since no previous clusters are available.\n";
-			for (int numberOfSkippedFields = 0; numberOfSkippedFields < 18; ++numberOfSkippedFields)
-				this->csvLogFile << "; ";
 		}
 
 		vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_INFO,
 			"SECalc: Skipped step 3 and step 4 since no previous clusters are available.");
 
-		this->setClusterColor(true);
+		if (!cached) {
+			this->setClusterColor(true);
+			this->storeResult();
+		}
 	}
 
 	///
-	/// Write MMSE.
+	/// Write MMSE, restored events are in the file already.
 	///
-	this->writeSE(data);
+	if (!eventsRestored)
+		this->writeSE(data);
 
 
 	///
@@ -571,8 +789,8 @@ void mmvis_static::StructureEventsCalculation::setData(megamol::core::moldyn::Mu
 	this->particles.SetGlobalColour(globalColor[0], globalColor[1], globalColor[2]);
 	this->particles.SetColourMapIndexValues(globalColorIndexMin, globalColorIndexMax);
 
-	this->particles.SetVertexData(MultiParticleDataCall::Particles::VERTDATA_FLOAT_XYZR, &this->particleList[0], particleStride);
-	this->particles.SetColourData(MultiParticleDataCall::Particles::COLDATA_FLOAT_RGB, &this->particleList[0].r, particleStride);
+	this->particles.SetVertexData(MultiParticleDataCall::Particles::VERTDATA_FLOAT_XYZR, &this->pipeline.particleList[0], particleStride);
+	this->particles.SetColourData(MultiParticleDataCall::Particles::COLDATA_FLOAT_RGB, &this->pipeline.particleList[0].r, particleStride);
 
 	///
 	/// Log output.
@@ -582,20 +800,20 @@ void mmvis_static::StructureEventsCalculation::setData(megamol::core::moldyn::Mu
 		vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_INFO,
 			"SECalc: Calculation finished in %lld ms.", duration.count());
 
-		if (this->quantitativeDataOutputSlot.Param<param::BoolParam>()->Value()) {
+		if (this->settings.quantitativeDataOutput) {
 			this->logFile << "Calculation finished in " << duration.count() << " ms ";
-			this->csvLogFile << duration.count() << "; "; // Complete calculation (ms)
+			this->metrics.Set(FrameMetrics::COMPLETE_CALCULATION_MS, static_cast<double>(duration.count()));
 		}
 	}
 
-	if (this->quantitativeDataOutputSlot.Param<param::BoolParam>()->Value()) {
+	if (this->settings.quantitativeDataOutput) {
 
 		// Old stuff.
 		//printf("Calculator: ParticleStride: %d, ParticleCount: %d, RandomParticleColor: (%f, %f, %f)\n",
 		//	particleStride, globalParticleIndex, particleList[0].r, particleList[0].g, particleList[0].b);
 		// For testing if sorting works.
 		//printf("Calculator: ParticleList SignedDistance max: %f, min: %f\n",
-		//	this->particleList.front().signedDistance, this->particleList.back().signedDistance);
+		//	this->pipeline.particleList.front().signedDistance, this->pipeline.particleList.back().signedDistance);
 		//printf("Calculator: Particle SignedDistance max: %f, min: %f\n",
 		//	signedDistanceMax, signedDistanceMin);
 
@@ -604,39 +822,39 @@ void mmvis_static::StructureEventsCalculation::setData(megamol::core::moldyn::Mu
 
 		// Determine representative size of all particles including their neighbours.
 		size_t innerVectorSize = 0;
-		for (auto & particle : this->particleList)
+		for (auto & particle : this->pipeline.particleList)
 			innerVectorSize += particle.neighbourIDs.size() * sizeof(uint64_t);
 
-		size_t particleBytes = this->particleList.size() * sizeof(Particle) + innerVectorSize;
+		size_t particleBytes = this->pipeline.particleList.size() * sizeof(Particle) + innerVectorSize;
 		particleBytes /= unitConversion;
 
 		innerVectorSize = 0;
-		for (auto & particle : this->previousParticleList)
+		for (auto & particle : this->pipeline.previousParticleList)
 			innerVectorSize += particle.neighbourIDs.size() * sizeof(uint64_t);
 
-		size_t previousParticleBytes = this->previousParticleList.size() * sizeof(Particle) + innerVectorSize;
+		size_t previousParticleBytes = this->pipeline.previousParticleList.size() * sizeof(Particle) + innerVectorSize;
 		previousParticleBytes /= unitConversion;
 
 		// Tree and clusters.
-		size_t kdtreeBytes = this->treeSizeOutputCache / unitConversion;
-		size_t clusterBytes = this->clusterList.size() * sizeof(Cluster) / unitConversion;
-		size_t previousClusterBytes = this->previousClusterList.size() * sizeof(Cluster) / unitConversion;
+		size_t kdtreeBytes = this->pipeline.GetStatistics().kdTreeBytes / unitConversion;
+		size_t clusterBytes = this->pipeline.clusterList.size() * sizeof(Cluster) / unitConversion;
+		size_t previousClusterBytes = this->pipeline.previousClusterList.size() * sizeof(Cluster) / unitConversion;
 
 		// Comparison: Partner clusters and their partners.
 		innerVectorSize = 0;
-		for (auto & partnerClusters : this->partnerClustersList.forwardList)
+		for (auto & partnerClusters : this->pipeline.partnerClustersList.forwardList)
 			innerVectorSize += partnerClusters.getNumberOfPartners() * sizeof(PartnerClusters::PartnerCluster);
-		size_t forwardListBytes = this->partnerClustersList.forwardList.size() * sizeof(PartnerClusters) + innerVectorSize;
+		size_t forwardListBytes = this->pipeline.partnerClustersList.forwardList.size() * sizeof(PartnerClusters) + innerVectorSize;
 
 		innerVectorSize = 0;
-		for (auto & partnerClusters : this->partnerClustersList.backwardsList)
+		for (auto & partnerClusters : this->pipeline.partnerClustersList.backwardsList)
 			innerVectorSize += partnerClusters.getNumberOfPartners() * sizeof(PartnerClusters::PartnerCluster);
-		size_t backwardsListBytes = this->partnerClustersList.backwardsList.size() * sizeof(PartnerClusters) + innerVectorSize;
+		size_t backwardsListBytes = this->pipeline.partnerClustersList.backwardsList.size() * sizeof(PartnerClusters) + innerVectorSize;
 
 		size_t partnerClustersBytes = (forwardListBytes + backwardsListBytes) / unitConversion;
 
 		// Structure events.
-		size_t seBytes = this->structureEvents.size() * sizeof(StructureEvents) / unitConversion;
+		size_t seBytes = this->structureEvents.GetStore().getCount() * sizeof(StructureEvents::StructureEvent) / unitConversion;
 
 		size_t totalSize = particleBytes + previousParticleBytes + kdtreeBytes + clusterBytes + previousClusterBytes + partnerClustersBytes + seBytes;
 
@@ -648,473 +866,707 @@ void mmvis_static::StructureEventsCalculation::setData(megamol::core::moldyn::Mu
 			<< clusterBytes << " kiB clusters, "
 			<< partnerClustersBytes << " kiB comparison partners, "
 			<< seBytes << " kiB StructureEvents and "
-			<< totalSize << " kiB for lists in total.";
-		this->csvLogFile
-			<< particleBytes << "; " //  // ParticleList(kiB)
-			<< previousParticleBytes << "; " // Previous particleList (kiB)
-			<< kdtreeBytes << "; " // kdTree (kiB)
-			<< clusterBytes << "; " // ClusterList (kiB)
-			<< previousClusterBytes << "; " // Previous clusterList (kiB)
-			<< partnerClustersBytes << "; " // Comparison partnersList (kiB)
-			<< seBytes << "; " // StructureEventsList (kiB)
-			<< totalSize << "; "; // Total list memory (kiB)
+			<< totalSize << " kiB for lists in total, "
+			<< this->pipeline.GetStatistics().arenaBytes / unitConversion << " kiB frame arena, "
+			<< this->pipeline.GetStatistics().heapAllocations << " heap allocations of frame temporaries.";
+		this->metrics.Set(FrameMetrics::PARTICLE_LIST_KIB, static_cast<double>(particleBytes));
+		this->metrics.Set(FrameMetrics::PREVIOUS_PARTICLE_LIST_KIB, static_cast<double>(previousParticleBytes));
+		this->metrics.Set(FrameMetrics::KDTREE_KIB, static_cast<double>(kdtreeBytes));
+		this->metrics.Set(FrameMetrics::CLUSTER_LIST_KIB, static_cast<double>(clusterBytes));
+		this->metrics.Set(FrameMetrics::PREVIOUS_CLUSTER_LIST_KIB, static_cast<double>(previousClusterBytes));
+		this->metrics.Set(FrameMetrics::PARTNERS_LIST_KIB, static_cast<double>(partnerClustersBytes));
+		this->metrics.Set(FrameMetrics::STRUCTURE_EVENTS_KIB, static_cast<double>(seBytes));
+		this->metrics.Set(FrameMetrics::TOTAL_KIB, static_cast<double>(totalSize));
+		this->metrics.Set(FrameMetrics::FRAME_ARENA_KIB, static_cast<double>(this->pipeline.GetStatistics().arenaBytes / unitConversion));
+		this->metrics.Set(FrameMetrics::HEAP_ALLOCATIONS, static_cast<double>(this->pipeline.GetStatistics().heapAllocations));
 
 		this->logFile << "\n\n";
 		this->logFile.close();
 
-		this->csvLogFile << "\n";
-		this->csvLogFile.close();
+		// The metrics of restored events have been written when they were determined.
+		if (!eventsRestored)
+			this->writeMetrics();
 
 		this->debugFile.close();
 	}
 }
 
 
-void mmvis_static::StructureEventsCalculation::buildParticleList(megamol::core::moldyn::MultiParticleDataCall& data,
-	uint64_t& globalParticleIndex, float& globalRadius, uint8_t(&globalColor)[4], float& globalColorIndexMin, float& globalColorIndexMax) {
-	using megamol::core::moldyn::MultiParticleDataCall;
-
-	///
-	/// Copy old lists.
-	///
-	if (this->particleList.size() > 0) {
-		this->previousParticleList = this->particleList;
-		this->particleList.clear(); // Don't forget!
-	}
-	if (this->clusterList.size() > 0) {
-		this->previousClusterList = this->clusterList;
-		this->clusterList.clear(); // Don't forget!
+/**
+ * mmvis_static::StructureEventsCalculation::updateStructureEvents
+ */
+void mmvis_static::StructureEventsCalculation::updateStructureEvents(const bool reCalculateSE, const bool reSweep) {
+	if (reCalculateSE) {
+		// No previous and partner list size detection here, since
+		// method itself catches this.
+		determineStructureEvents();
+		this->storeResult();
 	}
 
-	///
-	/// Count particles to determine list sizes.
-	///
-
-	size_t globalParticleCnt = 0;
-	unsigned int plc = data.GetParticleListCount();
-	for (unsigned int pli = 0; pli < plc; pli++) {
-		auto& pl = data.AccessParticles(pli);
-		if (pl.GetColourDataType() != MultiParticleDataCall::Particles::COLDATA_FLOAT_I)
-			continue;
-		if ((pl.GetVertexDataType() != MultiParticleDataCall::Particles::VERTDATA_FLOAT_XYZ)
-			&& (pl.GetVertexDataType() != MultiParticleDataCall::Particles::VERTDATA_FLOAT_XYZR)) {
-			continue;
-		}
-		globalParticleCnt += static_cast<size_t>(pl.GetCount());
+	if (reSweep) {
+		this->sweepAmounts.clear();
+		if (this->settings.quantitativeDataOutput)
+			this->sweepStructureEventThresholds();
 	}
+}
 
-	/// Heed size of neighbour IDs when reserving memory. A lot more than needed gets reserved,
-	/// since maxNeighbours is never reached with radius kD search and gas particles have no neighbours at all.
-	/// This is wrong (neighbour vector is stored elsewhere) and bad (way too much memory gets reserved).
-	//float perParticleNeighbourBytes = static_cast<float>(this->getKDTreeMaxNeighbours(this->radiusMultiplierSlot.Param<param::IntParam>()->Value()) * sizeof(uint64_t));
-	//size_t allParticleNeighbourIDSize = static_cast<size_t>(perParticleNeighbourBytes / (float) sizeof(Particle) * globalParticleCnt);
-	//particleList.reserve(globalParticleCnt + allParticleNeighbourIDSize);
 
-	particleList.reserve(globalParticleCnt);
+/**
+ * mmvis_static::StructureEventsCalculation::getCalculationSettings
+ */
+mmvis_static::StructureEventsCalculation::CalculationSettings mmvis_static::StructureEventsCalculation::getCalculationSettings(void) {
+	CalculationSettings settings;
+	settings.parameters = this->getSlotPipelineParameters();
+	settings.clusterColoring = this->clusterColoringSlot.Param<param::EnumParam>()->Value();
+	settings.createDummyTestData = this->createDummyTestDataSlot.Param<param::BoolParam>()->Value();
+	settings.speculation = this->speculationSlot.Param<param::BoolParam>()->Value();
+
+	settings.quantitativeDataOutput = this->quantitativeDataOutputSlot.Param<param::BoolParam>()->Value();
+	settings.outputLabel = vislib::StringA(this->outputLabelSlot.Param<param::StringParam>()->Value());
+	settings.metricsFormat = this->metricsFormatSlot.Param<param::EnumParam>()->Value();
+	settings.comparisonFormat = this->comparisonFormatSlot.Param<param::EnumParam>()->Value();
+	settings.mmseFilename = this->mmseFilenameSlot.Param<param::FilePathParam>()->Value();
+	settings.mmseCompressionLevel = static_cast<unsigned int>(this->mmseCompressionLevelSlot.Param<param::IntParam>()->Value());
+
+	settings.sweepMsMinCPPercentages = parseSweepGrid(vislib::StringA(this->sweepMsMinCPPercentagesSlot.Param<param::StringParam>()->Value()).PeekBuffer());
+	settings.sweepMsMinClusterAmounts = parseSweepGrid(vislib::StringA(this->sweepMsMinClusterAmountsSlot.Param<param::StringParam>()->Value()).PeekBuffer());
+	settings.sweepBdMaxCPPercentages = parseSweepGrid(vislib::StringA(this->sweepBdMaxCPPercentagesSlot.Param<param::StringParam>()->Value()).PeekBuffer());
+
+	settings.clusterCacheMode = this->clusterCacheModeSlot.Param<param::EnumParam>()->Value();
+	settings.clusterCacheFilename = this->clusterCacheFilenameSlot.Param<param::FilePathParam>()->Value();
+	if (this->clusterCacheModeSlot.IsDirty() || this->clusterCacheFilenameSlot.IsDirty()) {
+		this->clusterCacheModeSlot.ResetDirty();
+		this->clusterCacheFilenameSlot.ResetDirty();
+		settings.clusterCacheChanged = true;
+	}
+
+	// The defaults of the slots are those of the cache and the pool.
+	settings.resultCacheCapacity = static_cast<size_t>(this->resultCacheSizeSlot.Param<param::IntParam>()->Value()) * 1024 * 1024;
+	if (this->resultCacheSizeSlot.IsDirty()) {
+		this->resultCacheSizeSlot.ResetDirty();
+		settings.resultCacheCapacityChanged = true;
+	}
+	settings.taskPoolThreads = static_cast<unsigned int>(this->taskPoolThreadsSlot.Param<param::IntParam>()->Value());
+	if (this->taskPoolThreadsSlot.IsDirty()) {
+		this->taskPoolThreadsSlot.ResetDirty();
+		settings.taskPoolThreadsChanged = true;
+	}
+	return settings;
+}
 
-	///
-	/// Build list.
-	///
-	auto time_buildList = std::chrono::system_clock::now();
 
-	for (unsigned int particleListIndex = 0; particleListIndex < data.GetParticleListCount(); ++particleListIndex) {
+/**
+ * mmvis_static::StructureEventsCalculation::applySettings
+ */
+void mmvis_static::StructureEventsCalculation::applySettings(const CalculationSettings& settings) {
+	this->settings = settings;
+	if (settings.resultCacheCapacityChanged)
+		this->resultCache.SetCapacity(settings.resultCacheCapacity);
+	if (settings.taskPoolThreadsChanged)
+		TaskPool::SetDefaultThreadCount(settings.taskPoolThreads);
+	if (settings.clusterCacheChanged)
+		this->clusterCache.Close();
+}
 
-		///
-		/// Get meta information of data.
-		///
 
-		MultiParticleDataCall::Particles& particles = data.AccessParticles(particleListIndex);
+/**
+ * mmvis_static::StructureEventsCalculation::getResultCacheKey
+ */
+mmvis_static::FrameResultCache::Key mmvis_static::StructureEventsCalculation::getResultCacheKey(const unsigned int frameID) {
+	FrameResultCache::Key key;
+	key.frameID = frameID;
+	key.dataHash = this->dataHash;
+	key.neighbourSearch = static_cast<int>(this->settings.parameters.neighbourSearch);
+	key.radiusMultiplier = this->settings.parameters.radiusMultiplier;
+	key.minClusterSize = this->settings.parameters.minClusterSize;
+	key.periodicBoundary = this->settings.parameters.periodicBoundary;
+	// Colours are inherited from frame to frame, a restored frame of another colouring would keep its old colours.
+	key.clusterColoring = this->settings.clusterColoring;
+	return key;
+}
 
-		// Check for existing data.
 
-		//if (particles.GetVertexDataType() == MultiParticleDataCall::Particles::VERTDATA_NONE
-		//		|| particles.GetCount() == 0) {
-		//	printf("Particlelist %d skipped, no vertex data.\n", particleListIndex); // Debug.
-		//	continue; // Skip this particle list.
-		//}
+/**
+ * mmvis_static::StructureEventsCalculation::setTruePreviousFrame
+ */
+void mmvis_static::StructureEventsCalculation::setTruePreviousFrame(const FrameResultCache::Key& key) {
+	// Without hash there are no keys, the last calculated frame stays the previous one.
+	if (this->dataHash == 0)
+		return;
 
+	///
+	/// The lists of the last calculated frame, moved to the previous
+	/// lists by step 1, are kept if they are frame t-1.
+	///
+	if (key.frameID > 0) {
+		FrameResultCache::Key previousKey = key;
+		previousKey.frameID = key.frameID - 1;
 
-		// Check for existing data.
-		if (particles.GetCount() == 0) {
-			vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_WARN, "Particlelist %d skipped, no vertex data.", particleListIndex);
-			continue; // Skip this particle list.
-		}
+		// The clusters do not depend on the colouring, a previous frame of
+		// another colouring only passes on its colours.
+		FrameResultCache::Key listKey = this->listKey;
+		listKey.clusterColoring = key.clusterColoring;
+		if (this->listKeyValid && listKey == previousKey)
+			return;
 
-		// Check for correct vertex type.
-		if (particles.GetVertexDataType() != MultiParticleDataCall::Particles::VERTDATA_FLOAT_XYZ
-			&& particles.GetVertexDataType() != MultiParticleDataCall::Particles::VERTDATA_FLOAT_XYZR) {
-			vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_WARN, "Particlelist %d skipped, vertex are not floats.", particleListIndex);
-			continue; // Skip this particle list.
+		std::shared_ptr<const FrameResultCache::Entry> previous = this->resultCache.Get(previousKey);
+		const int coloringCount = 3; // Modes of the cluster colouring.
+		for (int coloring = 0; coloring < coloringCount && !previous; ++coloring) {
+			previousKey.clusterColoring = coloring;
+			if (coloring != key.clusterColoring)
+				previous = this->resultCache.Get(previousKey);
 		}
-
-		// Check for correct color type.
-		if (particles.GetColourDataType() != MultiParticleDataCall::Particles::COLDATA_FLOAT_I) {
-			vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_WARN, "Particlelist %d skipped, COLDATA_FLOAT_I expected.", particleListIndex);
-			continue; // Skip this particle list.
+		if (previous) {
+			FrameResultCache::RestorePrevious(*previous, this->pipeline);
+			return;
 		}
+	}
 
-		// Get pointer at vertex data.
-		const uint8_t *vertexPtr = static_cast<const uint8_t*>(particles.GetVertexData()); // ParticleRelaxationModule.
-		//const void *vertexPtr = particles.GetVertexData(); // Particle Thinner.
+	this->pipeline.previousParticleList.clear();
+	this->pipeline.previousClusterList.clear();
+}
 
-		// Get pointer at color data. The signed distance is stored here.
-		const uint8_t *colourPtr = static_cast<const uint8_t*>(particles.GetColourData());
 
-		// Get single vertices by heeding dataType and Stride.
-		// Vertex.
-		unsigned int vertexStride = particles.GetVertexDataStride(); // Distance from one Vertex to the next.
-		//bool vertexIsFloat = true;
-		bool hasRadius = false;
-		switch (particles.GetVertexDataType()) { // VERTDATA_NONE tested above.
-		case MultiParticleDataCall::Particles::VERTDATA_FLOAT_XYZR:
-			hasRadius = true;
-			vertexStride = std::max<unsigned int>(vertexStride, 16);
-			break;
-		case MultiParticleDataCall::Particles::VERTDATA_FLOAT_XYZ:
-			vertexStride = std::max<unsigned int>(vertexStride, 12);
-			break;
-			//case MultiParticleDataCall::Particles::VERTDATA_SHORT_XYZ:
-			//	vertexIsFloat = false;
-			//	vertexStride = std::max<unsigned int>(vertexStride, 6);
-			//	break;
-		default: throw std::exception();
-		}
+/**
+ * mmvis_static::StructureEventsCalculation::storeResult
+ */
+void mmvis_static::StructureEventsCalculation::storeResult(void) {
+	if (!this->listKeyValid)
+		return;
+	this->resultCache.Put(this->listKey, this->pipeline, this->pipelineCompared, this->pipelineEvents, this->getPipelineParameters());
+}
 
-		// Color.
-		unsigned int colourStride = particles.GetColourDataStride(); // Distance from one Color to the next == VertexStride.
-		colourStride = std::max<unsigned int>(colourStride, 4); // MultiParticleDataCall::Particles::COLDATA_FLOAT_I.
 
-		// Particlelist globals. Gets overwritten with each ParticleList. Doesn't matter here anyways.
-		globalRadius = particles.GetGlobalRadius();
-		::memcpy(globalColor, particles.GetGlobalColour(), 4);
-		globalColorIndexMin = particles.GetMinColourIndexValue();
-		globalColorIndexMax = particles.GetMaxColourIndexValue();
+/**
+ * mmvis_static::StructureEventsCalculation::requestCalculation
+ */
+void mmvis_static::StructureEventsCalculation::requestCalculation(megamol::core::moldyn::MultiParticleDataCall& inData,
+	const CalculationSettings& settings, const bool calculateFrame, const bool reCalculateSE, const bool reSweep) {
+	std::shared_ptr<FrameRequest> request = std::make_shared<FrameRequest>();
+	request->settings = settings;
+	request->calculateFrame = calculateFrame;
+	request->reCalculateSE = reCalculateSE;
+	request->reSweep = reSweep;
+
+	if (calculateFrame) {
+		copyParticleData(inData, *request);
+		this->requestedFrameValid = true;
+		this->requestedFrameId = request->frameId;
+		this->requestedDataHash = request->dataHash;
+	}
+
+	///
+	/// A new frame supersedes the waiting request, slot changes are added to
+	/// it. The settings are the latest ones, with the changes of both.
+	///
+	{
+		std::lock_guard<std::mutex> lock(this->requestMutex);
+		if (this->waitingRequest) {
+			const CalculationSettings& waitingSettings = this->waitingRequest->settings;
+			request->reCalculateSE = request->reCalculateSE || this->waitingRequest->reCalculateSE;
+			request->reSweep = request->reSweep || this->waitingRequest->reSweep;
+			request->settings.clusterCacheChanged = request->settings.clusterCacheChanged || waitingSettings.clusterCacheChanged;
+			request->settings.resultCacheCapacityChanged = request->settings.resultCacheCapacityChanged || waitingSettings.resultCacheCapacityChanged;
+			request->settings.taskPoolThreadsChanged = request->settings.taskPoolThreadsChanged || waitingSettings.taskPoolThreadsChanged;
+			if (!calculateFrame && this->waitingRequest->calculateFrame) {
+				this->waitingRequest->reCalculateSE = request->reCalculateSE;
+				this->waitingRequest->reSweep = request->reSweep;
+				this->waitingRequest->settings = request->settings;
+				request = this->waitingRequest;
+			}
+		}
+		this->waitingRequest = request;
+	}
 
-		///
-		/// Write data into local container.
-		///
+	this->calculationWorker.Submit(std::bind(&StructureEventsCalculation::calculateRequest, this));
+}
 
-		for (uint64_t particleIndex = 0; particleIndex < particles.GetCount(); ++particleIndex, vertexPtr += vertexStride, colourPtr += colourStride) {
 
-			Particle particle;
-			//Particle particle(this->radiusMultiplierSlot.Param<param::IntParam>()->Value()); // This doubles creation time! Don't do this, it is horrible (see Constructor description).
+/**
+ * mmvis_static::StructureEventsCalculation::calculateRequest
+ */
+void mmvis_static::StructureEventsCalculation::calculateRequest(void) {
+	std::shared_ptr<FrameRequest> request;
+	{
+		std::lock_guard<std::mutex> lock(this->requestMutex);
+		request.swap(this->waitingRequest);
+	}
+	if (!request)
+		return; // Taken by an earlier job.
 
-			// Vertex.
-			//if (vertexIsFloat) { // Performance is lower with if-else in loop, however readability is higher.
-			const float *vertexPtrf = reinterpret_cast<const float*>(vertexPtr);
-			particle.x = vertexPtrf[0];
-			particle.y = vertexPtrf[1];
-			particle.z = vertexPtrf[2];
-			particle.radius = hasRadius ? vertexPtrf[3] : globalRadius;
-			//}
-			//else {
-			//	const uint16_t *vertexPtr16 = reinterpret_cast<const uint16_t*>(vertexPtr);
-			//	Particle particle;
-			//	particle.x = static_cast<float>(vertexPtr16[0]);
-			//	particle.y = static_cast<float>(vertexPtr16[1]);
-			//	particle.z = static_cast<float>(vertexPtr16[2]);
-			//	particle.radius = static_cast<float>(vertexPtr16[3]);
-			//}
+	this->applySettings(request->settings);
+	if (request->calculateFrame) {
+		this->frameId = request->frameId;
+		this->dataHash = request->dataHash;
+		this->setData(request->data);
+	}
+	this->updateStructureEvents(request->reCalculateSE, request->reSweep);
 
-			// Colour/Signed Distance.
-			const float *colourPtrf = reinterpret_cast<const float*>(colourPtr);
-			particle.signedDistance = *colourPtrf;
+	this->publishResult();
+}
 
 
-			// For testing if sorting works.
-			//if (particle.signedDistance > signedDistanceMax)
-			//	signedDistanceMax = particle.signedDistance;
-			//if (particle.signedDistance < signedDistanceMin)
-			//	signedDistanceMin = particle.signedDistance;
+/**
+ * mmvis_static::StructureEventsCalculation::publishResult
+ */
+void mmvis_static::StructureEventsCalculation::publishResult(void) {
+	using megamol::core::moldyn::MultiParticleDataCall;
 
-			// Set particle ID.
-			particle.id = globalParticleIndex + particleIndex;
+	std::shared_ptr<FrameResult> result = std::make_shared<FrameResult>();
+	result->frameId = this->frameId;
+	result->dataHash = this->dataHash;
 
-			// Add particle to list.
-			this->particleList.push_back(particle);
-		}
-		globalParticleIndex += static_cast<size_t>(particles.GetCount());
-	}
-	
 	///
-	/// Log output.
+	/// Positions and cluster colours, packed.
 	///
-	{// Time measurement. 4s
-		auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now() - time_buildList);
-		vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_INFO,
-			"SECalc step 1: Created particle list with %d elements in %lld ms.", particleList.size(), duration.count());
-		
-		if (this->quantitativeDataOutputSlot.Param<param::BoolParam>()->Value()) {
-			this->logFile
-				<< "Step 1 (build particleList, create kdTree and find neighbours):\n"
-				<< "  a) ParticleList with " << particleList.size() << " particles (" << duration.count() << " ms)\n";
-			this->csvLogFile
-				<< particleList.size() << "; " // Particles (#)
-				<< duration.count() << "; "; // ParticleList (ms)
-		}
+	const size_t count = this->pipeline.particleList.size();
+	result->particleData.resize(7 * count);
+	for (size_t i = 0; i < count; ++i) {
+		const Particle& particle = this->pipeline.particleList[i];
+		float *target = &result->particleData[7 * i];
+		target[0] = particle.x;
+		target[1] = particle.y;
+		target[2] = particle.z;
+		target[3] = particle.radius;
+		target[4] = particle.r;
+		target[5] = particle.g;
+		target[6] = particle.b;
+	}
+	result->particles = this->particles;
+	result->particles.SetCount(count);
+	if (count > 0) {
+		result->particles.SetVertexData(MultiParticleDataCall::Particles::VERTDATA_FLOAT_XYZR, &result->particleData[0], 7 * sizeof(float));
+		result->particles.SetColourData(MultiParticleDataCall::Particles::COLDATA_FLOAT_RGB, &result->particleData[4], 7 * sizeof(float));
 	}
-}
-
 
-void mmvis_static::StructureEventsCalculation::findNeighboursWithKDTree(megamol::core::moldyn::MultiParticleDataCall& data) {
+	// Replays only the frames changed since the copy was published, with the columns.
+	result->structureEvents = this->structureEvents.Publish();
+	result->sedcHash = ++this->publishedResultCount;
 
-	auto time_buildTree = std::chrono::system_clock::now();
+	std::lock_guard<std::mutex> lock(this->resultMutex);
+	this->finishedResult = result;
+}
 
-	///
-	/// Create k-d-Tree.
-	///
-	/// nn_idx return value of search functions matches position in ANNpointArray,
-	/// which matches the particle ID in particleList as long as particleList
-	/// is not resorted!
-	///
 
-	ANNpoint annPtsData = new ANNcoord[3 * this->particleList.size()]; // Container for pointdata. Can be deleted at the end of the function.
-	ANNpointArray annPts = new ANNpoint[this->particleList.size()];
-	//uint64_t annPtsCounter = 0;
-	for (auto & particle : this->particleList) {
-		// Creating new points causes missing memory deallocation since they can't be deleted at the end of the function.
-		//ANNpoint qTree = new ANNcoord[3]; // Mustn't be deleted before the end of the function.
-		//qTree[0] = static_cast<ANNcoord>(particle.x);
-		//qTree[1] = static_cast<ANNcoord>(particle.y);
-		//qTree[2] = static_cast<ANNcoord>(particle.z);
-		//annPts[annPtsCounter] = qTree;
-		//annPtsCounter++;
-		// //delete[] qTree; // Wrong here, mustn't be called before end of the function!
-		
-		annPtsData[(particle.id * 3) + 0] = static_cast<ANNcoord>(particle.x);
-		annPtsData[(particle.id * 3) + 1] = static_cast<ANNcoord>(particle.y);
-		annPtsData[(particle.id * 3) + 2] = static_cast<ANNcoord>(particle.z);
-	}
-	for (size_t i = 0; i < this->particleList.size(); ++i) {
-		annPts[i] = annPtsData + (i * 3);
+/**
+ * mmvis_static::StructureEventsCalculation::stopCalculation
+ */
+void mmvis_static::StructureEventsCalculation::stopCalculation(void) {
+	{
+		std::lock_guard<std::mutex> lock(this->requestMutex);
+		this->waitingRequest.reset();
 	}
+	this->calculationWorker.Wait();
+}
 
-	ANNkd_tree* tree = new ANNkd_tree(annPts, static_cast<int>(this->particleList.size()), 3);
 
-	this->treeSizeOutputCache = tree->nPoints() * sizeof(ANNcoord) * 3; // One ANNPoint consists of 3 ANNcoords here.
+/**
+ * mmvis_static::StructureEventsCalculation::copyParticleData
+ */
+void mmvis_static::StructureEventsCalculation::copyParticleData(megamol::core::moldyn::MultiParticleDataCall& inData, FrameRequest& request) {
+	using megamol::core::moldyn::MultiParticleDataCall;
 
 	///
-	/// Log output.
-	///
-	{ // Time measurement. 7s
-		auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now() - time_buildTree);
-		vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_INFO,
-			"SECalc step 1: Created kD-tree in %lld ms.", duration.count());
-
-		if (this->quantitativeDataOutputSlot.Param<param::BoolParam>()->Value()) {
-			this->logFile << "  b) kD-tree (" << duration.count() << " ms)\n";
-			this->csvLogFile << duration.count() << "; "; // kdTree (ms)
+	/// Copy the particle lists the calculation uses, the others keep
+	/// their meta data only and are skipped by buildParticleList.
+	///
+	request.frameId = inData.FrameID();
+	request.dataHash = inData.DataHash();
+	request.data.AccessBoundingBoxes() = inData.AccessBoundingBoxes();
+	request.data.SetParticleListCount(inData.GetParticleListCount());
+	request.vertexBuffers.resize(inData.GetParticleListCount());
+	request.colourBuffers.resize(inData.GetParticleListCount());
+	for (unsigned int particleListIndex = 0; particleListIndex < inData.GetParticleListCount(); ++particleListIndex) {
+		const MultiParticleDataCall::Particles& particles = inData.AccessParticles(particleListIndex);
+		MultiParticleDataCall::Particles& copy = request.data.AccessParticles(particleListIndex);
+		copy = particles;
+
+		const MultiParticleDataCall::Particles::VertexDataType vertexType = particles.GetVertexDataType();
+		const bool supported = particles.GetCount() > 0 && particles.GetColourDataType() == MultiParticleDataCall::Particles::COLDATA_FLOAT_I
+			&& (vertexType == MultiParticleDataCall::Particles::VERTDATA_FLOAT_XYZ || vertexType == MultiParticleDataCall::Particles::VERTDATA_FLOAT_XYZR);
+		if (!supported) {
+			copy.SetVertexData(vertexType, NULL);
+			copy.SetColourData(particles.GetColourDataType(), NULL);
+			continue;
 		}
-	}
 
-	///
-	/// Get bounding box for periodic boundary condition.
-	///
-	auto bbox = data.AccessBoundingBoxes().ObjectSpaceBBox();
-	bbox.EnforcePositiveSize(); // paranoia says Sebastian. Well, nothing compared to list pointer consistency checks.
-	auto bbox_cntr = bbox.CalcCenter();
-	
-	const bool periodicBoundary = this->periodicBoundaryConditionSlot.Param<megamol::core::param::BoolParam>()->Value();
+		const size_t count = static_cast<size_t>(particles.GetCount());
+		const size_t vertexSize = (vertexType == MultiParticleDataCall::Particles::VERTDATA_FLOAT_XYZR ? 4 : 3) * sizeof(float);
+		const size_t vertexStride = particles.GetVertexDataStride() > 0 ? particles.GetVertexDataStride() : vertexSize;
+		const size_t colourStride = particles.GetColourDataStride() > 0 ? particles.GetColourDataStride() : sizeof(float);
 
-	///
-	/// Find and store neighbours.
-	///
-	const auto time_findNeighbours = std::chrono::system_clock::now();
+		std::vector<uint8_t>& vertexBuffer = request.vertexBuffers[particleListIndex];
+		const uint8_t *vertexData = static_cast<const uint8_t*>(particles.GetVertexData());
+		vertexBuffer.assign(vertexData, vertexData + (count - 1) * vertexStride + vertexSize);
+		copy.SetVertexData(vertexType, vertexBuffer.data(), particles.GetVertexDataStride());
 
-	const bool debugSkipParticles = false; // Skip particles for faster tests.
-	const bool useFRSearch = true; // Use kD tree search with radius.
-	const int radiusMultiplier = this->radiusMultiplierSlot.Param<param::IntParam>()->Value();
+		std::vector<uint8_t>& colourBuffer = request.colourBuffers[particleListIndex];
+		const uint8_t *colourData = static_cast<const uint8_t*>(particles.GetColourData());
+		colourBuffer.assign(colourData, colourData + (count - 1) * colourStride + sizeof(float));
+		copy.SetColourData(MultiParticleDataCall::Particles::COLDATA_FLOAT_I, colourBuffer.data(), particles.GetColourDataStride());
+	}
+}
 
-	const int maxNeighbours = this->getKDTreeMaxNeighbours(radiusMultiplier);
 
-	ANNdist sqrRadius = powf(radiusMultiplier * particleList[0].radius, 2);
+/**
+ * mmvis_static::StructureEventsCalculation::speculateNextFrame
+ */
+void mmvis_static::StructureEventsCalculation::speculateNextFrame(megamol::core::moldyn::MultiParticleDataCall& inData) {
+	const unsigned int frameCount = inData.FrameCount();
+	if (frameCount < 2)
+		return;
+	const unsigned int nextFrameId = (inData.FrameID() + 1) % frameCount;
+	if (this->speculationRequestedValid && this->speculationRequestedFrameId == nextFrameId)
+		return; // Already speculated.
 
 	///
-	/// Log output.
+	/// Not forced, the source loads the frame in the background and answers
+	/// with another one until it has it. Tried again with the next call.
 	///
-	if (useFRSearch)
-		vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_INFO,
-		"SECalc step 1: annkFRSearch with radius %d (%.2f) and %d max neighbours.", radiusMultiplier, sqrRadius, maxNeighbours);
-	else
-		vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_INFO,
-			"SECalc step 1: annkSearch %d max neighbours.", maxNeighbours);
-	
-	if (this->quantitativeDataOutputSlot.Param<param::BoolParam>()->Value()) {
-		this->logFile << "  c) Neighbours";
-
-		if (useFRSearch) {
-			this->logFile
-				<< " annkFRSearch with " << radiusMultiplier << "*radius and "
-				<< maxNeighbours << " max neighbours";
-			this->csvLogFile
-				<< radiusMultiplier << "; " // Neighbours radius multiplier
-				<< maxNeighbours << "; "; // Neighbours max neighbours
-		}
-		else {
-			this->logFile << " annkSearch with " << maxNeighbours << " max neighbours";
-			this->csvLogFile
-				<< "; " // Neighbours radius multiplier, empty.
-				<< maxNeighbours << "; "; // Neighbours max neighbours
-		}
+	const unsigned int servedFrameId = inData.FrameID();
+	inData.SetFrameID(nextFrameId, false);
+	if (!inData(0)) {
+		this->restoreServedFrame(inData, servedFrameId);
+		return;
+	}
+	// Without hash the result can not be matched to the data later.
+	if (inData.FrameID() != nextFrameId || inData.DataHash() == 0) {
+		inData.Unlock();
+		this->restoreServedFrame(inData, servedFrameId);
+		return;
 	}
 
-	uint64_t debugSkippedNeighbours = 0; // Not usable with concurrency.
-	uint64_t debugAddedNeighbours = 0; // Not usable with concurrency.
-	uint64_t progressControl = 1; // For avoiding duplicated progress control output. Initial value different from % 100000.
+	std::shared_ptr<FrameRequest> request = std::make_shared<FrameRequest>();
+	copyParticleData(inData, *request);
+	inData.Unlock();
+	this->restoreServedFrame(inData, servedFrameId);
+
+	std::shared_ptr<SpeculativeFrame> speculation = std::make_shared<SpeculativeFrame>();
+	speculation->frameId = request->frameId;
+	speculation->dataHash = request->dataHash;
+	speculation->parameters = this->getSlotPipelineParameters();
+	setBoundingBox(request->data, speculation->parameters);
+	{
+		// A speculation of another frame is discarded.
+		std::lock_guard<std::mutex> lock(this->speculationMutex);
+		this->speculation = speculation;
+	}
+	this->speculationWorker.Submit(std::bind(&StructureEventsCalculation::calculateSpeculation, this, request, speculation->parameters));
+
+	this->speculationRequestedValid = true;
+	this->speculationRequestedFrameId = nextFrameId;
+}
 
-	/// OpenMP. Doesnt work b/c ANN64d.dll throws exception (Zugriffsverletzung) for annkFRSearch, annkSearch:
-	/// Since parallel access by several threads to the same tree!
-	/// Furthermore ANN doesnt seem to work with parallelisation at all since it uses the same shared memory for all search structures! http://stackoverflow.com/a/2182357
-	//#pragma omp parallel for
-	//for (int i = 0; i < this->particleList.size(); ++i) {
-	//	auto particle = this->particleList[i];
-	
-	/// PPL. Doesnt work b/c ANN64d.dll throws exception (Zugriffsverletzung) for annkFRSearch, annkSearch:
-	/// Since parallel access by several threads to the same tree!
-	/// Furthermore ANN doesnt seem to work with parallelisation at all since it uses the same shared memory for all search structures! http://stackoverflow.com/a/2182357
-	//concurrency::parallel_for_each(this->particleList.begin(), this->particleList.end(),
-	//	[maxNeighbours, periodicBoundary, bbox_cntr, bbox, useFRSearch, tree, sqrRadius](Particle particle) {
 
-	for (auto & particle : this->particleList) {
+/**
+ * mmvis_static::StructureEventsCalculation::restoreServedFrame
+ */
+void mmvis_static::StructureEventsCalculation::restoreServedFrame(megamol::core::moldyn::MultiParticleDataCall& inData,
+	const unsigned int servedFrameId) {
+	// Not forced, the render thread never waits for the disk. If the source
+	// evicted the served frame, the next data request sets it again.
+	inData.SetFrameID(servedFrameId, false);
+	if (inData(0))
+		inData.Unlock();
+}
 
-		// Skip particles for faster testing. Not usable with concurrency.
-		if (debugSkipParticles && particle.id > 10000)
-			break;
 
-		ANNidxArray   nn_idx = 0;
-		ANNdistArray  dd = 0;
-		nn_idx = new ANNidx[maxNeighbours];
-		dd = new ANNdist[maxNeighbours];
-
-		ANNpoint q = new ANNcoord[3];
-
-		// The three loops are for periodic boundary condition.
-		for (int x_s = 0; x_s < (periodicBoundary ? 2 : 1); ++x_s) {
-			for (int y_s = 0; y_s < (periodicBoundary ? 2 : 1); ++y_s) {
-				for (int z_s = 0; z_s < (periodicBoundary ? 2 : 1); ++z_s) {
-
-					q[0] = static_cast<ANNcoord>(particle.x);
-					q[1] = static_cast<ANNcoord>(particle.y);
-					q[2] = static_cast<ANNcoord>(particle.z);
-
-					if (x_s > 0) q[0] = static_cast<ANNcoord>(particle.x + ((particle.x > bbox_cntr.X()) ? -bbox.Width() : bbox.Width()));
-					if (y_s > 0) q[1] = static_cast<ANNcoord>(particle.y + ((particle.y > bbox_cntr.Y()) ? -bbox.Height() : bbox.Height()));
-					if (z_s > 0) q[2] = static_cast<ANNcoord>(particle.z + ((particle.z > bbox_cntr.Z()) ? -bbox.Depth() : bbox.Depth()));
-
-					if (useFRSearch) {
-						tree->annkFRSearch(
-							q,				// the query point
-							sqrRadius,		// squared radius of query ball
-							maxNeighbours,	// number of neighbors to return
-							nn_idx,			// nearest neighbor array (modified)
-							dd				// dist to near neighbors as squared distance (modified)
-							);				// error bound (optional).
-					}
-					else {
-						tree->annkSearch(
-							q,				// the query point
-							maxNeighbours,	// number of neighbors to return
-							nn_idx,			// nearest neighbor array (modified)
-							dd				// dist to near neighbors as squared distance (modified)
-							);				// error bound (optional).
-					}
+/**
+ * mmvis_static::StructureEventsCalculation::calculateSpeculation
+ */
+void mmvis_static::StructureEventsCalculation::calculateSpeculation(std::shared_ptr<FrameRequest> request,
+	const StructureEventsPipeline::Parameters parameters) {
+	{
+		std::lock_guard<std::mutex> lock(this->speculationMutex);
+		if (!this->speculation || this->speculation->frameId != request->frameId || this->speculation->dataHash != request->dataHash)
+			return; // Superseded.
+	}
+
+	// Only the log, the files belong to the calculation.
+	std::unique_ptr<StructureEventsPipeline> speculative(new StructureEventsPipeline());
+	speculative->SetLogCallback([](const StructureEventsPipeline::LogLevel level, const std::string& message) {
+		if (level != StructureEventsPipeline::LOG_INFO)
+			vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_WARN, "SECalc speculation: %s", message.c_str());
+	});
 
-					for (size_t i = 0; i < maxNeighbours; ++i) {
-						if (nn_idx[i] == ANN_NULL_IDX) {
-							debugSkippedNeighbours++; // Deactivate if concurrent loop.
-							continue;
-						}
-						if (dd[i] < 0.001f) // Exclude self to catch ANN_ALLOW_SELF_MATCH = true.
-							continue;
+	std::vector<StructureEventsPipeline::ParticleSpan> spans;
+	getParticleSpans(request->data, spans);
+	speculative->BeginFrame(request->frameId);
+	for (auto & span : spans)
+		speculative->AddParticles(span);
+	speculative->FindNeighbours(parameters);
+	speculative->CreateClustersFastDepth(parameters);
+	speculative->MergeSmallClusters(parameters);
+
+	std::lock_guard<std::mutex> lock(this->speculationMutex);
+	if (this->speculation && this->speculation->frameId == request->frameId && this->speculation->dataHash == request->dataHash)
+		this->speculation->pipeline = std::move(speculative);
+}
 
-						debugAddedNeighbours++; // Deactivate if concurrent loop.
 
-						// Store whole particle in neighbour list: Takes a lot of memory and time! At maximum maxNeighbours = 3 and 2*r works on test machine.
-						//particle.neighbours.push_back(_getParticle(nn_idx[i])); // Search eates up to 500ms/Particle + high memory consumption!
-						//particle.neighbours.push_back(this->particleList[nn_idx[i]]);
+/**
+ * mmvis_static::StructureEventsCalculation::adoptSpeculativeClusters
+ */
+bool mmvis_static::StructureEventsCalculation::adoptSpeculativeClusters(megamol::core::moldyn::MultiParticleDataCall& data) {
+	if (!this->settings.speculation || this->dataHash == 0)
+		return false;
 
-						// Requires untouched particleList but needs a lot less memory!
-						//particle.neighbourPtrs.push_back(&this->particleList[nn_idx[i]]);
-						
-						// Safer method than above and still low memory consumption.
-						particle.neighbourIDs.push_back(nn_idx[i]);
-					}
+	const StructureEventsPipeline::Parameters parameters = this->getPipelineParameters(data);
+	std::unique_lock<std::mutex> lock(this->speculationMutex);
+	for (int attempt = 0; attempt < 2; ++attempt) {
+		if (!this->speculation || this->speculation->frameId != this->frameId || this->speculation->dataHash != this->dataHash
+			|| !haveSameClusterParameters(this->speculation->parameters, parameters))
+			return false;
+		if (this->speculation->pipeline)
+			break;
+		// Still calculated, waiting is faster than starting over.
+		lock.unlock();
+		this->speculationWorker.Wait();
+		lock.lock();
+	}
+	if (!this->speculation || !this->speculation->pipeline)
+		return false;
 
-					// Progress. Deactivate if concurrent loop.
-					if (debugAddedNeighbours % 100000 == 0)
-						if (debugAddedNeighbours != progressControl) {
-							progressControl = debugAddedNeighbours;
-							vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_INFO,
-								"SECalc step 1 progress: Neighbours: %d added, %d out of FRSearch radius.", debugAddedNeighbours, debugSkippedNeighbours);
-						}
-				}
-			}
-		}
+	StructureEventsPipeline& speculative = *this->speculation->pipeline;
+	if (speculative.particleList.size() != this->pipeline.particleList.size())
+		return false;
+	this->pipeline.AdoptClusters(speculative);
+	this->speculation.reset();
+	lock.unlock();
 
-		delete[] nn_idx;
-		delete[] dd;
-		delete[] q;
+	///
+	/// Log output.
+	///
+	vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_INFO,
+		"SECalc steps 1b and 2: Took %d clusters of the speculative calculation.", static_cast<int>(this->pipeline.clusterList.size()));
+	if (this->settings.quantitativeDataOutput) {
+		const StructureEventsPipeline::Statistics& statistics = this->pipeline.GetStatistics();
+		this->logFile
+			<< "  b) and c), step 2: Clusters of the speculative calculation ("
+			<< statistics.kdTreeDuration + statistics.neighboursDuration + statistics.fastDepthDuration + statistics.mergeDuration
+			<< " ms in the background)\n";
 	}
-	//});
+	return true;
+}
+
+
+/**
+ * mmvis_static::StructureEventsCalculation::getSlotPipelineParameters
+ */
+mmvis_static::StructureEventsPipeline::Parameters mmvis_static::StructureEventsCalculation::getSlotPipelineParameters(void) {
+	StructureEventsPipeline::Parameters parameters;
+	parameters.neighbourSearch = static_cast<StructureEventsPipeline::NeighbourSearch>(
+		this->neighbourSearchMethodSlot.Param<param::EnumParam>()->Value());
+	parameters.radiusMultiplier = this->radiusMultiplierSlot.Param<param::IntParam>()->Value();
+	parameters.minClusterSize = this->minClusterSizeSlot.Param<param::IntParam>()->Value();
+	parameters.periodicBoundary = this->periodicBoundaryConditionSlot.Param<param::BoolParam>()->Value();
+	parameters.msMinCPPercentage = this->msMinCPPercentageSlot.Param<param::FloatParam>()->Value();
+	parameters.msMinClusterAmount = this->msMinClusterAmountSlot.Param<param::IntParam>()->Value();
+	parameters.bdMaxCPPercentage = this->bdMaxCPPercentageSlot.Param<param::FloatParam>()->Value();
+	return parameters;
+}
+
+
+/**
+ * mmvis_static::StructureEventsCalculation::getPipelineParameters
+ */
+mmvis_static::StructureEventsPipeline::Parameters mmvis_static::StructureEventsCalculation::getPipelineParameters(void) {
+	return this->settings.parameters;
+}
+
+
+/**
+ * mmvis_static::StructureEventsCalculation::getPipelineParameters
+ */
+mmvis_static::StructureEventsPipeline::Parameters mmvis_static::StructureEventsCalculation::getPipelineParameters(
+	megamol::core::moldyn::MultiParticleDataCall& data) {
+	StructureEventsPipeline::Parameters parameters = this->getPipelineParameters();
+	setBoundingBox(data, parameters);
+	return parameters;
+}
+
+
+/**
+ * mmvis_static::StructureEventsCalculation::setBoundingBox
+ */
+void mmvis_static::StructureEventsCalculation::setBoundingBox(megamol::core::moldyn::MultiParticleDataCall& data,
+	StructureEventsPipeline::Parameters& parameters) {
+	auto bbox = data.AccessBoundingBoxes().ObjectSpaceBBox();
+	bbox.EnforcePositiveSize(); // paranoia says Sebastian. Well, nothing compared to list pointer consistency checks.
+	parameters.bboxMin[0] = bbox.Left();
+	parameters.bboxMin[1] = bbox.Bottom();
+	parameters.bboxMin[2] = bbox.Back();
+	parameters.bboxMax[0] = bbox.Right();
+	parameters.bboxMax[1] = bbox.Top();
+	parameters.bboxMax[2] = bbox.Front();
+}
+
+
+/**
+ * mmvis_static::StructureEventsCalculation::logPipelineMessage
+ */
+void mmvis_static::StructureEventsCalculation::logPipelineMessage(const StructureEventsPipeline::LogLevel level, const std::string& message) {
+	switch (level) {
+	case StructureEventsPipeline::LOG_ERROR:
+		vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_ERROR, "%s", message.c_str());
+		break;
+	case StructureEventsPipeline::LOG_WARN:
+		vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_WARN, "%s", message.c_str());
+		break;
+	default:
+		vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_INFO, "%s", message.c_str());
+		break;
+	}
+
+	if (level != StructureEventsPipeline::LOG_INFO && this->settings.quantitativeDataOutput) {
+		this->debugFile
+			<< message
+			<< " " << this->timeOutputCache
+			<< "\n";
+	}
+}
+
+
+void mmvis_static::StructureEventsCalculation::buildParticleList(megamol::core::moldyn::MultiParticleDataCall& data,
+	uint64_t& globalParticleIndex, float& globalRadius, uint8_t(&globalColor)[4], float& globalColorIndexMin, float& globalColorIndexMax) {
+	using megamol::core::moldyn::MultiParticleDataCall;
 
 	///
-	/// Log output.
+	/// Current lists become the previous ones.
+	///
+	this->pipeline.BeginFrame(this->frameId);
+
+	///
+	/// Count particles to determine list sizes.
 	///
-	{ // Time measurement depends heavily on maxNeighbours and sqrRadius (when using annkFRSearch) as well as on save method in particleList.
-		auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now() - time_findNeighbours);
-		vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_INFO,
-			"SECalc step 1: Neighbours set in %lld ms with %d added and %d out of FRSearch radius.\n", duration.count(), debugAddedNeighbours, debugSkippedNeighbours);
 
-		if (this->quantitativeDataOutputSlot.Param<param::BoolParam>()->Value()) {
-			this->logFile << ", added " << debugAddedNeighbours << " neighbours with " << debugSkippedNeighbours << " particles out of FRSearch radius (" << duration.count() << " ms)\n";
-			this->csvLogFile << duration.count() << "; "; // Neighbours (ms)
+	size_t globalParticleCnt = 0;
+	unsigned int plc = data.GetParticleListCount();
+	for (unsigned int pli = 0; pli < plc; pli++) {
+		auto& pl = data.AccessParticles(pli);
+		if (pl.GetColourDataType() != MultiParticleDataCall::Particles::COLDATA_FLOAT_I)
+			continue;
+		if ((pl.GetVertexDataType() != MultiParticleDataCall::Particles::VERTDATA_FLOAT_XYZ)
+			&& (pl.GetVertexDataType() != MultiParticleDataCall::Particles::VERTDATA_FLOAT_XYZR)) {
+			continue;
 		}
+		globalParticleCnt += static_cast<size_t>(pl.GetCount());
 	}
 
+	this->pipeline.particleList.reserve(globalParticleCnt);
+
 	///
-	/// Test.
+	/// Build list.
 	///
-	/*
-	uint64_t id = 1000;
-	if (this->particleList[id].neighbourIDs.size() > 0) {
-		//Particle nearestNeighbour = *this->particleList[id].neighbourPtrs[0];
-		Particle nearestNeighbour = this->particleList[this->particleList[id].neighbourIDs[0]];
+	for (unsigned int particleListIndex = 0; particleListIndex < data.GetParticleListCount(); ++particleListIndex) {
 
-		printf("Calculator: Particle %d at (%2f, %2f, %2f) nearest neighbour %d at (%2f, %2f, %2f).\n",
-			particleList[id].id, particleList[id].x, particleList[id].y, particleList[id].z,
-			nearestNeighbour.id, nearestNeighbour.x, nearestNeighbour.y, nearestNeighbour.z);
-	}
-	*/
+		///
+		/// Get meta information of data.
+		///
+
+		MultiParticleDataCall::Particles& particles = data.AccessParticles(particleListIndex);
+
+		// Check for existing data.
+		if (particles.GetCount() == 0) {
+			vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_WARN, "Particlelist %d skipped, no vertex data.", particleListIndex);
+			continue; // Skip this particle list.
+		}
+
+		// Check for correct vertex type.
+		if (particles.GetVertexDataType() != MultiParticleDataCall::Particles::VERTDATA_FLOAT_XYZ
+			&& particles.GetVertexDataType() != MultiParticleDataCall::Particles::VERTDATA_FLOAT_XYZR) {
+			vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_WARN, "Particlelist %d skipped, vertex are not floats.", particleListIndex);
+			continue; // Skip this particle list.
+		}
+
+		// Check for correct color type.
+		if (particles.GetColourDataType() != MultiParticleDataCall::Particles::COLDATA_FLOAT_I) {
+			vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_WARN, "Particlelist %d skipped, COLDATA_FLOAT_I expected.", particleListIndex);
+			continue; // Skip this particle list.
+		}
+
+		// Particlelist globals. Gets overwritten with each ParticleList. Doesn't matter here anyways.
+		globalRadius = particles.GetGlobalRadius();
+		::memcpy(globalColor, particles.GetGlobalColour(), 4);
+		globalColorIndexMin = particles.GetMinColourIndexValue();
+		globalColorIndexMax = particles.GetMaxColourIndexValue();
 
-	delete tree;
-	delete[] annPts;
-	delete[] annPtsData;
+		///
+		/// Vertex and signed distance (stored in the colour) spans for the pipeline.
+		///
+		StructureEventsPipeline::ParticleSpan span;
+		span.positions = particles.GetVertexData();
+		span.positionStride = particles.GetVertexDataStride();
+		span.hasRadius = particles.GetVertexDataType() == MultiParticleDataCall::Particles::VERTDATA_FLOAT_XYZR;
+		span.globalRadius = globalRadius;
+		span.signedDistances = particles.GetColourData();
+		span.signedDistanceStride = particles.GetColourDataStride();
+		span.count = particles.GetCount();
+		this->pipeline.AddParticles(span);
 
-	/// From ANN manual v1.1, page 8: http://www.cs.umd.edu/~mount/ANN/Files/1.1/ANNmanual_1.1.pdf
-	/// The library allocates a small amount of storage, which is shared by all search structures
-	///	built during the programs lifetime.Because the data is shared, it is not deallocated,
-	///	even when the all the individual structures are deleted.To avoid the resulting(minor) memory
-	///	leak, the following function can be called after all search structures have been destroyed.
-	annClose();
+		globalParticleIndex += static_cast<size_t>(particles.GetCount());
+	}
+	
+	///
+	/// Log output.
+	///
+	{// Time measurement. 4s
+		const long long duration = this->pipeline.GetStatistics().particleListDuration;
+		vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_INFO,
+			"SECalc step 1: Created particle list with %d elements in %lld ms.", this->pipeline.particleList.size(), duration);
+		
+		if (this->settings.quantitativeDataOutput) {
+			this->logFile
+				<< "Step 1 (build particleList, create kdTree and find neighbours):\n"
+				<< "  a) ParticleList with " << this->pipeline.particleList.size() << " particles (" << duration << " ms)\n";
+			this->metrics.Set(FrameMetrics::PARTICLES, static_cast<double>(this->pipeline.particleList.size()));
+			this->metrics.Set(FrameMetrics::PARTICLE_LIST_MS, static_cast<double>(duration));
+		}
+	}
 }
 
 
-void mmvis_static::StructureEventsCalculation::createClustersFastDepth() {
-	auto time_createCluster = std::chrono::system_clock::now();
+void mmvis_static::StructureEventsCalculation::findNeighboursWithKDTree(megamol::core::moldyn::MultiParticleDataCall& data) {
 
-	size_t debugNoNeighbourCounter = 0;
-	size_t debugUsedExistingClusterCounter = 0;
-	size_t debugNumberOfGasParticles = 0;
-	uint64_t progressControl = 1; // For avoiding duplicated progress control output. Initial value different from % 100000.
-	size_t progressControlCluster = 1; // For avoiding duplicated progress control output. Initial value different from % 100.
+	///
+	/// Get bounding box for periodic boundary condition.
+	///
+	const StructureEventsPipeline::Parameters parameters = this->getPipelineParameters(data);
+	this->pipeline.FindNeighbours(parameters);
+
+	///
+	/// Log output.
+	///
+	const StructureEventsPipeline::Statistics& statistics = this->pipeline.GetStatistics();
+
+	vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_INFO,
+		"SECalc step 1: Created kD-tree in %lld ms.", statistics.kdTreeDuration);
+	vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_INFO,
+		"SECalc step 1: Neighbours set in %lld ms with %d added and %d out of FRSearch radius.\n",
+		statistics.neighboursDuration, static_cast<int>(statistics.addedNeighbours), static_cast<int>(statistics.skippedNeighbours));
+
+	if (this->settings.quantitativeDataOutput) {
+		this->logFile
+			<< "  b) kD-tree (" << statistics.kdTreeDuration << " ms)\n"
+			<< "  c) Neighbours annkFRSearch with " << parameters.radiusMultiplier << "*radius and "
+			<< statistics.maxNeighbours << " max neighbours"
+			<< ", added " << statistics.addedNeighbours << " neighbours with " << statistics.skippedNeighbours
+			<< " particles out of FRSearch radius (" << statistics.neighboursDuration << " ms)\n";
+		this->metrics.Set(FrameMetrics::KDTREE_MS, static_cast<double>(statistics.kdTreeDuration));
+		this->metrics.Set(FrameMetrics::RADIUS_MULTIPLIER, parameters.radiusMultiplier);
+		this->metrics.Set(FrameMetrics::MAX_NEIGHBOURS, statistics.maxNeighbours);
+		this->metrics.Set(FrameMetrics::NEIGHBOURS_MS, static_cast<double>(statistics.neighboursDuration));
+	}
+}
 
-	int clusterID = 0;
+
+void mmvis_static::StructureEventsCalculation::createClustersFastDepth() {
 
 	// For testing Zero signed distance one size clusters phenomenon. Only seen at 5*radius, not at 4 yet.
-	std::ofstream testCFDCSVFile;
+	AsyncOutputFile testCFDCSVFile(this->outputQueue);
 
-	if (this->quantitativeDataOutputSlot.Param<param::BoolParam>()->Value()) {
-		vislib::StringA label(this->outputLabelSlot.Param<param::StringParam>()->Value());
+	if (this->settings.quantitativeDataOutput) {
+		vislib::StringA label(this->settings.outputLabel);
 		std::string filenameEnd;
 		if (!label.IsEmpty()) {
 			std::string labelStr = label;
@@ -1123,10 +1575,8 @@ void mmvis_static::StructureEventsCalculation::createClustersFastDepth() {
 		// CFD == Cluster Fast Depth
 		std::string filename = "SECalc ClusterFastDepth" + filenameEnd + ".csv";
 		testCFDCSVFile.open(filename.c_str(), std::ios_base::app | std::ios_base::out);
-		std::ifstream peekTest;
-		peekTest.open(filename.c_str());
 
-		if (peekTest.peek() == std::ifstream::traits_type::eof()) {
+		if (this->outputQueue.IsNewFile(filename)) {
 			testCFDCSVFile
 				<< "Label; "
 				<< "Time; "
@@ -1141,180 +1591,13 @@ void mmvis_static::StructureEventsCalculation::createClustersFastDepth() {
 				<< "PosZ; "
 				<< "\n";
 		}
-		peekTest.close();
 	}
 
-	///
-	/// Reallocation of clusterList (due to growth) makes pointer invalid. Either fix by:
-	/// 1) give clusterList big size, so list doesnt resize.
-	/// 2) change references to ids, clusterList mustn't be resorted but may be reallocated in memory.
-	/// 3) use id's in struct Cluster (+ vector may be resorted, - access very slow)
-	///
-	/// It has been fixed with method (1) (for speed) and method (2).
-	///
+	this->pipeline.CreateClustersFastDepth(this->getPipelineParameters());
 
-	// Avoid reallocation of clusterList, method (1) - though it's a waste of memory it saves time (no reallocation)!
-	if (this->radiusMultiplierSlot.Param<param::IntParam>()->Value() < 3)
-		this->clusterList.reserve(this->particleList.size() / 5); // Low radius multiplier will create a lot of clusters. Only important for test runs.
-	else
-		this->clusterList.reserve(this->particleList.size() / 20);
-
-	/// #pragma omp parallel for
-	/// Particle handling could be parallelized, if the traversed particles are not added to the cluster
-	/// and cluster creation/selection is thread safe. However the speedup might be negative!
-	// for (auto partIT = this->particleList.begin(); partIT < this->particleList.end(); ++partIT) {
-	//	auto particle = *partIT;
-	for (auto & particle : this->particleList) {
-		if (particle.signedDistance < 0) {
-			debugNumberOfGasParticles++; // Not usable with concurrency.
-			continue; // Skip gas.
-		}
-
-		//if (particle.neighbourPtrs.size() == 0) {
-		if (particle.neighbourIDs.size() == 0) {
-			debugNoNeighbourCounter++; // Not usable with concurrency.
-			continue; // Skip particles without neighbours.
-		}
-
-		//if (particle.clusterPtr)
-		if (particle.clusterID != -1)
-			continue; // Skip particles that already belong to a cluster.
-
-		///
-		/// Traverse the neighbours to find the deepest neighbour.
-		///
-		auto time_addParticlePath = std::chrono::system_clock::now();
-
-		// Container for deepest neighbours.
-		std::vector<uint64_t> parsedParticleIDs;
-
-		Particle deepestNeighbour = particle; // Initial condition.
-
-		for (;;) {
-			float signedDistance = 0; // For comparison of neighbours.
-			Particle currentParticle = deepestNeighbour; // Set last deepest particle as new current.
-
-			//for (int i = 0; i < currentParticle.neighbourPtrs.size(); ++i) {
-			//	if (currentParticle.neighbourPtrs[i]->signedDistance > signedDistance) {
-			//		signedDistance = currentParticle.neighbourPtrs[i]->signedDistance;
-			//		deepestNeighbour = *currentParticle.neighbourPtrs[i];
-			//	}
-			//}
-
-			// Get deepest neighbour.
-			for (int i = 0; i < currentParticle.neighbourIDs.size(); ++i) {
-				if (this->particleList[currentParticle.neighbourIDs[i]].signedDistance > signedDistance) {
-					signedDistance = this->particleList[currentParticle.neighbourIDs[i]].signedDistance;
-					deepestNeighbour = this->particleList[currentParticle.neighbourIDs[i]];
-				}
-			}
-
-			// Add current deepest neighbour to the list containing all the parsed particles.
-			parsedParticleIDs.push_back(deepestNeighbour.id);
-			
-			if (currentParticle.signedDistance >= deepestNeighbour.signedDistance) { // Current particle is local maximum.
-				//Debug printf("%f >= %f\n", currentParticle.signedDistance, deepestNeighbour.signedDistance); // Works.
-
-				// Find cluster in list.
-				uint64_t rootParticleID = currentParticle.id;
-				std::vector<Cluster>::iterator clusterListIterator = std::find_if(this->clusterList.begin(), this->clusterList.end(), [rootParticleID](const Cluster& c) -> bool {
-					return rootParticleID == c.rootParticleID;
-				});
-
-				Cluster* clusterPtr;
-				
-				//this->debugFile << "Particle " << particle.id; // Debugging black particles (clusterList got reallocated during creation).
-
-				// Create new cluster.
-				if (clusterListIterator == this->clusterList.end()) { // Iterator at the end of the list means std::find didnt find match.
-					Cluster cluster;
-					cluster.rootParticleID = currentParticle.id;
-					//cluster.id = static_cast<int> (this->clusterList.size());
-					cluster.id = clusterID; clusterID++; // Clearer than statement above.
-					this->clusterList.push_back(cluster);
-					clusterPtr = &clusterList.back();
-					// this->debugFile << " created cluster at "; // Debugging black particles (clusterList got reallocated during creation).
-				}
-				// Point to existing cluster. 
-				else {
-					debugUsedExistingClusterCounter++;
-					clusterPtr = &(*clusterListIterator); // Since iterator is never at v.end() here, it can be dereferenced.
-					//this->debugFile << " added to cluster at "; // Debugging black particles (clusterList got reallocated during creation).
-				}
-				
-				///
-				/// Add particle to cluster.
-				///
-				//particle.clusterPtr = clusterPtr;
-				particle.clusterID = clusterPtr->id;
-				(*clusterPtr).numberOfParticles++;
-
-				// Check for list ids consistency. Paranoia!
-				if (particle.clusterID != this->clusterList[particle.clusterID].id) {
-					vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_ERROR,
-						"SECalc step 2 (build): Cluster ID and position in cluster don't match: %d != %d!", particle.clusterID, this->clusterList[particle.clusterID].id);
-					this->debugFile
-						<< "SECalc step 2 (build) error: Cluster ID and position in cluster don't match: "
-						<< particle.clusterID << " != " << this->clusterList[particle.clusterID].id << "!"
-						<< " " << this->timeOutputCache
-						<< "\n";
-				}
-
-				///
-				/// Add the deepest neighbours found within the traversion to the cluster.
-				/// Exceptions:
-				/// - those that are already in a cluster
-				/// - the last neighbour since it was added just to check
-				///   if the current particle is the deepest particle.
-				///
-				parsedParticleIDs.pop_back(); // Remove last deepest neighbour since it is not deeper than current particle.
-				for (auto & particleID : parsedParticleIDs) {
-					
-					// Check for list ids consistency. Paranoia!
-					if (this->particleList[particleID].id != particleID) {
-						vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_ERROR,
-							"SECalc step 2 (build): Particle ID and position in particle list don't match: %d != %d!", particleID, this->particleList[particleID].id);
-						this->debugFile
-							<< "SECalc step 2 (build) error: Particle ID and position in particle list don't match: "
-							<< particleID << " != " << this->particleList[particleID].id << "!"
-							<< " " << this->timeOutputCache
-							<< "\n";
-					}
-
-					if (this->particleList[particleID].clusterID >= 0)
-						continue; // Skip particles already in a cluster.
-
-					//this->particleList[particleID].clusterPtr = clusterPtr;
-					this->particleList[particleID].clusterID = clusterPtr->id; // Requires untouched (i.e. sorting forbidden) particleList!
-					(*clusterPtr).numberOfParticles++; // Caused a bug since particles that are already part of the cluster are added again. Checks above avoid this now.
-				}
-				
-				//this->debugFile << clusterPtr << " with root " << (*clusterPtr).rootParticleID << ", parsed particles " << parsedParticleIDs.size() << " , number of particles " << (*clusterPtr).numberOfParticles << ".\n"; // Debugging black particles (clusterList got reallocated during creation).
-
-				// Progress, to not loose patience. To track creation of a lot of clusters.
-				if (this->clusterList.size() % 1000 == 0)
-					if (this->clusterList.size() != progressControlCluster) {
-						progressControlCluster = this->clusterList.size();
-						vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_INFO,
-							"SECalc step 2 progress: Amount of clusters %d. Particle %d. Liquid particles w/o neighbours %d.", this->clusterList.size(), particle.id, debugNoNeighbourCounter);
-					}
-
-				// Progress, to not loose patience when waiting for results.
-				if (particle.id % 100000 == 0) {
-					if (particle.id != progressControl) {
-						progressControl = particle.id;
-						auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now() - time_addParticlePath);
-						auto durTotal = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now() - time_createCluster);
-						vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_INFO,
-							"SECalc step 2 progress: Cluster for p %d (%lld ms, total %lld ms), pathlength %d.\nCluster elements: %d. Total number of clusters: %d.",
-							particle.id, duration.count(), durTotal.count(), parsedParticleIDs.size(), (*clusterPtr).numberOfParticles, this->clusterList.size());
-					}
-				}
-				break;
-			}
-			//printf("Particle %d with deepest neighbour %d.\n", currentParticle.id, deepestNeighbour.id); // Debug.
-		}
-	}
+	const std::vector<Particle>& particleList = this->pipeline.particleList;
+	const std::vector<Cluster>& clusterList = this->pipeline.clusterList;
+	const StructureEventsPipeline::Statistics& statistics = this->pipeline.GetStatistics();
 	
 	///
 	/// Log output.
@@ -1323,16 +1606,16 @@ void mmvis_static::StructureEventsCalculation::createClustersFastDepth() {
 		
 		// Min/Max Clusters.
 		const uint64_t minCluster = std::min_element(
-			this->clusterList.begin(), this->clusterList.end(), [](const Cluster& lhs, const Cluster& rhs) {
+			clusterList.begin(), clusterList.end(), [](const Cluster& lhs, const Cluster& rhs) {
 			return lhs.numberOfParticles < rhs.numberOfParticles;
 		})->numberOfParticles;
 		const uint64_t maxCluster = std::max_element(
-			this->clusterList.begin(), this->clusterList.end(), [](const Cluster& lhs, const Cluster& rhs) {
+			clusterList.begin(), clusterList.end(), [](const Cluster& lhs, const Cluster& rhs) {
 			return lhs.numberOfParticles < rhs.numberOfParticles;
 		})->numberOfParticles;
 
 		// Time measurement.
-		const auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now() - time_createCluster);
+		const long long duration = statistics.fastDepthDuration;
 
 		///
 		/// Debug values.
@@ -1341,73 +1624,106 @@ void mmvis_static::StructureEventsCalculation::createClustersFastDepth() {
 		int debugParticleInClustersNumber = 0;
 		int debugSizeOneClusters = 0; // For testing MergeClusters produces adjacent gas particle clusters theory.
 		int debugMinSizeClusters = 0; // For testing MergeClusters produces adjacent gas particle clusters theory.
-		const bool skipCFDOutput = this->clusterList.size() > 50000 ? true : false; // Output takes forever with thousands of clusters and particles.
 
-		if (this->quantitativeDataOutputSlot.Param<param::BoolParam>()->Value()) {
-			vislib::StringA label(this->outputLabelSlot.Param<param::StringParam>()->Value());
+		if (this->settings.quantitativeDataOutput) {
+			vislib::StringA label(this->settings.outputLabel);
+			const int minClusterSize = this->settings.parameters.minClusterSize;
 
-			for (auto & cluster : this->clusterList) {
+			// Clusters smaller clusterMinSize, bucket index per cluster id.
+			std::vector<int> clusterBuckets;
+			std::vector<const Cluster*> smallClusters;
+			for (auto & cluster : clusterList) {
 				// Particles in clusters.
 				debugParticleInClustersNumber += static_cast<int>(cluster.numberOfParticles);
 
 				// Clusters smaller clusterMinSize. E.g. for testing Zero signed distance one size clusters phenomenon.
-				if (cluster.numberOfParticles < this->minClusterSizeSlot.Param<param::IntParam>()->Value()) {
+				if (cluster.numberOfParticles < minClusterSize) {
 					
 					// For log.
 					debugMinSizeClusters++;
 					if (cluster.numberOfParticles == 1)
 						debugSizeOneClusters++;
-					
-					if (!skipCFDOutput) {
-						// For testing Single Zero Signed Distance Clusters theory.
-						for (auto & particle : this->particleList) {
-							if (particle.clusterID == cluster.id) {
-								testCFDCSVFile
-									<< label.PeekBuffer() << "; "
-									<< this->timeOutputCache << "; "
-									<< this->frameId << "; "
-									<< cluster.id << "; "
-									<< cluster.numberOfParticles << "; "
-									<< particle.id << "; "
-									<< particle.signedDistance << "; "
-									<< particle.neighbourIDs.size() << "; "
-									<< particle.x << "; "
-									<< particle.y << "; "
-									<< particle.z << "\n";
-							}
-						}
-					}
+
+					if (cluster.id >= static_cast<int>(clusterBuckets.size()))
+						clusterBuckets.resize(cluster.id + 1, -1);
+					clusterBuckets[cluster.id] = static_cast<int>(smallClusters.size());
+					smallClusters.push_back(&cluster);
+				}
+			}
+
+			///
+			/// Groups the particles of the small clusters in one pass over the particle list
+			/// (counting sort), instead of one pass per cluster. Particles keep their order.
+			///
+			const int clusterBucketAmount = static_cast<int>(clusterBuckets.size());
+			std::vector<int> particleBuckets(particleList.size());
+			TaskPool::GetDefault()->ParallelFor(0, particleList.size(), 16384, [&](size_t begin, size_t end, unsigned int) {
+				for (size_t i = begin; i < end; ++i) {
+					const int clusterID = particleList[i].clusterID;
+					particleBuckets[i] = (clusterID >= 0 && clusterID < clusterBucketAmount) ? clusterBuckets[clusterID] : -1;
+				}
+			});
+
+			std::vector<size_t> bucketBegins(smallClusters.size() + 1, 0);
+			for (const int bucket : particleBuckets) {
+				if (bucket >= 0)
+					bucketBegins[bucket + 1]++;
+			}
+			std::partial_sum(bucketBegins.begin(), bucketBegins.end(), bucketBegins.begin());
+			std::vector<size_t> bucketParticles(bucketBegins.back());
+			std::vector<size_t> bucketEnds(bucketBegins.begin(), bucketBegins.end() - 1);
+			for (size_t i = 0; i < particleBuckets.size(); ++i) {
+				if (particleBuckets[i] >= 0)
+					bucketParticles[bucketEnds[particleBuckets[i]]++] = i;
+			}
+
+			// For testing Single Zero Signed Distance Clusters theory.
+			for (size_t bucket = 0; bucket < smallClusters.size(); ++bucket) {
+				const Cluster& cluster = *smallClusters[bucket];
+				for (size_t bpi = bucketBegins[bucket]; bpi < bucketBegins[bucket + 1]; ++bpi) {
+					const Particle& particle = particleList[bucketParticles[bpi]];
+					testCFDCSVFile
+						<< label.PeekBuffer() << "; "
+						<< this->timeOutputCache << "; "
+						<< this->frameId << "; "
+						<< cluster.id << "; "
+						<< cluster.numberOfParticles << "; "
+						<< particle.id << "; "
+						<< particle.signedDistance << "; "
+						<< particle.neighbourIDs.size() << "; "
+						<< particle.x << "; "
+						<< particle.y << "; "
+						<< particle.z << "\n";
 				}
 			}
 
 			// Check cluster creation.
-			assert(debugParticleInClustersNumber + debugNumberOfGasParticles + debugNoNeighbourCounter == particleList.size());
+			assert(debugParticleInClustersNumber + statistics.gasParticles + statistics.noNeighbourParticles == particleList.size());
 		}
 		
 		vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_INFO,
 			"SECalc Step 2: %d (%d/%d) clusters created in %lld ms. %d particles used existing clusters.\nDebug: %d liquid particles w/o neighbour, %d size one clusters.",
-			this->clusterList.size(), minCluster, maxCluster, duration.count(), debugUsedExistingClusterCounter, debugNoNeighbourCounter, debugSizeOneClusters);
+			clusterList.size(), minCluster, maxCluster, duration, statistics.usedExistingClusterParticles, statistics.noNeighbourParticles, debugSizeOneClusters);
 
-		if (this->quantitativeDataOutputSlot.Param<param::BoolParam>()->Value()) {
+		if (this->settings.quantitativeDataOutput) {
 			this->logFile
 				<< "Step 2 (create and merge clusters):\n"
-				<< "  a) " << this->clusterList.size() << " clusters created with min/max sizes " << minCluster << "/" << maxCluster
-				<< " and particles in gas/cluster " << debugNumberOfGasParticles << "/" << debugParticleInClustersNumber << " (" << duration.count() << " ms)\n"
+				<< "  a) " << clusterList.size() << " clusters created with min/max sizes " << minCluster << "/" << maxCluster
+				<< " and particles in gas/cluster " << statistics.gasParticles << "/" << debugParticleInClustersNumber << " (" << duration << " ms)\n"
 				<< "     while "
-				<< debugUsedExistingClusterCounter << " particles used existing clusters"
-				<< " (debug: " << debugNoNeighbourCounter << " liquid particles w/o neighbours"
+				<< statistics.usedExistingClusterParticles << " particles used existing clusters"
+				<< " (debug: " << statistics.noNeighbourParticles << " liquid particles w/o neighbours"
 				<< ", " << debugSizeOneClusters << " size one clusters"
 				<< ", " << debugMinSizeClusters << " min size clusters)"
 				<< "\n";
-			this->csvLogFile
-				<< this->clusterList.size() << "; " // Clusters (#)
-				<< minCluster << "; " // MinCluster (#particles)
-				<< maxCluster << "; " // MaxCluster (#particles)
-				<< debugSizeOneClusters << "; " // SizeOneClusters for Fast Depth debug (#clusters)
-				<< debugMinSizeClusters << "; " // MinSizeClusters for Fast Depth debug (#clusters)
-				<< debugParticleInClustersNumber << "; " // Particles in clusters (#)
-				<< debugNumberOfGasParticles << "; " // Particles in gas (#)
-				<< duration.count() << "; "; // Fast Depth (ms)
+			this->metrics.Set(FrameMetrics::CLUSTERS, static_cast<double>(clusterList.size()));
+			this->metrics.Set(FrameMetrics::MIN_CLUSTER, static_cast<double>(minCluster));
+			this->metrics.Set(FrameMetrics::MAX_CLUSTER, static_cast<double>(maxCluster));
+			this->metrics.Set(FrameMetrics::FAST_DEPTH_SIZE_ONE_CLUSTERS, static_cast<double>(debugSizeOneClusters));
+			this->metrics.Set(FrameMetrics::FAST_DEPTH_MIN_SIZE_CLUSTERS, static_cast<double>(debugMinSizeClusters));
+			this->metrics.Set(FrameMetrics::PARTICLES_IN_CLUSTERS, static_cast<double>(debugParticleInClustersNumber));
+			this->metrics.Set(FrameMetrics::PARTICLES_IN_GAS, static_cast<double>(statistics.gasParticles));
+			this->metrics.Set(FrameMetrics::FAST_DEPTH_MS, static_cast<double>(duration));
 
 			testCFDCSVFile.close();
 		}
@@ -1416,231 +1732,7 @@ void mmvis_static::StructureEventsCalculation::createClustersFastDepth() {
 
 
 void mmvis_static::StructureEventsCalculation::mergeSmallClusters() {
-	auto time_mergeClusters = std::chrono::system_clock::now();
-
-	int mergedParticles = 0;
-
-	#pragma omp parallel for
-	for (int i = 0; i < this->particleList.size(); ++i) {
-		Particle particle = this->particleList[i];
-	//for (auto particle : this->particleList) {
-		if (particle.signedDistance < 0)
-			continue; // Skip gas.
-
-		//if (particle.neighbourPtrs.size() == 0)
-		if (particle.neighbourIDs.size() == 0)
-			continue; // Skip particles without neighbours.
-
-		//if (!particle.clusterPtr)
-		if (particle.clusterID == -1)
-			continue; // Skip particles w/o pointers, mandatory for test runs.
-
-		// Check for list ids consistency. Paranoia!
-		if (particle.clusterID != this->clusterList[particle.clusterID].id) {
-			vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_ERROR,
-				"SECalc step 2 (merge): Cluster ID and position in cluster don't match: %d != %d!", particle.clusterID, this->clusterList[particle.clusterID].id);
-			this->debugFile
-				<< "SECalc step 2 (merge) Error: Cluster ID and position in cluster don't match: "
-				<< particle.clusterID << " != " << this->clusterList[particle.clusterID].id << "!"
-				<< " " << this->timeOutputCache
-				<< "\n";
-		}
-		if (this->clusterList[particle.clusterID].rootParticleID != this->particleList[this->clusterList[particle.clusterID].rootParticleID].id) {
-			vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_ERROR,
-				"SECalc step 2 (merge): Root particle ID and position in particle list don't match: %d != %d!",
-				this->clusterList[particle.clusterID].rootParticleID, this->particleList[this->clusterList[particle.clusterID].rootParticleID].id);
-			this->debugFile
-				<< "SECalc step 2 (merge) error: Root particle ID and position in particleList don't match: "
-				<< this->clusterList[particle.clusterID].rootParticleID << " != " << this->particleList[this->clusterList[particle.clusterID].rootParticleID].id << "!"
-				<< " " << this->timeOutputCache
-				<< "\n";
-		}
-
-		//if (particle.clusterPtr->numberOfParticles >= this->minClusterSize)
-		if (this->clusterList[particle.clusterID].numberOfParticles >= this->minClusterSizeSlot.Param<param::IntParam>()->Value()) // Requires untouched (i.e. sorting forbidden) clusterList!
-			continue; // Skip particles of bigger clusters.
-
-		///
-		/// Add clusters in neighbourhood which are bigger than this->minClusterSize.
-		///
-
-		//std::mutex neighbourClusterIDs_mutex; // Mutex for thread safety w/o OpenMP.
-
-		std::vector<int> neighbourClusterIDs;
-
-		//#pragma omp parallel for
-		//for (int i = 0; i < particle.neighbourIDs.size(); ++i) {
-		//	Particle* neighbour = &this->particleList[particle.neighbourIDs[i]];
-		//for (auto neighbour : particle.neighbourPtrs) {
-		for (auto neighbourID : particle.neighbourIDs) {
-			Particle* neighbour = &this->particleList[neighbourID];
-
-			//if (!neighbour->clusterPtr)
-			if (neighbour->clusterID == -1)
-				continue; // Skip particles w/o pointers, mandatory for test runs.
-
-			//if (neighbour->clusterPtr->rootParticleID != particle.clusterPtr->rootParticleID
-			//	&& neighbour->clusterPtr->numberOfParticles >= this->minClusterSize)
-			//	neighbourClusters.push_back(neighbour->clusterPtr);
-			if (this->clusterList[neighbour->clusterID].rootParticleID != this->clusterList[particle.clusterID].rootParticleID
-				&& this->clusterList[neighbour->clusterID].numberOfParticles >= this->minClusterSizeSlot.Param<param::IntParam>()->Value()) {
-				//neighbourClusters.push_back(&this->clusterList[neighbour->clusterID]);
-				//std::lock_guard<std::mutex> lk(neighbourClusterIDs_mutex); // Mutex for thread safety of push_back w/o OpenMP.
-				//#pragma omp critical // Mutex for thread safety of push_back. Inefficient.
-				neighbourClusterIDs.push_back(this->clusterList[neighbour->clusterID].id); // Not thread safe!
-			}
-		}
-
-		///
-		/// 2nd level.
-		/// If no clusters in range, check neighbours of neighbours.
-		///
-		if (neighbourClusterIDs.size() == 0) {
-
-			//#pragma omp parallel for
-			for (int i = 0; i < particle.neighbourIDs.size(); ++i) {
-				Particle* neighbour = &this->particleList[particle.neighbourIDs[i]];
-			//for (auto neighbourIT = particle.neighbourIDs.begin(); neighbourIT < particle.neighbourIDs.end(); ++neighbourIT) {
-			//	Particle* neighbour = &this->particleList[*neighbourIT];
-			//for (auto neighbourID : particle.neighbourIDs) {
-			//	Particle* neighbour = &this->particleList[neighbourID];
-
-				// Check neighbours of neighbours.
-				//for (auto secondaryNeighbour : neighbour->neighbourPtrs) {
-				for (auto secondaryNeighbourID : neighbour->neighbourIDs) {
-					Particle* secondaryNeighbour = &this->particleList[secondaryNeighbourID];
-
-					//if (!secondaryNeighbour->clusterPtr)
-					if (secondaryNeighbour->clusterID == -1)
-						continue; // Skip particles w/o pointers, mandatory for test runs.
-
-					//if (secondaryNeighbour->clusterPtr->rootParticleID != particle.clusterPtr->rootParticleID
-					//	&& secondaryNeighbour->clusterPtr->numberOfParticles >= this->minClusterSize)
-					//	neighbourClusters.push_back(secondaryNeighbour->clusterPtr);
-					if (this->clusterList[secondaryNeighbour->clusterID].rootParticleID != this->clusterList[particle.clusterID].rootParticleID
-						&& this->clusterList[secondaryNeighbour->clusterID].numberOfParticles >= this->minClusterSizeSlot.Param<param::IntParam>()->Value()) {
-						//#pragma omp critical // Mutex for thread safety of push_back. Inefficient.
-						neighbourClusterIDs.push_back(this->clusterList[secondaryNeighbour->clusterID].id); // Not thread safe!
-					}
-				}
-			}
-		}
-
-		///
-		/// 3rd level.
-		/// If no clusters in range, check neighbours of neighbour neighbours.
-		///
-		if (neighbourClusterIDs.size() == 0) {
-			//#pragma omp parallel for
-			for (int i = 0; i < particle.neighbourIDs.size(); ++i) {
-				Particle* neighbour = &this->particleList[particle.neighbourIDs[i]];
-			//for (auto neighbourIT = particle.neighbourIDs.begin(); neighbourIT < particle.neighbourIDs.end(); ++neighbourIT) {
-			//	Particle* neighbour = &this->particleList[*neighbourIT];
-
-				for (auto secondaryNeighbourID : neighbour->neighbourIDs) {
-					Particle* secondaryNeighbour = &this->particleList[secondaryNeighbourID];
-
-					// Check neighbours of neighbours neighbour.
-					for (auto tertiaryNeighbourID : secondaryNeighbour->neighbourIDs) {
-						Particle* tertiaryNeighbour = &this->particleList[tertiaryNeighbourID];
-
-						if (tertiaryNeighbour->clusterID == -1)
-							continue; // Skip particles w/o pointers, mandatory for test runs.
-
-						if (this->clusterList[tertiaryNeighbour->clusterID].rootParticleID != this->clusterList[particle.clusterID].rootParticleID
-							&& this->clusterList[tertiaryNeighbour->clusterID].numberOfParticles >= this->minClusterSizeSlot.Param<param::IntParam>()->Value()) {
-							//#pragma omp critical // Mutex for thread safety of push_back. Inefficient.
-							neighbourClusterIDs.push_back(this->clusterList[tertiaryNeighbour->clusterID].id); // Not thread safe!
-						}
-					}
-				}
-			}
-		}
-
-		// If still no other clusters are in range it is assumed there are no connected other clusters, so this particle stays in the small cluster.
-		if (neighbourClusterIDs.size() == 0)
-			continue;
-
-		///
-		/// Determine new cluster.
-		///
-		
-		//this->debugFile << "Angle: ";
-
-		int newClusterID;
-		double M_PI = 3.14159265358979323846;
-		double smallestAngle = 2*M_PI;
-
-		// Direction of particle to its root.
-		Particle particleClusterRoot = this->particleList[this->clusterList[particle.clusterID].rootParticleID];  // Requires untouched (i.e. sorting forbidden) clusterList and particleList!
-		vislib::math::Vector<float, 3> dirParticle;
-		dirParticle.SetX(particle.x - particleClusterRoot.x);
-		dirParticle.SetY(particle.y - particleClusterRoot.y);
-		dirParticle.SetZ(particle.z - particleClusterRoot.z);
-
-		//std::vector<double> neighbourClustersAngle; // See below why deactivated.
-		//neighbourClustersAngle.resize(neighbourClusterIDs.size());
-
-		// Direction of particle to its neighbour clusters roots.
-		#pragma omp parallel for
-		for (int ncid = 0; ncid < neighbourClusterIDs.size(); ++ncid) {
-			int clusterID = neighbourClusterIDs[ncid];
-		//for (auto clusterID : neighbourClusterIDs) {
-			Particle clusterRoot = this->particleList[this->clusterList[clusterID].rootParticleID]; // Requires untouched (i.e. sorting forbidden) clusterList and particleList!
-			vislib::math::Vector<float, 3> dirNeighbourCluster;
-			dirNeighbourCluster.SetX(particle.x - clusterRoot.x);
-			dirNeighbourCluster.SetY(particle.y - clusterRoot.y);
-			dirNeighbourCluster.SetZ(particle.z - clusterRoot.z);
-
-			// Get angle.
-			double angle = dirParticle.Angle(dirNeighbourCluster);
-
-			if (angle > M_PI)
-				angle -= 2 * M_PI;
-
-			//neighbourClustersAngle[ncid] = angle; // See below why deactivated.
-
-			// Smallest angle. Doing this comparison outside of this for loop
-			// may accelerate concurrency by avoiding mutex? Nope it does not,
-			// so it stays here.
-			#pragma omp critical // Mutex for thread safety. 
-			{
-				if (angle < smallestAngle) {
-					newClusterID = clusterID;
-					smallestAngle = angle;
-				}
-			}
-			//this->debugFile << angle << ", ";
-		}
-
-		//this->debugFile << "\nSmallest Angle: " << smallestAngle << ".\n";
-
-		// Find smallest angle. Not faster than inside the angle for loop!
-		//for (int ncid = 0; ncid < neighbourClusterIDs.size(); ++ncid) {
-		//	int clusterID = neighbourClusterIDs[ncid];
-		//	double angle = neighbourClustersAngle[ncid];
-		//	if (angle < smallestAngle) {
-		//		newClusterID = clusterID;
-		//		smallestAngle = angle;
-		//	}
-		//}
-
-		// Eventually set new cluster.
-		this->clusterList[particle.clusterID].numberOfParticles--; // Remove particle from old cluster.
-		particle.clusterID = newClusterID;
-		this->clusterList[particle.clusterID].numberOfParticles++; // Add particle to new cluster.
-
-		#pragma omp critical // Mutex for thread safety. 
-		mergedParticles++;
-	}
-
-
-	///
-	/// No deletion of clusters here to not destroy
-	/// referencing by vector indices. Instead zero size
-	/// particle clusters should be ignored by the
-	/// compareCluster function.
-	///
+	this->pipeline.MergeSmallClusters(this->getPipelineParameters());
 
 	///
 	/// Log output.
@@ -1649,8 +1741,8 @@ void mmvis_static::StructureEventsCalculation::mergeSmallClusters() {
 	int removedClusters = 0; // Count removed clusters.
 	int debugSizeOneClusters = 0; // For testing MergeClusters produces adjacent gas particle clusters theory.
 	int debugMinSizeClusters = 0; // For testing MergeClusters produces adjacent gas particle clusters theory.
-	for (auto & cluster : this->clusterList) {
-		if (cluster.numberOfParticles < this->minClusterSizeSlot.Param<param::IntParam>()->Value()) {
+	for (auto & cluster : this->pipeline.clusterList) {
+		if (cluster.numberOfParticles < this->settings.parameters.minClusterSize) {
 			if (cluster.numberOfParticles == 0) {
 				removedClusters++;
 				continue;
@@ -1663,305 +1755,221 @@ void mmvis_static::StructureEventsCalculation::mergeSmallClusters() {
 
 
 	{ // Time measurement.
-		auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now() - time_mergeClusters);
+		const long long duration = this->pipeline.GetStatistics().mergeDuration;
+		const int mergedParticles = this->pipeline.GetStatistics().mergedParticles;
 		vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_INFO,
 			"SECalc Step 2: %d particles merged and %d clusters removed with min cluster size of %d particles (%lld ms).",
-			mergedParticles, removedClusters, this->minClusterSizeSlot.Param<param::IntParam>()->Value(), duration.count());
+			mergedParticles, removedClusters, this->settings.parameters.minClusterSize, duration);
 
-		if (this->quantitativeDataOutputSlot.Param<param::BoolParam>()->Value()) {
+		if (this->settings.quantitativeDataOutput) {
 			this->logFile
 				<< "  b) " << mergedParticles << " particles merged and "
 				<< removedClusters << " clusters removed with "
-				<< "min cluster size of " << this->minClusterSizeSlot.Param<param::IntParam>()->Value() << " particles (" << duration.count() << " ms)"
+				<< "min cluster size of " << this->settings.parameters.minClusterSize << " particles (" << duration << " ms)"
 				<< "\n"
 				<< "     (debug: "
 				<< debugSizeOneClusters << " size one clusters, "
 				<< debugMinSizeClusters << " min size clusters)"
 				<< "\n";
-			this->csvLogFile
-				<< this->minClusterSizeSlot.Param<param::IntParam>()->Value() << "; " // Minimum cluster limit (particles)
-				<< mergedParticles << "; " // Particles merged (#)
-				<< removedClusters << "; " // Clusters removed (#)
-				<< debugSizeOneClusters << "; " // SizeOneClusters for Merge Clusters debug [#clusters]
-				<< debugMinSizeClusters << "; " // MinSizeClusters for Merge Clusters debug [#clusters]
-				<< duration.count() << "; "; // Merge Clusters (ms)
-		}
-	}
-
-	///
-	/// Method 1: Search for nearest cluster (= root particle)
-	/// Bad since connected components would be needed to see if cluster is adjacent.
-	/// 
-	/*
-	int rootParticleIndex = 0;
-	ANNpoint rootPts = new ANNcoord[3 * this->clusterList.size()]; // Bigger than needed.
-	
-	std::vector<Cluster> minClusters;
-	minClusters.reserve(this->clusterList.size()); // Bigger than needed to avoid reallocation.
-
-	for (auto cluster : this->clusterList) {
-		if (cluster.numberOfParticles < this->minClusterSize) {
-			minClusters.push_back(cluster);
-			continue;
+			this->metrics.Set(FrameMetrics::MIN_CLUSTER_SIZE, this->settings.parameters.minClusterSize);
+			this->metrics.Set(FrameMetrics::PARTICLES_MERGED, static_cast<double>(mergedParticles));
+			this->metrics.Set(FrameMetrics::CLUSTERS_REMOVED, static_cast<double>(removedClusters));
+			this->metrics.Set(FrameMetrics::MERGE_SIZE_ONE_CLUSTERS, static_cast<double>(debugSizeOneClusters));
+			this->metrics.Set(FrameMetrics::MERGE_MIN_SIZE_CLUSTERS, static_cast<double>(debugMinSizeClusters));
+			this->metrics.Set(FrameMetrics::MERGE_CLUSTERS_MS, static_cast<double>(duration));
 		}
-
-		// Add root particles of remaining clusters to ptsList for kdTree.
-		Particle root = this->particleList[cluster.rootParticleID]; // Requires untouched (i.e. sorting forbidden) particleList!
-		rootPts[rootParticleIndex * 3 + 0] = static_cast<ANNcoord>(root.x);
-		rootPts[rootParticleIndex * 3 + 1] = static_cast<ANNcoord>(root.y);
-		rootPts[rootParticleIndex * 3 + 2] = static_cast<ANNcoord>(root.z);
 	}
-
-	// Build kdTree with root particles from remaining clusters.
-	ANNpointArray rootPtsArray = new ANNpoint[rootParticleIndex];
-	for (size_t i = 0; i < rootParticleIndex; ++i) {
-		rootPtsArray[i] = rootPts + (i * 3);
-	}
-	ANNkd_tree* tree = new ANNkd_tree(rootPtsArray, static_cast<int>(rootParticleIndex), 3);
-
-	// Get nearest and connected remaining cluster for minCluster with kdTree.
-	for (auto cluster : minClusters) {
-		int maxNeighbours = 5;
-
-		Particle root = this->particleList[cluster.rootParticleID]; // Requires untouched (i.e. sorting forbidden) particleList!
-
-		ANNpoint q = new ANNcoord[3];
-		q[0] = static_cast<ANNcoord>(root.x);
-		q[1] = static_cast<ANNcoord>(root.y);
-		q[2] = static_cast<ANNcoord>(root.z);
-
-		ANNidxArray   nn_idx = 0;
-		ANNdistArray  dd = 0;
-
-		nn_idx = new ANNidx[maxNeighbours];
-		dd = new ANNdist[maxNeighbours];
-
-		tree->annkSearch(
-			q,				// the query point
-			maxNeighbours,	// number of neighbors to return
-			nn_idx,			// nearest neighbor array (modified)
-			dd				// dist to near neighbors as squared distance (modified)
-			);				// error bound (optional).
-
-		for (size_t i = 0; i < maxNeighbours; ++i) {
-			if (nn_idx[i] == ANN_NULL_IDX) {
-				continue;
-			}
-			if (dd[i] < 0.001f) // Exclude self to catch ANN_ALLOW_SELF_MATCH = true.
-				continue;
-
-			// Check connected component.
-			if (connected) {
-				// Merge clusters by altering particle pointers.
-				break;
-			}
-		}
-
-	}
-	*/
 }
 
 
-void mmvis_static::StructureEventsCalculation::compareClusters() {
+bool mmvis_static::StructureEventsCalculation::loadClusterCache() {
+	if (this->settings.clusterCacheMode != 2 || !this->openClusterCache())
+		return false;
 
-	if (this->previousClusterList.size() == 0 || this->previousParticleList.size() == 0) {
-		if (this->quantitativeDataOutputSlot.Param<param::BoolParam>()->Value()) {
-			this->debugFile
-				<< "SECCalc step 3: No previous data, quit cluster comparison."
-				<< " " << this->timeOutputCache
-				<< "\n";
-		}
+	const ClusterCacheFile::Settings settings = this->getClusterCacheSettings();
+	if (!(this->clusterCache.GetSettings() == settings)) {
 		vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_WARN,
-			"SECCalc step 3: No previous data, quit cluster comparison.");
-		return;
+			"SECalc cluster cache: Settings of the MMSC file differ, clusters are calculated.");
+		return false;
+	}
+	if (this->clusterCache.GetParticleCount(this->frameId) != this->pipeline.particleList.size()) {
+		vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_WARN,
+			"SECalc cluster cache: Frame %d is not in the MMSC file, clusters are calculated.", this->frameId);
+		return false;
 	}
 
-	///
-	/// Copy lists and clear the old ones.
-	/// Copy is made for the future:
-	/// Comparison of several frames won't be implemented during the BA thesis.
-	///
-	if (this->partnerClustersList.forwardList.size() > 0) {
-		//this->previousPartnerClustersList.forwardList = this->partnerClustersList.forwardList;
-		this->partnerClustersList.forwardList.clear(); // Don't forget!
+	auto time_loadClusters = std::chrono::system_clock::now();
+
+	std::vector<int> clusterIDs;
+	std::vector<ClusterCacheFile::ClusterEntry> clusters;
+	if (!this->clusterCache.ReadFrame(this->frameId, clusterIDs, clusters))
+		return false;
+
+	for (auto & particle : this->pipeline.particleList) {
+		if (particle.id >= clusterIDs.size())
+			return false;
+		particle.clusterID = clusterIDs[static_cast<size_t>(particle.id)];
 	}
-	if (this->partnerClustersList.backwardsList.size() > 0) {
-		//this->previousPartnerClustersList.backwardsList = this->partnerClustersList.backwardsList;
-		this->partnerClustersList.backwardsList.clear(); // Don't forget!
+
+	this->pipeline.clusterList.clear();
+	this->pipeline.clusterList.reserve(clusters.size());
+	for (auto & entry : clusters) {
+		Cluster cluster;
+		cluster.rootParticleID = entry.rootParticleID;
+		cluster.numberOfParticles = entry.numberOfParticles;
+		cluster.id = entry.id;
+		this->pipeline.clusterList.push_back(cluster);
 	}
 
 	///
 	/// Log output.
 	///
-	std::ofstream compareAllFile;
-	std::ofstream forwardListFile;
-	std::ofstream backwardsListFile;
+	auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now() - time_loadClusters);
+	vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_INFO,
+		"SECalc cluster cache: Read %d clusters of frame %d (%lld ms), skipped steps 1b and 2.", this->pipeline.clusterList.size(), this->frameId, duration.count());
 
-	if (this->quantitativeDataOutputSlot.Param<param::BoolParam>()->Value()) {
-		// SECC == Structure Events Cluster Compare.
-		vislib::StringA label(this->outputLabelSlot.Param<param::StringParam>()->Value());
-		std::string filenameEnd;
-		if (!label.IsEmpty()) {
-			std::string labelStr = label;
-			filenameEnd = " " + labelStr;
-		}
-		filenameEnd += " f" + std::to_string(this->frameId) + " p" + std::to_string(this->particleList.size());
-		std::string filename = "SECC All" + filenameEnd + ".log";
-		compareAllFile.open(filename.c_str());
-		filename = "SECC forward" + filenameEnd + ".csv";
-		forwardListFile.open(filename.c_str());
-		filename = "SECC backwards" + filenameEnd + ".csv";
-		backwardsListFile.open(filename.c_str());
+	if (this->settings.quantitativeDataOutput) {
+		this->logFile << "Skipped step 1b and step 2, " << this->pipeline.clusterList.size() << " clusters read from cluster cache (" << duration.count() << " ms).\n";
+		this->metrics.Set(FrameMetrics::CLUSTERS, static_cast<double>(this->pipeline.clusterList.size()));
 	}
 
-	auto time_compareClusters = std::chrono::system_clock::now();
-
-	///
-	/// Create a comparison matrix to see how many particles the clusters have in common.
-	/// The inner vector contains the columns, the outer vector contains the rows.
-	/// The columns represents the previous clusters. Column id == cluster id of previous clusterList.
-	/// The rows represents the current clusters. Row id == cluster id of current clusterList.
-	/// Access by clusterComparisonMatrix[row][column].
-	///
+	return true;
+}
 
-	std::vector<std::vector<int>> clusterComparisonMatrix;
-	clusterComparisonMatrix.resize(this->clusterList.size(), std::vector<int>(this->previousClusterList.size(), 0));
-	//clusterComparisonMatrix.resize(this->clusterList.size() + 1, std::vector<int>(this->previousClusterList.size() + 1, 0));	// Adding a "gas cluster" at the end of each list.
 
-	// Set gas cluster ids (for analyzing the algorithm). For debugging.
-	//int currentGasClusterID = static_cast<int>(this->clusterList.size());
-	//int previousGasClusterID = static_cast<int>(this->previousClusterList.size());
+void mmvis_static::StructureEventsCalculation::storeClusterCache() {
+	if (this->settings.clusterCacheMode != 1 || !this->openClusterCache())
+		return;
 
-	// Previous to current particle comparison.
-	assert(this->particleList.size() == this->previousParticleList.size()); // Catches (smaller) dummy lists.
-	for (int pid = 0; pid < this->particleList.size(); ++pid) { // Since particleList size stays the same for each frame, one loop is just fine.
-		if (this->particleList[pid].clusterID != -1 && this->previousParticleList[pid].clusterID != -1) // Skip gas.
-			clusterComparisonMatrix[this->particleList[pid].clusterID][this->previousParticleList[pid].clusterID]++; // Race condition, so no parallel processing.
+	const ClusterCacheFile::Settings settings = this->getClusterCacheSettings();
+	if (!(this->clusterCache.GetSettings() == settings)) {
+		// Clusters of different settings must not be mixed in one file.
+		vislib::TString filename(this->clusterCache.GetFilename());
+		if (!this->clusterCache.OpenWrite(filename, settings))
+			return;
+	}
 
-		// Uses a "gas cluster" at the end of each clusterList to catch particles who were partly in gas or stay in gas. For debugging.
-		//int clusterID = -2;
-		//int previousClusterID = -2;
-		//if (this->previousParticleList[pid].clusterID == -1)
-		//	previousClusterID = previousGasClusterID;
-		//else
-		//	previousClusterID = this->previousParticleList[pid].clusterID;
-		//if (this->particleList[pid].clusterID == -1)
-		//	clusterID = currentGasClusterID;
-		//else
-		//	clusterID = this->particleList[pid].clusterID;
-		//clusterComparisonMatrix[clusterID][previousClusterID]++; // Race condition.
+	std::vector<int> clusterIDs(this->pipeline.particleList.size(), -1);
+	for (auto & particle : this->pipeline.particleList) {
+		if (particle.id < clusterIDs.size())
+			clusterIDs[static_cast<size_t>(particle.id)] = particle.clusterID;
 	}
-	
-	// Count gas and percentage.
-	int gasCountPrevious, gasCountCurrent;
-	gasCountPrevious = gasCountCurrent = 0;
-	for (auto & particle : this->previousParticleList) {
-		if (particle.clusterID < 0)
-			gasCountPrevious++;
+
+	std::vector<ClusterCacheFile::ClusterEntry> clusters;
+	clusters.reserve(this->pipeline.clusterList.size());
+	for (auto & cluster : this->pipeline.clusterList) {
+		ClusterCacheFile::ClusterEntry entry;
+		entry.rootParticleID = cluster.rootParticleID;
+		entry.numberOfParticles = cluster.numberOfParticles;
+		entry.id = cluster.id;
+		clusters.push_back(entry);
 	}
-	for (auto & particle : this->particleList) {
-		if (particle.clusterID < 0)
-			gasCountCurrent++;
+
+	if (!this->clusterCache.WriteFrame(this->frameId, clusterIDs, clusters)) {
+		vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_ERROR,
+			"SECalc cluster cache: Unable to write frame %d.", this->frameId);
 	}
-	double gasPercentagePrevious = gasCountPrevious / static_cast<double> (this->previousParticleList.size()) * 100;
-	double gasPercentageCurrent = gasCountCurrent / static_cast<double> (this->particleList.size()) * 100;
+}
 
-	///
-	/// Debug output.
-	/// Check size of comparison matrix.
-	///
-	/*
-	if (this->quantitativeDataOutputSlot.Param<param::BoolParam>()->Value()) {
-		this->debugFile << "Compare Matrix size: " << clusterComparisonMatrix.size() << " x " << clusterComparisonMatrix[0].size() << ".\n";
-
-		int sum = 0;
-		std::vector<int> rowSums;
-		rowSums.resize(clusterComparisonMatrix.size(), 0);
-		for (int row = 0; row < clusterComparisonMatrix.size(); ++row) {
-			for (int column = 0; column < clusterComparisonMatrix[row].size(); ++column) {
-				sum += clusterComparisonMatrix[row][column];
-				rowSums[row] += clusterComparisonMatrix[row][column];
-			}
-		}
-		this->debugFile << "Comparison Matrix sum + gasCount current/previous: " << sum << " + " << gasCountCurrent << "/" << gasCountPrevious;
-		//this->debugFile << " and the sum of each row:\n";
-		//for (auto & value : rowSums)
-		//	this->debugFile << value << "\n";
+
+bool mmvis_static::StructureEventsCalculation::openClusterCache() {
+	// Closed by applySettings if the mode or the file name changed.
+	const vislib::TString& filename = this->settings.clusterCacheFilename;
+	if (filename.IsEmpty())
+		return false;
+
+	const bool write = this->settings.clusterCacheMode == 1;
+	if (this->clusterCache.IsOpen() && this->clusterCache.IsWriting() == write)
+		return true;
+
+	if (write) {
+		return this->clusterCache.OpenWrite(filename, this->getClusterCacheSettings());
 	}
-	*/
+	return this->clusterCache.OpenRead(filename);
+}
 
-	///
-	/// Detecting the type of event.
-	/// First checking all new clusters for each previous cluster (forward),
-	/// then vice versa (backwards).
-	///
 
-	///
-	/// Forward check.
-	///
-	for (int pcid = 0; pcid < this->previousClusterList.size(); ++pcid) {
+mmvis_static::ClusterCacheFile::Settings mmvis_static::StructureEventsCalculation::getClusterCacheSettings() {
+	ClusterCacheFile::Settings settings;
+	settings.radiusMultiplier = this->settings.parameters.radiusMultiplier;
+	settings.minClusterSize = this->settings.parameters.minClusterSize;
+	settings.periodicBoundary = this->settings.parameters.periodicBoundary;
+	return settings;
+}
 
-		PartnerClusters partnerClusters;
 
-		// Add gas cluster. For debugging.
-		//if (pcid == previousGasClusterID) {
-		//	Cluster cluster;
-		//	cluster.id = previousGasClusterID;
-		//	cluster.numberOfParticles = gasCountPrevious;
-		//	partnerClusters.cluster = cluster;
-		//}
-		//else {
+void mmvis_static::StructureEventsCalculation::compareClusters() {
 
-		if (this->previousClusterList[pcid].numberOfParticles == 0)
-			continue; // Skip merged clusters.
-		
-		/// Zero signed distance one size clusters phenomenon do _not_ produce false event, so this is not needed for that problem.
-		/// MergeClusters produces adjacent gas particle clusters not occured yet, so not filtered here.
-		//if (this->previousClusterList[pcid].numberOfParticles == 1)
-			// Some 1 particles clusters are left
-			// Zero signed distance one size clusters phenomenon:
-			// - several particles with signedDistance = 0 build single particle clusters. Causes _no_ false event detection.
-			// MergeClusters produces adjacent gas particle clusters theory (not yet occured); would produce bad results:
-			// - kD search radius could be too high
-			// - so fast-depth adds gas particles to clusters which are next to those clusters (no problem so far)
-			// - during merging clusters they could be left behind when they are choosen first for the merge process.
-			//   Since mergeClusters has a limited search range currently they might not find bigger clusters and remain
-			//   in the same cluster. Instead their neighbours get merged because they have a lower distance to close
-			//   bigger clusters. This results in small clusters which produces wrong births/deaths (especially gas particles).
-			// - liquid particles could also be left in 1 particle clusters after merge b/c of the limited
-			//   search range, especially when minClusterSize is big
-		//	continue;
-
-		partnerClusters.cluster = this->previousClusterList[pcid];
-
-		//}
-
-		//for (int cid = 0; cid < this->clusterList.size() + 1; ++cid) { // +1 for gas cluster. For debugging.
-		for (int cid = 0; cid < this->clusterList.size(); ++cid) {
-
-			// Add gas cluster.
-			//if (cid == currentGasClusterID) {
-			//	Cluster cluster;
-			//	cluster.id = currentGasClusterID;
-			//	cluster.numberOfParticles = gasCountCurrent;
-			//	int numberOfCommonParticles = clusterComparisonMatrix[cid][pcid];
-			//	if (numberOfCommonParticles > 0) {
-			//		partnerClusters.addPartner(cluster, numberOfCommonParticles, true);
-			//	}
-			//	continue;
-			//}
+	if (!this->pipeline.CompareClusters())
+		return; // No previous data, logged by the pipeline.
+	this->pipelineCompared = true;
 
-			int numberOfCommonParticles = clusterComparisonMatrix[cid][pcid];
+	std::vector<Cluster>& clusterList = this->pipeline.clusterList;
+	PartnerClustersList& partnerClustersList = this->pipeline.partnerClustersList;
+	const StructureEventsPipeline::Statistics& statistics = this->pipeline.GetStatistics();
 
-			if (numberOfCommonParticles > 0) {
-				partnerClusters.addPartner(this->clusterList[cid], numberOfCommonParticles);
+	const int gasCountPrevious = statistics.gasCountPrevious;
+	const int gasCountCurrent = statistics.gasCountCurrent;
+	double gasPercentagePrevious = gasCountPrevious / static_cast<double> (this->pipeline.previousParticleList.size()) * 100;
+	double gasPercentageCurrent = gasCountCurrent / static_cast<double> (this->pipeline.particleList.size()) * 100;
+
+	///
+	/// Log output.
+	///
+	AsyncOutputFile compareAllFile(this->outputQueue);
+	AsyncOutputFile forwardListFile(this->outputQueue);
+	AsyncOutputFile backwardsListFile(this->outputQueue);
+
+	const bool quantitativeOutput = this->settings.quantitativeDataOutput;
+	const bool comparisonDumpOutput = quantitativeOutput && this->settings.comparisonFormat == 1;
+	const bool comparisonTextOutput = quantitativeOutput && !comparisonDumpOutput;
+
+	if (quantitativeOutput) {
+		// SECC == Structure Events Cluster Compare.
+		vislib::StringA label(this->settings.outputLabel);
+		std::string filenameEnd;
+		if (!label.IsEmpty()) {
+			std::string labelStr = label;
+			filenameEnd = " " + labelStr;
+		}
+		filenameEnd += " f" + std::to_string(this->frameId) + " p" + std::to_string(this->pipeline.particleList.size());
+		if (comparisonDumpOutput) {
+			// One write, the text views are created offline by secc_convert.
+			this->comparisonDump.Reset(this->frameId, this->pipeline.particleList.size(), gasCountPrevious, gasCountCurrent);
+			for (const auto & partnerClusters : partnerClustersList.forwardList) {
+				this->comparisonDump.AddCluster(ClusterComparisonDump::FORWARD, partnerClusters.cluster.id, partnerClusters.cluster.numberOfParticles);
+				for (int i = 0; i < partnerClusters.getNumberOfPartners(); ++i) {
+					const PartnerClusters::PartnerCluster cc = partnerClusters.getPartner(i);
+					this->comparisonDump.AddEdge(cc.cluster.id, cc.cluster.numberOfParticles, cc.commonParticles);
+				}
+			}
+			for (const auto & partnerClusters : partnerClustersList.backwardsList) {
+				this->comparisonDump.AddCluster(ClusterComparisonDump::BACKWARDS, partnerClusters.cluster.id, partnerClusters.cluster.numberOfParticles);
+				for (int i = 0; i < partnerClusters.getNumberOfPartners(); ++i) {
+					const PartnerClusters::PartnerCluster pc = partnerClusters.getPartner(i);
+					this->comparisonDump.AddEdge(pc.cluster.id, pc.cluster.numberOfParticles, pc.commonParticles);
+				}
 			}
+
+			AsyncOutputFile dumpFile(this->outputQueue);
+			std::string filename = "SECC" + filenameEnd + ".secc";
+			dumpFile.open(filename.c_str(), std::ios_base::out | std::ios_base::binary);
+			this->comparisonDump.Write(dumpFile);
+			dumpFile.close();
 		}
+		else {
+			std::string filename = "SECC All" + filenameEnd + ".log";
+			compareAllFile.open(filename.c_str());
+			filename = "SECC forward" + filenameEnd + ".csv";
+			forwardListFile.open(filename.c_str());
+			filename = "SECC backwards" + filenameEnd + ".csv";
+			backwardsListFile.open(filename.c_str());
+		}
+	}
 
-		///
-		/// Log output.
-		///
-		if (this->quantitativeDataOutputSlot.Param<param::BoolParam>()->Value()) {
+	if (comparisonTextOutput) {
+		for (const auto & partnerClustersRef : partnerClustersList.forwardList) {
+			PartnerClusters partnerClusters = partnerClustersRef; // Copy, the partners get sorted for the log.
 			compareAllFile
 				<< "Previous cluster " << partnerClusters.cluster.id
 				<< ", " << partnerClusters.cluster.numberOfParticles << " particles"
@@ -1984,65 +1992,8 @@ void mmvis_static::StructureEventsCalculation::compareClusters() {
 			compareAllFile << "\n";
 		}
 
-		this->partnerClustersList.forwardList.push_back(partnerClusters);
-	}
-
-
-	///
-	/// Backwards check.
-	///
-	for (int cid = 0; cid < this->clusterList.size(); ++cid) {
-
-		PartnerClusters partnerClusters;
-
-		// Add gas cluster. For debugging.
-		//if (cid == currentGasClusterID) {
-		//	Cluster cluster;
-		//	cluster.id = currentGasClusterID;
-		//	cluster.numberOfParticles = gasCountCurrent;
-		//	partnerClusters.cluster = cluster;
-		//}
-		//else {
-
-		if (this->clusterList[cid].numberOfParticles == 0)
-			continue; // Skip merged clusters.
-
-		/// See explanations in forward.
-		//if (this->clusterList[cid].numberOfParticles == 1)
-			// Some 1 particles clusters are left: see explanations in forward
-		//	continue;
-
-		partnerClusters.cluster = this->clusterList[cid];
-
-		//}
-		
-
-		//for (int pcid = 0; pcid < this->previousClusterList.size() + 1; ++pcid) { // +1 for gas cluster. For debugging.
-		for (int pcid = 0; pcid < this->previousClusterList.size(); ++pcid) {
-
-			// Add gas cluster. For debugging.
-			//if (pcid == previousGasClusterID) {
-			//	Cluster cluster;
-			//	cluster.id = previousGasClusterID;
-			//	cluster.numberOfParticles = gasCountPrevious;
-			//	int numberOfCommonParticles = clusterComparisonMatrix[cid][pcid];
-			//	if (numberOfCommonParticles > 0) {
-			//		partnerClusters.addPartner(cluster, numberOfCommonParticles, true);
-			//	}
-			//	continue;
-			//}
-
-			int numberOfCommonParticles = clusterComparisonMatrix[cid][pcid];
-
-			if (numberOfCommonParticles > 0) {
-				partnerClusters.addPartner(this->previousClusterList[pcid], numberOfCommonParticles);
-			}
-		}
-
-		///
-		/// Log output.
-		///
-		if (this->quantitativeDataOutputSlot.Param<param::BoolParam>()->Value()) {
+		for (const auto & partnerClustersRef : partnerClustersList.backwardsList) {
+			PartnerClusters partnerClusters = partnerClustersRef; // Copy, the partners get sorted for the log.
 			compareAllFile
 				<< "Cluster " << partnerClusters.cluster.id
 				<< ", " << partnerClusters.cluster.numberOfParticles << " particles"
@@ -2064,8 +2015,6 @@ void mmvis_static::StructureEventsCalculation::compareClusters() {
 			}
 			compareAllFile << "\n";
 		}
-		
-		this->partnerClustersList.backwardsList.push_back(partnerClusters);
 	}
 
 	///
@@ -2073,8 +2022,8 @@ void mmvis_static::StructureEventsCalculation::compareClusters() {
 	///
 	/*
 	#pragma omp parallel for
-	for (int i = 0; i < this->clusterList.size(); ++i) {
-		if (i < this->previousClusterList.size()) {
+	for (int i = 0; i < clusterList.size(); ++i) {
+		if (i < this->pipeline.previousClusterList.size()) {
 			clusterList[i].r = previousClusterList[i].r;
 			clusterList[i].g = previousClusterList[i].g;
 			clusterList[i].b = previousClusterList[i].b;
@@ -2095,22 +2044,22 @@ void mmvis_static::StructureEventsCalculation::compareClusters() {
 	/// Coloring of descendant clusters by using their biggest ancestor
 	/// or using random colors.
 	///
-	switch (this->clusterColoringSlot.Param<param::EnumParam>()->Value()) {
+	switch (this->settings.clusterColoring) {
 	case 0: // With color inheritance.
 	case 1: // With color inheritance.
 		//#pragma omp parallel for
-		for (int cli = 0; cli < this->clusterList.size(); ++cli) {
+		for (int cli = 0; cli < clusterList.size(); ++cli) {
 			bool colored = false;
-			if (this->clusterList[cli].numberOfParticles > 0) {
-				PartnerClusters* pcs = this->partnerClustersList.getPartnerClusters(this->clusterList[cli].id, PartnerClustersList::Direction::backwards);
+			if (clusterList[cli].numberOfParticles > 0) {
+				PartnerClusters* pcs = partnerClustersList.getPartnerClusters(clusterList[cli].id, PartnerClustersList::Direction::backwards);
 				if (pcs != NULL) {
 					for (int pci = 0; pci < pcs->getNumberOfPartners(); ++pci) {
 						PartnerClusters::PartnerCluster pc = pcs->getPartner(pci);
 						// Get partner with most common particles.
 						if (pcs->getMaxCommonParticles() == pc.commonParticles) {
-							this->clusterList[cli].r = pc.cluster.r;
-							this->clusterList[cli].g = pc.cluster.g;
-							this->clusterList[cli].b = pc.cluster.b;
+							clusterList[cli].r = pc.cluster.r;
+							clusterList[cli].g = pc.cluster.g;
+							clusterList[cli].b = pc.cluster.b;
 							colored = true;
 							break;
 						}
@@ -2118,28 +2067,28 @@ void mmvis_static::StructureEventsCalculation::compareClusters() {
 				}
 			}
 			if (colored == false) { // No parent cluster.
-				if (this->clusterColoringSlot.Param<param::EnumParam>()->Value() == 0) { // Root particle properties.
+				if (this->settings.clusterColoring == 0) { // Root particle properties.
 					// Use root particle properties for coloring.
-					const Particle* p = &this->particleList[this->clusterList[cli].rootParticleID];
-					const vislib::math::Vector<float, 3> color = this->getColorFromProperties(this->particleList[this->clusterList[cli].rootParticleID]);
-					this->clusterList[cli].r = color.GetX();
-					this->clusterList[cli].g = color.GetY();
-					this->clusterList[cli].b = color.GetZ();
+					const Particle* p = &this->pipeline.particleList[clusterList[cli].rootParticleID];
+					const vislib::math::Vector<float, 3> color = this->getColorFromProperties(this->pipeline.particleList[clusterList[cli].rootParticleID]);
+					clusterList[cli].r = color.GetX();
+					clusterList[cli].g = color.GetY();
+					clusterList[cli].b = color.GetZ();
 				}
 				else { // Random color.
 					std::random_device rd;
 					std::mt19937_64 mt(rd()); // Runtime doesn't always like concurrency here (crashes), though it works in dummy list.
 					std::uniform_real_distribution<float> distribution(0, 1);
-					this->clusterList[cli].r = distribution(mt);
-					this->clusterList[cli].g = distribution(mt);
-					this->clusterList[cli].b = distribution(mt);
+					clusterList[cli].r = distribution(mt);
+					clusterList[cli].g = distribution(mt);
+					clusterList[cli].b = distribution(mt);
 				}
 			}
 		}
 		break;
 	case 2: // No inheritance,
 		//#pragma omp parallel for
-		for (int cli = 0; cli < this->clusterList.size(); ++cli) {
+		for (int cli = 0; cli < clusterList.size(); ++cli) {
 			std::random_device rd;
 			std::mt19937_64 mt(rd()); // Runtime doesn't always like concurrency here (crashes), though it works in dummy list.
 			std::uniform_real_distribution<float> distribution(0, 1);
@@ -2153,77 +2102,78 @@ void mmvis_static::StructureEventsCalculation::compareClusters() {
 	///
 	/// Log output.
 	///
-	if (this->quantitativeDataOutputSlot.Param<param::BoolParam>()->Value()) {
+	if (this->settings.quantitativeDataOutput) {
 
 		///
 		/// Evaluation:
 		/// - csv to create diagrams
 		/// - for frame to frame comparison: Mean value and standard deviation of values.
 		///
-		std::vector<double> vTotalCommonPercentage;
-		forwardListFile << "Cluster id; Cluster size [#]; Common particles [#]; Common particles [%]; Partners [#]; Average partner common particles [%]; "
-			<< "LocalMaxTotal [%]; "
-			<< "75 % bp; 50 % bp; 45 % bp; 40 % bp; 35 % bp; 30 % bp; 25 % bp; 20 % bp; 10 % sp; 1 % sp; "
-			<< "bp = big partners, sp = small partners"
-			<< "\n";
-		for (auto partnerClusters : this->partnerClustersList.forwardList) {
-			forwardListFile << partnerClusters.cluster.id << ";"
-				<< partnerClusters.cluster.numberOfParticles << ";"
-				<< partnerClusters.getTotalCommonParticles() << ";"
-				<< partnerClusters.getTotalCommonPercentage() << ";"
-				<< partnerClusters.getNumberOfPartners() << ";"
-				<< partnerClusters.getAveragePartnerCommonPercentage() << ";"
-				<< partnerClusters.getLocalMaxTotalPercentage() << ";"
-				<< partnerClusters.getBigPartnerAmount(75) << ";"
-				<< partnerClusters.getBigPartnerAmount(50) << ";"
-				<< partnerClusters.getBigPartnerAmount(45) << ";"
-				<< partnerClusters.getBigPartnerAmount(40) << ";"
-				<< partnerClusters.getBigPartnerAmount(35) << ";"
-				<< partnerClusters.getBigPartnerAmount(30) << ";"
-				<< partnerClusters.getBigPartnerAmount(25) << ";"
-				<< partnerClusters.getBigPartnerAmount(20) << ";"
-				<< partnerClusters.getSmallPartnerAmount(10) << ";"
-				<< partnerClusters.getSmallPartnerAmount(1)
+		FrameMetrics::RunningStats totalCommonPercentageFwd;
+		FrameMetrics::RunningStats totalCommonPercentageBw;
+		for (const auto & partnerClusters : partnerClustersList.forwardList)
+			totalCommonPercentageFwd.Add(partnerClusters.getTotalCommonPercentage());
+		for (const auto & partnerClusters : partnerClustersList.backwardsList)
+			totalCommonPercentageBw.Add(partnerClusters.getTotalCommonPercentage());
+
+		if (comparisonTextOutput) {
+			forwardListFile << "Cluster id; Cluster size [#]; Common particles [#]; Common particles [%]; Partners [#]; Average partner common particles [%]; "
+				<< "LocalMaxTotal [%]; "
+				<< "75 % bp; 50 % bp; 45 % bp; 40 % bp; 35 % bp; 30 % bp; 25 % bp; 20 % bp; 10 % sp; 1 % sp; "
+				<< "bp = big partners, sp = small partners"
 				<< "\n";
-			vTotalCommonPercentage.push_back(partnerClusters.getTotalCommonPercentage());
-		}
-
-		MeanStdDev mdTotalCommonPercentageFwd = meanStdDeviation(vTotalCommonPercentage);
-		vTotalCommonPercentage.clear();
+			for (const auto & partnerClusters : partnerClustersList.forwardList) {
+				forwardListFile << partnerClusters.cluster.id << ";"
+					<< partnerClusters.cluster.numberOfParticles << ";"
+					<< partnerClusters.getTotalCommonParticles() << ";"
+					<< partnerClusters.getTotalCommonPercentage() << ";"
+					<< partnerClusters.getNumberOfPartners() << ";"
+					<< partnerClusters.getAveragePartnerCommonPercentage() << ";"
+					<< partnerClusters.getLocalMaxTotalPercentage() << ";"
+					<< partnerClusters.getBigPartnerAmount(75) << ";"
+					<< partnerClusters.getBigPartnerAmount(50) << ";"
+					<< partnerClusters.getBigPartnerAmount(45) << ";"
+					<< partnerClusters.getBigPartnerAmount(40) << ";"
+					<< partnerClusters.getBigPartnerAmount(35) << ";"
+					<< partnerClusters.getBigPartnerAmount(30) << ";"
+					<< partnerClusters.getBigPartnerAmount(25) << ";"
+					<< partnerClusters.getBigPartnerAmount(20) << ";"
+					<< partnerClusters.getSmallPartnerAmount(10) << ";"
+					<< partnerClusters.getSmallPartnerAmount(1)
+					<< "\n";
+			}
 
-		backwardsListFile << "Cluster id; Cluster size [#]; Common particles [#]; Common particles [%]; Partners [#]; Average partner common particles [%]; "
-			<< "LocalMaxTotal [%]; "
-			<< "75 % bp; 50 % bp; 45 % bp; 40 % bp; 35 % bp; 30 % bp; 25 % bp; 20 % bp; 10 % sp; 1 % sp; "
-			<< "bp = big partners, sp = small partners"
-			<< "\n";
-		for (auto partnerClusters : this->partnerClustersList.backwardsList) {
-			backwardsListFile << partnerClusters.cluster.id << ";"
-				<< partnerClusters.cluster.numberOfParticles << ";"
-				<< partnerClusters.getTotalCommonParticles() << ";"
-				<< partnerClusters.getTotalCommonPercentage() << ";"
-				<< partnerClusters.getNumberOfPartners() << ";"
-				<< partnerClusters.getAveragePartnerCommonPercentage() << ";"
-				<< partnerClusters.getLocalMaxTotalPercentage() << ";"
-				<< partnerClusters.getBigPartnerAmount(75) << ";"
-				<< partnerClusters.getBigPartnerAmount(50) << ";"
-				<< partnerClusters.getBigPartnerAmount(45) << ";"
-				<< partnerClusters.getBigPartnerAmount(40) << ";"
-				<< partnerClusters.getBigPartnerAmount(35) << ";"
-				<< partnerClusters.getBigPartnerAmount(30) << ";"
-				<< partnerClusters.getBigPartnerAmount(25) << ";"
-				<< partnerClusters.getBigPartnerAmount(20) << ";"
-				<< partnerClusters.getSmallPartnerAmount(10) << ";"
-				<< partnerClusters.getSmallPartnerAmount(1)
+			backwardsListFile << "Cluster id; Cluster size [#]; Common particles [#]; Common particles [%]; Partners [#]; Average partner common particles [%]; "
+				<< "LocalMaxTotal [%]; "
+				<< "75 % bp; 50 % bp; 45 % bp; 40 % bp; 35 % bp; 30 % bp; 25 % bp; 20 % bp; 10 % sp; 1 % sp; "
+				<< "bp = big partners, sp = small partners"
 				<< "\n";
-			vTotalCommonPercentage.push_back(partnerClusters.getTotalCommonPercentage());
+			for (const auto & partnerClusters : partnerClustersList.backwardsList) {
+				backwardsListFile << partnerClusters.cluster.id << ";"
+					<< partnerClusters.cluster.numberOfParticles << ";"
+					<< partnerClusters.getTotalCommonParticles() << ";"
+					<< partnerClusters.getTotalCommonPercentage() << ";"
+					<< partnerClusters.getNumberOfPartners() << ";"
+					<< partnerClusters.getAveragePartnerCommonPercentage() << ";"
+					<< partnerClusters.getLocalMaxTotalPercentage() << ";"
+					<< partnerClusters.getBigPartnerAmount(75) << ";"
+					<< partnerClusters.getBigPartnerAmount(50) << ";"
+					<< partnerClusters.getBigPartnerAmount(45) << ";"
+					<< partnerClusters.getBigPartnerAmount(40) << ";"
+					<< partnerClusters.getBigPartnerAmount(35) << ";"
+					<< partnerClusters.getBigPartnerAmount(30) << ";"
+					<< partnerClusters.getBigPartnerAmount(25) << ";"
+					<< partnerClusters.getBigPartnerAmount(20) << ";"
+					<< partnerClusters.getSmallPartnerAmount(10) << ";"
+					<< partnerClusters.getSmallPartnerAmount(1)
+					<< "\n";
+			}
 		}
 
-		MeanStdDev mdTotalCommonPercentageBw = meanStdDeviation(vTotalCommonPercentage);
-
 		///
 		/// Log output for frame to frame evaluation: Min/Max/Mean/StdDev.
 		///
-		if (this->quantitativeDataOutputSlot.Param<param::BoolParam>()->Value()) {
+		if (this->settings.quantitativeDataOutput) {
 			PartnerClusters maxPercentageFwd = partnerClustersList.getMaxPercentage();
 			PartnerClusters minPercentageFwd = partnerClustersList.getMinPercentage();
 			PartnerClusters maxPercentageBw = partnerClustersList.getMaxPercentage(PartnerClustersList::Direction::backwards);
@@ -2236,23 +2186,23 @@ void mmvis_static::StructureEventsCalculation::compareClusters() {
 				<< "\n"
 				<< "  - Fw ratio: "
 				<< "Min " << minPercentageFwd.getTotalCommonPercentage() << "% (cl " << minPercentageFwd.cluster.id << ", localMax to total ratio " << minPercentageFwd.getLocalMaxTotalPercentage() << "%), "
-				<< "Mean " << mdTotalCommonPercentageFwd.mean << "% (std deviation " << mdTotalCommonPercentageFwd.deviation << "%), "
+				<< "Mean " << totalCommonPercentageFwd.GetMean() << "% (std deviation " << totalCommonPercentageFwd.GetDeviation() << "%), "
 				<< "Max " << maxPercentageFwd.getTotalCommonPercentage() << "% (cl " << maxPercentageFwd.cluster.id << ", localMax to total ratio " << maxPercentageFwd.getLocalMaxTotalPercentage() << "%)"
 				<< "\n"
 				<< "  - Bw ratio: "
 				<< "Min " << minPercentageBw.getTotalCommonPercentage() << "% (cl " << minPercentageBw.cluster.id << ", localMax to total ratio " << minPercentageBw.getLocalMaxTotalPercentage() << "%), "
-				<< "Mean " << mdTotalCommonPercentageBw.mean << "% (std deviation " << mdTotalCommonPercentageBw.deviation << "%), "
+				<< "Mean " << totalCommonPercentageBw.GetMean() << "% (std deviation " << totalCommonPercentageBw.GetDeviation() << "%), "
 				<< "Max " << maxPercentageBw.getTotalCommonPercentage() << "% (cl " << maxPercentageBw.cluster.id << ", localMax to total ratio " << maxPercentageBw.getLocalMaxTotalPercentage() << "%)"
 				<< "\n";
 
-			this->csvLogFile << minPercentageFwd.getTotalCommonPercentage() << "; " // Forward min common particle ratio (%)
-				<< mdTotalCommonPercentageFwd.mean << "; " // Forward mean common particle ratio (%)
-				<< mdTotalCommonPercentageFwd.deviation << "; " // Forward common particle ratio std deviation (%)
-				<< maxPercentageFwd.getTotalCommonPercentage() << "; " // Forward max common particle ratio (%)
-				<< minPercentageBw.getTotalCommonPercentage() << "; " // Backwards min common particle ratio (%)
-				<< mdTotalCommonPercentageBw.mean << "; " // Backwards mean common particle ratio (%)
-				<< mdTotalCommonPercentageBw.deviation << "; " // Backwards common particle ratio std deviation (%)
-				<< maxPercentageBw.getTotalCommonPercentage() << "; "; // Backwards max common particle ratio (%)
+			this->metrics.Set(FrameMetrics::FORWARD_MIN_CP_PERCENTAGE, minPercentageFwd.getTotalCommonPercentage());
+			this->metrics.Set(FrameMetrics::FORWARD_MEAN_CP_PERCENTAGE, totalCommonPercentageFwd.GetMean());
+			this->metrics.Set(FrameMetrics::FORWARD_DEVIATION_CP_PERCENTAGE, totalCommonPercentageFwd.GetDeviation());
+			this->metrics.Set(FrameMetrics::FORWARD_MAX_CP_PERCENTAGE, maxPercentageFwd.getTotalCommonPercentage());
+			this->metrics.Set(FrameMetrics::BACKWARDS_MIN_CP_PERCENTAGE, minPercentageBw.getTotalCommonPercentage());
+			this->metrics.Set(FrameMetrics::BACKWARDS_MEAN_CP_PERCENTAGE, totalCommonPercentageBw.GetMean());
+			this->metrics.Set(FrameMetrics::BACKWARDS_DEVIATION_CP_PERCENTAGE, totalCommonPercentageBw.GetDeviation());
+			this->metrics.Set(FrameMetrics::BACKWARDS_MAX_CP_PERCENTAGE, maxPercentageBw.getTotalCommonPercentage());
 		}
 		///
 		/// Summary evaluation: Most common/uncommon clusters, critical values have to be evaluated depending on:
@@ -2267,305 +2217,300 @@ void mmvis_static::StructureEventsCalculation::compareClusters() {
 	}
 
 	{ // Time measurement.
-		auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now() - time_compareClusters);
+		const long long duration = statistics.compareDuration;
 		vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_INFO,
-			"SECalc step 3: Compared clusters (%lld ms).\n", duration.count());
+			"SECalc step 3: Compared clusters (%lld ms).\n", duration);
 
-		if (this->quantitativeDataOutputSlot.Param<param::BoolParam>()->Value()) {
-			this->logFile << "  - step 3 required " << duration.count() << " ms\n";
-			this->csvLogFile << duration.count() << "; "; // Compare Clusters (ms)
+		if (this->settings.quantitativeDataOutput) {
+			this->logFile << "  - step 3 required " << duration << " ms\n";
+			this->metrics.Set(FrameMetrics::COMPARE_CLUSTERS_MS, static_cast<double>(duration));
 		}
 	}
 
 	compareAllFile.close();
+	forwardListFile.close();
+	backwardsListFile.close();
 }
 
 
 void mmvis_static::StructureEventsCalculation::determineStructureEvents() {
 
-	if (this->partnerClustersList.forwardList.size() == 0 || this->partnerClustersList.backwardsList.size() == 0) {
-		if (this->quantitativeDataOutputSlot.Param<param::BoolParam>()->Value()) {
-			this->debugFile
-				<< "SECalc step 4: No comparison data, quit determination of StructureEvents."
-				<< " " << this->timeOutputCache
-				<< "\n";
-		}
-		vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_WARN,
-			"SECalc step 4: No comparison data, quit determination of StructureEvents.");
-		return;
-	}
+	std::vector<StructureEventsPipeline::Event>& events = this->pipelineEvents;
+	events.clear();
+	if (!this->pipeline.DetermineStructureEvents(this->getPipelineParameters(), events))
+		return; // No comparison data, logged by the pipeline.
+
+	const int (&eventAmount)[4] = this->pipeline.GetStatistics().eventAmount;
+
+	this->setFrameEvents(events);
 
 	///
 	/// Log output.
 	///
+	// Time measurement.
+	const long long duration = this->pipeline.GetStatistics().eventsDuration;
+	vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_INFO,
+		"SECalc step 4: Determined %d structure events (%lld ms).", std::accumulate(eventAmount, eventAmount + 4, 0), duration);
 
-	std::ofstream testEventsCSVFile;
+	if (this->settings.quantitativeDataOutput) {
+		this->logFile
+			<< "Step 4 (structure events) detected " << std::accumulate(eventAmount, eventAmount + 4, 0) << " events"
+			<< " (" << duration << " ms):\n"
+			<< "  - "
+			<< eventAmount[0] << " births, "
+			<< eventAmount[1] << " deaths, "
+			<< eventAmount[2] << " merges, "
+			<< eventAmount[3] << " splits"
+			<< "\n"
+			<< "  - limits for merge/split detection:"
+			<< " at least " << this->settings.parameters.msMinClusterAmount << " partner clusters"
+			<< " with " << this->settings.parameters.msMinCPPercentage << "% common particles ratio"
+			<< "\n"
+			<< "  - maximum limit of total common particles ratio for birth/death: "
+			<< this->settings.parameters.bdMaxCPPercentage << "%"
+			<< "\n";
+		this->metrics.Set(FrameMetrics::MS_MIN_CLUSTER_AMOUNT, this->settings.parameters.msMinClusterAmount);
+		this->metrics.Set(FrameMetrics::MS_MIN_CP_PERCENTAGE, this->settings.parameters.msMinCPPercentage);
+		this->metrics.Set(FrameMetrics::BD_MAX_CP_PERCENTAGE, this->settings.parameters.bdMaxCPPercentage);
+		this->metrics.Set(FrameMetrics::BIRTHS, eventAmount[0]);
+		this->metrics.Set(FrameMetrics::DEATHS, eventAmount[1]);
+		this->metrics.Set(FrameMetrics::MERGES, eventAmount[2]);
+		this->metrics.Set(FrameMetrics::SPLITS, eventAmount[3]);
+		this->metrics.Set(FrameMetrics::TOTAL_EVENTS, std::accumulate(eventAmount, eventAmount + 4, 0));
+		this->metrics.Set(FrameMetrics::DETERMINE_EVENTS_MS, static_cast<double>(duration));
+
+		this->sweepStructureEventThresholds();
+	}
+}
 
-	// 0 := Birth, 1 := Death, 2 := Merge, 3 := Split.
-	int eventAmount[4] = { 0 };
-	
-	// For test output.
-	int partnerAmount25p3, partnerAmount30p2, partnerAmount30p3, partnerAmount35p2, partnerAmount40p2, partnerAmount45p2;
-	partnerAmount25p3 = partnerAmount30p2 = partnerAmount30p3 = partnerAmount35p2 = partnerAmount40p2 = partnerAmount45p2 = 0;
-	const int birthDeathTestAmount = 5;
-	int deathAmount[birthDeathTestAmount] = { 0 };
-
-	if (this->quantitativeDataOutputSlot.Param<param::BoolParam>()->Value()) {
-		vislib::StringA label(this->outputLabelSlot.Param<param::StringParam>()->Value());
-		std::string filenameEnd;
-		if (!label.IsEmpty()) {
-			std::string labelStr = label;
-			filenameEnd = " " + labelStr;
-		}
-		// DSE == Determine Structure Events.
-		std::string filename = "SECalc DetermineStructureEvents" + filenameEnd + ".csv";
-		testEventsCSVFile.open(filename.c_str(), std::ios_base::app | std::ios_base::out);
-		std::ifstream testEventsCSVFilePeekTest;
-		testEventsCSVFilePeekTest.open(filename.c_str());
 
-		if (testEventsCSVFilePeekTest.peek() == std::ifstream::traits_type::eof()) {
-			testEventsCSVFile
-				<< "Label; "
-				<< "Time; "
-				<< "Frame ID; "
-				<< "25%, 3+ Split (#prevClusters); "
-				<< "30%, 2+ Split (#prevClusters); "
-				<< "30%, 3+ Split (#prevClusters); "
-				<< "35%, 2+ Split (#prevClusters); "
-				<< "40%, 2+ Split (#prevClusters); "
-				<< "45%, 2+ Split (#prevClusters); ";
-
-			for (int limit = 0; limit < birthDeathTestAmount; ++limit)
-				testEventsCSVFile << limit + 1 << "% Death (#prevClusters); ";
-
-			testEventsCSVFile
-				<< "25%, 3+ Merge (#clusters); "
-				<< "30%, 2+ Merge (#clusters); "
-				<< "30%, 3+ Merge (#clusters); "
-				<< "35%, 2+ Merge (#clusters); "
-				<< "40%, 2+ Merge (#clusters); "
-				<< "45%, 2+ Merge (#clusters); ";
-
-			for (int limit = 0; limit < birthDeathTestAmount; ++limit)
-				testEventsCSVFile << limit + 1 << "% Birth (#clusters); ";
-
-			testEventsCSVFile
-				<< "Split and merge are using limits for big partners"
-				<< "\n";
-		}
-		testEventsCSVFilePeekTest.close();
+void mmvis_static::StructureEventsCalculation::setFrameEvents(const std::vector<StructureEventsPipeline::Event>& events) {
 
-		testEventsCSVFile
-			<< label.PeekBuffer() << "; "
-			<< this->timeOutputCache << "; "
-			<< this->frameId << "; ";
+	// Events of this frame, replace the frame's previous events in the store.
+	std::vector<StructureEvents::StructureEvent> frameEvents;
+	frameEvents.reserve(events.size());
+
+	// Properties of the triggering cluster, same index as the event.
+	std::vector<StructureEventsStore::EventDetails> frameDetails;
+	frameDetails.reserve(events.size());
+
+	for (const auto & event : events) {
+		StructureEvents::StructureEvent se;
+		se.x = event.x;
+		se.y = event.y;
+		se.z = event.z;
+		se.time = event.time;
+		se.type = StructureEvents::getEventType(event.type);
+		frameEvents.push_back(se);
+
+		StructureEventsStore::EventDetails details;
+		details.triggerClusterID = event.triggerClusterID;
+		details.triggerClusterSize = event.triggerClusterSize;
+		details.partnerCount = event.partnerCount;
+		details.commonPercentage = event.commonPercentage;
+		frameDetails.push_back(details);
 	}
 	
-	auto time_setStructureEvents = std::chrono::system_clock::now();
+	///
+	/// Store events, the store updates the maximum time.
+	///
+	this->structureEvents.SetFrameEvents(this->frameId, frameEvents, frameDetails);
 
 	///
-	/// Forward direction.
+	/// Change hash to flag that sedc data has changed.
 	///
-	for (auto partnerClusters : this->partnerClustersList.forwardList) { // No parallelization because of little computation and sequential output.
-		
-		if (this->quantitativeDataOutputSlot.Param<param::BoolParam>()->Value()) {
-			// For test output.
-			if (partnerClusters.getBigPartnerAmount(25) > 2)
-				partnerAmount25p3++;
-			if (partnerClusters.getBigPartnerAmount(30) > 1)
-				partnerAmount30p2++;
-			if (partnerClusters.getBigPartnerAmount(30) > 2)
-				partnerAmount30p3++;
-			if (partnerClusters.getBigPartnerAmount(35) > 1)
-				partnerAmount35p2++;
-			if (partnerClusters.getBigPartnerAmount(40) > 1)
-				partnerAmount40p2++;
-			if (partnerClusters.getBigPartnerAmount(45) > 1)
-				partnerAmount45p2++;
-			for (int limit = 0; limit < birthDeathTestAmount; ++limit) {
-				if (partnerClusters.getNumberOfPartners() == 0 || partnerClusters.getTotalCommonPercentage() <= limit + 1) {
-					deathAmount[limit]++;
-				}
-			}
-		}
+	this->sedcHash = this->sedcHash != 1 ? 1 : 2;
+}
+
+
+void mmvis_static::StructureEventsCalculation::sweepStructureEventThresholds() {
 
-		// Detect split.
-		if (partnerClusters.getBigPartnerAmount(this->msMinCPPercentageSlot.Param<param::FloatParam>()->Value()) >= this->msMinClusterAmountSlot.Param<param::IntParam>()->Value()) {
-			StructureEvents::StructureEvent se;
-			se.x = this->previousParticleList[partnerClusters.cluster.rootParticleID].x;
-			se.y = this->previousParticleList[partnerClusters.cluster.rootParticleID].y;
-			se.z = this->previousParticleList[partnerClusters.cluster.rootParticleID].z;
-			se.time = static_cast<float>(this->frameId);
-			se.type = StructureEvents::SPLIT;
-			this->structureEvents.push_back(se);
-			eventAmount[3]++;
-		}
-
-		// Detect death.
-		if (partnerClusters.getNumberOfPartners() == 0 || partnerClusters.getTotalCommonPercentage() <= this->bdMaxCPPercentageSlot.Param<param::FloatParam>()->Value()) {
-			StructureEvents::StructureEvent se;
-			se.x = this->previousParticleList[partnerClusters.cluster.rootParticleID].x;
-			se.y = this->previousParticleList[partnerClusters.cluster.rootParticleID].y;
-			se.z = this->previousParticleList[partnerClusters.cluster.rootParticleID].z;
-			se.time = static_cast<float>(this->frameId);
-			se.type = StructureEvents::DEATH;
-			this->structureEvents.push_back(se);
-			eventAmount[1]++;
-		}
-	}
-
-	// Test output.
-	if (this->quantitativeDataOutputSlot.Param<param::BoolParam>()->Value()) {
-		testEventsCSVFile
-			<< partnerAmount25p3 << "; " // Split 25%, 3+ (#prevClusters)
-			<< partnerAmount30p2 << "; " // Split 30%, 2+ (#prevClusters)
-			<< partnerAmount30p3 << "; " // Split 30%, 3+ (#prevClusters)
-			<< partnerAmount35p2 << "; " // Split 35%, 2+ (#prevClusters)
-			<< partnerAmount40p2 << "; " // Split 40%, 2+ (#prevClusters)
-			<< partnerAmount45p2 << "; " // Split 45%, 2+ (#prevClusters)
-			<< deathAmount[0] << "; " // Death 1%
-			<< deathAmount[1] << "; " // Death 2%
-			<< deathAmount[2] << "; " // Death 3%
-			<< deathAmount[3] << "; " // Death 4%
-			<< deathAmount[4] << "; "; // Death 5%
+	if (this->pipeline.partnerClustersList.forwardList.size() == 0 || this->pipeline.partnerClustersList.backwardsList.size() == 0)
+		return;
+
+	const std::vector<float>& cpPercentages = this->settings.sweepMsMinCPPercentages;
+	const std::vector<float>& clusterAmountsF = this->settings.sweepMsMinClusterAmounts;
+	const std::vector<float>& bdPercentages = this->settings.sweepBdMaxCPPercentages;
+
+	if (cpPercentages.empty() || clusterAmountsF.empty() || bdPercentages.empty()) {
+		vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_WARN,
+			"SECalc step 4: Threshold sweep skipped, a sweep grid is empty.");
+		return;
 	}
-	
+
+	std::vector<int> clusterAmounts(clusterAmountsF.size());
+	std::transform(clusterAmountsF.begin(), clusterAmountsF.end(), clusterAmounts.begin(), [](const float a) {
+		return static_cast<int>(a);
+	});
+
+	auto time_sweep = std::chrono::system_clock::now();
+
 	///
-	/// Backward direction.
+	/// Single pass over each direction. Big partner amounts are queried once per
+	/// cp percentage and compared against all cluster amounts.
+	/// [direction][cp][amount] for merge/split, [direction][bd] for birth/death.
 	///
+	std::vector<int> msAmount[2], bdAmount[2];
+	std::vector<int> bigPartnerAmounts(cpPercentages.size());
 
-	// For test output.
-	partnerAmount25p3 = partnerAmount30p2 = partnerAmount30p3 = partnerAmount35p2 = partnerAmount40p2 = partnerAmount45p2 = 0;
-	int birthAmount[5] = { 0 };
+	for (int direction = 0; direction < 2; ++direction) {
+		const std::vector<PartnerClusters>& list = direction == 0 ? this->pipeline.partnerClustersList.forwardList : this->pipeline.partnerClustersList.backwardsList;
+		msAmount[direction].assign(cpPercentages.size() * clusterAmounts.size(), 0);
+		bdAmount[direction].assign(bdPercentages.size(), 0);
 
-	for (auto partnerClusters : this->partnerClustersList.backwardsList) { // No parallelization because of little computation and sequential output.
-		
-		if (this->quantitativeDataOutputSlot.Param<param::BoolParam>()->Value()) {
-			// For test output.
-			if (partnerClusters.getBigPartnerAmount(25) > 2)
-				partnerAmount25p3++;
-			if (partnerClusters.getBigPartnerAmount(30) > 1)
-				partnerAmount30p2++;
-			if (partnerClusters.getBigPartnerAmount(30) > 2)
-				partnerAmount30p3++;
-			if (partnerClusters.getBigPartnerAmount(35) > 1)
-				partnerAmount35p2++;
-			if (partnerClusters.getBigPartnerAmount(40) > 1)
-				partnerAmount40p2++;
-			if (partnerClusters.getBigPartnerAmount(45) > 1)
-				partnerAmount45p2++;
-			for (int limit = 0; limit < birthDeathTestAmount; ++limit) {
-				if (partnerClusters.getNumberOfPartners() == 0 || partnerClusters.getTotalCommonPercentage() <= limit + 1) {
-					birthAmount[limit]++;
+		for (const auto & partnerClusters : list) {
+			for (size_t cpi = 0; cpi < cpPercentages.size(); ++cpi)
+				bigPartnerAmounts[cpi] = partnerClusters.getBigPartnerAmount(cpPercentages[cpi]);
+
+			for (size_t cpi = 0; cpi < cpPercentages.size(); ++cpi) {
+				for (size_t ai = 0; ai < clusterAmounts.size(); ++ai) {
+					if (bigPartnerAmounts[cpi] >= clusterAmounts[ai])
+						msAmount[direction][cpi * clusterAmounts.size() + ai]++;
 				}
 			}
-		}
-
-		// Detect merge.
-		if (partnerClusters.getBigPartnerAmount(this->msMinCPPercentageSlot.Param<param::FloatParam>()->Value()) >= this->msMinClusterAmountSlot.Param<param::IntParam>()->Value()) {
-			StructureEvents::StructureEvent se;
-			se.x = this->particleList[partnerClusters.cluster.rootParticleID].x;
-			se.y = this->particleList[partnerClusters.cluster.rootParticleID].y;
-			se.z = this->particleList[partnerClusters.cluster.rootParticleID].z;
-			se.time = static_cast<float>(this->frameId);
-			se.type = StructureEvents::MERGE;
-			this->structureEvents.push_back(se);
-			eventAmount[2]++;
-		}
 
-		// Detect birth.
-		if (partnerClusters.getNumberOfPartners() == 0 || partnerClusters.getTotalCommonPercentage() <= this->bdMaxCPPercentageSlot.Param<param::FloatParam>()->Value()) {
-			StructureEvents::StructureEvent se;
-			se.x = this->particleList[partnerClusters.cluster.rootParticleID].x;
-			se.y = this->particleList[partnerClusters.cluster.rootParticleID].y;
-			se.z = this->particleList[partnerClusters.cluster.rootParticleID].z;
-			se.time = static_cast<float>(this->frameId);
-			se.type = StructureEvents::BIRTH;
-			this->structureEvents.push_back(se);
-			eventAmount[0]++;
+			const bool noPartners = partnerClusters.getNumberOfPartners() == 0;
+			const double totalCommonPercentage = partnerClusters.getTotalCommonPercentage();
+			for (size_t bdi = 0; bdi < bdPercentages.size(); ++bdi) {
+				if (noPartners || totalCommonPercentage <= bdPercentages[bdi])
+					bdAmount[direction][bdi]++;
+			}
 		}
 	}
-	
-	// Test output.
-	if (this->quantitativeDataOutputSlot.Param<param::BoolParam>()->Value()) {
-		testEventsCSVFile
-			<< partnerAmount25p3 << "; " // Merge 25%, 3+ (#prevClusters)
-			<< partnerAmount30p2 << "; " // Merge 30%, 2+ (#clusters)
-			<< partnerAmount30p3 << "; " // Merge 30%, 3+ (#clusters)
-			<< partnerAmount35p2 << "; " // Merge 35%, 2+ (#clusters)
-			<< partnerAmount40p2 << "; " // Merge 40%, 2+ (#clusters)
-			<< partnerAmount45p2 << "; " // Merge 45%, 2+ (#clusters)
-			<< birthAmount[0] << "; " // Birth 1%
-			<< birthAmount[1] << "; " // Birth 2%
-			<< birthAmount[2] << "; " // Birth 3%
-			<< birthAmount[3] << "; " // Birth 4%
-			<< birthAmount[4] << "; "; // Birth 5%
-	}
-
-	///
-	/// Set maximum time.
-	///
-	if (this->structureEvents.size() > 0) {
-		this->seMaxTimeCache = std::max_element(
-			this->structureEvents.begin(), this->structureEvents.end(), [](const StructureEvents::StructureEvent& lhs, const StructureEvents::StructureEvent& rhs) {
-			return lhs.time < rhs.time;
-		})->time;
-	}
-	else {
-		if (this->quantitativeDataOutputSlot.Param<param::BoolParam>()->Value()) {
-			this->debugFile
-				<< "SECalc step 4: No structure events determined!"
-				<< " " << this->timeOutputCache
-				<< "\n";
-		}
 
-		vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_WARN,
-			"SECalc step 4: No structure events determined!");
-	}
 	///
-	/// Change hash to flag that sedc data has changed.
+	/// Combine to grid points. Forward := death/split, backwards := birth/merge.
 	///
-	this->sedcHash = this->sedcHash != 1 ? 1 : 2;
+	std::vector<SweepPoint>& frameAmounts = this->sweepAmounts[this->frameId];
+	frameAmounts.clear();
+	frameAmounts.reserve(cpPercentages.size() * clusterAmounts.size() * bdPercentages.size());
+	for (size_t cpi = 0; cpi < cpPercentages.size(); ++cpi) {
+		for (size_t ai = 0; ai < clusterAmounts.size(); ++ai) {
+			for (size_t bdi = 0; bdi < bdPercentages.size(); ++bdi) {
+				SweepPoint sp;
+				sp.msMinCPPercentage = cpPercentages[cpi];
+				sp.msMinClusterAmount = clusterAmounts[ai];
+				sp.bdMaxCPPercentage = bdPercentages[bdi];
+				sp.eventAmount[0] = bdAmount[1][bdi];
+				sp.eventAmount[1] = bdAmount[0][bdi];
+				sp.eventAmount[2] = msAmount[1][cpi * clusterAmounts.size() + ai];
+				sp.eventAmount[3] = msAmount[0][cpi * clusterAmounts.size() + ai];
+				frameAmounts.push_back(sp);
+			}
+		}
+	}
 
 	///
-	/// Log output.
+	/// Output.
 	///
-	// Time measurement.
-	auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now() - time_setStructureEvents);
-	vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_INFO,
-		"SECalc step 4: Determined %d structure events (%lld ms).", std::accumulate(eventAmount, eventAmount + 4, 0), duration.count());
+	vislib::StringA label(this->settings.outputLabel);
+	std::string filenameEnd;
+	if (!label.IsEmpty()) {
+		std::string labelStr = label;
+		filenameEnd = " " + labelStr;
+	}
+
+	// Per frame amounts, appended.
+	std::string filename = "SECalc EventSweep" + filenameEnd + ".csv";
+	AsyncOutputFile sweepFile(this->outputQueue);
+	sweepFile.open(filename.c_str(), std::ios_base::app | std::ios_base::out);
+	if (this->outputQueue.IsNewFile(filename)) {
+		sweepFile
+			<< "Label; "
+			<< "Time; "
+			<< "Frame ID; "
+			<< "msMinCPPercentage (%); "
+			<< "msMinClusterAmount (#clusters); "
+			<< "bdMaxCPPercentage (%); "
+			<< "Births (#clusters); "
+			<< "Deaths (#prevClusters); "
+			<< "Merges (#clusters); "
+			<< "Splits (#prevClusters); "
+			<< "Split and merge are using limits for big partners"
+			<< "\n";
+	}
 
-	if (this->quantitativeDataOutputSlot.Param<param::BoolParam>()->Value()) {
-		this->logFile
-			<< "Step 4 (structure events) detected " << std::accumulate(eventAmount, eventAmount + 4, 0) << " events"
-			<< " (" << duration.count() << " ms):\n"
-			<< "  - "
-			<< eventAmount[0] << " births, "
-			<< eventAmount[1] << " deaths, "
-			<< eventAmount[2] << " merges, "
-			<< eventAmount[3] << " splits"
-			<< "\n"
-			<< "  - limits for merge/split detection:"
-			<< " at least " << this->msMinClusterAmountSlot.Param<param::IntParam>()->Value() << " partner clusters"
-			<< " with " << this->msMinCPPercentageSlot.Param<param::FloatParam>()->Value() << "% common particles ratio"
-			<< "\n"
-			<< "  - maximum limit of total common particles ratio for birth/death: "
-			<< this->bdMaxCPPercentageSlot.Param<param::FloatParam>()->Value() << "%"
+	for (const auto & sp : frameAmounts) {
+		sweepFile
+			<< label.PeekBuffer() << "; "
+			<< this->timeOutputCache << "; "
+			<< this->frameId << "; "
+			<< sp.msMinCPPercentage << "; "
+			<< sp.msMinClusterAmount << "; "
+			<< sp.bdMaxCPPercentage << "; "
+			<< sp.eventAmount[0] << "; "
+			<< sp.eventAmount[1] << "; "
+			<< sp.eventAmount[2] << "; "
+			<< sp.eventAmount[3] << "; "
+			<< "\n";
+	}
+	sweepFile.close();
+
+	// Series totals over all frames calculated so far, rewritten.
+	std::vector<SweepPoint> totals = frameAmounts;
+	for (auto & sp : totals)
+		std::fill(sp.eventAmount, sp.eventAmount + 4, 0);
+	size_t totalFrames = 0;
+	for (const auto & frame : this->sweepAmounts) {
+		if (frame.second.size() != totals.size())
+			continue; // Calculated with another grid.
+		for (size_t spi = 0; spi < totals.size(); ++spi) {
+			for (int type = 0; type < 4; ++type)
+				totals[spi].eventAmount[type] += frame.second[spi].eventAmount[type];
+		}
+		totalFrames++;
+	}
+
+	std::string totalsFilename = "SECalc EventSweep Totals" + filenameEnd + ".csv";
+	AsyncOutputFile totalsFile(this->outputQueue);
+	totalsFile.open(totalsFilename.c_str(), std::ios_base::trunc | std::ios_base::out);
+	totalsFile
+		<< "Label; "
+		<< "Time; "
+		<< "Frames (#frames); "
+		<< "msMinCPPercentage (%); "
+		<< "msMinClusterAmount (#clusters); "
+		<< "bdMaxCPPercentage (%); "
+		<< "Births (#events); "
+		<< "Deaths (#events); "
+		<< "Merges (#events); "
+		<< "Splits (#events); "
+		<< "Total events (#events); "
+		<< "\n";
+	for (const auto & sp : totals) {
+		totalsFile
+			<< label.PeekBuffer() << "; "
+			<< this->timeOutputCache << "; "
+			<< totalFrames << "; "
+			<< sp.msMinCPPercentage << "; "
+			<< sp.msMinClusterAmount << "; "
+			<< sp.bdMaxCPPercentage << "; "
+			<< sp.eventAmount[0] << "; "
+			<< sp.eventAmount[1] << "; "
+			<< sp.eventAmount[2] << "; "
+			<< sp.eventAmount[3] << "; "
+			<< std::accumulate(sp.eventAmount, sp.eventAmount + 4, 0) << "; "
 			<< "\n";
-		this->csvLogFile
-			<< this->msMinClusterAmountSlot.Param<param::IntParam>()->Value() << "; " // Minimal number of big partner clusters for merge / split (#cluster)
-			<< this->msMinCPPercentageSlot.Param<param::FloatParam>()->Value() << "; " // Minimal common particles ratio limit of big partners for merge / split (%)
-			<< this->bdMaxCPPercentageSlot.Param<param::FloatParam>()->Value() << "; " // Maximum total common particles ratio limit for birth / death (%)
-			<< eventAmount[0] << "; " // Births (#events)
-			<< eventAmount[1] << "; " // Deaths (#events)
-			<< eventAmount[2] << "; " // Merges (#events)
-			<< eventAmount[3] << "; " // Splits (#events)
-			<< std::accumulate(eventAmount, eventAmount + 4, 0) << "; " // Total events (#events)
-			<< duration.count() << "; "; // Determine structure events (ms)
-
-		testEventsCSVFile << "\n";
-		testEventsCSVFile.close();
 	}
+	totalsFile.close();
+
+	auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now() - time_sweep);
+	vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_INFO,
+		"SECalc step 4: Swept %d threshold combinations over %d frames (%lld ms).", static_cast<int>(frameAmounts.size()), static_cast<int>(totalFrames), duration.count());
+}
+
+
+std::vector<float> mmvis_static::StructureEventsCalculation::parseSweepGrid(const char *values) {
+	std::vector<float> grid;
+	std::istringstream stream(values);
+	std::string value;
+	while (std::getline(stream, value, ';')) {
+		char *end;
+		const float number = std::strtof(value.c_str(), &end);
+		if (end != value.c_str())
+			grid.push_back(number);
+	}
+	return grid;
 }
 
 
@@ -2578,30 +2523,31 @@ void mmvis_static::StructureEventsCalculation::setClusterColor(const bool renewC
 	/// Colourize cluster.
 	///
 	if (renewClusterColors) {
-		switch (this->clusterColoringSlot.Param<param::EnumParam>()->Value()) {
+		switch (this->settings.clusterColoring) {
 		case 0: // Particle properties.
-			#pragma omp parallel for
-			for (int cli = 0; cli < this->clusterList.size(); ++cli) {
-				const vislib::math::Vector<float, 3> color = this->getColorFromProperties(this->particleList[this->clusterList[cli].rootParticleID]);
-				this->clusterList[cli].r = color.GetX();
-				this->clusterList[cli].g = color.GetY();
-				this->clusterList[cli].b = color.GetZ();
-
-				if (this->clusterList[cli].rootParticleID < 0) { // Debug.
-					printf("Cl: %d.\n", this->clusterList[cli].rootParticleID);
+			TaskPool::GetDefault()->ParallelFor(0, this->pipeline.clusterList.size(), 1024, [this](size_t begin, size_t end, unsigned int) {
+				for (size_t cli = begin; cli < end; ++cli) {
+					const vislib::math::Vector<float, 3> color = this->getColorFromProperties(this->pipeline.particleList[this->pipeline.clusterList[cli].rootParticleID]);
+					this->pipeline.clusterList[cli].r = color.GetX();
+					this->pipeline.clusterList[cli].g = color.GetY();
+					this->pipeline.clusterList[cli].b = color.GetZ();
+
+					if (this->pipeline.clusterList[cli].rootParticleID < 0) { // Debug.
+						printf("Cl: %d.\n", this->pipeline.clusterList[cli].rootParticleID);
+					}
 				}
-			}
+			});
 			break;
 		case 1: // Random.
 		case 2: // Random.
 			//#pragma omp parallel for
-			for (int cli = 0; cli < this->clusterList.size(); ++cli) {
+			for (int cli = 0; cli < this->pipeline.clusterList.size(); ++cli) {
 				std::random_device rd;
 				std::mt19937_64 mt(rd()); // Runtime doesn't always like concurrency here (crashes), though it works in dummy list.
 				std::uniform_real_distribution<float> distribution(0, 1);
-				this->clusterList[cli].r = distribution(mt);
-				this->clusterList[cli].g = distribution(mt);
-				this->clusterList[cli].b = distribution(mt);
+				this->pipeline.clusterList[cli].r = distribution(mt);
+				this->pipeline.clusterList[cli].g = distribution(mt);
+				this->pipeline.clusterList[cli].b = distribution(mt);
 			}
 			break;
 		}
@@ -2610,31 +2556,32 @@ void mmvis_static::StructureEventsCalculation::setClusterColor(const bool renewC
 	///
 	/// Colourize particles.
 	///
-	#pragma omp parallel for
-	for (int pli = 0; pli < this->particleList.size(); ++pli) {
-		Particle* particle = &this->particleList[pli];
+	TaskPool::GetDefault()->ParallelFor(0, this->pipeline.particleList.size(), 16384, [this](size_t begin, size_t end, unsigned int) {
+		for (size_t pli = begin; pli < end; ++pli) {
+			Particle* particle = &this->pipeline.particleList[pli];
 
-		// Gas. Orange.
-		if (particle->clusterID == -1) {
-			particle->r = this->gasColor[0];
-			particle->g = this->gasColor[1];
-			particle->b = this->gasColor[2];
-			continue;
-		}
+			// Gas. Orange.
+			if (particle->clusterID == -1) {
+				particle->r = this->gasColor[0];
+				particle->g = this->gasColor[1];
+				particle->b = this->gasColor[2];
+				continue;
+			}
 
-		// Cluster.
-		particle->r = this->clusterList[particle->clusterID].r;
-		particle->g = this->clusterList[particle->clusterID].g;
-		particle->b = this->clusterList[particle->clusterID].b;
+			// Cluster.
+			particle->r = this->pipeline.clusterList[particle->clusterID].r;
+			particle->g = this->pipeline.clusterList[particle->clusterID].g;
+			particle->b = this->pipeline.clusterList[particle->clusterID].b;
 
-		/*
-		if (particle.r < 0) { // Debug wrong clusterPtr, points to nothing: ints = -572662307; floats = -1998397155538108400.000000 for all -> points to reallocated address!
-			debugBlackParticles++;
-			if (particle.id % 100 == 0)
-				printf("Part: %d, %d (%f, %f, %f).\n", this->clusterList[particle.clusterID].rootParticleID, this->clusterList[particle.clusterID].numberOfParticles, particle.r, particle.g, particle.b);
+			/*
+			if (particle.r < 0) { // Debug wrong clusterPtr, points to nothing: ints = -572662307; floats = -1998397155538108400.000000 for all -> points to reallocated address!
+				debugBlackParticles++;
+				if (particle.id % 100 == 0)
+					printf("Part: %d, %d (%f, %f, %f).\n", this->pipeline.clusterList[particle.clusterID].rootParticleID, this->pipeline.clusterList[particle.clusterID].numberOfParticles, particle.r, particle.g, particle.b);
+			}
+			*/
 		}
-		*/
-	}
+	});
 
 	///
 	/// Log output.
@@ -2644,13 +2591,13 @@ void mmvis_static::StructureEventsCalculation::setClusterColor(const bool renewC
 	auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now() - time_setClusterColor);
 	vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_INFO,
 		"SECalc output: Colorized %d clusters with (debug) %d black particles (%lld ms).",
-		this->clusterList.size(), debugBlackParticles, duration.count());
+		this->pipeline.clusterList.size(), debugBlackParticles, duration.count());
 	//this->logFile << debugBlackParticles << " black p.";
 }
 
 
 void mmvis_static::StructureEventsCalculation::setSignedDistanceColor(const float min, const float max) {
-	for (auto & element : this->particleList) {
+	for (auto & element : this->pipeline.particleList) {
 
 		float borderTolerance = 6 * element.radius;
 
@@ -2680,88 +2627,97 @@ void mmvis_static::StructureEventsCalculation::setSignedDistanceColor(const floa
 
 
 void mmvis_static::StructureEventsCalculation::setDummyLists(int particleAmount, int clusterAmount, int eventAmount) {
-	this->particleList.resize(particleAmount);
-	this->previousParticleList.resize(particleAmount);
-	this->clusterList.resize(clusterAmount);
-	this->previousClusterList.resize(clusterAmount);
-	this->structureEvents.resize(eventAmount); // Resets events, so if dummy is used in animation it resets the events.
+	this->pipeline.BeginFrame(this->frameId);
+	this->pipeline.particleList.resize(particleAmount);
+	this->pipeline.previousParticleList.resize(particleAmount);
+	this->pipeline.clusterList.resize(clusterAmount);
+	this->pipeline.previousClusterList.resize(clusterAmount);
+	std::vector<StructureEvents::StructureEvent> dummyEvents(eventAmount);
 
 	uint64_t numberOfParticlesInCluster = 0;
 
-	#pragma omp parallel for
+	// Sequential, the cluster sizes depend on the particles of the clusters before.
+	std::random_device rd;
+	std::mt19937_64 mt(rd());
 	for (int i = 0; i < clusterAmount; ++i) {
-		this->clusterList[i].id = i;
-		this->previousClusterList[i].id = i;
+		this->pipeline.clusterList[i].id = i;
+		this->pipeline.previousClusterList[i].id = i;
 
 		// Set number of particles.
 		uint64_t maxParticles = (particleAmount - numberOfParticlesInCluster) / clusterAmount;
-		std::random_device rd;
-		std::mt19937_64 mt(rd());
 		std::uniform_int_distribution<uint64_t> distribution(1, maxParticles);
-		this->clusterList[i].numberOfParticles = distribution(mt);
-		numberOfParticlesInCluster += this->clusterList[i].numberOfParticles;
+		this->pipeline.clusterList[i].numberOfParticles = distribution(mt);
+		numberOfParticlesInCluster += this->pipeline.clusterList[i].numberOfParticles;
 
-		uint64_t streuung = this->clusterList[i].numberOfParticles / 10;
-		std::uniform_int_distribution<uint64_t> distribution2(this->clusterList[i].numberOfParticles - streuung, this->clusterList[i].numberOfParticles + streuung);
-		this->previousClusterList[i].numberOfParticles = distribution2(mt);
+		uint64_t streuung = this->pipeline.clusterList[i].numberOfParticles / 10;
+		std::uniform_int_distribution<uint64_t> distribution2(this->pipeline.clusterList[i].numberOfParticles - streuung, this->pipeline.clusterList[i].numberOfParticles + streuung);
+		this->pipeline.previousClusterList[i].numberOfParticles = distribution2(mt);
 
 		// Set root particle.
 		std::uniform_int_distribution<uint64_t> distRoot(0, particleAmount - 1);
-		this->previousClusterList[i].rootParticleID = distRoot(mt);
-		this->clusterList[i].rootParticleID = distRoot(mt);
-	}
-
-	#pragma omp parallel for
-	for (int i = 0; i < particleAmount; ++i) {
-		this->particleList[i].id = i;
-		this->previousParticleList[i].id = i;
-
-		// Set cluster id.
-		std::random_device rd;
-		std::mt19937_64 mt(rd());
-		std::uniform_int_distribution<int> distribution(0, clusterAmount - 1);
-		this->particleList[i].clusterID = distribution(mt);
-
-		int streuung = 1;
-		std::uniform_int_distribution<int> distribution2(std::max(0, this->particleList[i].clusterID - streuung), std::min(clusterAmount - 1, this->particleList[i].clusterID + streuung));
-		this->previousParticleList[i].clusterID = distribution2(mt);
-
-		// Set position.
-		std::uniform_real_distribution<float> disPos(0, 500);
-		this->particleList[i].x = disPos(mt);
-		this->particleList[i].y = disPos(mt);
-		this->particleList[i].z = disPos(mt);
-	}
+		this->pipeline.previousClusterList[i].rootParticleID = distRoot(mt);
+		this->pipeline.clusterList[i].rootParticleID = distRoot(mt);
+	}
+
+	// One generator per range, seeded sequentially since random_device is not thread safe everywhere.
+	std::shared_ptr<TaskPool> pool = TaskPool::GetDefault();
+	std::mutex seedMutex;
+	auto nextSeed = [&rd, &seedMutex]() -> std::mt19937_64::result_type {
+		std::lock_guard<std::mutex> lock(seedMutex);
+		return rd();
+	};
+
+	pool->ParallelFor(0, static_cast<size_t>(std::max(particleAmount, 0)), 16384, [&](size_t begin, size_t end, unsigned int) {
+		std::mt19937_64 mt(nextSeed());
+		for (size_t i = begin; i < end; ++i) {
+			this->pipeline.particleList[i].id = i;
+			this->pipeline.previousParticleList[i].id = i;
+
+			// Set cluster id.
+			std::uniform_int_distribution<int> distribution(0, clusterAmount - 1);
+			this->pipeline.particleList[i].clusterID = distribution(mt);
+
+			int streuung = 1;
+			std::uniform_int_distribution<int> distribution2(std::max(0, this->pipeline.particleList[i].clusterID - streuung), std::min(clusterAmount - 1, this->pipeline.particleList[i].clusterID + streuung));
+			this->pipeline.previousParticleList[i].clusterID = distribution2(mt);
+
+			// Set position.
+			std::uniform_real_distribution<float> disPos(0, 500);
+			this->pipeline.particleList[i].x = disPos(mt);
+			this->pipeline.particleList[i].y = disPos(mt);
+			this->pipeline.particleList[i].z = disPos(mt);
+		}
+	});
 	
 	// Cluster event.
-	#pragma omp parallel for
-	for (int i = 0; i < eventAmount; ++i) {
-		std::random_device rd;
-		std::mt19937_64 mt(rd());
-		std::uniform_real_distribution<float> disPos(0, 100);
-		this->structureEvents[i].x = disPos(mt);
-		this->structureEvents[i].y = disPos(mt);
-		this->structureEvents[i].z = disPos(mt);
+	pool->ParallelFor(0, static_cast<size_t>(std::max(eventAmount, 0)), 16384, [&](size_t begin, size_t end, unsigned int) {
+		std::mt19937_64 mt(nextSeed());
+		for (size_t i = begin; i < end; ++i) {
+			std::uniform_real_distribution<float> disPos(0, 100);
+			dummyEvents[i].x = disPos(mt);
+			dummyEvents[i].y = disPos(mt);
+			dummyEvents[i].z = disPos(mt);
 
-		std::uniform_int_distribution<int> disTime(0, 140);
-		this->structureEvents[i].time = static_cast<float> (disTime(mt));
+			std::uniform_int_distribution<int> disTime(0, 140);
+			dummyEvents[i].time = static_cast<float> (disTime(mt));
 
-		std::uniform_int_distribution<int> disType(0, 3);
-		this->structureEvents[i].type = StructureEvents::getEventType(disType(mt));
-	}
+			std::uniform_int_distribution<int> disType(0, 3);
+			dummyEvents[i].type = StructureEvents::getEventType(disType(mt));
+		}
+	});
+
+	// Resets events, so if dummy is used in animation it resets the events.
+	this->structureEvents.Clear();
+	this->structureEvents.SetFrameEvents(this->frameId, dummyEvents);
 
 
 	///
 	/// Log output.
 	///
-	if (this->quantitativeDataOutputSlot.Param<param::BoolParam>()->Value()) {
+	if (this->settings.quantitativeDataOutput) {
 		this->logFile << "Skipped step 1 and step 2 since dummy list is set.\n";
-		this->csvLogFile << particleAmount << "; ";
-		for (int numberOfSkippedFields = 0; numberOfSkippedFields < 5; ++numberOfSkippedFields)
-			this->csvLogFile << "; ";
-		this->csvLogFile << clusterAmount << "; ";
-		for (int numberOfSkippedFields = 0; numberOfSkippedFields < 13; ++numberOfSkippedFields)
-			this->csvLogFile << "; ";
+		this->metrics.Set(FrameMetrics::PARTICLES, particleAmount);
+		this->metrics.Set(FrameMetrics::CLUSTERS, clusterAmount);
 	}
 
 	vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_INFO,
@@ -2774,25 +2730,20 @@ void mmvis_static::StructureEventsCalculation::writeSE(megamol::core::moldyn::Mu
 	///
 	/// Check availability.
 	///
-	vislib::TString filename(this->mmseFilenameSlot.Param<param::FilePathParam>()->Value());
+	vislib::TString filename(this->settings.mmseFilename);
 	if (filename.IsEmpty()) { // Avoids separate boolean to set output file.
 		vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_INFO,
 			"SECalc output: No MMSE file name specified. No file is written.");
 		return;
 	}
 
-	if (this->structureEvents.size() == 0) {
+	const StructureEventsStore& store = this->structureEvents.GetStore();
+	if (store.getCount() == 0) {
 		vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_ERROR,
 			"SECalc output: No event data. Abort MMSE writing.");
 		return;
 	}
 
-	if (vislib::sys::File::Exists(filename)) {
-		vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_WARN,
-			"SECalc output: File %s already exists and will be overwritten.",
-			vislib::StringA(filename).PeekBuffer());
-	}
-
 	vislib::math::Cuboid<float> bbox;
 	vislib::math::Cuboid<float> cbox;
 
@@ -2819,95 +2770,102 @@ void mmvis_static::StructureEventsCalculation::writeSE(megamol::core::moldyn::Mu
 	}
 	
 	///
-	/// Create file.
-	///
-	vislib::sys::FastFile file;
-	if (!file.Open(filename, vislib::sys::File::WRITE_ONLY, vislib::sys::File::SHARE_EXCLUSIVE, vislib::sys::File::CREATE_OVERWRITE)) {
-		vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_ERROR,
-			"SECalc output: Unable to create MMSE file \"%s\". Abort.",
-			vislib::StringA(filename).PeekBuffer());
-		return;
+	/// Write file, version 2 with one chunk per frame. The outputQueue writes
+	/// a copy of the events, so the next frame does not wait for the disk.
+	///
+	const StructureEvents::StructureEvent *storeEvents = store.getEvents();
+	const float maxTime = store.getMaxTime();
+	StructureEvents events;
+	events.setEvents(&storeEvents->x, &storeEvents->time, &storeEvents->type, maxTime, store.getCount());
+	store.setSideColumnsTo(events);
+	const bool withSideColumns = events.hasSideColumns();
+
+	///
+	/// Append only the events of the current frame to the open file.
+	///
+	const unsigned int compressionLevel = this->settings.mmseCompressionLevel;
+	bool append = false;
+	size_t offset = 0, count = 0;
+	if (this->mmseQueuedOpen && !this->mmseWriteFailed && this->mmseQueuedFilename == filename
+		&& this->mmseQueuedSideColumns == withSideColumns
+		&& this->mmseQueuedCompressionLevel == compressionLevel) {
+		std::map<unsigned int, size_t> frameCounts = this->mmseQueuedFrameCounts;
+		if (store.getFramePartition(this->frameId, offset, count))
+			frameCounts[this->frameId] = count;
+		size_t fileEventCount = 0;
+		for (auto & frame : frameCounts)
+			fileEventCount += frame.second;
+		if (fileEventCount == store.getCount()) {
+			append = true;
+			this->mmseQueuedFrameCounts.swap(frameCounts);
+		}
+	}
+
+	///
+	/// First frame, new file name or settings, or the file differs from the event list
+	/// (e.g. after a reset), so all frames are written to a new file.
+	///
+	if (!append) {
+		if (vislib::sys::File::Exists(filename)) {
+			vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_WARN,
+				"SECalc output: File %s already exists and will be overwritten.",
+				vislib::StringA(filename).PeekBuffer());
+		}
+		offset = 0;
+		count = store.getCount();
+		this->mmseQueuedOpen = true;
+		this->mmseQueuedFilename = filename;
+		this->mmseQueuedSideColumns = withSideColumns;
+		this->mmseQueuedCompressionLevel = compressionLevel;
+		this->mmseQueuedFrameCounts = store.getFrameCounts();
+		this->mmseWriteFailed = false;
+	}
+
+	if (count > 0) {
+		std::shared_ptr<const EventsSnapshot> snapshot = std::make_shared<const EventsSnapshot>(
+			storeEvents, events.getSideColumns(), offset, count, maxTime);
+		MMSEAppendWriter *writer = &this->mmseWriter;
+		std::atomic<bool> *failed = &this->mmseWriteFailed;
+		this->outputQueue.Push([snapshot, writer, failed, append, filename, withSideColumns, compressionLevel, bbox, cbox]() {
+			StructureEvents snapshotEvents;
+			snapshot->setTo(snapshotEvents);
+			if (!(append || writer->Open(vislib::StringA(filename).PeekBuffer(), withSideColumns, compressionLevel))
+				|| !writer->Append(snapshotEvents, bbox.PeekBounds(), cbox.PeekBounds(), snapshot->maxTime)) {
+				writer->Close();
+				*failed = true; // The next frame rewrites the file.
+				vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_ERROR,
+					"SECalc output: Unable to write MMSE file \"%s\".",
+					vislib::StringA(filename).PeekBuffer());
+			}
+		}, snapshot->getBytes());
 	}
 
-#define ASSERT_WRITEOUT(A, S) if (file.Write((A), (S)) != (S)) { \
-        vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_ERROR, "Write SE: Write error %d", __LINE__); \
-        file.Close(); \
-        return; \
-		    }
-
-	///
-	/// Set header.
-	///
-	vislib::StringA magicID("MMSE");
-	ASSERT_WRITEOUT(magicID.PeekBuffer(), 4); // Only works with 4.
-	ASSERT_WRITEOUT(bbox.PeekBounds(), 6 * 4); // 6 * float.
-	ASSERT_WRITEOUT(cbox.PeekBounds(), 6 * 4); // 6 * float.
-
-	///
-	/// Header continued.
-	///
-	uint64_t eventCnt = this->structureEvents.size();
-	ASSERT_WRITEOUT(&eventCnt, 8);
-	float maxTime = this->seMaxTimeCache;
-	ASSERT_WRITEOUT(&maxTime, 4);
-
-	///
-	/// Daten.
-	///
-	unsigned int eventStride = sizeof(StructureEvents::StructureEvent);
-	const void *startPtr = &this->structureEvents.front().x; // Start of the eventdata.
-	ASSERT_WRITEOUT(startPtr, eventStride * eventCnt);
-
-	vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_INFO, "SECalc output: %d events written, maxTime %f.", eventCnt, this->seMaxTimeCache);
-
-	file.Close();
-
-#undef ASSERT_WRITEOUT
+	vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_INFO, "SECalc output: %d of %d events queued for writing, maxTime %f.",
+		static_cast<int>(count), static_cast<int>(store.getCount()), store.getMaxTime());
 }
 
 
-mmvis_static::StructureEventsCalculation::MeanStdDev
-mmvis_static::StructureEventsCalculation::meanStdDeviation(std::vector<double> v) {
-	double sum = std::accumulate(v.begin(), v.end(), 0.0);
-	double mean = sum / v.size();
-	
-	std::vector<double> diff(v.size());
-	std::transform(v.begin(), v.end(), diff.begin(),
-		std::bind2nd(std::minus<double>(), mean));
-	double sq_sum = std::inner_product(diff.begin(), diff.end(), diff.begin(), 0.0);
-	double stdev = std::sqrt(sq_sum / v.size());
-	
-	MeanStdDev md;
-	md.mean = mean;
-	md.deviation = stdev;
-	return md;
-}
-
+void mmvis_static::StructureEventsCalculation::writeMetrics(void) {
+	vislib::StringA label(this->settings.outputLabel);
+	std::string labelStr = label.PeekBuffer();
+	std::string filename = "SECalc" + (labelStr.empty() ? std::string() : " " + labelStr);
 
-const int mmvis_static::StructureEventsCalculation::getKDTreeMaxNeighbours(const int radiusMultiplier) {
-	int maxNeighbours = 0;
-	switch (radiusMultiplier){
-	case 2: // Not tested, so using safe maxNeighbours amount.
-	case 3: // Not tested, so using safe maxNeighbours amount.
-	case 4:
-		maxNeighbours = 35;
-		break;
-	case 5:
-		maxNeighbours = 60;
-		break;
-	case 6:
-		maxNeighbours = 100;
-		break;
-	case 7:
-		maxNeighbours = 155;
-		break;
-	case 8: // Not tested, so using safe maxNeighbours amount.
-	case 9: // Not tested, so using safe maxNeighbours amount.
-	case 10:
-		maxNeighbours = 425;
-		break;
+	AsyncOutputFile metricsFile(this->outputQueue);
+	if (this->settings.metricsFormat == 1) {
+		filename += ".secm";
+		metricsFile.open(filename.c_str(), std::ios_base::app | std::ios_base::binary);
+		if (this->outputQueue.IsNewFile(filename))
+			this->metrics.WriteBinaryHeader(metricsFile, labelStr);
+		this->metrics.WriteBinary(metricsFile);
+	}
+	else {
+		filename += ".csv";
+		metricsFile.open(filename.c_str(), std::ios_base::app);
+		if (this->outputQueue.IsNewFile(filename))
+			this->metrics.WriteCSVHeader(metricsFile);
+		this->metrics.WriteCSV(metricsFile, labelStr);
 	}
-	return maxNeighbours;
+	metricsFile.close();
 }
 
 
@@ -3022,7 +2980,7 @@ void mmvis_static::StructureEventsCalculation::sortBySignedDistance() {
 	///
 	auto time_sortList = std::chrono::system_clock::now();
 
-	std::sort(this->particleList.begin(), this->particleList.end(), [](const Particle& lhs, const Particle& rhs) {
+	std::sort(this->pipeline.particleList.begin(), this->pipeline.particleList.end(), [](const Particle& lhs, const Particle& rhs) {
 		return lhs.signedDistance > rhs.signedDistance;
 	});
 
@@ -3034,7 +2992,7 @@ void mmvis_static::StructureEventsCalculation::sortBySignedDistance() {
 
 void mmvis_static::StructureEventsCalculation::findNeighboursBySignedDistance() {
 	uint64_t counter = 0;
-	for (auto & particle : this->particleList) {
+	for (auto & particle : this->pipeline.particleList) {
 		if (particle.signedDistance < 0)
 			continue; // Skip gas.
 
@@ -3043,7 +3001,7 @@ void mmvis_static::StructureEventsCalculation::findNeighboursBySignedDistance()
 		if (counter % 10000 == 0)
 			printf("Particle %d: Distance %f +/- %f. Position (%f, %f, %f). \n", particle.id, particle.signedDistance, signedDistanceRange, particle.x, particle.y, particle.z);
 
-		for (auto & neighbour : this->particleList) {
+		for (auto & neighbour : this->pipeline.particleList) {
 			if (neighbour.signedDistance <= particle.signedDistance - signedDistanceRange)
 				break; // Leave loop since list is sorted by Signed Distance and lower particle are not of interest.
 
@@ -3091,7 +3049,7 @@ void mmvis_static::StructureEventsCalculation::createClustersSignedDistanceOnly(
 	uint64_t listIteration = 0;
 
 	// Naive cluster detection.
-	for (auto & particle : this->particleList) {
+	for (auto & particle : this->pipeline.particleList) {
 		// Gas particle doesnt need to be in a cluster.
 		if (particle.signedDistance < 0)
 			continue;
@@ -3109,10 +3067,10 @@ void mmvis_static::StructureEventsCalculation::createClustersSignedDistanceOnly(
 		}
 
 		// Put the particle in the first cluster in range.
-		for (auto cluster : this->clusterList) {
+		for (auto cluster : this->pipeline.clusterList) {
 			// Find particle in list
 			uint64_t rootParticleID = cluster.rootParticleID;
-			std::vector<Particle>::iterator particleListIterator = std::find_if(this->particleList.begin(), this->particleList.end(), [rootParticleID](const Particle& p) -> bool {
+			std::vector<Particle>::iterator particleListIterator = std::find_if(this->pipeline.particleList.begin(), this->pipeline.particleList.end(), [rootParticleID](const Particle& p) -> bool {
 				return true; // return p.id == rootParticleID;
 			});
 			if (isInSameComponent(*particleListIterator, particle)) {
@@ -3161,7 +3119,7 @@ mmvis_static::StructureEventsCalculation::Particle
 mmvis_static::StructureEventsCalculation::_getParticle (const uint64_t particleID) const {
 	auto time_getParticle = std::chrono::system_clock::now();
 
-	for (auto & particle : this->particleList) {
+	for (auto & particle : this->pipeline.particleList) {
 		if (particle.id == particleID) {
 
 			// Time measurement.
@@ -3178,7 +3136,7 @@ mmvis_static::StructureEventsCalculation::Cluster*
 mmvis_static::StructureEventsCalculation::_getCluster(const uint64_t rootParticleID) const {
 	auto time_getCluster = std::chrono::system_clock::now();
 
-	for (auto &cluster : this->clusterList) {
+	for (auto &cluster : this->pipeline.clusterList) {
 		if (cluster.rootParticleID == rootParticleID) {
 
 			// Time measurement.
@@ -18,7 +18,24 @@
 #include "mmcore/Module.h"
 #include "mmcore/moldyn/MultiParticleDataCall.h"
 #include "mmcore/param/ParamSlot.h"
+#include "AsyncOutputQueue.h"
+#include "ClusterCacheFile.h"
+#include "ClusterComparisonDump.h"
+#include "FrameMetrics.h"
+#include "FrameResultCache.h"
+#include "LatestJobWorker.h"
+#include "MMSEAppendWriter.h"
 #include "StructureEventsDataCall.h"
+#include "StructureEventsPipeline.h"
+#include "StructureEventsPublisher.h"
+#include "StructureEventsStore.h"
+
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 // File operations.
 #include <fstream>
@@ -28,6 +45,7 @@
 namespace megamol {
 	namespace mmvis_static {
 		///
+		/// Adapter of the StructureEventsPipeline to MegaMol.
 		/// Calculates Structure Events in several steps:
 		/// 1) Getting the neighbours of each particle.
 		/// 2) Creating clusters by using these neighbours.
@@ -37,6 +55,14 @@ namespace megamol {
 		/// Outputs the events to SEDC.
 		/// Outputs the clusters by coloring the particles to MPDC.
 		///
+		/// In the asynchronous mode the calculation runs on a worker thread.
+		/// The calls get copies of the last finished frame meanwhile, a frame
+		/// requested while another one waits for the worker replaces it.
+		///
+		/// With speculation, steps 1 and 2 of the frame after the requested one
+		/// run in the background, as soon as the source has it. The next frame
+		/// takes the clusters if frame, data hash and parameters match.
+		///
 		/// Detailed steps:
 		/// 1) a) Build particle list from MPDC.
 		///    b) Create kD tree for neighbour detection.
@@ -62,6 +88,9 @@ namespace megamol {
 		/// --------------------------
 		/// - ANN not parallelizeable: http://stackoverflow.com/a/2182357
 		///
+		/// - the parallel loops of all stages run on the work-stealing TaskPool instead of OpenMP,
+		///   its thread count is set by TaskPool::threads
+		///
 		/// - lack of usage of OpenMP in for loops:
 		///   http://stackoverflow.com/questions/17848521/using-openmp-with-c11-range-based-for-loops
 		///   - OpenMP doesn't like break and should have predefined size (push_back is not thread safe)
@@ -85,319 +114,22 @@ namespace megamol {
 		class StructureEventsCalculation : public core::Module {
 		public:
 
-			struct MeanStdDev {
-				double mean = 0;
-				double deviation = 0;
-			};
-
-			struct Cluster;
+			/// Data types of the pipeline.
+			typedef StructureEventsPipeline::Particle Particle;
+			typedef StructureEventsPipeline::Cluster Cluster;
+			typedef StructureEventsPipeline::PartnerClusters PartnerClusters;
+			typedef StructureEventsPipeline::PartnerClustersList PartnerClustersList;
 
 			///
-			/// Dichtgepacktes struct.
-			/// It is important that no automatic padding is inserted by compiler
-			/// therefore all datatypes have sizes of 4 or 8.
-			///
-			/// MPDC data types: FLOAT_XYZR, FLOAT_RGB.
-			/// Stride = (4 byte * (4 + 3 + 1)) + 8 byte + Cluster + Neighbours.
+			/// Event amounts of one grid point of the threshold sweep.
+			/// Merge/split depend on msMinCPPercentage and msMinClusterAmount,
+			/// birth/death on bdMaxCPPercentage only.
 			///
-			struct Particle {
-				float x, y, z, radius;
-				float r, g, b;
-				float signedDistance;
-				uint64_t id;
-
-				// Store a pointer to the cluster. Bad when cluster is moved in memory.
-				//Cluster* clusterPtr = NULL;
-				// Store the cluster id. Save when cluster list is moved in memory.
-				int clusterID = -1;
-
-				// Store pointer to the neighbours. Bad when they are moved in memory.
-				//std::vector<Particle*> neighbourPtrs;
-				// Store ids of the neighbours. Save when particle list is moved in memory.
-				std::vector<uint64_t> neighbourIDs;
-
-				// Copy & store neighbour directly to avoid costly
-				// list search everytime we need a neighbour.
-				// Doesn't work, takes way too much memory!
-				// std::vector<Particle> neighbours;
-
-				Particle() : clusterID(-1) {}
-
-				// This constructor wastes memory and takes a lot of time.
-				Particle(int radiusModifier) : clusterID(-1) {
-					// The compiler should set vector reservation since the vector
-					// is stored at a different location in memory than the struct.
-					neighbourIDs.reserve(StructureEventsCalculation::getKDTreeMaxNeighbours(radiusModifier));
-				}
-
-				bool operator==(const Particle& rhs) const {
-					return this->id == rhs.id;
-				}
-			};
-
-			struct Cluster {
-				uint64_t rootParticleID;
-				uint64_t numberOfParticles = 0;
-				int id;
-				float r, g, b = 0; // For visualization.
-
-				bool operator==(const Cluster& rhs) const {
-					return this->id == rhs.id;
-				}
-			};
-
-			class PartnerClusters {
-			public:
-				struct PartnerCluster {
-					Cluster cluster;
-					int commonParticles = 0;
-					bool isGasCluster = false;
-
-					//PartnerClusters &parent;  // Reference to parent
-					//PartnerCluster(PartnerClusters &ccs) : parent(ccs) {}  // Initialise reference in constructor
-
-					/// Common percentage with this (partner) cluster.
-					double getCommonPercentage() {
-						return (static_cast<float> (this->commonParticles) / static_cast<float> (this->cluster.numberOfParticles)) * 100;
-					}
-
-					/// Common percentage with parent cluster.
-					double getClusterCommonPercentage(const Cluster& c) {
-						return (static_cast<float> (this->commonParticles) / static_cast<float> (c.numberOfParticles)) * 100;
-					}
-					/*
-					PartnerCluster operator=(const PartnerCluster& rhs) {
-						//PartnerCluster cc(rhs.parent);
-						cc.cluster = rhs.cluster;
-						cc.commonParticles = rhs.commonParticles;
-						return cc;
-					}
-					*/
-					bool operator==(const PartnerCluster& rhs) const {
-						return this->cluster == rhs.cluster;
-					}
-
-					//bool operator<(const PartnerCluster& rhs) const {
-					//	return this->commonParticles > rhs.commonParticles;
-					//}
-				};
-			private:
-				std::vector<PartnerCluster> partners;
-				//std::multimap<int, PartnerCluster, std::greater<int>> partners; // Highest int first.
-				int minCommonParticles = -1;
-				int maxCommonParticles = -1;
-				int totalCommonParticles = 0;
-				double minCommonPercentage = -1.f;
-				double maxCommonPercentage = -1.f;
-				double totalCommonPercentage = -1.f;
-
-			public:
-				Cluster cluster;
-				void addPartner(Cluster newCluster, int commonParticles) {
-					PartnerCluster PartnerCluster;
-					PartnerCluster.cluster = newCluster;
-					PartnerCluster.commonParticles = commonParticles;
-					this->partners.push_back(PartnerCluster);
-					//this->partners.insert(std::pair<int, PartnerCluster> (commonParticles, PartnerCluster));
-
-					
-					totalCommonParticles += commonParticles;
-
-					// Max and min.
-					if (minCommonParticles < 0 || minCommonParticles > commonParticles)
-						minCommonParticles = commonParticles;
-					if (maxCommonParticles < 0 || maxCommonParticles < commonParticles)
-						maxCommonParticles = commonParticles;
-					if (minCommonPercentage < 0 || minCommonPercentage > PartnerCluster.getClusterCommonPercentage(this->cluster))
-						minCommonPercentage = PartnerCluster.getClusterCommonPercentage(this->cluster);
-					if (maxCommonPercentage < 0 || maxCommonPercentage < PartnerCluster.getClusterCommonPercentage(this->cluster))
-						maxCommonPercentage = PartnerCluster.getClusterCommonPercentage(this->cluster);
-				}
-
-				void addPartner(Cluster newCluster, int commonParticles, bool gasCluster) {
-					if (gasCluster) {
-						PartnerCluster PartnerCluster;
-						PartnerCluster.cluster = newCluster;
-						PartnerCluster.commonParticles = commonParticles;
-						PartnerCluster.isGasCluster = true;
-					}
-					else
-						this->addPartner(newCluster, commonParticles);
-				}
-
-				void sortPartners() {
-					std::sort(this->partners.begin(), this->partners.end(), [](const PartnerCluster& lhs, const PartnerCluster& rhs) {
-						return (lhs.commonParticles > rhs.commonParticles);
-					});
-				}
-
-				PartnerCluster getPartner(const int partnerPosition) const {
-					return this->partners[partnerPosition];
-				}
-
-				/// Amount of partner clusters with ClusterCommonPercentage / TotalCommonPercentage >= percentage %.
-				/// Previous->current: For possible split detection, not optimal for big clusters.
-				/// Current->previous: For possible merge detection, not optimal for big clusters.
-				int getBigPartnerAmount(const double percentage) const {
-					if (this->getTotalCommonPercentage() == 0)
-						return -1; // It's so 90s.
-
-					int count = 0;
-					double ratio = percentage / 100;
-					for (auto partner : this->partners) {
-						if (partner.getClusterCommonPercentage(this->cluster) / this->getTotalCommonPercentage() >= ratio)
-							count++;
-					}
-					return count;
-				}
-
-				/// Amount of partner clusters with ClusterCommonPercentage / TotalCommonPercentage <= percentage %.
-				/// For noise detection.
-				int getSmallPartnerAmount(const double percentage) const {
-					if (this->getTotalCommonPercentage() == 0)
-						return -1; // It's so 90s.
-
-					int count = 0;
-					double ratio = percentage / 100;
-					for (auto partner : this->partners) {
-						if (partner.getClusterCommonPercentage(this->cluster) / this->getTotalCommonPercentage() <= ratio)
-							count++;
-					}
-					return count;
-				}
-
-				/// Average number of common particles. 
-				/// For similar cluster detection.
-				/// For noise detection.
-				double getAveragePartnerCommonPercentage() const {
-					return this->getTotalCommonPercentage() / static_cast<double>(this->partners.size());
-				}
-
-				/// Common particle to cluster size ratio.
-				/// Previous->current: For shrink detection. For death detection.
-				/// Current->previous: For growth detection. For birth detection.
-				double getTotalCommonPercentage() const {
-					if (this->totalCommonPercentage < 0)
-						return (static_cast<float> (this->totalCommonParticles) / static_cast<float> (this->cluster.numberOfParticles)) * 100;
-					return this->totalCommonPercentage;
-				}
-
-				/// Ratio of common particles of the biggest partner to common particle ratio of this cluster.
-				/// For similar cluster detection.
-				double getLocalMaxTotalPercentage() const { // Name props to Andreas.
-					if (this->getTotalCommonPercentage() == 0)
-						return -1; // It's so 90s.
-
-					return (this->maxCommonPercentage / this->getTotalCommonPercentage()) * 100;
-				}
-
-				/// For similar cluster detection.
-				/// For noise detection.
-				/// For birth detection (backwards).
-				/// For death detection (forward).
-				int getNumberOfPartners() const {
-					return static_cast<int> (partners.size());
-				}
-
-				int getMinCommonParticles() const {
-					return this->minCommonParticles;
-				}
-
-				int getMaxCommonParticles() const {
-					return this->maxCommonParticles;
-				}
-
-				int getTotalCommonParticles() const {
-					return this->totalCommonParticles;
-				}
-
-				double getMinCommonPercentage() const {
-					return this->minCommonPercentage;
-				}
-
-				double getMaxCommonPercentage() const {
-					return this->maxCommonPercentage;
-				}
-
-				bool hasPartnerCluster(int clusterID) const {
-					auto it = std::find_if(this->partners.begin(), this->partners.end(), [clusterID](const PartnerCluster& pc) -> bool {
-						return pc.cluster.id == clusterID;
-					});
-					if (it != partners.end())
-						return true;
-					else
-						return false;
-				}
-			};
-
-			///
-			/// Container to hold both comparison lists w/o own global values.
-			/// Provides methods to access extrema or search in both lists.
-			///
-			class PartnerClustersList {
-			private:
-			public:
-				std::vector<PartnerClusters> forwardList;
-				std::vector<PartnerClusters> backwardsList;
-
-				enum class Direction : int {
-					forward,
-					backwards
-				};
-
-				PartnerClusters getMaxPercentage(Direction direction = Direction::forward) {
-					std::vector<PartnerClusters>* list;
-					if (direction == Direction::backwards)
-						list = &this->backwardsList;
-					else
-						list = &this->forwardList;
-					auto it = std::max_element(list->begin(), list->end(), [](const PartnerClusters& lhs, const PartnerClusters& rhs) {
-						return lhs.getTotalCommonPercentage() < rhs.getTotalCommonPercentage();
-					});
-					return *it;
-				}
-
-				PartnerClusters getMinPercentage(Direction direction = Direction::forward) {
-					std::vector<PartnerClusters>* list;
-					if (direction == Direction::backwards)
-						list = &this->backwardsList;
-					else
-						list = &this->forwardList;
-					auto it = std::min_element(list->begin(), list->end(), [](const PartnerClusters& lhs, const PartnerClusters& rhs) {
-						return lhs.getTotalCommonPercentage() < rhs.getTotalCommonPercentage();
-					});
-					return *it;
-				}
-
-				PartnerClusters* getPartnerClusters(int clusterId, Direction direction = Direction::forward) {
-					std::vector<PartnerClusters>* list;
-					if (direction == Direction::backwards)
-						list = &this->backwardsList;
-					else
-						list = &this->forwardList;
-					std::vector<PartnerClusters>::iterator it = std::find_if(list->begin(), list->end(), [clusterId](const PartnerClusters& p) -> bool {
-						return p.cluster.id == clusterId;
-					});
-					if (it == list->end())
-						return NULL;
-					return static_cast<PartnerClusters*>(&(*it));
-				}
-
-				/// List of PartnerClusters who contains the clusterid as parent.
-				/// @param direction Direction of the cluster whos clusterId is given.
-				std::vector<PartnerClusters*> getParentPartnerClusters(int clusterId, Direction directionOfGivenCluster = Direction::forward) {
-					std::vector<PartnerClusters>* parentList;
-					std::vector<PartnerClusters*> returnList;
-					if (directionOfGivenCluster == Direction::backwards)
-						parentList = &this->forwardList;
-					else
-						parentList = &this->backwardsList;
-					for (auto partnerClusters : *parentList) {
-						if (partnerClusters.hasPartnerCluster(clusterId))
-							returnList.push_back(&partnerClusters);
-					}
-					return returnList;
-				}
+			struct SweepPoint {
+				float msMinCPPercentage;
+				int msMinClusterAmount;
+				float bdMaxCPPercentage;
+				int eventAmount[4]; // 0 := Birth, 1 := Death, 2 := Merge, 3 := Split.
 			};
 
 			/**
@@ -435,6 +167,80 @@ namespace megamol {
 
 		private:
 
+			///
+			/// Values of the slots a calculation uses, taken on the thread of the
+			/// calls. The worker of the asynchronous mode must not read the slots.
+			///
+			struct CalculationSettings {
+				StructureEventsPipeline::Parameters parameters; // Without the bounding box.
+				int clusterColoring;
+				bool createDummyTestData;
+				bool speculation;
+
+				/// Output.
+				bool quantitativeDataOutput;
+				vislib::StringA outputLabel;
+				int metricsFormat;
+				int comparisonFormat;
+				vislib::TString mmseFilename;
+				unsigned int mmseCompressionLevel;
+
+				/// Threshold grids of the sweep.
+				std::vector<float> sweepMsMinCPPercentages;
+				std::vector<float> sweepMsMinClusterAmounts;
+				std::vector<float> sweepBdMaxCPPercentages;
+
+				/// Cluster cache, changed if the MMSC file has to be opened again.
+				int clusterCacheMode;
+				vislib::TString clusterCacheFilename;
+				bool clusterCacheChanged;
+
+				/// Result cache and TaskPool, only applied if changed.
+				size_t resultCacheCapacity;
+				bool resultCacheCapacityChanged;
+				unsigned int taskPoolThreads;
+				bool taskPoolThreadsChanged;
+
+				CalculationSettings(void) : clusterColoring(0), createDummyTestData(false), speculation(false),
+					quantitativeDataOutput(false), metricsFormat(0), comparisonFormat(0), mmseCompressionLevel(0),
+					clusterCacheMode(0), clusterCacheChanged(false),
+					resultCacheCapacity(FrameResultCache::DEFAULT_CAPACITY), resultCacheCapacityChanged(false),
+					taskPoolThreads(0), taskPoolThreadsChanged(false) {}
+			};
+
+			/// Copy of the incoming data for the asynchronous calculation.
+			struct FrameRequest {
+				unsigned int frameId;
+				size_t dataHash;
+				core::moldyn::MultiParticleDataCall data; // Particle lists point into the buffers.
+				std::vector<std::vector<uint8_t>> vertexBuffers;
+				std::vector<std::vector<uint8_t>> colourBuffers;
+				CalculationSettings settings;
+				bool calculateFrame;
+				bool reCalculateSE;
+				bool reSweep;
+
+				FrameRequest(void) : frameId(0), dataHash(0), calculateFrame(false), reCalculateSE(false), reSweep(false) {}
+			};
+
+			/// Finished frame of the asynchronous calculation, owned by the calls.
+			struct FrameResult {
+				unsigned int frameId;
+				size_t dataHash;
+				std::vector<float> particleData; // x, y, z, radius, r, g, b of each particle.
+				core::moldyn::MultiParticleDataCall::Particles particles;
+				std::shared_ptr<const StructureEventsStore> structureEvents; // Shared with later results, not changed.
+				size_t sedcHash;
+			};
+
+			/// Steps 1 and 2 of a frame calculated ahead of time.
+			struct SpeculativeFrame {
+				unsigned int frameId;
+				size_t dataHash;
+				StructureEventsPipeline::Parameters parameters;
+				std::unique_ptr<StructureEventsPipeline> pipeline; // NULL while calculated.
+			};
+
 			/**
 			 * Implementation of 'Create'.
 			 *
@@ -495,6 +301,88 @@ namespace megamol {
 			/// Writes the data from a single MultiParticleDataCall frame into particleList.			 
 			void setData(core::moldyn::MultiParticleDataCall& data);
 
+			/// Recalculates step 4 and the threshold sweep for changed slots.
+			void updateStructureEvents(const bool reCalculateSE, const bool reSweep);
+
+			///
+			/// Takes the values of the slots for a calculation, only on the
+			/// thread of the calls. Resets the dirty flags of the slots that are
+			/// applied once, the settings are flagged as changed instead.
+			///
+			CalculationSettings getCalculationSettings(void);
+
+			/// Makes the settings those of the calculation, applies the changed result cache, TaskPool and cluster cache.
+			void applySettings(const CalculationSettings& settings);
+
+			/// Key of the result cache for the frame of the current data and settings.
+			FrameResultCache::Key getResultCacheKey(const unsigned int frameID);
+
+			///
+			/// Sets the previous lists of the pipeline to frame t-1 of the key,
+			/// from the lists of the last calculated frame or from the result
+			/// cache. Clears them if frame t-1 is not available.
+			///
+			void setTruePreviousFrame(const FrameResultCache::Key& key);
+
+			/// Stores the current frame in the result cache, if the lists have a key.
+			void storeResult(void);
+
+			///
+			/// Asynchronous mode: queues the calculation for the worker. The
+			/// incoming data is copied if calculateFrame, the source may free it
+			/// after the call. Merges with the request that waits for the worker.
+			///
+			void requestCalculation(core::moldyn::MultiParticleDataCall& inData, const CalculationSettings& settings,
+				const bool calculateFrame, const bool reCalculateSE, const bool reSweep);
+
+			/// Asynchronous mode: job of the worker, calculates the waiting request and publishes the result.
+			void calculateRequest(void);
+
+			/// Asynchronous mode: copies the particles and publishes the events for the calls.
+			void publishResult(void);
+
+			/// Asynchronous mode: drops the waiting request and waits for the worker.
+			void stopCalculation(void);
+
+			/// Copies the particle lists the calculation uses into the request.
+			static void copyParticleData(core::moldyn::MultiParticleDataCall& inData, FrameRequest& request);
+
+			///
+			/// Speculation: requests the frame after the one in inData from the
+			/// source, without forcing it. If the source has it, steps 1 and 2
+			/// run on a copy in the background. Called after the data has been
+			/// served, the source is set back to the served frame afterwards.
+			///
+			void speculateNextFrame(core::moldyn::MultiParticleDataCall& inData);
+
+			/// Speculation: requests the served frame again without forcing it, so other users of the source see it if it is still loaded.
+			void restoreServedFrame(core::moldyn::MultiParticleDataCall& inData, const unsigned int servedFrameId);
+
+			/// Speculation: job of the speculationWorker.
+			void calculateSpeculation(std::shared_ptr<FrameRequest> request, const StructureEventsPipeline::Parameters parameters);
+
+			///
+			/// Replaces steps 1b and 2 of the current frame by the speculative
+			/// clusters, waits if they are still calculated.
+			/// @return False if the clusters have to be calculated.
+			///
+			bool adoptSpeculativeClusters(core::moldyn::MultiParticleDataCall& data);
+
+			/// Pipeline parameters from the slots, without the bounding box. Only on the thread of the calls.
+			StructureEventsPipeline::Parameters getSlotPipelineParameters(void);
+
+			/// Pipeline parameters of the calculation, without the bounding box.
+			StructureEventsPipeline::Parameters getPipelineParameters(void);
+
+			/// Pipeline parameters of the calculation and the bounding box of the data.
+			StructureEventsPipeline::Parameters getPipelineParameters(core::moldyn::MultiParticleDataCall& data);
+
+			/// Sets the bounding box of the data for the periodic boundary condition.
+			static void setBoundingBox(core::moldyn::MultiParticleDataCall& data, StructureEventsPipeline::Parameters& parameters);
+
+			/// Passes the messages of the pipeline to the log.
+			void logPipelineMessage(const StructureEventsPipeline::LogLevel level, const std::string& message);
+
 			/// Build the particle list from the call.
 			void buildParticleList(core::moldyn::MultiParticleDataCall& data,
 				uint64_t& globalParticleIndex, float& globalRadius, uint8_t (&globalColor)[4], float& globalColorIndexMin, float& globalColorIndexMax);
@@ -511,6 +399,24 @@ namespace megamol {
 			/// Merge small clusters into bigger ones.
 			void mergeSmallClusters();
 
+			///
+			/// Replaces steps 1b and 2 by the cluster assignment of the current
+			/// frame from the MMSC file, if the cache is read and has the frame
+			/// with the same particles and settings.
+			/// @return False if the clusters have to be calculated.
+			///
+			bool loadClusterCache();
+
+			/// Writes the cluster assignment of the current frame to the MMSC file, if the cache is written.
+			void storeClusterCache();
+
+			/// Opens the MMSC file for the cluster cache mode of the settings.
+			/// @return False if the cache is not used or can not be opened.
+			bool openClusterCache();
+
+			/// Settings of steps 1 and 2 that a cached cluster assignment depends on.
+			ClusterCacheFile::Settings getClusterCacheSettings();
+
 			///
 			/// SECC: Structure Event Cluster Comparison.
 			/// Compares clusters of two frames.
@@ -520,6 +426,19 @@ namespace megamol {
 			/// Using heuristic to set the StructureEvents.
 			void determineStructureEvents();
 
+			/// Replaces the events of the current frame in the store and flags the SEDC as changed.
+			void setFrameEvents(const std::vector<StructureEventsPipeline::Event>& events);
+
+			///
+			/// Counts the structure events of every point of the threshold grid
+			/// in one pass over the partner lists, without creating events.
+			/// Writes the amounts of the current frame and of all frames so far.
+			///
+			void sweepStructureEventThresholds();
+
+			/// Parses a semicolon separated list of numbers, invalid entries are skipped.
+			static std::vector<float> parseSweepGrid(const char *values);
+
 			/// Set colour of particles based on cluster assignment.
 			void setClusterColor(bool renewClusterColors);
 
@@ -532,32 +451,20 @@ namespace megamol {
 			/// Supplements the writer; for jobs where the MMPLD Writer has to be called.
 			void writeSE(megamol::core::moldyn::MultiParticleDataCall& data);
 
-			/// Mean value and standard deviation of values: http ://stackoverflow.com/a/7616783/4566599
-			MeanStdDev meanStdDeviation(std::vector<double> v);
+			/// Appends the metrics of the frame to the metrics file of the label.
+			void writeMetrics(void);
 
 			/// Returns a color depending on particle properties.
 			/// Move to HSV in future.
 			/// @return A color 3-vector with values [0..1]
 			const vislib::math::Vector<float, 3> getColorFromProperties(const Particle &p);
 
-			///
-			/// Returns minimal maxNeighbours for radius so no particle in radius gets excluded.
-			/// Determined by experiments:
-			///
-			/// radiusMultiplier, maxNeighbours
-			/// 4, 35 <- causes zero signed distance one size clusters phenomenon 
-			/// 5, 60 <- causes zero signed distance one size clusters phenomenon 
-			/// 6, 100
-			/// 7, 155
-			/// 10, 425
-			/// 20, 3270
-			///
-			static const int getKDTreeMaxNeighbours(const int radiusMultiplier);
+			/// Writer thread of the log, CSV and MMSE files, declared before the files using it.
+			AsyncOutputQueue outputQueue;
 
-			/// Files.
-			std::ofstream logFile;
-			std::ofstream csvLogFile;
-			std::ofstream debugFile;
+			/// Files, written by the outputQueue on close.
+			AsyncOutputFile logFile;
+			AsyncOutputFile debugFile;
 
 			/// The call for incoming data.
 			core::CallerSlot inDataSlot;
@@ -572,6 +479,12 @@ namespace megamol {
 			/// Switch the calculation on/off (once started it will last until finished).
 			core::param::ParamSlot calculationActiveSlot;
 
+			/// Calculate on a worker thread, the calls get the last finished frame meanwhile.
+			core::param::ParamSlot asynchronousSlot;
+
+			/// Calculate steps 1 and 2 of the next frame in the background.
+			core::param::ParamSlot speculationSlot;
+
 			/// Creates random previous and current data. For I/O tests. Skips steps 1 and 2.
 			core::param::ParamSlot createDummyTestDataSlot;
 
@@ -581,9 +494,18 @@ namespace megamol {
 			/// Switch for creating log files and those with quantitative data.
 			core::param::ParamSlot quantitativeDataOutputSlot;
 
+			/// Format of the metrics file, CSV or binary.
+			core::param::ParamSlot metricsFormatSlot;
+
+			/// Format of the cluster comparison output, SECC text logs or binary dump.
+			core::param::ParamSlot comparisonFormatSlot;
+
 			/// The path to the MMSE file to be written.
 			core::param::ParamSlot mmseFilenameSlot;
 
+			/// The compression level of the MMSE frame chunks, 0 for raw chunks.
+			core::param::ParamSlot mmseCompressionLevelSlot;
+
 			/// Mode for cluster coloring.
 			core::param::ParamSlot clusterColoringSlot;
 
@@ -593,6 +515,9 @@ namespace megamol {
 			/// Limit of the radius multiplier for the kD-Tree FRsearch.
 			core::param::ParamSlot radiusMultiplierSlot;
 
+			/// Search structure of the neighbour search (kD-tree or grid).
+			core::param::ParamSlot neighbourSearchMethodSlot;
+
 			/// Limit for cluster merging.
 			core::param::ParamSlot minClusterSizeSlot;
 
@@ -601,6 +526,26 @@ namespace megamol {
 			core::param::ParamSlot msMinCPPercentageSlot;
 			core::param::ParamSlot bdMaxCPPercentageSlot;
 
+			/// Threshold grids for the event sweep.
+			core::param::ParamSlot sweepMsMinCPPercentagesSlot;
+			core::param::ParamSlot sweepMsMinClusterAmountsSlot;
+			core::param::ParamSlot sweepBdMaxCPPercentagesSlot;
+
+			/// Cluster cache: off, write or read.
+			core::param::ParamSlot clusterCacheModeSlot;
+
+			/// The path to the MMSC file.
+			core::param::ParamSlot clusterCacheFilenameSlot;
+
+			/// Bound of the result cache in MiB, 0 switches it off.
+			core::param::ParamSlot resultCacheSizeSlot;
+
+			/// Threads of the default TaskPool, 0 for one per hardware thread.
+			core::param::ParamSlot taskPoolThreadsSlot;
+
+			/// Settings of the current calculation. Used by the worker in the asynchronous mode.
+			CalculationSettings settings;
+
 			/// The hash id of the data stored
 			size_t dataHash;
 
@@ -610,37 +555,105 @@ namespace megamol {
 			/// The frame id of the data stored
 			unsigned int frameId;
 
-			/// List with all particles of one frame. Key = position of the particle in the MMPLD particle list.
-			std::vector<Particle> particleList;
-			std::vector<Particle> previousParticleList;
+			/// Steps 1 to 4, holds the particle, cluster and partner lists.
+			StructureEventsPipeline pipeline;
 
-			/// List with all clusters.
-			std::vector<Cluster> clusterList;
-			std::vector<Cluster> previousClusterList;
-
-			/// Cluster comparison.
-			PartnerClustersList partnerClustersList;
+			/// Partner graph of the cluster comparison for the binary SECC output, kept to reuse its memory.
+			ClusterComparisonDump comparisonDump;
 			//PartnerClustersList previousPartnerClustersList; // For future implementations.
 
-			/// Structure Events. The list should never be cleared/reset so that
-			/// it can contain the StructureEvents of all calculated frames.
-			std::vector<StructureEvents::StructureEvent> structureEvents;
+			/// Structure Events of all calculated frames. Recalculating a frame
+			/// replaces its events, the store also keeps the maximum time.
+			/// Published to the calls in the asynchronous mode.
+			StructureEventsPublisher structureEvents;
+
+			/// MMSE file of the calculation, kept open to append the events of each frame.
+			/// Only used by jobs of the outputQueue.
+			MMSEAppendWriter mmseWriter;
+
+			/// State of the mmseWriter after all queued jobs, so writeSE decides
+			/// between append and rewrite without waiting for the outputQueue.
+			bool mmseQueuedOpen;
+			vislib::TString mmseQueuedFilename;
+			bool mmseQueuedSideColumns;
+			unsigned int mmseQueuedCompressionLevel;
+			std::map<unsigned int, size_t> mmseQueuedFrameCounts; // Key = frame id.
+
+			/// Set by a job of the outputQueue if writing the MMSE file failed.
+			std::atomic<bool> mmseWriteFailed;
+
+			/// MMSC file with the cluster assignments of steps 1 and 2.
+			ClusterCacheFile clusterCache;
 
-			/// Cache for maximum time of all structure events.
-			float seMaxTimeCache;
+			/// Results of calculated frames, for revisited frames and the true frame t-1 of step 3.
+			FrameResultCache resultCache;
 
-			/// The size of the kdTree, for output.
-			unsigned int treeSizeOutputCache;
+			/// Key of the frame in the lists of the pipeline, invalid for
+			/// dummy lists and data without hash.
+			FrameResultCache::Key listKey;
+			bool listKeyValid;
+
+			/// Events of step 4 of the current frame, for the result cache.
+			std::vector<StructureEventsPipeline::Event> pipelineEvents;
+
+			/// Flag that the partner lists of the pipeline belong to the current frame.
+			bool pipelineCompared;
+
+			/// Event amounts of all sweep grid points. Key = frame id, so
+			/// recalculated frames replace their amounts in the series totals.
+			std::map<unsigned int, std::vector<SweepPoint>> sweepAmounts;
 
 			/// The time of the calculation for output.
 			char timeOutputCache[80];
 
+			/// Quantitative data of the current frame, written by writeMetrics.
+			FrameMetrics metrics;
+
 			/// Cache container of a single MMPLD particle list.
 			core::moldyn::MultiParticleDataCall::Particles particles;
 
 			/// Color for gas particles.
 			std::vector<float> gasColor;
 
+			///
+			/// Asynchronous mode.
+			/// The requested* and served* members are only used on the thread of
+			/// the calls, all other calculation members only by the worker.
+			///
+
+			/// Frame of the last request, to request every frame once.
+			bool requestedFrameValid;
+			unsigned int requestedFrameId;
+			size_t requestedDataHash;
+
+			/// Request waiting for the worker, guarded by requestMutex.
+			std::shared_ptr<FrameRequest> waitingRequest;
+			std::mutex requestMutex;
+
+			/// Latest result of the worker, guarded by resultMutex.
+			std::shared_ptr<FrameResult> finishedResult;
+			std::mutex resultMutex;
+
+			/// Number of published results, the SEDC hash of the results.
+			size_t publishedResultCount;
+
+			/// Result served to the calls. The previous one stays valid until
+			/// the next result, renderers may still hold its pointers.
+			std::shared_ptr<FrameResult> servedResult;
+			std::shared_ptr<FrameResult> previousServedResult;
+
+			///
+			/// Speculation.
+			///
+
+			/// Frame of the last speculation request, only used on the thread of the calls.
+			bool speculationRequestedValid;
+			unsigned int speculationRequestedFrameId;
+
+			/// Latest speculation, guarded by speculationMutex.
+			std::shared_ptr<SpeculativeFrame> speculation;
+			std::mutex speculationMutex;
+
 			/// Takes long, OBSOLETE.
 			//void sortBySignedDistance();
 
@@ -661,6 +674,12 @@ namespace megamol {
 			/// Get a cluster from clusterList with particle ID. UNUSED.
 			//mmvis_static::StructureEventsCalculation::Cluster*
 			//	mmvis_static::StructureEventsCalculation::_getCluster(const uint64_t rootParticleID) const;
+
+			/// Worker of the speculation, the calculation waits for it.
+			LatestJobWorker speculationWorker;
+
+			/// Worker of the asynchronous mode, declared last so its jobs end before the members are destroyed.
+			LatestJobWorker calculationWorker;
 		};
 
 	} /* namespace mmvis_static */
@@ -0,0 +1,252 @@
+/**
+ * StructureEventsColumns.cpp
+ *
+ * Copyright (C) 2009-2015 by MegaMol Team
+ * Copyright (C) 2015 by Richard Hhne, TU Dresden
+ * Alle Rechte vorbehalten.
+ */
+
+#include "stdafx.h"
+#include "StructureEventsColumns.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <limits>
+
+using namespace megamol;
+
+/**
+ * mmvis_static::StructureEventsColumns::StructureEventsColumns
+ */
+mmvis_static::StructureEventsColumns::StructureEventsColumns(void) {
+}
+
+
+/**
+ * mmvis_static::StructureEventsColumns::~StructureEventsColumns
+ */
+mmvis_static::StructureEventsColumns::~StructureEventsColumns(void) {
+}
+
+
+/**
+ * mmvis_static::StructureEventsColumns::build
+ */
+void mmvis_static::StructureEventsColumns::build(const StructureEvents::StructureEvent *events, const size_t count, const unsigned int stride) {
+	this->clear();
+	if (events == NULL || count == 0)
+		return;
+
+	const uint8_t *base = reinterpret_cast<const uint8_t*>(events);
+	auto eventAt = [base, stride](const size_t index) -> const StructureEvents::StructureEvent& {
+		return *reinterpret_cast<const StructureEvents::StructureEvent*>(base + index * stride);
+	};
+
+	///
+	/// Gather event indices per type. Events from the calculation are
+	/// ordered by frame already, so sorting is mostly skipped.
+	///
+	std::vector<size_t> indices[4];
+	for (size_t i = 0; i < count; ++i) {
+		const int type = static_cast<int>(eventAt(i).type);
+		if (type < 0 || type > 3)
+			continue; // Invalid type code, skip event.
+		indices[type].push_back(i);
+	}
+
+	for (int type = 0; type < 4; ++type) {
+		std::vector<size_t>& typeIndices = indices[type];
+		auto timeLess = [&eventAt](const size_t lhs, const size_t rhs) {
+			return eventAt(lhs).time < eventAt(rhs).time;
+		};
+		if (!std::is_sorted(typeIndices.begin(), typeIndices.end(), timeLess))
+			std::stable_sort(typeIndices.begin(), typeIndices.end(), timeLess);
+
+		///
+		/// Fill columns.
+		///
+		TypeColumns& c = this->columns[type];
+		c.positions.resize(typeIndices.size() * 3);
+		c.times.resize(typeIndices.size());
+		for (size_t i = 0; i < typeIndices.size(); ++i) {
+			const StructureEvents::StructureEvent& se = eventAt(typeIndices[i]);
+			c.positions[i * 3] = se.x;
+			c.positions[i * 3 + 1] = se.y;
+			c.positions[i * 3 + 2] = se.z;
+			c.times[i] = se.time;
+		}
+
+		///
+		/// Frame offsets, times are sorted so a single walk suffices.
+		///
+		const size_t frameCount = c.times.empty() ? 0 : static_cast<size_t>(std::max(0.f, std::floor(c.times.back()))) + 1;
+		c.frameOffsets.resize(frameCount + 1);
+		size_t eventIndex = 0;
+		for (size_t frame = 0; frame <= frameCount; ++frame) {
+			while (eventIndex < c.times.size() && c.times[eventIndex] < static_cast<float>(frame))
+				++eventIndex;
+			c.frameOffsets[frame] = eventIndex;
+		}
+		c.frameOffsets[frameCount] = c.times.size();
+	}
+}
+
+
+/**
+ * mmvis_static::StructureEventsColumns::setFrame
+ */
+bool mmvis_static::StructureEventsColumns::setFrame(const unsigned int frameId, const StructureEvents::StructureEvent *events, const size_t count) {
+	///
+	/// Event indices per type, sorted by time like in build.
+	///
+	std::vector<size_t> indices[4];
+	float minTime = 0, maxTime = 0;
+	bool hasEvents = false;
+	for (size_t i = 0; i < count; ++i) {
+		const int type = static_cast<int>(events[i].type);
+		if (type < 0 || type > 3)
+			continue; // Invalid type code, skip event.
+		indices[type].push_back(i);
+		minTime = hasEvents ? std::min(minTime, events[i].time) : events[i].time;
+		maxTime = hasEvents ? std::max(maxTime, events[i].time) : events[i].time;
+		hasEvents = true;
+	}
+	auto timeLess = [events](const size_t lhs, const size_t rhs) {
+		return events[lhs].time < events[rhs].time;
+	};
+	for (auto & typeIndices : indices) {
+		if (!std::is_sorted(typeIndices.begin(), typeIndices.end(), timeLess))
+			std::stable_sort(typeIndices.begin(), typeIndices.end(), timeLess);
+	}
+
+	///
+	/// The columns stay sorted by time if the events lie between those of
+	/// the neighbouring frames.
+	///
+	auto it = this->partitions.lower_bound(frameId);
+	const bool replaces = it != this->partitions.end() && it->first == frameId;
+	auto next = replaces ? std::next(it) : it;
+	if (hasEvents) {
+		if (it != this->partitions.begin() && std::prev(it)->second.maxTime > minTime)
+			return false;
+		if (next != this->partitions.end() && next->second.minTime < maxTime)
+			return false;
+	}
+
+	FramePartition partition;
+	partition.minTime = minTime;
+	partition.maxTime = maxTime;
+	size_t oldCounts[4];
+	for (int type = 0; type < 4; ++type) {
+		TypeColumns& c = this->columns[type];
+		const std::vector<size_t>& typeIndices = indices[type];
+		const size_t offset = replaces ? it->second.offsets[type]
+			: (next != this->partitions.end() ? next->second.offsets[type] : c.times.size());
+		const size_t oldCount = replaces ? it->second.counts[type] : 0;
+		const size_t oldSize = c.times.size();
+		partition.offsets[type] = offset;
+		partition.counts[type] = typeIndices.size();
+		oldCounts[type] = oldCount;
+		if (oldCount == 0 && typeIndices.empty())
+			continue;
+
+		// Time range of the removed and the inserted events.
+		float changedMin = std::numeric_limits<float>::max();
+		float changedMax = std::numeric_limits<float>::lowest();
+		if (oldCount > 0) {
+			changedMin = c.times[offset];
+			changedMax = c.times[offset + oldCount - 1];
+		}
+		if (!typeIndices.empty()) {
+			changedMin = std::min(changedMin, events[typeIndices.front()].time);
+			changedMax = std::max(changedMax, events[typeIndices.back()].time);
+		}
+
+		///
+		/// Replace the frame's part of the columns.
+		///
+		std::vector<float> framePositions(typeIndices.size() * 3);
+		std::vector<float> frameTimes(typeIndices.size());
+		for (size_t i = 0; i < typeIndices.size(); ++i) {
+			const StructureEvents::StructureEvent& se = events[typeIndices[i]];
+			framePositions[i * 3] = se.x;
+			framePositions[i * 3 + 1] = se.y;
+			framePositions[i * 3 + 2] = se.z;
+			frameTimes[i] = se.time;
+		}
+		c.positions.erase(c.positions.begin() + offset * 3, c.positions.begin() + (offset + oldCount) * 3);
+		c.positions.insert(c.positions.begin() + offset * 3, framePositions.begin(), framePositions.end());
+		c.times.erase(c.times.begin() + offset, c.times.begin() + offset + oldCount);
+		c.times.insert(c.times.begin() + offset, frameTimes.begin(), frameTimes.end());
+
+		///
+		/// Frame offsets. Frames up to the first changed time keep their
+		/// offset, frames after the last changed time shift by the count
+		/// difference, frames past the old times start after all old events.
+		///
+		if (c.times.empty()) {
+			c.frameOffsets.clear();
+			continue;
+		}
+		const size_t oldFrameCount = c.frameOffsets.empty() ? 0 : c.frameOffsets.size() - 1;
+		const size_t frameCount = static_cast<size_t>(std::max(0.f, std::floor(c.times.back()))) + 1;
+		const size_t firstChangedFrame = changedMin < 0.f ? 0 : static_cast<size_t>(std::floor(changedMin)) + 1;
+		c.frameOffsets.resize(frameCount + 1);
+		for (size_t frame = std::min(firstChangedFrame, oldFrameCount + 1); frame <= frameCount; ++frame) {
+			if (frame < firstChangedFrame) {
+				c.frameOffsets[frame] = oldSize;
+			}
+			else if (static_cast<float>(frame) <= changedMax) {
+				c.frameOffsets[frame] = std::lower_bound(c.times.begin(), c.times.end(), static_cast<float>(frame)) - c.times.begin();
+			}
+			else {
+				const size_t oldOffset = frame <= oldFrameCount ? c.frameOffsets[frame] : oldSize;
+				c.frameOffsets[frame] = oldOffset - oldCount + typeIndices.size();
+			}
+		}
+	}
+
+	///
+	/// Store the partition, shift the following ones.
+	///
+	if (replaces)
+		it = this->partitions.erase(it);
+	if (hasEvents)
+		it = ++this->partitions.insert(it, std::make_pair(frameId, partition));
+	for (; it != this->partitions.end(); ++it) {
+		for (int type = 0; type < 4; ++type)
+			it->second.offsets[type] = it->second.offsets[type] - oldCounts[type] + partition.counts[type];
+	}
+
+	return true;
+}
+
+
+/**
+ * mmvis_static::StructureEventsColumns::clear
+ */
+void mmvis_static::StructureEventsColumns::clear(void) {
+	for (auto & c : this->columns) {
+		c.positions.clear();
+		c.times.clear();
+		c.frameOffsets.clear();
+	}
+	this->partitions.clear();
+}
+
+
+/**
+ * mmvis_static::StructureEventsColumns::setTo
+ */
+void mmvis_static::StructureEventsColumns::setTo(StructureEvents& events) const {
+	for (int type = 0; type < 4; ++type) {
+		const TypeColumns& c = this->columns[type];
+		events.setColumns(StructureEvents::getEventType(type),
+			c.positions.empty() ? NULL : c.positions.data(),
+			c.times.empty() ? NULL : c.times.data(),
+			c.times.size(),
+			c.frameOffsets.empty() ? NULL : c.frameOffsets.data(),
+			c.frameOffsets.empty() ? 0 : c.frameOffsets.size() - 1);
+	}
+}
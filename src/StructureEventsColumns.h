@@ -0,0 +1,97 @@
+/**
+ * StructureEventsColumns.h
+ *
+ * Copyright (C) 2009-2015 by MegaMol Team
+ * Copyright (C) 2015 by Richard Hhne, TU Dresden
+ * Alle Rechte vorbehalten.
+ */
+
+#ifndef MMVISSTATIC_StructureEventsColumns_H_INCLUDED
+#define MMVISSTATIC_StructureEventsColumns_H_INCLUDED
+#if (defined(_MSC_VER) && (_MSC_VER > 1000))
+#pragma once
+#endif /* (defined(_MSC_VER) && (_MSC_VER > 1000)) */
+
+#include "StructureEventsDataCall.h"
+
+#include <map>
+#include <vector>
+
+namespace megamol {
+	namespace mmvis_static {
+
+		/**
+		 * Columnar copy of an event list, one set of columns per event type.
+		 *
+		 * Each type has its positions (3x float) and times, sorted by time,
+		 * and a frame offset table where frame f covers the events with
+		 * f <= time < f + 1. The columns are owned here and handed to
+		 * StructureEventsDataCall as pointers via setTo().
+		 */
+		class StructureEventsColumns {
+		public:
+
+			/// Ctor.
+			StructureEventsColumns(void);
+
+			/// Dtor.
+			virtual ~StructureEventsColumns(void);
+
+			///
+			/// Rebuilds all columns from an array of struct StructureEvent.
+			/// The order of events with equal time and type is kept.
+			///
+			/// @param stride Byte distance between two events.
+			///
+			void build(const StructureEvents::StructureEvent *events, const size_t count, const unsigned int stride = sizeof(StructureEvents::StructureEvent));
+
+			///
+			/// Replaces the events of one frame of a list partitioned by frame,
+			/// like StructureEventsStore, in each type's column. Only that
+			/// frame's part of the columns is touched. Not for columns made by
+			/// build().
+			///
+			/// @return False if the events do not fit between the neighbouring
+			///         frames in time order, the columns are unchanged then.
+			///
+			bool setFrame(const unsigned int frameId, const StructureEvents::StructureEvent *events, const size_t count);
+
+			/// Removes all columns.
+			void clear(void);
+
+			/// Sets the column pointers of all types to the call data.
+			void setTo(StructureEvents& events) const;
+
+			/// Number of events of the type.
+			inline size_t getCount(const StructureEvents::EventType type) const {
+				return this->columns[type].times.size();
+			}
+
+		private:
+
+			/// Columns of one event type.
+			struct TypeColumns {
+				std::vector<float> positions;
+				std::vector<float> times;
+				std::vector<size_t> frameOffsets; // frameCount + 1 entries.
+			};
+
+			/// Part of the columns set by setFrame for one frame.
+			struct FramePartition {
+				size_t offsets[4]; // Index = EventType.
+				size_t counts[4];
+				float minTime;
+				float maxTime;
+			};
+
+			/// Columns, index = EventType.
+			TypeColumns columns[4];
+
+			/// Partitions of the frames set by setFrame. Key = frame id.
+			std::map<unsigned int, FramePartition> partitions;
+		};
+
+	} /* namespace mmvis_static */
+} /* namespace megamol */
+
+#endif /* MMVISSTATIC_StructureEventsColumns_H_INCLUDED */
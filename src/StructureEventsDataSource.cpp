@@ -9,12 +9,17 @@
 #include "stdafx.h"
 #include "StructureEventsDataSource.h"
 
+#include "mmcore/param/BoolParam.h"
 #include "mmcore/param/FilePathParam.h"
 #include "StructureEventsDataCall.h"
+#include "TaskPool.h"
 #include "vislib/sys/Log.h"
-#include "vislib/sys/FastFile.h"
 #include "vislib/sys/SystemInformation.h"
 
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+
 using namespace megamol;
 using namespace megamol::core;
 
@@ -24,18 +29,34 @@ using namespace megamol::core;
 mmvis_static::StructureEventsDataSource::StructureEventsDataSource(void) : core::Module(),
 //mmvis_static::StructureEventsDataSource::StructureEventsDataSource(void) : core::view::AnimDataModule(),
 	filename("filename", "The path to the MMSE file to load."),
+	onlyRequestedFrameSlot("onlyRequestedFrame", "Load only the events of the requested frame (MMSE version 2 files)."),
+	memoryMappingSlot("memoryMapping", "Map the file into memory instead of copying the events."),
 	getDataSlot("getdata", "Slot to request data from this data source."),
 	file(NULL), bbox(-1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f),
 	clipbox(-1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f),
-	sedcHash(0), headerSize(0), eventCount(0), maxTime(0), frameCount(1), reReadData(false) {
+	sedcHash(0), headerSize(0), loadedFrameID(-1), eventCount(0), maxTime(0), frameCount(1),
+	columnSource(NULL), columnSourceCount(0), columnSourceStride(sizeof(StructureEvents::StructureEvent)), reReadData(false) {
 
 	this->filename.SetParameter(new param::FilePathParam("eventsFromMPDC.mmse"));
 	this->filename.SetUpdateCallback(&StructureEventsDataSource::filenameChanged);
 	this->MakeSlotAvailable(&this->filename);
 
+	this->onlyRequestedFrameSlot.SetParameter(new param::BoolParam(false));
+	this->MakeSlotAvailable(&this->onlyRequestedFrameSlot);
+
+	this->memoryMappingSlot.SetParameter(new param::BoolParam(true));
+	this->MakeSlotAvailable(&this->memoryMappingSlot);
+
 	this->getDataSlot.SetCallback("StructureEventsDataCall", "GetData", &StructureEventsDataSource::getDataCallback);
 	this->getDataSlot.SetCallback("StructureEventsDataCall", "GetExtent", &StructureEventsDataSource::getExtentCallback);
 	this->MakeSlotAvailable(&this->getDataSlot);
+
+	this->header.version = 1;
+	this->header.flags = 0;
+	this->header.eventCount = 0;
+	this->header.maxTime = 0;
+	this->header.frameCount = 0;
+	this->header.frameTableOffset = 0;
 }
 
 /**
@@ -58,6 +79,8 @@ bool mmvis_static::StructureEventsDataSource::create(void) {
  * mmvis_static::StructureEventsDataSource::release
  */
 void mmvis_static::StructureEventsDataSource::release(void) {
+	this->columnSource = NULL;
+	this->mappedFile.Close();
 }
 
 
@@ -66,9 +89,9 @@ void mmvis_static::StructureEventsDataSource::release(void) {
  */
 bool mmvis_static::StructureEventsDataSource::filenameChanged(param::ParamSlot& slot) {
 	using vislib::sys::Log;
-	using vislib::sys::File;
 	this->bbox.Set(-1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f);
 	this->clipbox = this->bbox;
+	this->mappedFile.Close();
 
 	// Change hash to flag that sedc data has changed.
 	this->sedcHash = this->sedcHash != 1 ? 1 : 2;
@@ -77,17 +100,19 @@ bool mmvis_static::StructureEventsDataSource::filenameChanged(param::ParamSlot&
 	/// Check for existing file.
 	///
 	if (this->file == NULL) {
-		this->file = new vislib::sys::FastFile();
+		this->file = new std::ifstream();
 	}
 	else {
-		this->file->Close();
+		this->file->close();
+		this->file->clear();
 	}
 	ASSERT(this->filename.Param<param::FilePathParam>() != NULL);
 	
 	///
 	/// Open file.
 	///
-	if (!this->file->Open(this->filename.Param<param::FilePathParam>()->Value(), File::READ_ONLY, File::SHARE_READ, File::OPEN_ONLY)) {
+	this->file->open(vislib::StringA(this->filename.Param<param::FilePathParam>()->Value()).PeekBuffer(), std::ios_base::binary);
+	if (!this->file->is_open()) {
 		Log::DefaultLog.WriteMsg(Log::LEVEL_ERROR, "Unable to open MMSE-File \"%s\".", vislib::StringA(
 			this->filename.Param<param::FilePathParam>()->Value()).PeekBuffer());
 
@@ -107,51 +132,46 @@ bool mmvis_static::StructureEventsDataSource::filenameChanged(param::ParamSlot&
         this->bbox.Set(-1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f); \
         this->clipbox = this->bbox; \
         return true;
-#define _ASSERT_READFILE(BUFFER, BUFFERSIZE) if (this->file->Read((BUFFER), (BUFFERSIZE)) != (BUFFERSIZE)) { \
-        _ERROR_OUT("Unable to read MMSE file header"); \
-	    }
-	
-	this->headerSize = 0;
 
 	///
-	/// Check file type by id.
+	/// Read header, version 1 and 2.
 	///
-	char magicid[4];
-	_ASSERT_READFILE(magicid, 4);
-	if (::memcmp(magicid, "MMSE", 4) != 0) { // with 4 it works, the two bytes afterwards are not NULL when 6, didnt found the error in writer, so changed to 4 in both
-		_ERROR_OUT("MMSE file header id wrong");
+	if (!MMSEFormat::ReadHeader(*this->file, this->header)) {
+		_ERROR_OUT("Unable to read MMSE file header");
+	}
+	if (this->header.version == 0) {
+		_ERROR_OUT("MMSE file is incomplete");
+	}
+	if (this->header.version > MMSEFormat::VERSION_2) {
+		_ERROR_OUT("MMSE file version not supported");
 	}
-	this->headerSize += 4;
-
-	///
-	/// Get extends and mmse properties.
-	/// file->Read() automatically moves the file pointer.
-	///
-	float box[6];
-	_ASSERT_READFILE(box, 4 * 6);
-	this->bbox.Set(box[0], box[1], box[2], box[3], box[4], box[5]);
-	this->headerSize += 4 * 6;
-
-	_ASSERT_READFILE(box, 4 * 6);
-	this->clipbox.Set(box[0], box[1], box[2], box[3], box[4], box[5]);
-	this->headerSize += 4 * 6;
 
-	uint64_t count[1]; // Beautiful workaround.
-	_ASSERT_READFILE(count, 8);
-	this->eventCount = count[0];
-	this->headerSize += 8;
+	this->bbox.Set(this->header.bbox[0], this->header.bbox[1], this->header.bbox[2],
+		this->header.bbox[3], this->header.bbox[4], this->header.bbox[5]);
+	this->clipbox.Set(this->header.cbox[0], this->header.cbox[1], this->header.cbox[2],
+		this->header.cbox[3], this->header.cbox[4], this->header.cbox[5]);
+	this->eventCount = static_cast<size_t>(this->header.eventCount);
+	this->maxTime = this->header.maxTime;
+	this->frameCount = static_cast<int>(this->maxTime) == 0 ? 1 : static_cast<int>(this->maxTime);
+
+	if (this->header.version == 1) {
+		this->headerSize = MMSEFormat::HEADER_SIZE_V1;
+		this->frameTable.clear();
+	}
+	else {
+		this->headerSize = MMSEFormat::HEADER_SIZE_V2;
+		if (!MMSEFormat::ReadFrameTable(*this->file, this->header, this->frameTable)) {
+			_ERROR_OUT("Unable to read MMSE frame table");
+		}
+		if (!this->frameTable.empty())
+			this->frameCount = this->frameTable.back().frameID + 1;
+	}
 
-	float time[1]; // Beautiful workaround.
-	_ASSERT_READFILE(time, 4);
-	this->maxTime = time[0];
-	this->frameCount = static_cast<int>(time[0]) == 0 ? 1 : static_cast<int>(time[0]);
-	this->headerSize += 4;
+	this->updateMapping();
 
 	/// Flag that the data has to be renewed.
 	this->reReadData = true;
 
-#undef _ASSERT_READFILE_EXTEND
-#undef _ASSERT_READFILE
 #undef _ERROR_OUT
 
 	return true;
@@ -169,6 +189,26 @@ bool mmvis_static::StructureEventsDataSource::getDataCallback(Call& caller) {
 	//call->SetUnlocker(new Unlocker());
 	outSedc->SetDataHash(this->sedcHash);
 
+	if (this->onlyRequestedFrameSlot.IsDirty()) {
+		this->onlyRequestedFrameSlot.ResetDirty();
+		this->reReadData = true;
+	}
+	if (this->memoryMappingSlot.IsDirty()) {
+		this->memoryMappingSlot.ResetDirty();
+		this->updateMapping();
+		// The event pointers change.
+		this->sedcHash = this->sedcHash != 1 ? 1 : 2;
+		outSedc->SetDataHash(this->sedcHash);
+		this->reReadData = true;
+	}
+	if (this->onlyRequestedFrameSlot.Param<param::BoolParam>()->Value() && this->header.version >= 2
+		&& this->loadedFrameID != static_cast<int>(outSedc->FrameID())) {
+		// Change hash to flag that sedc data has changed.
+		this->sedcHash = this->sedcHash != 1 ? 1 : 2;
+		outSedc->SetDataHash(this->sedcHash);
+		this->reReadData = true;
+	}
+
 	if (!this->reReadData) // Will cause erroneous data if file is moved in memory.
 		return true;
 
@@ -179,6 +219,25 @@ bool mmvis_static::StructureEventsDataSource::getDataCallback(Call& caller) {
 }
 
 
+/**
+ * mmvis_static::StructureEventsDataSource::updateMapping
+ */
+void mmvis_static::StructureEventsDataSource::updateMapping(void) {
+	// Events in the mapping are gone, the next SetData defers the columns again.
+	this->columnSource = NULL;
+	this->eventColumns.clear();
+	this->mappedFile.Close();
+	if (this->file == NULL || !this->memoryMappingSlot.Param<param::BoolParam>()->Value())
+		return;
+
+	vislib::StringA path(this->filename.Param<param::FilePathParam>()->Value());
+	if (!this->mappedFile.Open(path.PeekBuffer())) {
+		vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_WARN,
+			"Unable to map MMSE file \"%s\", reading it instead.", path.PeekBuffer());
+	}
+}
+
+
 /**
  * mmvis_static::StructureEventsDataSource::getExtentCallback
  */
@@ -199,7 +258,7 @@ bool mmvis_static::StructureEventsDataSource::getExtentCallback(Call& caller) {
 bool mmvis_static::StructureEventsDataSource::SetData(StructureEventsDataCall& data) {
 	//This function gets called very often!
 
-#define _ASSERT_READFILE(BUFFER, BUFFERSIZE) if (this->file->Read((BUFFER), (BUFFERSIZE)) != (BUFFERSIZE)) { \
+#define _ASSERT_READFILE(BUFFER, BUFFERSIZE) if (!this->file->read((BUFFER), (BUFFERSIZE))) { \
 		vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_ERROR, "Unable to read MMSE file data"); \
 		return false; \
 		}
@@ -207,6 +266,12 @@ bool mmvis_static::StructureEventsDataSource::SetData(StructureEventsDataCall& d
 	//if (this->sedcHash == 0) // filenameChanged not exectuted.
 	//	filenameChanged(this->filename);
 
+	if (this->file == NULL)
+		return false;
+
+	if (this->header.version >= 2)
+		return this->SetDataV2(data);
+
 	StructureEvents* events = &data.getEvents();
 
 	size_t bufferSize = events->getStride() * this->eventCount;
@@ -218,16 +283,28 @@ bool mmvis_static::StructureEventsDataSource::SetData(StructureEventsDataCall& d
 
 	//vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_INFO, "MMSE Source: HeaderSize %d bufferSize %d.", this->headerSize, bufferSize);
 
-	this->file->Seek(this->headerSize);
-	this->eventData.EnforceSize(bufferSize);
-	_ASSERT_READFILE(this->eventData, bufferSize);
-
-	if (this->eventData.IsEmpty())
-		return false;
+	///
+	/// Events are used in place if the file is mapped, otherwise copied.
+	///
+	const uint8_t *eventStart;
+	const bool mapped = this->mappedFile.IsOpen() && this->mappedFile.GetSize() >= this->headerSize + bufferSize;
+	if (mapped) {
+		eventStart = this->mappedFile.GetDataAt(this->headerSize);
+	}
+	else {
+		this->file->clear();
+		this->file->seekg(static_cast<std::streamoff>(this->headerSize));
+		this->eventData.EnforceSize(bufferSize);
+		_ASSERT_READFILE(this->eventData.As<char>(), bufferSize);
+
+		if (this->eventData.IsEmpty())
+			return false;
+		eventStart = this->eventData.As<uint8_t>();
+	}
 
-	const float* location = this->eventData.As<float>();
-	const float* time = this->eventData.AsAt<float>(12);
-	const StructureEvents::EventType* type = this->eventData.AsAt<StructureEvents::EventType>(16);
+	const float* location = reinterpret_cast<const float*>(eventStart);
+	const float* time = reinterpret_cast<const float*>(eventStart + 12);
+	const StructureEvents::EventType* type = reinterpret_cast<const StructureEvents::EventType*>(eventStart + 16);
 
 	// Debug.
 	/*
@@ -246,8 +323,243 @@ bool mmvis_static::StructureEventsDataSource::SetData(StructureEventsDataCall& d
 		this->maxTime,
 		this->eventCount);
 
+	///
+	/// Optional side block, missing in files of older writers.
+	///
+	char sideID[4];
+	uint64_t sideCount = 0;
+	size_t sideSize = 4 * 4 * this->eventCount;
+	const uint8_t *sideStart = NULL;
+	if (mapped) {
+		const uint64_t sideOffset = this->headerSize + bufferSize;
+		if (this->mappedFile.GetSize() >= sideOffset + 12 + sideSize
+			&& ::memcmp(this->mappedFile.GetDataAt(sideOffset), "MMSD", 4) == 0) {
+			::memcpy(&sideCount, this->mappedFile.GetDataAt(sideOffset + 4), 8);
+			if (sideCount == this->eventCount)
+				sideStart = this->mappedFile.GetDataAt(sideOffset + 12);
+		}
+	}
+	else if (this->file->read(sideID, 4) && ::memcmp(sideID, "MMSD", 4) == 0
+		&& this->file->read(reinterpret_cast<char*>(&sideCount), 8) && sideCount == this->eventCount) {
+		this->sideData.EnforceSize(sideSize);
+		_ASSERT_READFILE(this->sideData.As<char>(), sideSize);
+		sideStart = this->sideData.As<uint8_t>();
+	}
+
+	if (sideStart != NULL) {
+		events->setSideColumns(reinterpret_cast<const int*>(sideStart),
+			reinterpret_cast<const int*>(sideStart + 4 * this->eventCount),
+			reinterpret_cast<const int*>(sideStart + 2 * 4 * this->eventCount),
+			reinterpret_cast<const float*>(sideStart + 3 * 4 * this->eventCount));
+	}
+	else {
+		events->setSideColumns(NULL, NULL, NULL, NULL);
+	}
+
+	// Columns per type for slices by type and time.
+	this->deferColumns(*events, reinterpret_cast<const StructureEvents::StructureEvent*>(eventStart), this->eventCount, events->getStride());
+
 	// Flag to renew data.
 	this->reReadData = false;
 
 	return true;
-}
\ No newline at end of file
+}
+
+
+bool mmvis_static::StructureEventsDataSource::SetDataV2(StructureEventsDataCall& data) {
+	StructureEvents* events = &data.getEvents();
+	const bool withSide = (this->header.flags & MMSEFormat::FLAG_SIDE_COLUMNS) != 0;
+
+	///
+	/// Chunks to load, random access by frame table.
+	///
+	auto first = this->frameTable.begin();
+	auto last = this->frameTable.end();
+	int frame = -1;
+	if (this->onlyRequestedFrameSlot.Param<param::BoolParam>()->Value()) {
+		frame = static_cast<int>(data.FrameID());
+		first = std::lower_bound(this->frameTable.begin(), this->frameTable.end(), static_cast<uint32_t>(frame),
+			[](const MMSEFormat::FrameEntry& entry, const uint32_t frameID) {
+			return entry.frameID < frameID;
+		});
+		last = (first != this->frameTable.end() && first->frameID == static_cast<uint32_t>(frame)) ? first + 1 : first;
+	}
+
+	size_t count = 0;
+	for (auto it = first; it != last; ++it)
+		count += static_cast<size_t>(it->eventCount);
+
+	if (count == 0) {
+		events->setEvents(NULL, NULL, NULL, this->maxTime, 0);
+		events->setSideColumns(NULL, NULL, NULL, NULL);
+		this->deferColumns(*events, NULL, 0);
+		this->loadedFrameID = frame;
+		this->reReadData = false;
+		return true;
+	}
+
+	///
+	/// Raw chunks are used in place if the file is mapped: adjacent chunks
+	/// without side columns, or a single chunk with its side columns, which
+	/// follow the events of the chunk.
+	///
+	const size_t inPlaceSize = count * (sizeof(StructureEvents::StructureEvent) + (withSide ? MMSEFormat::SIDE_COLUMNS_SIZE : 0));
+	bool inPlace = this->mappedFile.IsOpen() && (!withSide || last - first == 1)
+		&& first->offset + inPlaceSize <= this->mappedFile.GetSize();
+	for (auto it = first; it != last && inPlace; ++it) {
+		inPlace = it->encoding == MMSEFormat::ENCODING_RAW
+			&& (it + 1 == last || it->offset + it->byteSize == (it + 1)->offset);
+	}
+	if (inPlace && withSide)
+		inPlace = first->byteSize >= inPlaceSize;
+	if (inPlace) {
+		const uint8_t *eventStart = this->mappedFile.GetDataAt(first->offset);
+		events->setEvents(reinterpret_cast<const float*>(eventStart),
+			reinterpret_cast<const float*>(eventStart + 12),
+			reinterpret_cast<const StructureEvents::EventType*>(eventStart + 16),
+			this->maxTime,
+			count);
+
+		if (withSide) {
+			const uint8_t *sideStart = eventStart + count * sizeof(StructureEvents::StructureEvent);
+			events->setSideColumns(reinterpret_cast<const int*>(sideStart),
+				reinterpret_cast<const int*>(sideStart + 4 * count),
+				reinterpret_cast<const int*>(sideStart + 2 * 4 * count),
+				reinterpret_cast<const float*>(sideStart + 3 * 4 * count));
+		}
+		else {
+			events->setSideColumns(NULL, NULL, NULL, NULL);
+		}
+
+		this->deferColumns(*events, reinterpret_cast<const StructureEvents::StructureEvent*>(eventStart), count);
+
+		this->loadedFrameID = frame;
+		this->reReadData = false;
+		return true;
+	}
+
+	///
+	/// Read chunks, side columns are concatenated per column.
+	///
+	this->eventData.EnforceSize(count * sizeof(StructureEvents::StructureEvent));
+	if (withSide)
+		this->sideData.EnforceSize(count * MMSEFormat::SIDE_COLUMNS_SIZE);
+
+	StructureEvents::StructureEvent *eventTarget = this->eventData.As<StructureEvents::StructureEvent>();
+	int *idTarget = withSide ? this->sideData.As<int>() : NULL;
+	int *sizeTarget = withSide ? this->sideData.AsAt<int>(count * 4) : NULL;
+	int *partnerTarget = withSide ? this->sideData.AsAt<int>(2 * count * 4) : NULL;
+	float *ratioTarget = withSide ? this->sideData.AsAt<float>(3 * count * 4) : NULL;
+
+	///
+	/// Raw chunks of an unmapped file are read into place. Other chunks are
+	/// taken from the mapping or read in one piece and decoded in parallel.
+	///
+	std::vector<MMSEFormat::FrameEntry> decodeEntries;
+	std::vector<size_t> decodeOffsets;
+	std::vector<const uint8_t*> decodeSources;
+	std::vector<uint8_t> chunkData;
+	std::vector<size_t> chunkDataOffsets;
+
+	size_t offset = 0;
+	for (auto it = first; it != last; ++it) {
+		if (this->mappedFile.IsOpen() && it->offset + it->byteSize <= this->mappedFile.GetSize()) {
+			decodeEntries.push_back(*it);
+			decodeOffsets.push_back(offset);
+			decodeSources.push_back(this->mappedFile.GetDataAt(it->offset));
+		}
+		else if (it->encoding != MMSEFormat::ENCODING_RAW) {
+			const size_t dataOffset = chunkData.size();
+			chunkData.resize(dataOffset + static_cast<size_t>(it->byteSize));
+			this->file->clear();
+			this->file->seekg(static_cast<std::streamoff>(it->offset));
+			if (!this->file->read(reinterpret_cast<char*>(chunkData.data() + dataOffset), static_cast<std::streamsize>(it->byteSize))) {
+				vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_ERROR, "Unable to read MMSE frame %u", it->frameID);
+				return false;
+			}
+			decodeEntries.push_back(*it);
+			decodeOffsets.push_back(offset);
+			decodeSources.push_back(NULL);
+			chunkDataOffsets.push_back(dataOffset);
+		}
+		else if (!MMSEFormat::ReadFrameChunk(*this->file, this->header, *it, eventTarget + offset,
+			withSide ? idTarget + offset : NULL, withSide ? sizeTarget + offset : NULL,
+			withSide ? partnerTarget + offset : NULL, withSide ? ratioTarget + offset : NULL)) {
+			vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_ERROR, "Unable to read MMSE frame %u", it->frameID);
+			return false;
+		}
+		offset += static_cast<size_t>(it->eventCount);
+	}
+
+	// Read chunks are located after the buffer stopped growing.
+	for (size_t i = 0, j = 0; i < decodeSources.size(); ++i) {
+		if (decodeSources[i] == NULL)
+			decodeSources[i] = chunkData.data() + chunkDataOffsets[j++];
+	}
+
+	// Chunks differ in size, one per range lets the pool balance them.
+	std::atomic<bool> decodeSuccess(true);
+	TaskPool::GetDefault()->ParallelFor(0, decodeEntries.size(), 1, [&](size_t begin, size_t end, unsigned int) {
+		for (size_t i = begin; i < end; ++i) {
+			const size_t eventOffset = decodeOffsets[i];
+			if (!MMSEFormat::DecodeChunk(decodeSources[i], this->header, decodeEntries[i], eventTarget + eventOffset,
+				withSide ? idTarget + eventOffset : NULL, withSide ? sizeTarget + eventOffset : NULL,
+				withSide ? partnerTarget + eventOffset : NULL, withSide ? ratioTarget + eventOffset : NULL)) {
+				decodeSuccess = false;
+			}
+		}
+	});
+	if (!decodeSuccess) {
+		vislib::sys::Log::DefaultLog.WriteMsg(vislib::sys::Log::LEVEL_ERROR, "Unable to decode MMSE frames");
+		return false;
+	}
+
+	events->setEvents(this->eventData.As<float>(),
+		this->eventData.AsAt<float>(12),
+		this->eventData.AsAt<StructureEvents::EventType>(16),
+		this->maxTime,
+		count);
+
+	if (withSide) {
+		events->setSideColumns(this->sideData.As<int>(),
+			this->sideData.AsAt<int>(count * 4),
+			this->sideData.AsAt<int>(2 * count * 4),
+			this->sideData.AsAt<float>(3 * count * 4));
+	}
+	else {
+		events->setSideColumns(NULL, NULL, NULL, NULL);
+	}
+
+	// Columns per type for slices by type and time.
+	this->deferColumns(*events, this->eventData.As<StructureEvents::StructureEvent>(), count);
+
+	this->loadedFrameID = frame;
+	this->reReadData = false;
+
+	return true;
+}
+
+
+/**
+ * mmvis_static::StructureEventsDataSource::deferColumns
+ */
+void mmvis_static::StructureEventsDataSource::deferColumns(StructureEvents& events, const StructureEvents::StructureEvent *source,
+	const size_t count, const unsigned int stride) {
+	this->columnSource = source;
+	this->columnSourceCount = count;
+	this->columnSourceStride = stride;
+	this->eventColumns.clear();
+	events.setColumnBuilder(this);
+}
+
+
+/**
+ * mmvis_static::StructureEventsDataSource::buildColumns
+ */
+void mmvis_static::StructureEventsDataSource::buildColumns(StructureEvents& events) {
+	if (this->columnSource != NULL) {
+		this->eventColumns.build(this->columnSource, this->columnSourceCount, this->columnSourceStride);
+		this->columnSource = NULL;
+	}
+	this->eventColumns.setTo(events);
+}
@@ -15,29 +15,23 @@
 #include "mmcore/view/AnimDataModule.h"
 #include "mmcore/CalleeSlot.h"
 #include "mmcore/param/ParamSlot.h"
+#include "MappedFile.h"
+#include "MMSEFormat.h"
+#include "StructureEventsColumns.h"
 #include "StructureEventsDataCall.h"
 #include "vislib/math/Cuboid.h"
-#include "vislib/sys/File.h"
 #include "vislib/RawStorage.h"
+#include <fstream>
+#include <vector>
 
 namespace megamol {
 	namespace mmvis_static {
 		///
-		/// Reads MMSE file.
+		/// Reads MMSE file, version 1 and 2.
+		/// See MMSEFormat for the file format. The columns per event type are
+		/// built on the first slice request, not on open.
 		///
-		/// File format header:
-		/// 0..3 char* MagicIdentifier
-		/// 4..27 6x float (32 bit) Data set bounding box
-		/// 28..51 6x float (32 bit) Data set clipping box
-		/// 52..59 uint64_t Number of events
-		/// 60..63 float Maximum time of all events
-		///
-		/// File format body (relative bytes):
-		/// 0..11 3x float (32bit) Event position
-		/// 12..15 float Event time
-		/// 16..19 EventType (int) Event type
-		///
-		class StructureEventsDataSource : public core::Module {
+		class StructureEventsDataSource : public core::Module, public StructureEvents::ColumnBuilder {
 		//class StructureEventsDataSource : public core::view::AnimDataModule {
 		public:
 			/**
@@ -117,11 +111,34 @@ namespace megamol {
 			/// Sets the data.
 			bool SetData(StructureEventsDataCall& data);
 
+			/// Sets the data of version 2 files, all frames or only the requested one.
+			bool SetDataV2(StructureEventsDataCall& data);
+
+			/// Maps or unmaps the opened file depending on memoryMappingSlot.
+			void updateMapping(void);
+
+			///
+			/// Defers the columns of the loaded events to the first request.
+			///
+			/// @param source The loaded events, in the mapping or eventData.
+			///
+			void deferColumns(StructureEvents& events, const StructureEvents::StructureEvent *source, const size_t count,
+				const unsigned int stride = sizeof(StructureEvents::StructureEvent));
+
+			/// Builds the columns of the loaded events if needed and sets them to the events.
+			virtual void buildColumns(StructureEvents& events);
+
 			/// The file name.
 			core::param::ParamSlot filename;
 
+			/// Load only the events of the requested frame (version 2 files).
+			core::param::ParamSlot onlyRequestedFrameSlot;
+
+			/// Use the events in place from a memory mapping of the file.
+			core::param::ParamSlot memoryMappingSlot;
+
 			/// The opened data file.
-			vislib::sys::File *file;
+			std::ifstream *file;
 
 			/// The hash id of the data stored
 			size_t sedcHash;
@@ -138,6 +155,15 @@ namespace megamol {
 			/// The size of the header in byte, for file->seek.
 			int headerSize;
 
+			/// The file header.
+			MMSEFormat::Header header;
+
+			/// The frame chunks of version 2 files, ordered by frame id.
+			std::vector<MMSEFormat::FrameEntry> frameTable;
+
+			/// The frame loaded with onlyRequestedFrameSlot, -1 if all frames are loaded.
+			int loadedFrameID;
+
 			/// The data set event count.
 			size_t eventCount;
 
@@ -147,9 +173,27 @@ namespace megamol {
 			/// The number of time frames (SE doesnt have them), required for the call.
 			unsigned int frameCount;
 
-			/// The data.
+			/// The data, if the file is not mapped.
 			vislib::RawStorage eventData;
 
+			/// The mapping of the opened file, events are used in place where possible.
+			MappedFile mappedFile;
+
+			/// The side block data.
+			vislib::RawStorage sideData;
+
+			/// The data per event type, sorted by time.
+			StructureEventsColumns eventColumns;
+
+			/// The loaded events eventColumns are built from on request, NULL if built.
+			const StructureEvents::StructureEvent *columnSource;
+
+			/// Number of events at columnSource.
+			size_t columnSourceCount;
+
+			/// Byte distance of the events at columnSource.
+			unsigned int columnSourceStride;
+
 			/// Flag for data changes.
 			bool reReadData;
 		};
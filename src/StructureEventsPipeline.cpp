@@ -0,0 +1,1034 @@
+/**
+ * StructureEventsPipeline.cpp
+ *
+ * Copyright (C) 2009-2015 by MegaMol Team
+ * Copyright (C) 2015 by Richard Hhne, TU Dresden
+ * Alle Rechte vorbehalten.
+ */
+
+#include "StructureEventsPipeline.h"
+
+#include "ANN/ANN.h"
+
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstdarg>
+#include <cstdio>
+#include <mutex>
+#include <numeric>
+#include <type_traits>
+
+using namespace megamol;
+
+namespace {
+
+	/// Milliseconds since start.
+	long long millisecondsSince(const std::chrono::system_clock::time_point& start) {
+		return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now() - start).count();
+	}
+
+	/// Angle between two directions in radians, like vislib::math::Vector::Angle.
+	double angle(const float (&lhs)[3], const float (&rhs)[3]) {
+		const float dot = lhs[0] * rhs[0] + lhs[1] * rhs[1] + lhs[2] * rhs[2];
+		const float lengths = std::sqrt(lhs[0] * lhs[0] + lhs[1] * lhs[1] + lhs[2] * lhs[2])
+			* std::sqrt(rhs[0] * rhs[0] + rhs[1] * rhs[1] + rhs[2] * rhs[2]);
+		float cosAngle = dot / lengths;
+		if (cosAngle > 1.f)
+			cosAngle = 1.f;
+		else if (cosAngle < -1.f)
+			cosAngle = -1.f;
+		return std::acos(cosAngle);
+	}
+
+	// The scratch memory of the threads holds the ANN results.
+	static_assert(std::is_same<ANNidx, int>::value && std::is_same<ANNdist, double>::value, "ThreadScratch expects int indices and double distances.");
+
+	/// Fixed radius search on an ANN kD-tree, not thread safe.
+	struct KDTreeSearch {
+		ANNkd_tree *tree;
+
+		void operator()(ANNcoord (&query)[3], const ANNdist sqrRadius, const int k, ANNidx *indices, ANNdist *sqrDistances,
+				std::vector<mmvis_static::NeighbourGrid::Candidate>& /*candidates*/) const {
+			this->tree->annkFRSearch(query, sqrRadius, k, indices, sqrDistances);
+		}
+	};
+
+	/// Fixed radius search on a NeighbourGrid, thread safe.
+	struct GridSearch {
+		const mmvis_static::NeighbourGrid *grid;
+
+		void operator()(ANNcoord (&query)[3], const ANNdist sqrRadius, const int k, ANNidx *indices, ANNdist *sqrDistances,
+				std::vector<mmvis_static::NeighbourGrid::Candidate>& candidates) const {
+			this->grid->Search(query, sqrRadius, k, indices, sqrDistances, candidates);
+		}
+	};
+
+	/// Serializes the kD-tree searches of all pipelines.
+	std::mutex annMutex;
+
+	/// Serializes the log callbacks of all threads.
+	std::mutex logMutex;
+
+	/// Counters of the neighbour search, reduced over the particle blocks.
+	struct NeighbourCounts {
+		uint64_t skipped;
+		uint64_t added;
+		uint64_t grownLists;
+	};
+
+} /* end anonymous namespace */
+
+
+/**
+ * mmvis_static::StructureEventsPipeline::StructureEventsPipeline
+ */
+mmvis_static::StructureEventsPipeline::StructureEventsPipeline(void) : frameID(0), countedArenaAllocations(0), countedScratchBytes(0) {
+}
+
+
+/**
+ * mmvis_static::StructureEventsPipeline::~StructureEventsPipeline
+ */
+mmvis_static::StructureEventsPipeline::~StructureEventsPipeline(void) {
+}
+
+
+/**
+ * mmvis_static::StructureEventsPipeline::BeginFrame
+ */
+void mmvis_static::StructureEventsPipeline::BeginFrame(const unsigned int frameID) {
+	this->frameID = frameID;
+	this->statistics.Reset();
+	this->arena.Reset();
+
+	///
+	/// Current lists become the previous ones, without copies. The
+	/// particles of frame t-2 are recycled by AddParticles.
+	///
+	if (this->particleList.size() > 0) {
+		this->recycledParticles.swap(this->previousParticleList);
+		this->previousParticleList.swap(this->particleList);
+		this->particleList.clear(); // Don't forget!
+	}
+	if (this->clusterList.size() > 0) {
+		this->previousClusterList.swap(this->clusterList);
+		this->clusterList.clear(); // Don't forget!
+	}
+}
+
+
+/**
+ * mmvis_static::StructureEventsPipeline::AddParticles
+ */
+void mmvis_static::StructureEventsPipeline::AddParticles(const ParticleSpan& span) {
+	auto time_buildList = std::chrono::system_clock::now();
+
+	const unsigned int vertexStride = std::max<unsigned int>(span.positionStride, span.hasRadius ? 16 : 12);
+	const unsigned int colourStride = std::max<unsigned int>(span.signedDistanceStride, 4);
+	const uint8_t *vertexPtr = static_cast<const uint8_t*>(span.positions);
+	const uint8_t *colourPtr = static_cast<const uint8_t*>(span.signedDistances);
+	const uint64_t firstID = this->particleList.size();
+
+	if (this->particleList.capacity() < this->particleList.size() + static_cast<size_t>(span.count)) {
+		this->particleList.reserve(this->particleList.size() + static_cast<size_t>(span.count));
+		this->statistics.heapAllocations++;
+	}
+
+	for (uint64_t particleIndex = 0; particleIndex < span.count; ++particleIndex, vertexPtr += vertexStride, colourPtr += colourStride) {
+		// Reuse the particle with the same id of frame t-2 and the memory of its neighbour list.
+		const size_t id = static_cast<size_t>(firstID + particleIndex);
+		if (id < this->recycledParticles.size()) {
+			this->particleList.push_back(std::move(this->recycledParticles[id]));
+			this->particleList.back().neighbourIDs.clear();
+			this->particleList.back().clusterID = -1;
+		}
+		else
+			this->particleList.push_back(Particle());
+		Particle& particle = this->particleList.back();
+
+		// Vertex.
+		const float *vertexPtrf = reinterpret_cast<const float*>(vertexPtr);
+		particle.x = vertexPtrf[0];
+		particle.y = vertexPtrf[1];
+		particle.z = vertexPtrf[2];
+		particle.radius = span.hasRadius ? vertexPtrf[3] : span.globalRadius;
+
+		// Colour/Signed Distance.
+		particle.signedDistance = *reinterpret_cast<const float*>(colourPtr);
+
+		// Set particle ID.
+		particle.id = firstID + particleIndex;
+	}
+
+	this->statistics.particleListDuration += millisecondsSince(time_buildList);
+}
+
+
+/**
+ * mmvis_static::StructureEventsPipeline::Recycle
+ */
+void mmvis_static::StructureEventsPipeline::Recycle(void) {
+	if (this->particleList.size() > this->recycledParticles.size())
+		this->recycledParticles.swap(this->particleList);
+	this->particleList.clear();
+	this->previousParticleList.clear();
+	this->clusterList.clear();
+	this->previousClusterList.clear();
+}
+
+
+/**
+ * mmvis_static::StructureEventsPipeline::AdoptFrame
+ */
+void mmvis_static::StructureEventsPipeline::AdoptFrame(StructureEventsPipeline& clustered) {
+	this->frameID = clustered.frameID;
+	this->statistics = clustered.statistics;
+	this->arena.Reset();
+
+	///
+	/// Current lists become the previous ones, without copies.
+	///
+	if (this->particleList.size() > 0)
+		this->previousParticleList.swap(this->particleList);
+	if (this->clusterList.size() > 0)
+		this->previousClusterList.swap(this->clusterList);
+
+	this->particleList.swap(clustered.particleList);
+	this->clusterList.swap(clustered.clusterList);
+
+	// The other pipeline reuses the particles of frame t-2.
+	clustered.recycledParticles.swap(clustered.particleList);
+	clustered.particleList.clear();
+	clustered.clusterList.clear();
+}
+
+
+/**
+ * mmvis_static::StructureEventsPipeline::AdoptClusters
+ */
+void mmvis_static::StructureEventsPipeline::AdoptClusters(StructureEventsPipeline& clustered) {
+	const long long particleListDuration = this->statistics.particleListDuration;
+	const size_t heapAllocations = this->statistics.heapAllocations;
+	this->statistics = clustered.statistics;
+	this->statistics.particleListDuration = particleListDuration;
+	this->statistics.heapAllocations += heapAllocations;
+
+	this->particleList.swap(clustered.particleList);
+	this->clusterList.swap(clustered.clusterList);
+	clustered.particleList.clear();
+	clustered.clusterList.clear();
+}
+
+
+/**
+ * mmvis_static::StructureEventsPipeline::FindNeighbours
+ */
+void mmvis_static::StructureEventsPipeline::FindNeighbours(const Parameters& parameters) {
+	if (this->particleList.empty())
+		return;
+
+	const int maxNeighbours = GetKDTreeMaxNeighbours(parameters.radiusMultiplier);
+	const ANNdist sqrRadius = powf(parameters.radiusMultiplier * this->particleList[0].radius, 2);
+	this->statistics.maxNeighbours = maxNeighbours;
+
+	std::shared_ptr<TaskPool> pool = TaskPool::GetDefault();
+
+	auto time_buildTree = std::chrono::system_clock::now();
+
+	if (parameters.neighbourSearch == NEIGHBOURSEARCH_GRID) {
+		this->grid.Build(&this->particleList[0].x, sizeof(Particle), this->particleList.size(), std::sqrt(sqrRadius), *pool);
+
+		this->statistics.kdTreeBytes = this->grid.GetBytes();
+		this->statistics.kdTreeDuration = millisecondsSince(time_buildTree);
+
+		this->log(LOG_INFO, "SECalc step 1: Grid search with radius %d (%.2f) and %d max neighbours.", parameters.radiusMultiplier, sqrRadius, maxNeighbours);
+
+		GridSearch search;
+		search.grid = &this->grid;
+		this->searchNeighbours(*pool, search, parameters, sqrRadius, maxNeighbours, true);
+		this->countAllocations();
+		return;
+	}
+
+	/// ANN doesnt work with parallelisation since it uses the same shared memory for all search structures! http://stackoverflow.com/a/2182357
+	/// This includes the trees of pipelines calculating other frames at the same time.
+	std::lock_guard<std::mutex> annLock(annMutex);
+
+	///
+	/// Create k-d-Tree.
+	///
+	/// nn_idx return value of search functions matches position in ANNpointArray,
+	/// which matches the particle ID in particleList as long as particleList
+	/// is not resorted!
+	///
+	ANNpoint annPtsData = this->arena.AllocateArray<ANNcoord>(3 * this->particleList.size()); // Container for pointdata, valid until the next frame.
+	ANNpointArray annPts = this->arena.AllocateArray<ANNpoint>(this->particleList.size());
+	for (auto & particle : this->particleList) {
+		annPtsData[(particle.id * 3) + 0] = static_cast<ANNcoord>(particle.x);
+		annPtsData[(particle.id * 3) + 1] = static_cast<ANNcoord>(particle.y);
+		annPtsData[(particle.id * 3) + 2] = static_cast<ANNcoord>(particle.z);
+	}
+	for (size_t i = 0; i < this->particleList.size(); ++i) {
+		annPts[i] = annPtsData + (i * 3);
+	}
+
+	ANNkd_tree* tree = new ANNkd_tree(annPts, static_cast<int>(this->particleList.size()), 3);
+
+	this->statistics.kdTreeBytes = tree->nPoints() * sizeof(ANNcoord) * 3; // One ANNPoint consists of 3 ANNcoords here.
+	this->statistics.kdTreeDuration = millisecondsSince(time_buildTree);
+
+	this->log(LOG_INFO, "SECalc step 1: annkFRSearch with radius %d (%.2f) and %d max neighbours.", parameters.radiusMultiplier, sqrRadius, maxNeighbours);
+
+	KDTreeSearch search;
+	search.tree = tree;
+	this->searchNeighbours(*pool, search, parameters, sqrRadius, maxNeighbours, false);
+
+	delete tree; // ANN allocates its nodes itself.
+
+	/// From ANN manual v1.1, page 8: The library allocates a small amount of storage,
+	/// which is shared by all search structures built during the programs lifetime.
+	/// To avoid the resulting (minor) memory leak, the following function can be
+	/// called after all search structures have been destroyed.
+	annClose();
+
+	this->countAllocations();
+}
+
+
+/**
+ * mmvis_static::StructureEventsPipeline::searchNeighbours
+ */
+template<typename Search>
+void mmvis_static::StructureEventsPipeline::searchNeighbours(TaskPool& pool, const Search& search, const Parameters& parameters,
+		const double sqrRadius, const int maxNeighbours, const bool concurrent) {
+
+	///
+	/// Bounding box for periodic boundary condition.
+	///
+	const float bboxSize[3] = {
+		parameters.bboxMax[0] - parameters.bboxMin[0],
+		parameters.bboxMax[1] - parameters.bboxMin[1],
+		parameters.bboxMax[2] - parameters.bboxMin[2] };
+	const float bboxCenter[3] = {
+		parameters.bboxMin[0] + bboxSize[0] / 2,
+		parameters.bboxMin[1] + bboxSize[1] / 2,
+		parameters.bboxMin[2] + bboxSize[2] / 2 };
+	const bool periodicBoundary = parameters.periodicBoundary;
+
+	///
+	/// Find and store neighbours.
+	///
+	const auto time_findNeighbours = std::chrono::system_clock::now();
+
+	this->prepareThreadScratch(pool);
+
+	const NeighbourCounts noCounts = { 0, 0, 0 };
+	auto searchBlock = [&](size_t begin, size_t end, unsigned int thread) -> NeighbourCounts {
+		NeighbourCounts counts = noCounts;
+
+		// Result arrays and search scratch memory of the thread.
+		ThreadScratch& scratch = this->getThreadScratch(thread);
+		scratch.indices.resize(maxNeighbours);
+		scratch.sqrDistances.resize(maxNeighbours);
+		ANNidx *nn_idx = scratch.indices.data();
+		ANNdist *dd = scratch.sqrDistances.data();
+		ANNcoord q[3];
+
+		for (size_t particleIndex = begin; particleIndex < end; ++particleIndex) {
+			Particle& particle = this->particleList[particleIndex];
+
+			// The three loops are for periodic boundary condition.
+			for (int x_s = 0; x_s < (periodicBoundary ? 2 : 1); ++x_s) {
+				for (int y_s = 0; y_s < (periodicBoundary ? 2 : 1); ++y_s) {
+					for (int z_s = 0; z_s < (periodicBoundary ? 2 : 1); ++z_s) {
+
+						q[0] = static_cast<ANNcoord>(particle.x);
+						q[1] = static_cast<ANNcoord>(particle.y);
+						q[2] = static_cast<ANNcoord>(particle.z);
+
+						if (x_s > 0) q[0] = static_cast<ANNcoord>(particle.x + ((particle.x > bboxCenter[0]) ? -bboxSize[0] : bboxSize[0]));
+						if (y_s > 0) q[1] = static_cast<ANNcoord>(particle.y + ((particle.y > bboxCenter[1]) ? -bboxSize[1] : bboxSize[1]));
+						if (z_s > 0) q[2] = static_cast<ANNcoord>(particle.z + ((particle.z > bboxCenter[2]) ? -bboxSize[2] : bboxSize[2]));
+
+						search(q, sqrRadius, maxNeighbours, nn_idx, dd, scratch.candidates);
+
+						for (int i = 0; i < maxNeighbours; ++i) {
+							if (nn_idx[i] == ANN_NULL_IDX) {
+								counts.skipped++;
+								continue;
+							}
+							if (dd[i] < 0.001f) // Exclude self to catch ANN_ALLOW_SELF_MATCH = true.
+								continue;
+
+							counts.added++;
+							if (particle.neighbourIDs.size() == particle.neighbourIDs.capacity())
+								counts.grownLists++;
+							particle.neighbourIDs.push_back(nn_idx[i]);
+						}
+					}
+				}
+			}
+
+			// Progress.
+			if (particleIndex % 100000 == 0 && particleIndex > 0)
+				this->log(LOG_INFO, "SECalc step 1 progress: Neighbours of particle %d searched.", static_cast<int>(particleIndex));
+		}
+		return counts;
+	};
+
+	///
+	/// The neighbour counts differ a lot between dense and sparse regions,
+	/// the blocks are small enough to be balanced by the pool.
+	///
+	NeighbourCounts counts;
+	if (concurrent) {
+		counts = pool.Reduce(0, this->particleList.size(), 1024, noCounts, searchBlock,
+			[](const NeighbourCounts& lhs, const NeighbourCounts& rhs) -> NeighbourCounts {
+				NeighbourCounts sum = { lhs.skipped + rhs.skipped, lhs.added + rhs.added, lhs.grownLists + rhs.grownLists };
+				return sum;
+			});
+	}
+	else
+		counts = searchBlock(0, this->particleList.size(), pool.GetCallerThread());
+
+	this->statistics.addedNeighbours = counts.added;
+	this->statistics.skippedNeighbours = counts.skipped;
+	this->statistics.heapAllocations += static_cast<size_t>(counts.grownLists);
+	this->statistics.neighboursDuration = millisecondsSince(time_findNeighbours);
+}
+
+
+/**
+ * mmvis_static::StructureEventsPipeline::CreateClustersFastDepth
+ */
+void mmvis_static::StructureEventsPipeline::CreateClustersFastDepth(const Parameters& parameters) {
+	auto time_createCluster = std::chrono::system_clock::now();
+
+	size_t noNeighbourCounter = 0;
+	size_t usedExistingClusterCounter = 0;
+	size_t numberOfGasParticles = 0;
+	uint64_t progressControl = 1; // For avoiding duplicated progress control output. Initial value different from % 100000.
+	size_t progressControlCluster = 1; // For avoiding duplicated progress control output. Initial value different from % 100.
+
+	int clusterID = 0;
+
+	///
+	/// Reallocation of clusterList (due to growth) makes pointer invalid. Either fix by:
+	/// 1) give clusterList big size, so list doesnt resize.
+	/// 2) change references to ids, clusterList mustn't be resorted but may be reallocated in memory.
+	/// 3) use id's in struct Cluster (+ vector may be resorted, - access very slow)
+	///
+	/// It has been fixed with method (1) (for speed) and method (2).
+	///
+
+	// Avoid reallocation of clusterList, method (1) - though it's a waste of memory it saves time (no reallocation)!
+	if (parameters.radiusMultiplier < 3)
+		this->clusterList.reserve(this->particleList.size() / 5); // Low radius multiplier will create a lot of clusters. Only important for test runs.
+	else
+		this->clusterList.reserve(this->particleList.size() / 20);
+
+	std::shared_ptr<TaskPool> pool = TaskPool::GetDefault();
+
+	// Container for deepest neighbours, reused for all particles.
+	this->prepareThreadScratch(*pool);
+	std::vector<uint64_t>& parsedParticleIDs = this->getThreadScratch(pool->GetCallerThread()).path;
+
+	///
+	/// The deepest neighbour of a particle only depends on the particle, so
+	/// it is searched in parallel, the particle itself if no neighbour is
+	/// deeper than 0. The ascents below only follow these links, their
+	/// cluster creation stays sequential to keep the cluster ids.
+	///
+	uint64_t *deepestNeighbourIDs = this->arena.AllocateArray<uint64_t>(this->particleList.size());
+	pool->ParallelFor(0, this->particleList.size(), 2048, [this, deepestNeighbourIDs](size_t begin, size_t end, unsigned int) {
+		for (size_t p = begin; p < end; ++p) {
+			const Particle& particle = this->particleList[p];
+			float signedDistance = 0; // For comparison of neighbours.
+			uint64_t deepestNeighbourID = particle.id;
+			for (size_t i = 0; i < particle.neighbourIDs.size(); ++i) {
+				const Particle& neighbour = this->particleList[particle.neighbourIDs[i]];
+				if (neighbour.signedDistance > signedDistance) {
+					signedDistance = neighbour.signedDistance;
+					deepestNeighbourID = neighbour.id;
+				}
+			}
+			deepestNeighbourIDs[p] = deepestNeighbourID;
+		}
+	});
+
+	for (auto & particle : this->particleList) {
+		if (particle.signedDistance < 0) {
+			numberOfGasParticles++; // Not usable with concurrency.
+			continue; // Skip gas.
+		}
+
+		if (particle.neighbourIDs.size() == 0) {
+			noNeighbourCounter++; // Not usable with concurrency.
+			continue; // Skip particles without neighbours.
+		}
+
+		if (particle.clusterID != -1)
+			continue; // Skip particles that already belong to a cluster.
+
+		///
+		/// Traverse the neighbours to find the deepest neighbour.
+		///
+		auto time_addParticlePath = std::chrono::system_clock::now();
+
+		parsedParticleIDs.clear();
+
+		// Positions, signed distances and neighbours don't change in this step,
+		// so the particles are referenced instead of copied.
+		const Particle *deepestNeighbour = &particle; // Initial condition.
+
+		for (;;) {
+			const Particle *currentParticle = deepestNeighbour; // Set last deepest particle as new current.
+
+			// Get deepest neighbour.
+			deepestNeighbour = &this->particleList[deepestNeighbourIDs[currentParticle->id]];
+
+			// Add current deepest neighbour to the list containing all the parsed particles.
+			parsedParticleIDs.push_back(deepestNeighbour->id);
+
+			if (currentParticle->signedDistance >= deepestNeighbour->signedDistance) { // Current particle is local maximum.
+
+				// Find cluster in list.
+				uint64_t rootParticleID = currentParticle->id;
+				std::vector<Cluster>::iterator clusterListIterator = std::find_if(this->clusterList.begin(), this->clusterList.end(), [rootParticleID](const Cluster& c) -> bool {
+					return rootParticleID == c.rootParticleID;
+				});
+
+				Cluster* clusterPtr;
+
+				// Create new cluster.
+				if (clusterListIterator == this->clusterList.end()) { // Iterator at the end of the list means std::find didnt find match.
+					Cluster cluster;
+					cluster.rootParticleID = currentParticle->id;
+					cluster.id = clusterID; clusterID++;
+					this->clusterList.push_back(cluster);
+					clusterPtr = &clusterList.back();
+				}
+				// Point to existing cluster.
+				else {
+					usedExistingClusterCounter++;
+					clusterPtr = &(*clusterListIterator); // Since iterator is never at v.end() here, it can be dereferenced.
+				}
+
+				///
+				/// Add particle to cluster.
+				///
+				particle.clusterID = clusterPtr->id;
+				(*clusterPtr).numberOfParticles++;
+
+				// Check for list ids consistency. Paranoia!
+				if (particle.clusterID != this->clusterList[particle.clusterID].id) {
+					this->log(LOG_ERROR, "SECalc step 2 (build): Cluster ID and position in cluster don't match: %d != %d!",
+						particle.clusterID, this->clusterList[particle.clusterID].id);
+				}
+
+				///
+				/// Add the deepest neighbours found within the traversion to the cluster.
+				/// Exceptions:
+				/// - those that are already in a cluster
+				/// - the last neighbour since it was added just to check
+				///   if the current particle is the deepest particle.
+				///
+				parsedParticleIDs.pop_back(); // Remove last deepest neighbour since it is not deeper than current particle.
+				for (auto & particleID : parsedParticleIDs) {
+
+					// Check for list ids consistency. Paranoia!
+					if (this->particleList[particleID].id != particleID) {
+						this->log(LOG_ERROR, "SECalc step 2 (build): Particle ID and position in particle list don't match: %llu != %llu!",
+							static_cast<unsigned long long>(particleID), static_cast<unsigned long long>(this->particleList[particleID].id));
+					}
+
+					if (this->particleList[particleID].clusterID >= 0)
+						continue; // Skip particles already in a cluster.
+
+					this->particleList[particleID].clusterID = clusterPtr->id; // Requires untouched (i.e. sorting forbidden) particleList!
+					(*clusterPtr).numberOfParticles++; // Caused a bug since particles that are already part of the cluster are added again. Checks above avoid this now.
+				}
+
+				// Progress, to not loose patience. To track creation of a lot of clusters.
+				if (this->clusterList.size() % 1000 == 0)
+					if (this->clusterList.size() != progressControlCluster) {
+						progressControlCluster = this->clusterList.size();
+						this->log(LOG_INFO, "SECalc step 2 progress: Amount of clusters %d. Particle %llu. Liquid particles w/o neighbours %d.",
+							static_cast<int>(this->clusterList.size()), static_cast<unsigned long long>(particle.id), static_cast<int>(noNeighbourCounter));
+					}
+
+				// Progress, to not loose patience when waiting for results.
+				if (particle.id % 100000 == 0) {
+					if (particle.id != progressControl) {
+						progressControl = particle.id;
+						this->log(LOG_INFO, "SECalc step 2 progress: Cluster for p %llu (%lld ms, total %lld ms), pathlength %d.\nCluster elements: %llu. Total number of clusters: %d.",
+							static_cast<unsigned long long>(particle.id), millisecondsSince(time_addParticlePath), millisecondsSince(time_createCluster),
+							static_cast<int>(parsedParticleIDs.size()), static_cast<unsigned long long>((*clusterPtr).numberOfParticles), static_cast<int>(this->clusterList.size()));
+					}
+				}
+				break;
+			}
+		}
+	}
+
+	this->statistics.gasParticles = numberOfGasParticles;
+	this->statistics.noNeighbourParticles = noNeighbourCounter;
+	this->statistics.usedExistingClusterParticles = usedExistingClusterCounter;
+	this->statistics.fastDepthDuration = millisecondsSince(time_createCluster);
+	this->countAllocations();
+}
+
+
+/**
+ * mmvis_static::StructureEventsPipeline::MergeSmallClusters
+ */
+void mmvis_static::StructureEventsPipeline::MergeSmallClusters(const Parameters& parameters) {
+	auto time_mergeClusters = std::chrono::system_clock::now();
+
+	const uint64_t minClusterSize = static_cast<uint64_t>(std::max(parameters.minClusterSize, 0));
+	int mergedParticles = 0;
+
+	std::shared_ptr<TaskPool> pool = TaskPool::GetDefault();
+	this->prepareThreadScratch(*pool);
+
+	///
+	/// Two passes, so the result does not depend on the threads: the new
+	/// cluster of each particle is decided in parallel with the cluster
+	/// sizes of Fast Depth, then the sizes are updated in particle order.
+	/// The particles are read only: a merged particle changes the sizes of
+	/// both clusters, its cluster id in the list stays as it is.
+	/// The search of neighbour clusters ranges from one to three levels of
+	/// neighbours, so the blocks are small to let the pool balance them.
+	///
+	int *newClusterIDs = this->arena.AllocateArray<int>(this->particleList.size()); // -1 := stays.
+	pool->ParallelFor(0, this->particleList.size(), 256, [&](size_t begin, size_t end, unsigned int thread) {
+		for (size_t i = begin; i < end; ++i) {
+			const Particle& particle = this->particleList[i];
+			newClusterIDs[i] = -1;
+			if (particle.signedDistance < 0)
+				continue; // Skip gas.
+
+			if (particle.neighbourIDs.size() == 0)
+				continue; // Skip particles without neighbours.
+
+			if (particle.clusterID == -1)
+				continue; // Skip particles w/o pointers, mandatory for test runs.
+
+			// Check for list ids consistency. Paranoia!
+			if (particle.clusterID != this->clusterList[particle.clusterID].id) {
+				this->log(LOG_ERROR, "SECalc step 2 (merge): Cluster ID and position in cluster don't match: %d != %d!",
+					particle.clusterID, this->clusterList[particle.clusterID].id);
+			}
+			if (this->clusterList[particle.clusterID].rootParticleID != this->particleList[this->clusterList[particle.clusterID].rootParticleID].id) {
+				this->log(LOG_ERROR, "SECalc step 2 (merge): Root particle ID and position in particle list don't match: %llu != %llu!",
+					static_cast<unsigned long long>(this->clusterList[particle.clusterID].rootParticleID),
+					static_cast<unsigned long long>(this->particleList[this->clusterList[particle.clusterID].rootParticleID].id));
+			}
+
+			if (this->clusterList[particle.clusterID].numberOfParticles >= minClusterSize) // Requires untouched (i.e. sorting forbidden) clusterList!
+				continue; // Skip particles of bigger clusters.
+
+			///
+			/// Add clusters in neighbourhood which are bigger than minClusterSize.
+			///
+			std::vector<int>& neighbourClusterIDs = this->getThreadScratch(thread).clusterIDs;
+			neighbourClusterIDs.clear();
+
+			for (auto neighbourID : particle.neighbourIDs) {
+				Particle* neighbour = &this->particleList[neighbourID];
+
+				if (neighbour->clusterID == -1)
+					continue; // Skip particles w/o pointers, mandatory for test runs.
+
+				if (this->clusterList[neighbour->clusterID].rootParticleID != this->clusterList[particle.clusterID].rootParticleID
+					&& this->clusterList[neighbour->clusterID].numberOfParticles >= minClusterSize) {
+					neighbourClusterIDs.push_back(this->clusterList[neighbour->clusterID].id);
+				}
+			}
+
+			///
+			/// 2nd level.
+			/// If no clusters in range, check neighbours of neighbours.
+			///
+			if (neighbourClusterIDs.size() == 0) {
+				for (size_t ni = 0; ni < particle.neighbourIDs.size(); ++ni) {
+					Particle* neighbour = &this->particleList[particle.neighbourIDs[ni]];
+
+					// Check neighbours of neighbours.
+					for (auto secondaryNeighbourID : neighbour->neighbourIDs) {
+						Particle* secondaryNeighbour = &this->particleList[secondaryNeighbourID];
+
+						if (secondaryNeighbour->clusterID == -1)
+							continue; // Skip particles w/o pointers, mandatory for test runs.
+
+						if (this->clusterList[secondaryNeighbour->clusterID].rootParticleID != this->clusterList[particle.clusterID].rootParticleID
+							&& this->clusterList[secondaryNeighbour->clusterID].numberOfParticles >= minClusterSize) {
+							neighbourClusterIDs.push_back(this->clusterList[secondaryNeighbour->clusterID].id);
+						}
+					}
+				}
+			}
+
+			///
+			/// 3rd level.
+			/// If no clusters in range, check neighbours of neighbour neighbours.
+			///
+			if (neighbourClusterIDs.size() == 0) {
+				for (size_t ni = 0; ni < particle.neighbourIDs.size(); ++ni) {
+					Particle* neighbour = &this->particleList[particle.neighbourIDs[ni]];
+
+					for (auto secondaryNeighbourID : neighbour->neighbourIDs) {
+						Particle* secondaryNeighbour = &this->particleList[secondaryNeighbourID];
+
+						// Check neighbours of neighbours neighbour.
+						for (auto tertiaryNeighbourID : secondaryNeighbour->neighbourIDs) {
+							Particle* tertiaryNeighbour = &this->particleList[tertiaryNeighbourID];
+
+							if (tertiaryNeighbour->clusterID == -1)
+								continue; // Skip particles w/o pointers, mandatory for test runs.
+
+							if (this->clusterList[tertiaryNeighbour->clusterID].rootParticleID != this->clusterList[particle.clusterID].rootParticleID
+								&& this->clusterList[tertiaryNeighbour->clusterID].numberOfParticles >= minClusterSize) {
+								neighbourClusterIDs.push_back(this->clusterList[tertiaryNeighbour->clusterID].id);
+							}
+						}
+					}
+				}
+			}
+
+			// If still no other clusters are in range it is assumed there are no connected other clusters, so this particle stays in the small cluster.
+			if (neighbourClusterIDs.size() == 0)
+				continue;
+
+			///
+			/// Determine new cluster.
+			///
+			int newClusterID = -1;
+			const double pi = 3.14159265358979323846;
+			double smallestAngle = 2 * pi;
+
+			// Direction of particle to its root.
+			const Particle& particleClusterRoot = this->particleList[this->clusterList[particle.clusterID].rootParticleID]; // Requires untouched (i.e. sorting forbidden) clusterList and particleList!
+			const float dirParticle[3] = {
+				particle.x - particleClusterRoot.x,
+				particle.y - particleClusterRoot.y,
+				particle.z - particleClusterRoot.z };
+
+			// Direction of particle to its neighbour clusters roots. Few clusters, so no nested loop on the pool.
+			for (size_t ncid = 0; ncid < neighbourClusterIDs.size(); ++ncid) {
+				int clusterID = neighbourClusterIDs[ncid];
+				const Particle& clusterRoot = this->particleList[this->clusterList[clusterID].rootParticleID]; // Requires untouched (i.e. sorting forbidden) clusterList and particleList!
+				const float dirNeighbourCluster[3] = {
+					particle.x - clusterRoot.x,
+					particle.y - clusterRoot.y,
+					particle.z - clusterRoot.z };
+
+				// Get angle.
+				double clusterAngle = angle(dirParticle, dirNeighbourCluster);
+
+				if (clusterAngle > pi)
+					clusterAngle -= 2 * pi;
+
+				// Smallest angle.
+				if (clusterAngle < smallestAngle) {
+					newClusterID = clusterID;
+					smallestAngle = clusterAngle;
+				}
+			}
+
+			newClusterIDs[i] = newClusterID;
+		}
+	});
+
+	// Eventually set new clusters.
+	for (size_t i = 0; i < this->particleList.size(); ++i) {
+		if (newClusterIDs[i] < 0)
+			continue;
+		this->clusterList[this->particleList[i].clusterID].numberOfParticles--; // Remove particle from old cluster.
+		this->clusterList[newClusterIDs[i]].numberOfParticles++; // Add particle to new cluster.
+		mergedParticles++;
+	}
+
+	///
+	/// No deletion of clusters here to not destroy
+	/// referencing by vector indices. Instead zero size
+	/// particle clusters should be ignored by the
+	/// compareCluster function.
+	///
+
+	this->statistics.mergedParticles = mergedParticles;
+	this->statistics.mergeDuration = millisecondsSince(time_mergeClusters);
+	this->countAllocations();
+}
+
+
+/**
+ * mmvis_static::StructureEventsPipeline::CompareClusters
+ */
+bool mmvis_static::StructureEventsPipeline::CompareClusters(void) {
+
+	if (this->previousClusterList.size() == 0 || this->previousParticleList.size() == 0) {
+		this->partnerClustersList.forwardList.clear();
+		this->partnerClustersList.backwardsList.clear();
+		this->log(LOG_WARN, "SECCalc step 3: No previous data, quit cluster comparison.");
+		return false;
+	}
+
+	auto time_compareClusters = std::chrono::system_clock::now();
+
+	std::shared_ptr<TaskPool> pool = TaskPool::GetDefault();
+
+	///
+	/// Create a comparison matrix to see how many particles the clusters have in common.
+	/// The inner vector contains the columns, the outer vector contains the rows.
+	/// The columns represents the previous clusters. Column id == cluster id of previous clusterList.
+	/// The rows represents the current clusters. Row id == cluster id of current clusterList.
+	/// Access by clusterComparisonMatrix[row * columns + column], rows after rows in the frame arena.
+	///
+	const size_t columns = this->previousClusterList.size();
+	int *clusterComparisonMatrix = this->arena.AllocateArray<int>(this->clusterList.size() * columns);
+	std::fill(clusterComparisonMatrix, clusterComparisonMatrix + this->clusterList.size() * columns, 0);
+
+	// Previous to current particle comparison.
+	assert(this->particleList.size() == this->previousParticleList.size()); // Catches (smaller) dummy lists.
+	for (size_t pid = 0; pid < this->particleList.size(); ++pid) { // Since particleList size stays the same for each frame, one loop is just fine.
+		if (this->particleList[pid].clusterID != -1 && this->previousParticleList[pid].clusterID != -1) // Skip gas.
+			clusterComparisonMatrix[this->particleList[pid].clusterID * columns + this->previousParticleList[pid].clusterID]++; // Race condition, so no parallel processing.
+	}
+
+	// Count gas.
+	auto countGas = [pool](const std::vector<Particle>& list) -> int {
+		return pool->Reduce(0, list.size(), 65536, 0, [&list](size_t begin, size_t end, unsigned int) -> int {
+			int gasCount = 0;
+			for (size_t pid = begin; pid < end; ++pid) {
+				if (list[pid].clusterID < 0)
+					gasCount++;
+			}
+			return gasCount;
+		}, std::plus<int>());
+	};
+	this->statistics.gasCountPrevious = countGas(this->previousParticleList);
+	this->statistics.gasCountCurrent = countGas(this->particleList);
+
+	///
+	/// The partner lists of the last comparison are overwritten, so the
+	/// partners of each entry reuse their memory. The entry of a cluster is
+	/// the number of unmerged clusters before it (scan), so the entries are
+	/// filled in parallel in the same order as before. The common particles
+	/// of a cluster and a partner are at matrix[cid * clusterStride + partnerID * partnerStride].
+	///
+	std::atomic<size_t> grownPartnerLists(0);
+	auto comparePartners = [this, pool, clusterComparisonMatrix, &grownPartnerLists](std::vector<PartnerClusters>& list, const std::vector<Cluster>& clusters,
+			const std::vector<Cluster>& partners, const size_t clusterStride, const size_t partnerStride) {
+		size_t *entries = this->arena.AllocateArray<size_t>(clusters.size());
+		for (size_t cid = 0; cid < clusters.size(); ++cid)
+			entries[cid] = (clusters[cid].numberOfParticles == 0) ? 0 : 1; // Skip merged clusters.
+		const size_t count = pool->ExclusiveScan(entries, entries, clusters.size(), 4096);
+
+		if (count > list.capacity())
+			grownPartnerLists++;
+		list.resize(count);
+
+		pool->ParallelFor(0, clusters.size(), 64, [&](size_t begin, size_t end, unsigned int) {
+			for (size_t cid = begin; cid < end; ++cid) {
+				if (clusters[cid].numberOfParticles == 0)
+					continue; // Skip merged clusters.
+
+				PartnerClusters& partnerClusters = list[entries[cid]];
+				partnerClusters.reset(clusters[cid]);
+				const size_t partnerBytes = partnerClusters.getBytes();
+
+				for (size_t partnerID = 0; partnerID < partners.size(); ++partnerID) {
+					int numberOfCommonParticles = clusterComparisonMatrix[cid * clusterStride + partnerID * partnerStride];
+					if (numberOfCommonParticles > 0)
+						partnerClusters.addPartner(partners[partnerID], numberOfCommonParticles);
+				}
+				partnerClusters.finalizePartners(); // Partner set complete, sort ratios for threshold queries.
+
+				if (partnerClusters.getBytes() > partnerBytes)
+					grownPartnerLists++;
+			}
+		});
+	};
+
+	// Forward check: Partners of each previous cluster.
+	comparePartners(this->partnerClustersList.forwardList, this->previousClusterList, this->clusterList, 1, columns);
+
+	// Backwards check: Partners of each current cluster.
+	comparePartners(this->partnerClustersList.backwardsList, this->clusterList, this->previousClusterList, columns, 1);
+
+	this->statistics.heapAllocations += grownPartnerLists;
+	this->countAllocations();
+	this->statistics.compareDuration = millisecondsSince(time_compareClusters);
+	return true;
+}
+
+
+/**
+ * mmvis_static::StructureEventsPipeline::DetermineStructureEvents
+ */
+bool mmvis_static::StructureEventsPipeline::DetermineStructureEvents(const Parameters& parameters, std::vector<Event>& events) {
+	events.clear();
+
+	if (this->partnerClustersList.forwardList.size() == 0 || this->partnerClustersList.backwardsList.size() == 0) {
+		this->log(LOG_WARN, "SECalc step 4: No comparison data, quit determination of StructureEvents.");
+		return false;
+	}
+
+	auto time_setStructureEvents = std::chrono::system_clock::now();
+
+	int (&eventAmount)[4] = this->statistics.eventAmount;
+	std::fill(eventAmount, eventAmount + 4, 0);
+
+	// Event at the root particle of the triggering cluster.
+	auto addEvent = [this, &events, &eventAmount](const PartnerClusters& partnerClusters, const Particle& root, const EventType type) {
+		Event se;
+		se.x = root.x;
+		se.y = root.y;
+		se.z = root.z;
+		se.time = static_cast<float>(this->frameID);
+		se.type = type;
+		se.triggerClusterID = partnerClusters.cluster.id;
+		se.triggerClusterSize = static_cast<int>(partnerClusters.cluster.numberOfParticles);
+		se.partnerCount = partnerClusters.getNumberOfPartners();
+		se.commonPercentage = static_cast<float>(partnerClusters.getTotalCommonPercentage());
+		events.push_back(se);
+		eventAmount[type]++;
+	};
+
+	///
+	/// Forward direction.
+	///
+	for (const auto & partnerClusters : this->partnerClustersList.forwardList) { // No parallelization because of little computation and sequential output.
+		const Particle& root = this->previousParticleList[partnerClusters.cluster.rootParticleID];
+
+		// Detect split.
+		if (partnerClusters.getBigPartnerAmount(parameters.msMinCPPercentage) >= parameters.msMinClusterAmount)
+			addEvent(partnerClusters, root, SPLIT);
+
+		// Detect death.
+		if (partnerClusters.getNumberOfPartners() == 0 || partnerClusters.getTotalCommonPercentage() <= parameters.bdMaxCPPercentage)
+			addEvent(partnerClusters, root, DEATH);
+	}
+
+	///
+	/// Backward direction.
+	///
+	for (const auto & partnerClusters : this->partnerClustersList.backwardsList) { // No parallelization because of little computation and sequential output.
+		const Particle& root = this->particleList[partnerClusters.cluster.rootParticleID];
+
+		// Detect merge.
+		if (partnerClusters.getBigPartnerAmount(parameters.msMinCPPercentage) >= parameters.msMinClusterAmount)
+			addEvent(partnerClusters, root, MERGE);
+
+		// Detect birth.
+		if (partnerClusters.getNumberOfPartners() == 0 || partnerClusters.getTotalCommonPercentage() <= parameters.bdMaxCPPercentage)
+			addEvent(partnerClusters, root, BIRTH);
+	}
+
+	if (events.size() == 0)
+		this->log(LOG_WARN, "SECalc step 4: No structure events determined!");
+
+	this->statistics.eventsDuration = millisecondsSince(time_setStructureEvents);
+	return true;
+}
+
+
+/**
+ * mmvis_static::StructureEventsPipeline::Calculate
+ */
+void mmvis_static::StructureEventsPipeline::Calculate(const unsigned int frameID, const std::vector<ParticleSpan>& spans,
+		const Parameters& parameters, std::vector<Event>& events) {
+	events.clear();
+
+	this->BeginFrame(frameID);
+	for (auto & span : spans)
+		this->AddParticles(span);
+
+	this->FindNeighbours(parameters);
+	this->CreateClustersFastDepth(parameters);
+	this->MergeSmallClusters(parameters);
+
+	if (this->previousClusterList.size() > 0 && this->previousParticleList.size() > 0) {
+		if (this->CompareClusters())
+			this->DetermineStructureEvents(parameters, events);
+	}
+}
+
+
+/**
+ * mmvis_static::StructureEventsPipeline::GetKDTreeMaxNeighbours
+ */
+int mmvis_static::StructureEventsPipeline::GetKDTreeMaxNeighbours(const int radiusMultiplier) {
+	int maxNeighbours = 0;
+	switch (radiusMultiplier){
+	case 2: // Not tested, so using safe maxNeighbours amount.
+	case 3: // Not tested, so using safe maxNeighbours amount.
+	case 4:
+		maxNeighbours = 35;
+		break;
+	case 5:
+		maxNeighbours = 60;
+		break;
+	case 6:
+		maxNeighbours = 100;
+		break;
+	case 7:
+		maxNeighbours = 155;
+		break;
+	case 8: // Not tested, so using safe maxNeighbours amount.
+	case 9: // Not tested, so using safe maxNeighbours amount.
+	case 10:
+		maxNeighbours = 425;
+		break;
+	}
+	return maxNeighbours;
+}
+
+
+/**
+ * mmvis_static::StructureEventsPipeline::prepareThreadScratch
+ */
+void mmvis_static::StructureEventsPipeline::prepareThreadScratch(const TaskPool& pool) {
+	if (this->threadScratch.size() < pool.GetThreadCount())
+		this->threadScratch.resize(pool.GetThreadCount());
+}
+
+
+/**
+ * mmvis_static::StructureEventsPipeline::countAllocations
+ */
+void mmvis_static::StructureEventsPipeline::countAllocations(void) {
+	this->statistics.arenaBytes = std::max(this->statistics.arenaBytes, this->arena.GetUsedBytes());
+
+	this->statistics.heapAllocations += this->arena.GetHeapAllocations() - this->countedArenaAllocations;
+	this->countedArenaAllocations = this->arena.GetHeapAllocations();
+
+	// Growth of the scratch memory, at least one allocation.
+	size_t scratchBytes = 0;
+	for (auto & scratch : this->threadScratch)
+		scratchBytes += scratch.GetBytes();
+	if (scratchBytes > this->countedScratchBytes)
+		this->statistics.heapAllocations++;
+	this->countedScratchBytes = scratchBytes;
+}
+
+
+/**
+ * mmvis_static::StructureEventsPipeline::log
+ */
+void mmvis_static::StructureEventsPipeline::log(const LogLevel level, const char *format, ...) const {
+	if (!this->logCallback)
+		return;
+
+	char message[1024];
+	va_list arguments;
+	va_start(arguments, format);
+	vsnprintf(message, sizeof(message), format, arguments);
+	va_end(arguments);
+
+	std::lock_guard<std::mutex> lock(logMutex);
+	this->logCallback(level, message);
+}
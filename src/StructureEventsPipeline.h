@@ -0,0 +1,720 @@
+/**
+ * StructureEventsPipeline.h
+ *
+ * Copyright (C) 2009-2015 by MegaMol Team
+ * Copyright (C) 2015 by Richard Hhne, TU Dresden
+ * Alle Rechte vorbehalten.
+ */
+
+#ifndef MMVISSTATIC_StructureEventsPipeline_H_INCLUDED
+#define MMVISSTATIC_StructureEventsPipeline_H_INCLUDED
+#if (defined(_MSC_VER) && (_MSC_VER > 1000))
+#pragma once
+#endif /* (defined(_MSC_VER) && (_MSC_VER > 1000)) */
+
+#include "FrameArena.h"
+#include "NeighbourGrid.h"
+#include "TaskPool.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace megamol {
+	namespace mmvis_static {
+
+		///
+		/// Steps 1 to 4 of the structure event calculation on plain C++ data,
+		/// without MegaMol: strided position/signed distance spans in,
+		/// clusters, partner lists and events out.
+		/// StructureEventsCalculation is the adapter of the pipeline to the
+		/// MegaMol calls and parameters and writes all logs and files.
+		///
+		/// Usage per frame:
+		/// BeginFrame, AddParticles for each particle list, FindNeighbours,
+		/// CreateClustersFastDepth, MergeSmallClusters, CompareClusters,
+		/// DetermineStructureEvents. Calculate runs all of them.
+		///
+		/// Only needs the standard library and ANN, so it can be built,
+		/// benchmarked and profiled without the MegaMol runtime.
+		///
+		/// The parallel loops of the steps run on the default TaskPool.
+		///
+		/// Temporaries of a frame come from a frame arena and per thread
+		/// scratch memory, the particles of frame t-2 are reused for the next
+		/// frame. After the first frames the steps hardly allocate, the
+		/// remaining heap allocations are counted in the statistics.
+		///
+		class StructureEventsPipeline {
+		public:
+
+			struct Cluster;
+
+			///
+			/// Dichtgepacktes struct.
+			/// It is important that no automatic padding is inserted by compiler
+			/// therefore all datatypes have sizes of 4 or 8.
+			///
+			/// MPDC data types: FLOAT_XYZR, FLOAT_RGB.
+			/// Stride = (4 byte * (4 + 3 + 1)) + 8 byte + Cluster + Neighbours.
+			///
+			struct Particle {
+				float x, y, z, radius;
+				float r, g, b;
+				float signedDistance;
+				uint64_t id;
+
+				// Store a pointer to the cluster. Bad when cluster is moved in memory.
+				//Cluster* clusterPtr = NULL;
+				// Store the cluster id. Save when cluster list is moved in memory.
+				int clusterID = -1;
+
+				// Store pointer to the neighbours. Bad when they are moved in memory.
+				//std::vector<Particle*> neighbourPtrs;
+				// Store ids of the neighbours. Save when particle list is moved in memory.
+				std::vector<uint64_t> neighbourIDs;
+
+				// Copy & store neighbour directly to avoid costly
+				// list search everytime we need a neighbour.
+				// Doesn't work, takes way too much memory!
+				// std::vector<Particle> neighbours;
+
+				Particle() : clusterID(-1) {}
+
+				// This constructor wastes memory and takes a lot of time.
+				Particle(int radiusModifier) : clusterID(-1) {
+					// The compiler should set vector reservation since the vector
+					// is stored at a different location in memory than the struct.
+					neighbourIDs.reserve(StructureEventsPipeline::GetKDTreeMaxNeighbours(radiusModifier));
+				}
+
+				bool operator==(const Particle& rhs) const {
+					return this->id == rhs.id;
+				}
+			};
+
+			struct Cluster {
+				uint64_t rootParticleID;
+				uint64_t numberOfParticles = 0;
+				int id;
+				float r, g, b = 0; // For visualization.
+
+				bool operator==(const Cluster& rhs) const {
+					return this->id == rhs.id;
+				}
+			};
+
+			class PartnerClusters {
+			public:
+				struct PartnerCluster {
+					Cluster cluster;
+					int commonParticles = 0;
+					bool isGasCluster = false;
+
+					//PartnerClusters &parent;  // Reference to parent
+					//PartnerCluster(PartnerClusters &ccs) : parent(ccs) {}  // Initialise reference in constructor
+
+					/// Common percentage with this (partner) cluster.
+					double getCommonPercentage() const {
+						return (static_cast<float> (this->commonParticles) / static_cast<float> (this->cluster.numberOfParticles)) * 100;
+					}
+
+					/// Common percentage with parent cluster.
+					double getClusterCommonPercentage(const Cluster& c) const {
+						return (static_cast<float> (this->commonParticles) / static_cast<float> (c.numberOfParticles)) * 100;
+					}
+					/*
+					PartnerCluster operator=(const PartnerCluster& rhs) {
+						//PartnerCluster cc(rhs.parent);
+						cc.cluster = rhs.cluster;
+						cc.commonParticles = rhs.commonParticles;
+						return cc;
+					}
+					*/
+					bool operator==(const PartnerCluster& rhs) const {
+						return this->cluster == rhs.cluster;
+					}
+
+					//bool operator<(const PartnerCluster& rhs) const {
+					//	return this->commonParticles > rhs.commonParticles;
+					//}
+				};
+			private:
+				std::vector<PartnerCluster> partners;
+				//std::multimap<int, PartnerCluster, std::greater<int>> partners; // Highest int first.
+
+				/// Ratios ClusterCommonPercentage / TotalCommonPercentage of all partners, sorted ascending.
+				/// Set by finalizePartners() so threshold queries become a binary search.
+				std::vector<double> sortedPartnerRatios;
+				bool partnersFinalized = false;
+
+				int minCommonParticles = -1;
+				int maxCommonParticles = -1;
+				int totalCommonParticles = 0;
+				double minCommonPercentage = -1.f;
+				double maxCommonPercentage = -1.f;
+				double totalCommonPercentage = -1.f;
+
+			public:
+				Cluster cluster;
+
+				/// Empties the partners for the cluster, keeps the memory of the lists.
+				void reset(const Cluster& newCluster) {
+					this->cluster = newCluster;
+					this->partners.clear();
+					this->sortedPartnerRatios.clear();
+					this->partnersFinalized = false;
+					this->minCommonParticles = this->maxCommonParticles = -1;
+					this->totalCommonParticles = 0;
+					this->minCommonPercentage = this->maxCommonPercentage = this->totalCommonPercentage = -1.f;
+				}
+
+				/// Memory of the partner lists in byte.
+				size_t getBytes() const {
+					return this->partners.capacity() * sizeof(PartnerCluster) + this->sortedPartnerRatios.capacity() * sizeof(double);
+				}
+
+				void addPartner(Cluster newCluster, int commonParticles) {
+					PartnerCluster PartnerCluster;
+					PartnerCluster.cluster = newCluster;
+					PartnerCluster.commonParticles = commonParticles;
+					this->partners.push_back(PartnerCluster);
+					//this->partners.insert(std::pair<int, PartnerCluster> (commonParticles, PartnerCluster));
+					this->partnersFinalized = false; // Ratio distribution is outdated.
+
+					totalCommonParticles += commonParticles;
+
+					// Max and min.
+					if (minCommonParticles < 0 || minCommonParticles > commonParticles)
+						minCommonParticles = commonParticles;
+					if (maxCommonParticles < 0 || maxCommonParticles < commonParticles)
+						maxCommonParticles = commonParticles;
+					if (minCommonPercentage < 0 || minCommonPercentage > PartnerCluster.getClusterCommonPercentage(this->cluster))
+						minCommonPercentage = PartnerCluster.getClusterCommonPercentage(this->cluster);
+					if (maxCommonPercentage < 0 || maxCommonPercentage < PartnerCluster.getClusterCommonPercentage(this->cluster))
+						maxCommonPercentage = PartnerCluster.getClusterCommonPercentage(this->cluster);
+				}
+
+				void addPartner(Cluster newCluster, int commonParticles, bool gasCluster) {
+					if (gasCluster) {
+						PartnerCluster PartnerCluster;
+						PartnerCluster.cluster = newCluster;
+						PartnerCluster.commonParticles = commonParticles;
+						PartnerCluster.isGasCluster = true;
+					}
+					else
+						this->addPartner(newCluster, commonParticles);
+				}
+
+				void sortPartners() {
+					std::sort(this->partners.begin(), this->partners.end(), [](const PartnerCluster& lhs, const PartnerCluster& rhs) {
+						return (lhs.commonParticles > rhs.commonParticles);
+					});
+				}
+
+				PartnerCluster getPartner(const int partnerPosition) const {
+					return this->partners[partnerPosition];
+				}
+
+				///
+				/// Sorts the partner share ratios once the partner set is complete.
+				/// Has to be called after the last addPartner(), otherwise the
+				/// threshold queries fall back to scanning all partners.
+				///
+				void finalizePartners() {
+					this->sortedPartnerRatios.clear();
+					this->sortedPartnerRatios.reserve(this->partners.size());
+					const double totalCommonPercentage = this->getTotalCommonPercentage();
+					if (totalCommonPercentage != 0) {
+						for (auto & partner : this->partners)
+							this->sortedPartnerRatios.push_back(partner.getClusterCommonPercentage(this->cluster) / totalCommonPercentage);
+						std::sort(this->sortedPartnerRatios.begin(), this->sortedPartnerRatios.end());
+					}
+					this->partnersFinalized = true;
+				}
+
+				/// Amount of partner clusters with ClusterCommonPercentage / TotalCommonPercentage >= percentage %.
+				/// Previous->current: For possible split detection, not optimal for big clusters.
+				/// Current->previous: For possible merge detection, not optimal for big clusters.
+				/// O(log partners) after finalizePartners().
+				int getBigPartnerAmount(const double percentage) const {
+					if (this->getTotalCommonPercentage() == 0)
+						return -1; // It's so 90s.
+
+					double ratio = percentage / 100;
+
+					if (this->partnersFinalized) {
+						auto first = std::lower_bound(this->sortedPartnerRatios.begin(), this->sortedPartnerRatios.end(), ratio);
+						return static_cast<int>(this->sortedPartnerRatios.end() - first);
+					}
+
+					int count = 0;
+					for (auto & partner : this->partners) {
+						if (partner.getClusterCommonPercentage(this->cluster) / this->getTotalCommonPercentage() >= ratio)
+							count++;
+					}
+					return count;
+				}
+
+				/// Amount of partner clusters with ClusterCommonPercentage / TotalCommonPercentage <= percentage %.
+				/// For noise detection.
+				/// O(log partners) after finalizePartners().
+				int getSmallPartnerAmount(const double percentage) const {
+					if (this->getTotalCommonPercentage() == 0)
+						return -1; // It's so 90s.
+
+					double ratio = percentage / 100;
+
+					if (this->partnersFinalized) {
+						auto last = std::upper_bound(this->sortedPartnerRatios.begin(), this->sortedPartnerRatios.end(), ratio);
+						return static_cast<int>(last - this->sortedPartnerRatios.begin());
+					}
+
+					int count = 0;
+					for (auto & partner : this->partners) {
+						if (partner.getClusterCommonPercentage(this->cluster) / this->getTotalCommonPercentage() <= ratio)
+							count++;
+					}
+					return count;
+				}
+
+				/// Average number of common particles. 
+				/// For similar cluster detection.
+				/// For noise detection.
+				double getAveragePartnerCommonPercentage() const {
+					return this->getTotalCommonPercentage() / static_cast<double>(this->partners.size());
+				}
+
+				/// Common particle to cluster size ratio.
+				/// Previous->current: For shrink detection. For death detection.
+				/// Current->previous: For growth detection. For birth detection.
+				double getTotalCommonPercentage() const {
+					if (this->totalCommonPercentage < 0)
+						return (static_cast<float> (this->totalCommonParticles) / static_cast<float> (this->cluster.numberOfParticles)) * 100;
+					return this->totalCommonPercentage;
+				}
+
+				/// Ratio of common particles of the biggest partner to common particle ratio of this cluster.
+				/// For similar cluster detection.
+				double getLocalMaxTotalPercentage() const { // Name props to Andreas.
+					if (this->getTotalCommonPercentage() == 0)
+						return -1; // It's so 90s.
+
+					return (this->maxCommonPercentage / this->getTotalCommonPercentage()) * 100;
+				}
+
+				/// For similar cluster detection.
+				/// For noise detection.
+				/// For birth detection (backwards).
+				/// For death detection (forward).
+				int getNumberOfPartners() const {
+					return static_cast<int> (partners.size());
+				}
+
+				int getMinCommonParticles() const {
+					return this->minCommonParticles;
+				}
+
+				int getMaxCommonParticles() const {
+					return this->maxCommonParticles;
+				}
+
+				int getTotalCommonParticles() const {
+					return this->totalCommonParticles;
+				}
+
+				double getMinCommonPercentage() const {
+					return this->minCommonPercentage;
+				}
+
+				double getMaxCommonPercentage() const {
+					return this->maxCommonPercentage;
+				}
+
+				bool hasPartnerCluster(int clusterID) const {
+					auto it = std::find_if(this->partners.begin(), this->partners.end(), [clusterID](const PartnerCluster& pc) -> bool {
+						return pc.cluster.id == clusterID;
+					});
+					if (it != partners.end())
+						return true;
+					else
+						return false;
+				}
+			};
+
+			///
+			/// Container to hold both comparison lists w/o own global values.
+			/// Provides methods to access extrema or search in both lists.
+			///
+			class PartnerClustersList {
+			private:
+			public:
+				std::vector<PartnerClusters> forwardList;
+				std::vector<PartnerClusters> backwardsList;
+
+				enum class Direction : int {
+					forward,
+					backwards
+				};
+
+				PartnerClusters getMaxPercentage(Direction direction = Direction::forward) {
+					std::vector<PartnerClusters>* list;
+					if (direction == Direction::backwards)
+						list = &this->backwardsList;
+					else
+						list = &this->forwardList;
+					auto it = std::max_element(list->begin(), list->end(), [](const PartnerClusters& lhs, const PartnerClusters& rhs) {
+						return lhs.getTotalCommonPercentage() < rhs.getTotalCommonPercentage();
+					});
+					return *it;
+				}
+
+				PartnerClusters getMinPercentage(Direction direction = Direction::forward) {
+					std::vector<PartnerClusters>* list;
+					if (direction == Direction::backwards)
+						list = &this->backwardsList;
+					else
+						list = &this->forwardList;
+					auto it = std::min_element(list->begin(), list->end(), [](const PartnerClusters& lhs, const PartnerClusters& rhs) {
+						return lhs.getTotalCommonPercentage() < rhs.getTotalCommonPercentage();
+					});
+					return *it;
+				}
+
+				PartnerClusters* getPartnerClusters(int clusterId, Direction direction = Direction::forward) {
+					std::vector<PartnerClusters>* list;
+					if (direction == Direction::backwards)
+						list = &this->backwardsList;
+					else
+						list = &this->forwardList;
+					std::vector<PartnerClusters>::iterator it = std::find_if(list->begin(), list->end(), [clusterId](const PartnerClusters& p) -> bool {
+						return p.cluster.id == clusterId;
+					});
+					if (it == list->end())
+						return NULL;
+					return static_cast<PartnerClusters*>(&(*it));
+				}
+
+				/// List of PartnerClusters who contains the clusterid as parent.
+				/// @param direction Direction of the cluster whos clusterId is given.
+				std::vector<PartnerClusters*> getParentPartnerClusters(int clusterId, Direction directionOfGivenCluster = Direction::forward) {
+					std::vector<PartnerClusters>* parentList;
+					std::vector<PartnerClusters*> returnList;
+					if (directionOfGivenCluster == Direction::backwards)
+						parentList = &this->forwardList;
+					else
+						parentList = &this->backwardsList;
+					for (auto partnerClusters : *parentList) {
+						if (partnerClusters.hasPartnerCluster(clusterId))
+							returnList.push_back(&partnerClusters);
+					}
+					return returnList;
+				}
+			};
+
+			///
+			/// Particles of one list, e.g. one MMPLD particle list.
+			/// Positions are 3 floats, followed by the radius if hasRadius.
+			/// The signed distance is one float per particle.
+			///
+			struct ParticleSpan {
+				const void *positions;
+				unsigned int positionStride; // Byte from one position to the next, 0 if packed.
+				bool hasRadius;
+				float globalRadius; // Used if !hasRadius.
+				const void *signedDistances;
+				unsigned int signedDistanceStride; // Byte from one signed distance to the next, 0 if packed.
+				uint64_t count;
+
+				ParticleSpan(void) : positions(NULL), positionStride(0), hasRadius(false), globalRadius(0),
+					signedDistances(NULL), signedDistanceStride(0), count(0) {}
+			};
+
+			/// Search structures of step 1.
+			enum NeighbourSearch {
+				NEIGHBOURSEARCH_KDTREE = 0, // ANN kD-tree, one search at a time in the process.
+				NEIGHBOURSEARCH_GRID = 1 // NeighbourGrid, parallel and concurrent searches.
+			};
+
+			/// Parameters of all steps, defaults are the ones of the module.
+			struct Parameters {
+				/// Steps 1 and 2.
+				NeighbourSearch neighbourSearch;
+				int radiusMultiplier;
+				int minClusterSize;
+				bool periodicBoundary;
+				float bboxMin[3], bboxMax[3]; // For the periodic boundary condition.
+
+				/// Step 4.
+				float msMinCPPercentage;
+				int msMinClusterAmount;
+				float bdMaxCPPercentage;
+
+				Parameters(void) : neighbourSearch(NEIGHBOURSEARCH_KDTREE), radiusMultiplier(5), minClusterSize(10), periodicBoundary(true),
+					msMinCPPercentage(40.f), msMinClusterAmount(2), bdMaxCPPercentage(2.f) {
+					std::fill(this->bboxMin, this->bboxMin + 3, 0.f);
+					std::fill(this->bboxMax, this->bboxMax + 3, 0.f);
+				}
+			};
+
+			/// Event types, same values as StructureEvents::EventType.
+			enum EventType : int {
+				BIRTH = 0,
+				DEATH,
+				MERGE,
+				SPLIT
+			};
+
+			/// Event with the properties of its triggering cluster.
+			struct Event {
+				float x, y, z;
+				float time;
+				EventType type;
+				int triggerClusterID;
+				int triggerClusterSize;
+				int partnerCount;
+				float commonPercentage;
+			};
+
+			/// Values of the last frame for logs and metrics. Durations in ms.
+			struct Statistics {
+				/// Step 1.
+				long long particleListDuration;
+				long long kdTreeDuration;
+				long long neighboursDuration;
+				size_t kdTreeBytes;
+				int maxNeighbours;
+				uint64_t addedNeighbours;
+				uint64_t skippedNeighbours; // Out of FRSearch radius.
+
+				/// Step 2.
+				long long fastDepthDuration;
+				size_t gasParticles;
+				size_t noNeighbourParticles; // Liquid particles w/o neighbours.
+				size_t usedExistingClusterParticles;
+				long long mergeDuration;
+				int mergedParticles;
+
+				/// Step 3.
+				long long compareDuration;
+				int gasCountPrevious;
+				int gasCountCurrent;
+
+				/// Step 4.
+				long long eventsDuration;
+				int eventAmount[4]; // 0 := Birth, 1 := Death, 2 := Merge, 3 := Split.
+
+				/// Memory.
+				size_t arenaBytes; // Peak of the frame arena.
+				size_t heapAllocations; // Arena blocks, grown scratch, neighbour and partner lists.
+
+				Statistics(void) {
+					this->Reset();
+				}
+
+				void Reset(void) {
+					particleListDuration = kdTreeDuration = neighboursDuration = fastDepthDuration = mergeDuration = compareDuration = eventsDuration = 0;
+					kdTreeBytes = 0;
+					maxNeighbours = 0;
+					addedNeighbours = skippedNeighbours = 0;
+					gasParticles = noNeighbourParticles = usedExistingClusterParticles = 0;
+					mergedParticles = 0;
+					gasCountPrevious = gasCountCurrent = 0;
+					std::fill(eventAmount, eventAmount + 4, 0);
+					arenaBytes = heapAllocations = 0;
+				}
+			};
+
+			/// Message levels of the log callback.
+			enum LogLevel {
+				LOG_ERROR = 1,
+				LOG_WARN = 100,
+				LOG_INFO = 200
+			};
+
+			/// Receives errors, warnings and progress messages. Calls are serialized.
+			typedef std::function<void(const LogLevel level, const std::string& message)> LogCallback;
+
+			/// Ctor.
+			StructureEventsPipeline(void);
+
+			/// Dtor.
+			virtual ~StructureEventsPipeline(void);
+
+			/// Sets the receiver of messages, none by default.
+			inline void SetLogCallback(const LogCallback& callback) {
+				this->logCallback = callback;
+			}
+
+			///
+			/// Starts a frame: the particles and clusters of the last frame
+			/// become the previous ones, the lists of the frame are empty.
+			///
+			void BeginFrame(const unsigned int frameID);
+
+			/// Appends the particles of the span, ids continue the ones of the previous spans.
+			void AddParticles(const ParticleSpan& span);
+
+			///
+			/// Empties all lists for a frame that does not follow the current
+			/// one. The particles are kept for reuse by AddParticles.
+			///
+			void Recycle(void);
+
+			///
+			/// Starts a frame with the particles and clusters of steps 1 and 2 of
+			/// another pipeline, e.g. one that calculated them concurrently with
+			/// other frames. Moves the lists and takes the statistics, the
+			/// lists of the other pipeline are empty afterwards.
+			///
+			void AdoptFrame(StructureEventsPipeline& clustered);
+
+			///
+			/// Replaces steps 1b and 2 of the current frame by the lists of
+			/// another pipeline that clustered the same particles, e.g. ahead of
+			/// time. Keeps the previous lists, takes the statistics of steps 1b
+			/// and 2. The lists of the other pipeline are empty afterwards.
+			///
+			void AdoptClusters(StructureEventsPipeline& clustered);
+
+			///
+			/// Step 1: Fixed radius neighbour search. The kD-tree search is
+			/// serialized across all pipelines, the grid search runs in parallel.
+			///
+			void FindNeighbours(const Parameters& parameters);
+
+			/// Step 2a: Cluster Fast Depth, create clusters using neighbourhood and signed distance.
+			void CreateClustersFastDepth(const Parameters& parameters);
+
+			/// Step 2b: Merge small clusters into bigger ones.
+			void MergeSmallClusters(const Parameters& parameters);
+
+			///
+			/// Step 3: Compares the clusters of the previous and the current frame.
+			/// @return False if there are no previous clusters.
+			///
+			bool CompareClusters(void);
+
+			///
+			/// Step 4: Heuristics on the partner lists of step 3.
+			/// @param events Receives the events of the frame.
+			/// @return False if there is no comparison data.
+			///
+			bool DetermineStructureEvents(const Parameters& parameters, std::vector<Event>& events);
+
+			///
+			/// Runs all steps on the frame. Steps 3 and 4 are skipped for the first frame.
+			/// @param events Receives the events of the frame.
+			///
+			void Calculate(const unsigned int frameID, const std::vector<ParticleSpan>& spans, const Parameters& parameters, std::vector<Event>& events);
+
+			inline unsigned int GetFrameID(void) const {
+				return this->frameID;
+			}
+
+			inline const Statistics& GetStatistics(void) const {
+				return this->statistics;
+			}
+
+			///
+			/// Returns minimal maxNeighbours for radius so no particle in radius gets excluded.
+			/// Determined by experiments:
+			///
+			/// radiusMultiplier, maxNeighbours
+			/// 4, 35 <- causes zero signed distance one size clusters phenomenon 
+			/// 5, 60 <- causes zero signed distance one size clusters phenomenon 
+			/// 6, 100
+			/// 7, 155
+			/// 10, 425
+			/// 20, 3270
+			///
+			static int GetKDTreeMaxNeighbours(const int radiusMultiplier);
+
+			/// List with all particles of one frame. Key = particle id.
+			/// The adapter may fill the cluster ids (cluster cache, dummy lists).
+			std::vector<Particle> particleList;
+			std::vector<Particle> previousParticleList;
+
+			/// List with all clusters. Key = cluster id.
+			std::vector<Cluster> clusterList;
+			std::vector<Cluster> previousClusterList;
+
+			/// Cluster comparison.
+			PartnerClustersList partnerClustersList;
+
+		private:
+
+			/// Scratch memory of a thread, kept across frames.
+			struct ThreadScratch {
+				std::vector<int> indices; // Of the neighbour search.
+				std::vector<double> sqrDistances;
+				std::vector<NeighbourGrid::Candidate> candidates;
+				std::vector<uint64_t> path; // Deepest neighbours of Fast Depth.
+				std::vector<int> clusterIDs; // Neighbour clusters of the merge.
+
+				size_t GetBytes(void) const {
+					return this->indices.capacity() * sizeof(int) + this->sqrDistances.capacity() * sizeof(double)
+						+ this->candidates.capacity() * sizeof(NeighbourGrid::Candidate)
+						+ this->path.capacity() * sizeof(uint64_t) + this->clusterIDs.capacity() * sizeof(int);
+				}
+			};
+
+			/// Forbidden copy ctor.
+			StructureEventsPipeline(const StructureEventsPipeline& src);
+
+			/// Forbidden assignment.
+			StructureEventsPipeline& operator=(const StructureEventsPipeline& rhs);
+
+			/// Formats and passes the message to the callback.
+			void log(const LogLevel level, const char *format, ...) const;
+
+			/// Provides scratch memory for each thread of the pool.
+			void prepareThreadScratch(const TaskPool& pool);
+
+			/// Scratch memory of a thread of the pool, after prepareThreadScratch.
+			inline ThreadScratch& getThreadScratch(const unsigned int thread) {
+				return this->threadScratch[thread];
+			}
+
+			/// Adds the arena blocks and scratch growth since the last call to the statistics.
+			void countAllocations(void);
+
+			///
+			/// Queries the search for every particle and its periodic images and stores the neighbours.
+			/// @param search Called as search(query, sqrRadius, k, indices, sqrDistances, candidates).
+			/// @param concurrent Flag that the search is thread safe, else it runs on the calling thread.
+			///
+			template<typename Search>
+			void searchNeighbours(TaskPool& pool, const Search& search, const Parameters& parameters, const double sqrRadius,
+				const int maxNeighbours, const bool concurrent);
+
+			LogCallback logCallback;
+
+			unsigned int frameID;
+
+			Statistics statistics;
+
+			/// Temporaries of the frame, reset by BeginFrame and AdoptFrame.
+			FrameArena arena;
+
+			/// Grid of the neighbour search, keeps its memory across frames.
+			NeighbourGrid grid;
+
+			/// Scratch memory, index = thread of the TaskPool.
+			std::vector<ThreadScratch> threadScratch;
+
+			/// Particles of frame t-2, their neighbour lists are reused by AddParticles.
+			std::vector<Particle> recycledParticles;
+
+			/// Arena blocks and scratch memory at the last countAllocations.
+			size_t countedArenaAllocations;
+			size_t countedScratchBytes;
+		};
+
+	} /* namespace mmvis_static */
+} /* namespace megamol */
+
+#endif /* MMVISSTATIC_StructureEventsPipeline_H_INCLUDED */
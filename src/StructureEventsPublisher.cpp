@@ -0,0 +1,132 @@
+/**
+ * StructureEventsPublisher.cpp
+ *
+ * Copyright (C) 2009-2015 by MegaMol Team
+ * Copyright (C) 2015 by Richard Hhne, TU Dresden
+ * Alle Rechte vorbehalten.
+ */
+
+#include "stdafx.h"
+#include "StructureEventsPublisher.h"
+
+#include <algorithm>
+
+using namespace megamol;
+
+/**
+ * mmvis_static::StructureEventsPublisher::StructureEventsPublisher
+ */
+mmvis_static::StructureEventsPublisher::StructureEventsPublisher(void) : store(), changes(), droppedChanges(0), loggedSize(0), copies() {
+}
+
+
+/**
+ * mmvis_static::StructureEventsPublisher::~StructureEventsPublisher
+ */
+mmvis_static::StructureEventsPublisher::~StructureEventsPublisher(void) {
+}
+
+
+/**
+ * mmvis_static::StructureEventsPublisher::SetFrameEvents
+ */
+void mmvis_static::StructureEventsPublisher::SetFrameEvents(const unsigned int frameId, const std::vector<StructureEvents::StructureEvent>& frameEvents,
+	const std::vector<StructureEventsStore::EventDetails>& frameDetails) {
+	this->store.setFrameEvents(frameId, frameEvents, frameDetails);
+
+	this->changes.push_back(Change());
+	Change& change = this->changes.back();
+	change.clear = false;
+	change.frameId = frameId;
+	change.events = frameEvents;
+	change.details = frameDetails;
+	this->logChange();
+}
+
+
+/**
+ * mmvis_static::StructureEventsPublisher::Clear
+ */
+void mmvis_static::StructureEventsPublisher::Clear(void) {
+	this->store.clear();
+
+	this->changes.push_back(Change());
+	this->changes.back().clear = true;
+	this->changes.back().frameId = 0;
+	this->logChange();
+}
+
+
+/**
+ * mmvis_static::StructureEventsPublisher::Publish
+ */
+std::shared_ptr<const mmvis_static::StructureEventsStore> mmvis_static::StructureEventsPublisher::Publish(void) {
+	const size_t changeCount = this->droppedChanges + this->changes.size();
+
+	///
+	/// A copy released by all readers. The release of the last reader
+	/// happens before the copy is changed again.
+	///
+	std::shared_ptr<Copy> copy;
+	for (auto & candidate : this->copies) {
+		if (!candidate->published.load(std::memory_order_acquire)) {
+			copy = candidate;
+			break;
+		}
+	}
+
+	///
+	/// Replay the missed changes, copy the whole store if the log does not have them.
+	///
+	if (copy && copy->appliedChanges >= this->droppedChanges) {
+		for (size_t i = copy->appliedChanges; i < changeCount; ++i) {
+			const Change& change = this->changes[i - this->droppedChanges];
+			if (change.clear)
+				copy->store.clear();
+			else
+				copy->store.setFrameEvents(change.frameId, change.events, change.details);
+		}
+	}
+	else {
+		if (!copy) {
+			copy = std::make_shared<Copy>();
+			this->copies.push_back(copy);
+		}
+		copy->store = this->store;
+	}
+	copy->appliedChanges = changeCount;
+	copy->store.getColumns(); // Built here, not by the readers.
+	copy->published.store(true, std::memory_order_relaxed);
+
+	///
+	/// Drop the changes all copies have.
+	///
+	size_t appliedChanges = changeCount;
+	for (auto & candidate : this->copies)
+		appliedChanges = std::min(appliedChanges, candidate->appliedChanges);
+	while (this->droppedChanges < appliedChanges) {
+		this->loggedSize -= this->changes.front().events.size() + 1;
+		this->changes.pop_front();
+		this->droppedChanges++;
+	}
+
+	// The copy lives until the last reader and the publisher have released it.
+	return std::shared_ptr<const StructureEventsStore>(&copy->store, [copy](const StructureEventsStore *) {
+		copy->published.store(false, std::memory_order_release);
+	});
+}
+
+
+/**
+ * mmvis_static::StructureEventsPublisher::logChange
+ */
+void mmvis_static::StructureEventsPublisher::logChange(void) {
+	this->loggedSize += this->changes.back().events.size() + 1;
+
+	// Replaying more would cost more than copying the store.
+	while (!this->changes.empty() && this->loggedSize > this->store.getCount() + 1) {
+		this->loggedSize -= this->changes.front().events.size() + 1;
+		this->changes.pop_front();
+		this->droppedChanges++;
+	}
+}
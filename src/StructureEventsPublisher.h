@@ -0,0 +1,116 @@
+/**
+ * StructureEventsPublisher.h
+ *
+ * Copyright (C) 2009-2015 by MegaMol Team
+ * Copyright (C) 2015 by Richard Hhne, TU Dresden
+ * Alle Rechte vorbehalten.
+ */
+
+#ifndef MMVISSTATIC_StructureEventsPublisher_H_INCLUDED
+#define MMVISSTATIC_StructureEventsPublisher_H_INCLUDED
+#if (defined(_MSC_VER) && (_MSC_VER > 1000))
+#pragma once
+#endif /* (defined(_MSC_VER) && (_MSC_VER > 1000)) */
+
+#include "StructureEventsStore.h"
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <vector>
+
+namespace megamol {
+	namespace mmvis_static {
+
+		/**
+		 * Event store of the calculation and its published copies for the
+		 * threads reading the events.
+		 *
+		 * Every change of the store is recorded. Publish() takes a copy no
+		 * reader holds any more and replays the changes it missed, so a
+		 * published frame costs the events changed since that copy was
+		 * published, not all events. A copy is never changed while a reader
+		 * holds it. A copy that missed more changes than the log keeps is
+		 * copied as a whole, the log never holds more events than the store.
+		 *
+		 * All methods are called by the thread of the calculation only, the
+		 * published copies may be released on any thread.
+		 */
+		class StructureEventsPublisher {
+		public:
+
+			/// Ctor.
+			StructureEventsPublisher(void);
+
+			/// Dtor, published copies stay valid until they are released.
+			virtual ~StructureEventsPublisher(void);
+
+			/// The events of the calculation, only changed by SetFrameEvents and Clear.
+			inline const StructureEventsStore& GetStore(void) const {
+				return this->store;
+			}
+
+			/// Columns of the events of the calculation, see StructureEventsStore::getColumns.
+			inline const StructureEventsColumns& GetColumns(void) {
+				return this->store.getColumns();
+			}
+
+			/// Replaces the events of the frame, see StructureEventsStore::setFrameEvents.
+			void SetFrameEvents(const unsigned int frameId, const std::vector<StructureEvents::StructureEvent>& frameEvents,
+				const std::vector<StructureEventsStore::EventDetails>& frameDetails = std::vector<StructureEventsStore::EventDetails>());
+
+			/// Removes the events of all frames.
+			void Clear(void);
+
+			///
+			/// Copy of the current events with built columns, not changed until
+			/// the last reader releases it.
+			///
+			std::shared_ptr<const StructureEventsStore> Publish(void);
+
+		private:
+
+			/// Change of the store, a frame's events or the removal of all events.
+			struct Change {
+				bool clear;
+				unsigned int frameId;
+				std::vector<StructureEvents::StructureEvent> events;
+				std::vector<StructureEventsStore::EventDetails> details;
+			};
+
+			/// Copy of the store for the readers.
+			struct Copy {
+				StructureEventsStore store;
+				size_t appliedChanges; // Number of changes since the start that are in the store.
+				std::atomic<bool> published; // Reset by the last reader.
+
+				Copy(void) : store(), appliedChanges(0), published(false) {}
+			};
+
+			/// Forbidden copy ctor.
+			StructureEventsPublisher(const StructureEventsPublisher& src);
+
+			/// Forbidden assignment.
+			StructureEventsPublisher& operator=(const StructureEventsPublisher& rhs);
+
+			/// Counts the last change of the log, drops the oldest changes beyond the events of the store.
+			void logChange(void);
+
+			/// Events of the calculation.
+			StructureEventsStore store;
+
+			/// Changes not yet in all copies, the first one is change number droppedChanges.
+			std::deque<Change> changes;
+			size_t droppedChanges;
+
+			/// Events of the logged changes, one more per change.
+			size_t loggedSize;
+
+			/// Copies of the store, published or free.
+			std::vector<std::shared_ptr<Copy>> copies;
+		};
+
+	} /* namespace mmvis_static */
+} /* namespace megamol */
+
+#endif /* MMVISSTATIC_StructureEventsPublisher_H_INCLUDED */
@@ -0,0 +1,183 @@
+/**
+ * StructureEventsStore.cpp
+ *
+ * Copyright (C) 2009-2015 by MegaMol Team
+ * Copyright (C) 2015 by Richard Hhne, TU Dresden
+ * Alle Rechte vorbehalten.
+ */
+
+#include "stdafx.h"
+#include "StructureEventsStore.h"
+
+#include <algorithm>
+
+using namespace megamol;
+
+/**
+ * mmvis_static::StructureEventsStore::StructureEventsStore
+ */
+mmvis_static::StructureEventsStore::StructureEventsStore(void) : events(), detailedFrameCount(0), partitions(), maxTime(0), columns(), columnsByFrame(true), columnsDirty(false) {
+}
+
+
+/**
+ * mmvis_static::StructureEventsStore::~StructureEventsStore
+ */
+mmvis_static::StructureEventsStore::~StructureEventsStore(void) {
+}
+
+
+/**
+ * mmvis_static::StructureEventsStore::setFrameEvents
+ */
+void mmvis_static::StructureEventsStore::setFrameEvents(const unsigned int frameId, const std::vector<StructureEvents::StructureEvent>& frameEvents,
+	const std::vector<EventDetails>& frameDetails) {
+	auto it = this->partitions.lower_bound(frameId);
+
+	// Only the frame's part of the columns changes, unless the frame breaks the time order.
+	if (this->columnsByFrame && !this->columns.setFrame(frameId, frameEvents.data(), frameEvents.size())) {
+		this->columnsByFrame = false;
+		this->columns.clear();
+	}
+	if (!this->columnsByFrame)
+		this->columnsDirty = true;
+
+	///
+	/// Remove the old partition, the frame's position in the list is kept.
+	///
+	size_t offset = it == this->partitions.end() ? this->events.size() : it->second.offset;
+	size_t oldCount = 0;
+	bool maxTimeRemoved = false;
+	if (it != this->partitions.end() && it->first == frameId) {
+		oldCount = it->second.count;
+		maxTimeRemoved = it->second.maxTime >= this->maxTime;
+		if (it->second.hasDetails)
+			this->detailedFrameCount--;
+		this->events.erase(this->events.begin() + offset, this->events.begin() + offset + oldCount);
+		this->triggerClusterIDs.erase(this->triggerClusterIDs.begin() + offset, this->triggerClusterIDs.begin() + offset + oldCount);
+		this->triggerClusterSizes.erase(this->triggerClusterSizes.begin() + offset, this->triggerClusterSizes.begin() + offset + oldCount);
+		this->partnerCounts.erase(this->partnerCounts.begin() + offset, this->partnerCounts.begin() + offset + oldCount);
+		this->commonPercentages.erase(this->commonPercentages.begin() + offset, this->commonPercentages.begin() + offset + oldCount);
+		it = this->partitions.erase(it);
+	}
+
+	///
+	/// Insert the new partition.
+	///
+	if (!frameEvents.empty()) {
+		this->events.insert(this->events.begin() + offset, frameEvents.begin(), frameEvents.end());
+
+		const bool hasDetails = frameDetails.size() == frameEvents.size();
+		this->triggerClusterIDs.insert(this->triggerClusterIDs.begin() + offset, frameEvents.size(), -1);
+		this->triggerClusterSizes.insert(this->triggerClusterSizes.begin() + offset, frameEvents.size(), -1);
+		this->partnerCounts.insert(this->partnerCounts.begin() + offset, frameEvents.size(), -1);
+		this->commonPercentages.insert(this->commonPercentages.begin() + offset, frameEvents.size(), 0.f);
+		if (hasDetails) {
+			for (size_t i = 0; i < frameDetails.size(); ++i) {
+				this->triggerClusterIDs[offset + i] = frameDetails[i].triggerClusterID;
+				this->triggerClusterSizes[offset + i] = frameDetails[i].triggerClusterSize;
+				this->partnerCounts[offset + i] = frameDetails[i].partnerCount;
+				this->commonPercentages[offset + i] = frameDetails[i].commonPercentage;
+			}
+			this->detailedFrameCount++;
+		}
+
+		Partition partition;
+		partition.offset = offset;
+		partition.count = frameEvents.size();
+		partition.hasDetails = hasDetails;
+		partition.maxTime = std::max_element(frameEvents.begin(), frameEvents.end(), [](const StructureEvents::StructureEvent& lhs, const StructureEvents::StructureEvent& rhs) {
+			return lhs.time < rhs.time;
+		})->time;
+		it = ++this->partitions.insert(it, std::make_pair(frameId, partition));
+	}
+
+	///
+	/// Shift the following partitions.
+	///
+	if (frameEvents.size() != oldCount) {
+		for (; it != this->partitions.end(); ++it)
+			it->second.offset = it->second.offset - oldCount + frameEvents.size();
+	}
+
+	///
+	/// Maximum time. Only rescan partitions (not events) if the old maximum was removed.
+	///
+	if (maxTimeRemoved) {
+		this->maxTime = 0;
+		for (auto & p : this->partitions)
+			this->maxTime = std::max(this->maxTime, p.second.maxTime);
+	}
+	else if (!frameEvents.empty()) {
+		this->maxTime = std::max(this->maxTime, this->partitions[frameId].maxTime);
+	}
+}
+
+
+/**
+ * mmvis_static::StructureEventsStore::clear
+ */
+void mmvis_static::StructureEventsStore::clear(void) {
+	this->events.clear();
+	this->triggerClusterIDs.clear();
+	this->triggerClusterSizes.clear();
+	this->partnerCounts.clear();
+	this->commonPercentages.clear();
+	this->detailedFrameCount = 0;
+	this->partitions.clear();
+	this->maxTime = 0;
+	this->columns.clear();
+	this->columnsByFrame = true;
+	this->columnsDirty = false;
+}
+
+
+/**
+ * mmvis_static::StructureEventsStore::setSideColumnsTo
+ */
+void mmvis_static::StructureEventsStore::setSideColumnsTo(StructureEvents& events) const {
+	if (this->detailedFrameCount == 0 || this->events.empty()) {
+		events.setSideColumns(NULL, NULL, NULL, NULL);
+		return;
+	}
+	events.setSideColumns(this->triggerClusterIDs.data(),
+		this->triggerClusterSizes.data(),
+		this->partnerCounts.data(),
+		this->commonPercentages.data());
+}
+
+
+/**
+ * mmvis_static::StructureEventsStore::getColumns
+ */
+const mmvis_static::StructureEventsColumns& mmvis_static::StructureEventsStore::getColumns(void) {
+	if (this->columnsDirty) {
+		this->columns.build(this->getEvents(), this->getCount());
+		this->columnsDirty = false;
+	}
+	return this->columns;
+}
+
+
+/**
+ * mmvis_static::StructureEventsStore::getFramePartition
+ */
+bool mmvis_static::StructureEventsStore::getFramePartition(const unsigned int frameId, size_t& offset, size_t& count) const {
+	auto it = this->partitions.find(frameId);
+	if (it == this->partitions.end())
+		return false;
+	offset = it->second.offset;
+	count = it->second.count;
+	return true;
+}
+
+
+/**
+ * mmvis_static::StructureEventsStore::getFrameCounts
+ */
+std::map<unsigned int, size_t> mmvis_static::StructureEventsStore::getFrameCounts(void) const {
+	std::map<unsigned int, size_t> counts;
+	for (auto & partition : this->partitions)
+		counts[partition.first] = partition.second.count;
+	return counts;
+}
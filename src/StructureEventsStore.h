@@ -0,0 +1,143 @@
+/**
+ * StructureEventsStore.h
+ *
+ * Copyright (C) 2009-2015 by MegaMol Team
+ * Copyright (C) 2015 by Richard Hhne, TU Dresden
+ * Alle Rechte vorbehalten.
+ */
+
+#ifndef MMVISSTATIC_StructureEventsStore_H_INCLUDED
+#define MMVISSTATIC_StructureEventsStore_H_INCLUDED
+#if (defined(_MSC_VER) && (_MSC_VER > 1000))
+#pragma once
+#endif /* (defined(_MSC_VER) && (_MSC_VER > 1000)) */
+
+#include "StructureEventsColumns.h"
+#include "StructureEventsDataCall.h"
+
+#include <map>
+#include <vector>
+
+namespace megamol {
+	namespace mmvis_static {
+
+		/**
+		 * Event list of all calculated frames, partitioned by frame.
+		 *
+		 * The events of all frames are stored contiguously, ordered by
+		 * frame id, so the list can be handed to StructureEventsDataCall
+		 * and the MMSE writer without copying. Setting the events of a
+		 * frame replaces its partition, so recalculating a frame never
+		 * duplicates events.
+		 */
+		class StructureEventsStore {
+		public:
+
+			/// Cluster properties of one event, stored apart from the events as side columns.
+			struct EventDetails {
+				int triggerClusterID;
+				int triggerClusterSize;
+				int partnerCount;
+				float commonPercentage;
+			};
+
+			/// Ctor.
+			StructureEventsStore(void);
+
+			/// Dtor.
+			virtual ~StructureEventsStore(void);
+
+			///
+			/// Replaces the events of the frame. An empty list removes the frame's events.
+			/// @param frameDetails Same size as frameEvents or empty if there are no details.
+			///
+			void setFrameEvents(const unsigned int frameId, const std::vector<StructureEvents::StructureEvent>& frameEvents,
+				const std::vector<EventDetails>& frameDetails = std::vector<EventDetails>());
+
+			/// Removes the events of all frames.
+			void clear(void);
+
+			/// Start of the contiguous event list, NULL if there are no events.
+			inline const StructureEvents::StructureEvent* getEvents(void) const {
+				return this->events.empty() ? NULL : this->events.data();
+			}
+
+			/// Number of events of all frames.
+			inline size_t getCount(void) const {
+				return this->events.size();
+			}
+
+			/// Maximum time of all events.
+			inline float getMaxTime(void) const {
+				return this->maxTime;
+			}
+
+			/// Number of frames with events.
+			inline size_t getFrameCount(void) const {
+				return this->partitions.size();
+			}
+
+			/// Sets the side columns to the call data, NULL pointers if no frame has details.
+			void setSideColumnsTo(StructureEvents& events) const;
+
+			///
+			/// Columnar copy of the events. Setting a frame updates only its
+			/// part of the columns, they are rebuilt on request only after a
+			/// frame broke the time order of the frames.
+			///
+			const StructureEventsColumns& getColumns(void);
+
+			/// The columns without building them, for a store that has not changed since getColumns().
+			inline const StructureEventsColumns& getBuiltColumns(void) const {
+				return this->columns;
+			}
+
+			/// Position of the first event of the frame in the event list.
+			/// @return False if the frame has no events.
+			bool getFramePartition(const unsigned int frameId, size_t& offset, size_t& count) const;
+
+			/// Number of events of each frame with events. Key = frame id.
+			std::map<unsigned int, size_t> getFrameCounts(void) const;
+
+		private:
+
+			/// Part of the event list belonging to one frame.
+			struct Partition {
+				size_t offset;
+				size_t count;
+				float maxTime;
+				bool hasDetails;
+			};
+
+			/// Events of all frames, ordered by frame id.
+			std::vector<StructureEvents::StructureEvent> events;
+
+			/// Side columns, same index as events. Frames without details hold -1 and 0.
+			std::vector<int> triggerClusterIDs;
+			std::vector<int> triggerClusterSizes;
+			std::vector<int> partnerCounts;
+			std::vector<float> commonPercentages;
+
+			/// Number of frames that were set with details.
+			size_t detailedFrameCount;
+
+			/// Partitions of the event list. Key = frame id.
+			std::map<unsigned int, Partition> partitions;
+
+			/// Maximum time of all events.
+			float maxTime;
+
+			/// Columnar copy of the events.
+			StructureEventsColumns columns;
+
+			/// Flag that the columns are updated per frame, false after a frame broke the time order.
+			bool columnsByFrame;
+
+			/// Flag that the columns have to be rebuilt, only if not columnsByFrame.
+			bool columnsDirty;
+		};
+
+	} /* namespace mmvis_static */
+} /* namespace megamol */
+
+#endif /* MMVISSTATIC_StructureEventsStore_H_INCLUDED */
@@ -10,11 +10,15 @@
 #include "StructureEventsWriter.h"
 
 #include "mmcore/param/FilePathParam.h"
+#include "mmcore/param/IntParam.h"
 #include "vislib/sys/Log.h"
-#include "vislib/sys/FastFile.h"
+#include "vislib/sys/File.h"
 #include "vislib/String.h"
 #include "vislib/sys/Thread.h"
 
+#include <algorithm>
+#include <fstream>
+
 using namespace megamol;
 using namespace megamol::core;
 
@@ -23,11 +27,15 @@ using namespace megamol::core;
  */
 mmvis_static::StructureEventsWriter::StructureEventsWriter() : AbstractDataWriter(),
 	filenameSlot("filename", "The path to the MMSE file to be written"),
+	compressionLevelSlot("compressionLevel", "0 writes raw frame chunks, 1 to 9 deflated chunks (slower, smaller)."),
 	dataSlot("data", "The slot requesting the data to be written") {
 
 	this->filenameSlot.SetParameter(new param::FilePathParam("eventsFromMPDC.mmse"));
 	this->MakeSlotAvailable(&this->filenameSlot);
 
+	this->compressionLevelSlot.SetParameter(new param::IntParam(0, 0, MMSEFormat::MAX_COMPRESSION_LEVEL));
+	this->MakeSlotAvailable(&this->compressionLevelSlot);
+
 	this->dataSlot.SetCompatibleCall<StructureEventsDataCallDescription>();
 	this->MakeSlotAvailable(&this->dataSlot);
 }
@@ -124,8 +132,8 @@ bool mmvis_static::StructureEventsWriter::run(void) {
 	///
 	/// Create file.
 	///
-	vislib::sys::FastFile file;
-	if (!file.Open(filename, vislib::sys::File::WRITE_ONLY, vislib::sys::File::SHARE_EXCLUSIVE, vislib::sys::File::CREATE_OVERWRITE)) {
+	std::ofstream file(vislib::StringA(filename).PeekBuffer(), std::ios_base::binary | std::ios_base::trunc);
+	if (!file.is_open()) {
 		Log::DefaultLog.WriteMsg(Log::LEVEL_ERROR,
 			"Unable to create output file \"%s\". Abort.",
 			vislib::StringA(filename).PeekBuffer());
@@ -133,25 +141,31 @@ bool mmvis_static::StructureEventsWriter::run(void) {
 		return false;
 	}
 
-#define ASSERT_WRITEOUT(A, S) if (file.Write((A), (S)) != (S)) { \
+#define ASSERT_WRITEOUT(A, S) if (!file.write(reinterpret_cast<const char*>(A), (S))) { \
         Log::DefaultLog.WriteMsg(Log::LEVEL_ERROR, "Write error %d", __LINE__); \
-        file.Close(); \
+        file.close(); \
         sedc->Unlock(); \
         return false; \
 	    }
 
 	///
-	/// Set header.
+	/// Set header. Version 0 documents that the file is incomplete,
+	/// the final header is written after the frame table.
 	///
-	vislib::StringA magicID("MMSE");
-	ASSERT_WRITEOUT(magicID.PeekBuffer(), 4); // Only works with 4.
-	//UINT16 version = 0; // Um Zustand zu dokumentieren, bis wohin geschrieben wurde? Ein bisschen und "The version number encodes the major version as multiple of 100 and adds the minor version."
-	//ASSERT_WRITEOUT(&version, 2);
-	//ASSERT_WRITEOUT(&frameCnt, 4);
-	ASSERT_WRITEOUT(bbox.PeekBounds(), 6 * 4); // 6 * float.
-	ASSERT_WRITEOUT(cbox.PeekBounds(), 6 * 4); // 6 * float.
-
-	//UINT64 seekTable = static_cast<UINT64>(file.Tell()); // Position of current file pointer: To be able to set offset.
+	MMSEFormat::Header header;
+	header.version = 0;
+	header.flags = 0;
+	std::copy(bbox.PeekBounds(), bbox.PeekBounds() + 6, header.bbox);
+	std::copy(cbox.PeekBounds(), cbox.PeekBounds() + 6, header.cbox);
+	header.eventCount = 0;
+	header.maxTime = 0;
+	header.frameCount = 0;
+	header.frameTableOffset = 0;
+	if (!MMSEFormat::WriteHeader(file, header)) {
+		file.close();
+		sedc->Unlock();
+		return false;
+	}
 	sedc->Unlock();
 	//file.Seek(seekTable); // Move the file pointer. Not needed here as well as file.Tell().
 
@@ -163,7 +177,7 @@ bool mmvis_static::StructureEventsWriter::run(void) {
 			sedc->SetFrameID(i, true);
 			if (!(*sedc)(0)) {
 				Log::DefaultLog.WriteMsg(Log::LEVEL_ERROR, "Cannot get data frame %u. Abort.\n", i);
-				file.Close();
+				file.close();
 				return false;
 			}
 			if (sedc->FrameID() != i) {
@@ -178,69 +192,63 @@ bool mmvis_static::StructureEventsWriter::run(void) {
 		*/
 	if (!(*sedc)(0)) {
 		Log::DefaultLog.WriteMsg(Log::LEVEL_ERROR, "Cannot get structure events data. Abort.\n");
-		file.Close();
+		file.close();
 		return false;
 	}
 
-	if (!this->writeData(file, *sedc)) {
+	if (!this->writeData(file, *sedc, header)) {
 		sedc->Unlock();
 		Log::DefaultLog.WriteMsg(Log::LEVEL_ERROR, "Cannot write data. Abort.\n");
-		file.Close();
+		file.close();
 		return false;
 	}
 	sedc->Unlock();
 
-	//file.Seek(6); // set correct version to show that file is complete, 6 = reserved for ID
-	//version = 100;
-	//ASSERT_WRITEOUT(&version, 2);
-
-	//file.Seek(frameOffset); // wozu? vielleicht, dass ein weiterer Prozess noch Daten anhngen kann?
-
 	Log::DefaultLog.WriteMsg(Log::LEVEL_INFO, "Completed writing data\n");
-	file.Close();
+	file.close();
 
 #undef ASSERT_WRITEOUT
 	return true;
 }
 
 
-bool mmvis_static::StructureEventsWriter::writeData(vislib::sys::File& file, StructureEventsDataCall& data) {
+bool mmvis_static::StructureEventsWriter::writeData(std::ostream& file, StructureEventsDataCall& data, MMSEFormat::Header& header) {
 	using vislib::sys::Log;
 
-#define ASSERT_WRITEOUT(A, S) if (file.Write((A), (S)) != (S)) { \
+#define ASSERT_WRITEOUT(A, S) if (!file.write(reinterpret_cast<const char*>(A), (S))) { \
         Log::DefaultLog.WriteMsg(Log::LEVEL_ERROR, "Write error %d", __LINE__); \
-        file.Close(); \
         return false; \
     }
 
 	StructureEvents events = data.getEvents();
-	
+	uint64_t eventCnt = events.getCount();
+
 	///
-	/// Header continued.
+	/// Daten, one chunk per frame.
 	///
-	uint64_t eventCnt = events.getCount();
-	ASSERT_WRITEOUT(&eventCnt, 8);
-	float maxTime = events.getMaxTime();
-	ASSERT_WRITEOUT(&maxTime, 4);
+	std::vector<MMSEFormat::FrameEntry> frameTable;
+	header.flags = events.hasSideColumns() ? MMSEFormat::FLAG_SIDE_COLUMNS : 0;
+	const unsigned int compressionLevel = static_cast<unsigned int>(this->compressionLevelSlot.Param<param::IntParam>()->Value());
+	if (!MMSEFormat::WriteFrameChunks(file, events, events.hasSideColumns(), frameTable, compressionLevel)) {
+		return false;
+	}
 
 	///
-	/// Daten.
+	/// Frame table and final header, the version is set last.
 	///
-	unsigned int eventStride = events.getStride();
-	// Start of event data. Cast to 1 byte for correct stride calculation in for-loop. Mandatory!
-	const unsigned char* eventPtr = static_cast<const unsigned char*>(events.getLocation());
-
-	// Write each event and not all at once since file.Write() needs to know the buffer size.
-	// Alternative?
-	//const void *pointer = events.getLocation(); // Start of the eventdata.
-	//ASSERT_WRITEOUT(pointer, eventStride * eventCnt);
-	for (uint64_t eventIndex = 0; eventIndex < eventCnt; ++eventIndex) {
-		// Alle Properties (stride).Typ des Pointers egal, da file.Write -> void*
-		ASSERT_WRITEOUT(eventPtr, eventStride);
-		eventPtr += eventStride; // Increment the position of the Pointer.
+	header.eventCount = eventCnt;
+	header.maxTime = events.getMaxTime();
+	header.frameCount = static_cast<uint32_t>(frameTable.size());
+	header.frameTableOffset = static_cast<uint64_t>(file.tellp());
+	if (!MMSEFormat::WriteFrameTable(file, frameTable)) {
+		return false;
+	}
+	header.version = MMSEFormat::VERSION_2;
+	if (!MMSEFormat::WriteHeader(file, header)) {
+		return false;
 	}
 
-	Log::DefaultLog.WriteMsg(Log::LEVEL_INFO, "%d events written.", eventCnt);
+	Log::DefaultLog.WriteMsg(Log::LEVEL_INFO, "%d events in %d frames written.", eventCnt, header.frameCount);
 
 #undef ASSERT_WRITEOUT
 	return true;
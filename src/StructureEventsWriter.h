@@ -15,9 +15,11 @@
 #include "mmcore/AbstractDataWriter.h"
 #include "mmcore/CallerSlot.h"
 #include "mmcore/param/ParamSlot.h"
-#include "vislib/sys/File.h"
+#include "MMSEFormat.h"
 #include "StructureEventsDataCall.h"
 
+#include <ostream>
+
 namespace megamol {
 	namespace mmvis_static {
 		/**
@@ -28,19 +30,8 @@ namespace megamol {
 		 */
 
 		///
-		/// Writes MMSE file.
-		///
-		/// File format header:
-		/// 0..3 char* MagicIdentifier
-		/// 4..27 6x float (32 bit) Data set bounding box
-		/// 28..51 6x float (32 bit) Data set clipping box
-		/// 52..59 uint64_t Number of events
-		/// 60..63 float Maximum time of all events
-		///
-		/// File format body (relative bytes):
-		/// 0..11 3x float (32bit) Event position
-		/// 12..15 float Event time
-		/// 16..19 EventType (int) Event type
+		/// Writes MMSE file, version 2 with one chunk per frame.
+		/// See MMSEFormat for the file format.
 		///
 		class StructureEventsWriter : public core::AbstractDataWriter {
 		public:
@@ -123,14 +114,18 @@ namespace megamol {
 			 *
 			 * @param file The output data file
 			 * @param data The data of the current frame
+			 * @param header The file header, completed and written at last
 			 *
 			 * @return True on success
 			 */
-			bool writeData(vislib::sys::File& file, StructureEventsDataCall& data);
+			bool writeData(std::ostream& file, StructureEventsDataCall& data, MMSEFormat::Header& header);
 
 			/// The file name.
 			core::param::ParamSlot filenameSlot;
 
+			/// The compression level of the frame chunks, 0 for raw chunks.
+			core::param::ParamSlot compressionLevelSlot;
+
 			/// The slot asking for data.
 			core::CallerSlot dataSlot;
 		};
@@ -0,0 +1,274 @@
+/**
+ * TaskPool.cpp
+ *
+ * Copyright (C) 2009-2015 by MegaMol Team
+ * Copyright (C) 2015 by Richard Hhne, TU Dresden
+ * Alle Rechte vorbehalten.
+ */
+
+#include "TaskPool.h"
+
+#include <chrono>
+
+using namespace megamol;
+
+namespace {
+
+	/// Guards the default pool and its thread count.
+	std::mutex defaultMutex;
+
+	unsigned int defaultThreadCount = 0;
+
+	///
+	/// The default pool, created on first use. It is never destroyed since
+	/// joining the workers while the plugin library unloads can dead lock.
+	///
+	std::shared_ptr<mmvis_static::TaskPool>& defaultPool(void) {
+		static std::shared_ptr<mmvis_static::TaskPool> *pool = new std::shared_ptr<mmvis_static::TaskPool>();
+		return *pool;
+	}
+
+	/// Threads for a thread count of 0.
+	unsigned int getHardwareThreads(void) {
+		return std::max(1u, std::thread::hardware_concurrency());
+	}
+
+} /* end anonymous namespace */
+
+
+/**
+ * mmvis_static::TaskPool::TaskPool
+ */
+mmvis_static::TaskPool::TaskPool(const unsigned int threadCount) : workers(), queues(), callerQueue(), queuedRanges(0),
+		sleepMutex(), wake(), stop(false) {
+	const unsigned int workerCount = (threadCount > 0 ? threadCount : getHardwareThreads()) - 1;
+
+	// All queues exist before the first worker steals.
+	for (unsigned int worker = 0; worker < workerCount; ++worker)
+		this->queues.push_back(std::unique_ptr<RangeQueue>(new RangeQueue()));
+	for (unsigned int worker = 0; worker < workerCount; ++worker)
+		this->workers.push_back(std::thread(&TaskPool::work, this, worker));
+}
+
+
+/**
+ * mmvis_static::TaskPool::~TaskPool
+ */
+mmvis_static::TaskPool::~TaskPool(void) {
+	{
+		std::lock_guard<std::mutex> lock(this->sleepMutex);
+		this->stop = true;
+	}
+	this->wake.notify_all();
+
+	for (auto & worker : this->workers)
+		worker.join();
+}
+
+
+/**
+ * mmvis_static::TaskPool::GetDefault
+ */
+std::shared_ptr<mmvis_static::TaskPool> mmvis_static::TaskPool::GetDefault(void) {
+	std::lock_guard<std::mutex> lock(defaultMutex);
+	std::shared_ptr<TaskPool>& pool = defaultPool();
+	if (!pool)
+		pool = std::make_shared<TaskPool>(defaultThreadCount);
+	return pool;
+}
+
+
+/**
+ * mmvis_static::TaskPool::SetDefaultThreadCount
+ */
+void mmvis_static::TaskPool::SetDefaultThreadCount(const unsigned int threadCount) {
+	std::lock_guard<std::mutex> lock(defaultMutex);
+	defaultThreadCount = threadCount;
+
+	// Replaced on next use, holders of the old pool keep it alive.
+	std::shared_ptr<TaskPool>& pool = defaultPool();
+	if (pool && pool->GetThreadCount() != (threadCount > 0 ? threadCount : getHardwareThreads()))
+		pool.reset();
+}
+
+
+/**
+ * mmvis_static::TaskPool::ParallelFor
+ */
+void mmvis_static::TaskPool::ParallelFor(const size_t begin, const size_t end, const size_t grain, const RangeFunction& function) {
+	if (end <= begin)
+		return;
+
+	const size_t grainSize = grain > 0 ? grain : 1;
+	if (this->workers.empty() || end - begin <= grainSize) {
+		function(begin, end, this->GetCallerThread());
+		return;
+	}
+
+	Job job;
+	job.function = &function;
+	job.grain = grainSize;
+	job.remaining = end - begin;
+
+	Range range = { &job, begin, end };
+	this->run(range, this->callerQueue, this->GetCallerThread());
+
+	///
+	/// Help with the ranges of the job that are still queued, then wait
+	/// for the ranges the workers run. Workers may split off further
+	/// ranges meanwhile, so the wait is short.
+	///
+	for (;;) {
+		{
+			std::lock_guard<std::mutex> lock(job.mutex);
+			if (job.remaining == 0)
+				break;
+		}
+
+		if (this->takeOfJob(&job, range)) {
+			this->run(range, this->callerQueue, this->GetCallerThread());
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(job.mutex);
+		job.finished.wait_for(lock, std::chrono::milliseconds(1), [&job]() { return job.remaining == 0; });
+	}
+
+	if (job.exception)
+		std::rethrow_exception(job.exception);
+}
+
+
+/**
+ * mmvis_static::TaskPool::work
+ */
+void mmvis_static::TaskPool::work(const unsigned int worker) {
+	Range range;
+	for (;;) {
+		if (this->take(worker, range)) {
+			this->run(range, *this->queues[worker], worker);
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(this->sleepMutex);
+		this->wake.wait(lock, [this]() { return this->stop || this->queuedRanges > 0; });
+		if (this->stop)
+			return;
+	}
+}
+
+
+/**
+ * mmvis_static::TaskPool::push
+ */
+void mmvis_static::TaskPool::push(RangeQueue& queue, const Range& range) {
+	{
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		queue.ranges.push_back(range);
+	}
+	this->queuedRanges++;
+
+	// Synchronizes with the check of a worker that is about to sleep.
+	{
+		std::lock_guard<std::mutex> lock(this->sleepMutex);
+	}
+	this->wake.notify_one();
+}
+
+
+/**
+ * mmvis_static::TaskPool::take
+ */
+bool mmvis_static::TaskPool::take(const unsigned int worker, Range& range) {
+	{
+		RangeQueue& queue = *this->queues[worker];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if (!queue.ranges.empty()) {
+			range = queue.ranges.back();
+			queue.ranges.pop_back();
+			this->queuedRanges--;
+			return true;
+		}
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(this->callerQueue.mutex);
+		if (!this->callerQueue.ranges.empty()) {
+			range = this->callerQueue.ranges.front();
+			this->callerQueue.ranges.pop_front();
+			this->queuedRanges--;
+			return true;
+		}
+	}
+
+	// Steal, starting at the next worker to spread the thieves.
+	for (size_t i = 1; i < this->queues.size(); ++i) {
+		RangeQueue& queue = *this->queues[(worker + i) % this->queues.size()];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if (!queue.ranges.empty()) {
+			range = queue.ranges.front();
+			queue.ranges.pop_front();
+			this->queuedRanges--;
+			return true;
+		}
+	}
+	return false;
+}
+
+
+/**
+ * mmvis_static::TaskPool::takeOfJob
+ */
+bool mmvis_static::TaskPool::takeOfJob(const Job *job, Range& range) {
+	auto takeFrom = [this, job, &range](RangeQueue& queue) -> bool {
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		for (auto it = queue.ranges.begin(); it != queue.ranges.end(); ++it) {
+			if (it->job == job) {
+				range = *it;
+				queue.ranges.erase(it);
+				this->queuedRanges--;
+				return true;
+			}
+		}
+		return false;
+	};
+
+	if (takeFrom(this->callerQueue))
+		return true;
+	for (auto & queue : this->queues) {
+		if (takeFrom(*queue))
+			return true;
+	}
+	return false;
+}
+
+
+/**
+ * mmvis_static::TaskPool::run
+ */
+void mmvis_static::TaskPool::run(Range range, RangeQueue& queue, const unsigned int thread) {
+	Job *job = range.job;
+
+	// The biggest halves are pushed first, so thieves take them while this thread goes on with small ones.
+	while (range.end - range.begin > job->grain) {
+		const size_t middle = range.begin + (range.end - range.begin) / 2;
+		const Range rest = { job, middle, range.end };
+		this->push(queue, rest);
+		range.end = middle;
+	}
+
+	try {
+		(*job->function)(range.begin, range.end, thread);
+	}
+	catch (...) {
+		std::lock_guard<std::mutex> lock(job->mutex);
+		if (!job->exception)
+			job->exception = std::current_exception();
+	}
+
+	// The caller returns once remaining is 0, so the job is not touched after the lock.
+	std::lock_guard<std::mutex> lock(job->mutex);
+	job->remaining -= range.end - range.begin;
+	if (job->remaining == 0)
+		job->finished.notify_all();
+}
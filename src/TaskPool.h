@@ -0,0 +1,233 @@
+/**
+ * TaskPool.h
+ *
+ * Copyright (C) 2009-2015 by MegaMol Team
+ * Copyright (C) 2015 by Richard Hhne, TU Dresden
+ * Alle Rechte vorbehalten.
+ */
+
+#ifndef MMVISSTATIC_TaskPool_H_INCLUDED
+#define MMVISSTATIC_TaskPool_H_INCLUDED
+#if (defined(_MSC_VER) && (_MSC_VER > 1000))
+#pragma once
+#endif /* (defined(_MSC_VER) && (_MSC_VER > 1000)) */
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace megamol {
+	namespace mmvis_static {
+
+		/**
+		 * Work-stealing thread pool shared by all stages, replaces the OpenMP
+		 * loops and the hand partitioned loops.
+		 *
+		 * A parallel loop is a job whose range is split lazily: the thread
+		 * that runs a range bigger than the grain keeps the first half and
+		 * pushes the second half on its own deque. Workers take the newest
+		 * range of their own deque and steal the oldest, i.e. biggest, range
+		 * of the others, so irregular loops balance themselves.
+		 *
+		 * The calling thread takes part in its own job and only runs ranges
+		 * of it, so loops of different callers (e.g. the workers of the
+		 * FrameScheduler) can share the pool. The first exception of a job
+		 * is rethrown to the caller after all ranges finished.
+		 *
+		 * Loops may be nested, but per thread memory indexed by the thread
+		 * index must not be shared between the levels.
+		 */
+		class TaskPool {
+		public:
+
+			///
+			/// Body of a parallel loop.
+			/// @param thread Index of the running thread, < GetThreadCount().
+			/// The calling thread has index GetThreadCount() - 1.
+			///
+			typedef std::function<void(size_t begin, size_t end, unsigned int thread)> RangeFunction;
+
+			///
+			/// Ctor, starts the workers.
+			/// @param threadCount Threads of a loop including the calling thread, 0 for one per hardware thread.
+			///
+			TaskPool(const unsigned int threadCount = 0);
+
+			/// Dtor, stops the workers. Pending loops must have finished.
+			virtual ~TaskPool(void);
+
+			///
+			/// The pool used by all stages. It is replaced by SetDefaultThreadCount,
+			/// so it should be got once per operation.
+			///
+			static std::shared_ptr<TaskPool> GetDefault(void);
+
+			///
+			/// Sets the threads of the default pool. Running loops finish on the
+			/// old pool.
+			/// @param threadCount 0 for one per hardware thread.
+			///
+			static void SetDefaultThreadCount(const unsigned int threadCount);
+
+			/// Threads of a loop including the calling thread.
+			inline unsigned int GetThreadCount(void) const {
+				return static_cast<unsigned int>(this->workers.size()) + 1;
+			}
+
+			/// Index of the calling thread in its own loops, used by code that runs sequentially.
+			inline unsigned int GetCallerThread(void) const {
+				return static_cast<unsigned int>(this->workers.size());
+			}
+
+			///
+			/// Runs function for all elements of [begin, end), in ranges of at
+			/// most grain elements. Returns after all ranges finished.
+			///
+			void ParallelFor(const size_t begin, const size_t end, const size_t grain, const RangeFunction& function);
+
+			///
+			/// Reduction over [begin, end). The blocks of grain elements are fixed
+			/// and their results are combined in order, so the result does not
+			/// depend on the number of threads.
+			/// @param map Called as T map(blockBegin, blockEnd, thread).
+			/// @param combine Called as T combine(lhs, rhs).
+			///
+			template<typename T, typename Map, typename Combine>
+			T Reduce(const size_t begin, const size_t end, const size_t grain, const T& identity, const Map& map, const Combine& combine) {
+				if (end <= begin)
+					return identity;
+
+				const size_t blockSize = grain > 0 ? grain : 1;
+				const size_t blockCount = (end - begin + blockSize - 1) / blockSize;
+				std::vector<T> partials(blockCount, identity);
+				this->ParallelFor(0, blockCount, 1, [&](size_t firstBlock, size_t lastBlock, unsigned int thread) {
+					for (size_t block = firstBlock; block < lastBlock; ++block) {
+						const size_t blockBegin = begin + block * blockSize;
+						partials[block] = map(blockBegin, std::min(blockBegin + blockSize, end), thread);
+					}
+				});
+
+				T result = identity;
+				for (auto & partial : partials)
+					result = combine(result, partial);
+				return result;
+			}
+
+			///
+			/// Exclusive prefix sum of values into sums, both with count elements.
+			/// Blocked in two passes: sums of the blocks, then the blocks with
+			/// their offsets. sums may be values.
+			/// @return The sum of all values.
+			///
+			template<typename T>
+			T ExclusiveScan(const T *values, T *sums, const size_t count, const size_t grain) {
+				const size_t blockSize = grain > 0 ? grain : 1;
+				const size_t blockCount = (count + blockSize - 1) / blockSize;
+				std::vector<T> offsets(blockCount, T());
+
+				this->ParallelFor(0, blockCount, 1, [&](size_t firstBlock, size_t lastBlock, unsigned int) {
+					for (size_t block = firstBlock; block < lastBlock; ++block) {
+						T sum = T();
+						for (size_t i = block * blockSize; i < std::min((block + 1) * blockSize, count); ++i)
+							sum += values[i];
+						offsets[block] = sum;
+					}
+				});
+
+				T total = T();
+				for (auto & offset : offsets) {
+					const T sum = offset;
+					offset = total;
+					total += sum;
+				}
+
+				this->ParallelFor(0, blockCount, 1, [&](size_t firstBlock, size_t lastBlock, unsigned int) {
+					for (size_t block = firstBlock; block < lastBlock; ++block) {
+						T sum = offsets[block];
+						for (size_t i = block * blockSize; i < std::min((block + 1) * blockSize, count); ++i) {
+							const T value = values[i];
+							sums[i] = sum;
+							sum += value;
+						}
+					}
+				});
+				return total;
+			}
+
+		private:
+
+			/// Parallel loop.
+			struct Job {
+				const RangeFunction *function;
+				size_t grain;
+				size_t remaining; // Elements not finished, guarded by mutex.
+				std::mutex mutex;
+				std::condition_variable finished;
+				std::exception_ptr exception; // First exception of the ranges.
+			};
+
+			/// Part of the range of a job.
+			struct Range {
+				Job *job;
+				size_t begin;
+				size_t end;
+			};
+
+			/// Ranges to run, the owner works at the back, thieves at the front.
+			struct RangeQueue {
+				std::mutex mutex;
+				std::deque<Range> ranges;
+			};
+
+			/// Forbidden copy ctor.
+			TaskPool(const TaskPool& src);
+
+			/// Forbidden assignment.
+			TaskPool& operator=(const TaskPool& rhs);
+
+			/// Main loop of a worker.
+			void work(const unsigned int worker);
+
+			/// Pushes a range on the queue and wakes a worker.
+			void push(RangeQueue& queue, const Range& range);
+
+			///
+			/// Takes a range for a worker: the newest of its own queue, the oldest
+			/// of the callers, or the oldest of the other workers.
+			///
+			bool take(const unsigned int worker, Range& range);
+
+			/// Takes the oldest range of job from any queue, for the calling thread.
+			bool takeOfJob(const Job *job, Range& range);
+
+			/// Runs the range, splits off halves bigger than the grain into queue.
+			void run(Range range, RangeQueue& queue, const unsigned int thread);
+
+			std::vector<std::thread> workers;
+
+			/// Queue of each worker.
+			std::vector<std::unique_ptr<RangeQueue>> queues;
+
+			/// Ranges split by the calling threads.
+			RangeQueue callerQueue;
+
+			/// Number of queued ranges, the workers sleep while it is 0.
+			std::atomic<size_t> queuedRanges;
+
+			std::mutex sleepMutex;
+			std::condition_variable wake;
+			bool stop;
+		};
+
+	} /* namespace mmvis_static */
+} /* namespace megamol */
+
+#endif /* MMVISSTATIC_TaskPool_H_INCLUDED */
@@ -0,0 +1,423 @@
+/**
+ * secalc_batch.cpp
+ *
+ * Copyright (C) 2009-2015 by MegaMol Team
+ * Copyright (C) 2015 by Richard Hhne, TU Dresden
+ * Alle Rechte vorbehalten.
+ */
+
+///
+/// Headless structure events calculation of a whole MMPLD time series.
+///
+/// Usage: secalc_batch [--<parameter>=<value> ...] file.mmpld
+/// The parameters have the names of the StructureEventsCalculation slots.
+/// Runs steps 1 to 4 for every frame and writes the MMSE file and the
+/// per frame metrics ("SECalc <label>.csv" or ".secm") like the module.
+/// The particles are read from the mapped file, the operating system
+/// reads the next frame ahead while the current one is calculated. A
+/// FrameScheduler runs the frames through a pipeline of stages: loading,
+/// steps 1 and 2 of several frames at the same time, then steps 3 and 4
+/// in frame order. The output is written on the thread of an
+/// AsyncOutputQueue, the last stage.
+///
+
+#include "AsyncOutputQueue.h"
+#include "FrameMetrics.h"
+#include "FrameScheduler.h"
+#include "MMPLDFile.h"
+#include "MMSEAppendWriter.h"
+#include "StructureEvents.h"
+#include "StructureEventsPipeline.h"
+#include "TaskPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <vector>
+
+using namespace megamol::mmvis_static;
+
+namespace {
+
+	/// Settings of the run, defaults are the ones of the module.
+	struct Options {
+		StructureEventsPipeline::Parameters parameters;
+		std::string label;
+		int metricsFormat; // 0 := CSV, 1 := binary.
+		std::string mmseFilename;
+		unsigned int mmseCompressionLevel;
+		unsigned int threads; // Of the TaskPool, 0 := one per hardware thread.
+		unsigned int frameWorkers; // 0 := one per hardware thread.
+		size_t memoryBudget; // Of the frames in flight, in byte.
+		std::string inputFilename;
+
+		Options(void) : parameters(), label(), metricsFormat(0), mmseFilename("StructureEvents.mmse"),
+			mmseCompressionLevel(0), threads(0), frameWorkers(0), memoryBudget(FrameScheduler::DEFAULT_MEMORY_BUDGET), inputFilename() {}
+	};
+
+	/// Events of one frame with their side columns, owned by the queued output job.
+	struct FrameEvents {
+		std::vector<StructureEvents::StructureEvent> events;
+		std::vector<int> triggerClusterIDs;
+		std::vector<int> triggerClusterSizes;
+		std::vector<int> partnerCounts;
+		std::vector<float> commonPercentages;
+
+		size_t getBytes(void) const {
+			return this->events.size() * (sizeof(StructureEvents::StructureEvent) + 3 * sizeof(int) + sizeof(float));
+		}
+	};
+
+	void printUsage(void) {
+		std::cerr << "Usage: secalc_batch [--<parameter>=<value> ...] file.mmpld\n"
+			<< "Parameters (see the StructureEventsCalculation module):\n"
+			<< "  --NeighbourSearch::periodicBoundary=0|1\n"
+			<< "  --NeighbourSearch::radiusMultiplier=2..10\n"
+			<< "  --NeighbourSearch::method=0|1 (kD-tree, uniform grid)\n"
+			<< "  --ClusterCreation::minClusterSize=<int> (at least 8)\n"
+			<< "  --StructureEvents::msMinClusterAmount=<int> (at least 2)\n"
+			<< "  --StructureEvents::msMinCPPercentage=20..45\n"
+			<< "  --StructureEvents::bdMaxCPPercentage=2..10\n"
+			<< "  --output::label=<text>\n"
+			<< "  --output::metricsFormat=0|1 (CSV, binary)\n"
+			<< "  --output::mmseFilename=<path>\n"
+			<< "  --output::mmseCompressionLevel=0..9\n"
+			<< "  --TaskPool::threads=<int> (of the parallel loops, 0 for one per hardware thread)\n"
+			<< "Batch only:\n"
+			<< "  --frameWorkers=<int> (workers of the neighbour and cluster stages, 0 for one per hardware thread)\n"
+			<< "  --memoryBudget=<MiB> (of the frames in flight, at least 1)\n";
+	}
+
+	/// Parses an integer in [minimum, maximum], false if value is no such number.
+	bool parseInt(const std::string& value, const int minimum, const int maximum, int& result) {
+		char *end = NULL;
+		const long number = std::strtol(value.c_str(), &end, 10);
+		if (value.empty() || *end != '\0' || number < minimum || number > maximum)
+			return false;
+		result = static_cast<int>(number);
+		return true;
+	}
+
+	/// Parses a float in [minimum, maximum], false if value is no such number.
+	bool parseFloat(const std::string& value, const float minimum, const float maximum, float& result) {
+		char *end = NULL;
+		const double number = std::strtod(value.c_str(), &end);
+		if (value.empty() || *end != '\0' || !(number >= minimum && number <= maximum))
+			return false;
+		result = static_cast<float>(number);
+		return true;
+	}
+
+	///
+	/// Sets the option of the argument. The ranges are those of the slots.
+	/// @return False if the option is unknown or the value out of range.
+	///
+	bool parseOption(const std::string& argument, Options& options) {
+		const size_t separator = argument.find('=');
+		if (argument.compare(0, 2, "--") != 0 || separator == std::string::npos)
+			return false;
+		const std::string name = argument.substr(2, separator - 2);
+		const std::string value = argument.substr(separator + 1);
+		StructureEventsPipeline::Parameters& parameters = options.parameters;
+		const int maxInt = std::numeric_limits<int>::max();
+		int number = 0;
+
+		if (name == "NeighbourSearch::periodicBoundary") {
+			if (value == "true" || value == "false")
+				number = value == "true" ? 1 : 0;
+			else if (!parseInt(value, 0, 1, number))
+				return false;
+			parameters.periodicBoundary = number != 0;
+		}
+		else if (name == "NeighbourSearch::method") {
+			if (!parseInt(value, 0, 1, number))
+				return false;
+			parameters.neighbourSearch = number == 1
+				? StructureEventsPipeline::NEIGHBOURSEARCH_GRID : StructureEventsPipeline::NEIGHBOURSEARCH_KDTREE;
+		}
+		else if (name == "NeighbourSearch::radiusMultiplier")
+			return parseInt(value, 2, 10, parameters.radiusMultiplier);
+		else if (name == "ClusterCreation::minClusterSize")
+			return parseInt(value, 8, maxInt, parameters.minClusterSize);
+		else if (name == "StructureEvents::msMinClusterAmount")
+			return parseInt(value, 2, maxInt, parameters.msMinClusterAmount);
+		else if (name == "StructureEvents::msMinCPPercentage")
+			return parseFloat(value, 20.0f, 45.0f, parameters.msMinCPPercentage);
+		else if (name == "StructureEvents::bdMaxCPPercentage")
+			return parseFloat(value, 2.0f, 10.0f, parameters.bdMaxCPPercentage);
+		else if (name == "output::label")
+			options.label = value;
+		else if (name == "output::metricsFormat")
+			return parseInt(value, 0, 1, options.metricsFormat);
+		else if (name == "output::mmseFilename")
+			options.mmseFilename = value;
+		else if (name == "output::mmseCompressionLevel") {
+			if (!parseInt(value, 0, static_cast<int>(MMSEFormat::MAX_COMPRESSION_LEVEL), number))
+				return false;
+			options.mmseCompressionLevel = static_cast<unsigned int>(number);
+		}
+		else if (name == "TaskPool::threads") {
+			if (!parseInt(value, 0, maxInt, number))
+				return false;
+			options.threads = static_cast<unsigned int>(number);
+		}
+		else if (name == "frameWorkers") {
+			if (!parseInt(value, 0, maxInt, number))
+				return false;
+			options.frameWorkers = static_cast<unsigned int>(number);
+		}
+		else if (name == "memoryBudget") {
+			if (!parseInt(value, 1, maxInt, number))
+				return false;
+			options.memoryBudget = static_cast<size_t>(number) * 1024 * 1024;
+		}
+		else
+			return false;
+		return true;
+	}
+
+	/// Writes warnings and errors of the pipeline to stderr.
+	void logPipelineMessage(const StructureEventsPipeline::LogLevel level, const std::string& message) {
+		if (level <= StructureEventsPipeline::LOG_WARN)
+			std::cerr << (level == StructureEventsPipeline::LOG_ERROR ? "Error: " : "Warning: ") << message << "\n";
+	}
+
+	/// Spans of the lists with float vertices and signed distances in COLOUR_FLOAT_I, the module skips all others.
+	void getParticleSpans(const MMPLDFile::Frame& frame, std::vector<StructureEventsPipeline::ParticleSpan>& spans) {
+		spans.clear();
+		for (size_t listIndex = 0; listIndex < frame.lists.size(); ++listIndex) {
+			const MMPLDFile::ParticleList& list = frame.lists[listIndex];
+			if (list.count == 0 || !list.HasSignedDistances()) {
+				std::cerr << "Warning: Frame " << frame.frameID << ", particlelist " << listIndex
+					<< " skipped, float vertices and COLOUR_FLOAT_I expected.\n";
+				continue;
+			}
+			StructureEventsPipeline::ParticleSpan span;
+			span.positions = list.data;
+			span.positionStride = list.stride;
+			span.hasRadius = list.vertexType == MMPLDFile::VERTEX_FLOAT_XYZR;
+			span.globalRadius = list.globalRadius;
+			span.signedDistances = list.data + list.colourOffset;
+			span.signedDistanceStride = list.stride;
+			span.count = list.count;
+			spans.push_back(span);
+		}
+	}
+
+	/// Records the statistics of the frame, metrics of skipped steps stay unset.
+	void setMetrics(const StructureEventsPipeline& pipeline, const StructureEventsPipeline::Parameters& parameters,
+		const bool compared, FrameMetrics& metrics) {
+		const StructureEventsPipeline::Statistics& statistics = pipeline.GetStatistics();
+		metrics.Set(FrameMetrics::PARTICLES, static_cast<double>(pipeline.particleList.size()));
+		metrics.Set(FrameMetrics::PARTICLE_LIST_MS, static_cast<double>(statistics.particleListDuration));
+		metrics.Set(FrameMetrics::KDTREE_MS, static_cast<double>(statistics.kdTreeDuration));
+		metrics.Set(FrameMetrics::RADIUS_MULTIPLIER, parameters.radiusMultiplier);
+		metrics.Set(FrameMetrics::MAX_NEIGHBOURS, statistics.maxNeighbours);
+		metrics.Set(FrameMetrics::NEIGHBOURS_MS, static_cast<double>(statistics.neighboursDuration));
+		metrics.Set(FrameMetrics::PARTICLES_IN_GAS, static_cast<double>(statistics.gasParticles));
+		metrics.Set(FrameMetrics::FAST_DEPTH_MS, static_cast<double>(statistics.fastDepthDuration));
+		metrics.Set(FrameMetrics::MIN_CLUSTER_SIZE, parameters.minClusterSize);
+		metrics.Set(FrameMetrics::PARTICLES_MERGED, statistics.mergedParticles);
+		metrics.Set(FrameMetrics::MERGE_CLUSTERS_MS, static_cast<double>(statistics.mergeDuration));
+		metrics.Set(FrameMetrics::CLUSTERS, static_cast<double>(pipeline.clusterList.size()));
+		metrics.Set(FrameMetrics::KDTREE_KIB, static_cast<double>(statistics.kdTreeBytes / 1024));
+		metrics.Set(FrameMetrics::FRAME_ARENA_KIB, static_cast<double>(statistics.arenaBytes / 1024));
+		metrics.Set(FrameMetrics::HEAP_ALLOCATIONS, static_cast<double>(statistics.heapAllocations));
+
+		if (!compared)
+			return;
+		const int (&eventAmount)[4] = statistics.eventAmount;
+		metrics.Set(FrameMetrics::COMPARE_CLUSTERS_MS, static_cast<double>(statistics.compareDuration));
+		metrics.Set(FrameMetrics::MS_MIN_CLUSTER_AMOUNT, parameters.msMinClusterAmount);
+		metrics.Set(FrameMetrics::MS_MIN_CP_PERCENTAGE, parameters.msMinCPPercentage);
+		metrics.Set(FrameMetrics::BD_MAX_CP_PERCENTAGE, parameters.bdMaxCPPercentage);
+		metrics.Set(FrameMetrics::BIRTHS, eventAmount[0]);
+		metrics.Set(FrameMetrics::DEATHS, eventAmount[1]);
+		metrics.Set(FrameMetrics::MERGES, eventAmount[2]);
+		metrics.Set(FrameMetrics::SPLITS, eventAmount[3]);
+		metrics.Set(FrameMetrics::TOTAL_EVENTS, std::accumulate(eventAmount, eventAmount + 4, 0));
+		metrics.Set(FrameMetrics::DETERMINE_EVENTS_MS, static_cast<double>(statistics.eventsDuration));
+	}
+
+	/// Converts the events of the pipeline to the MMSE event and side columns.
+	void convertEvents(const std::vector<StructureEventsPipeline::Event>& events, FrameEvents& frameEvents) {
+		frameEvents.events.reserve(events.size());
+		frameEvents.triggerClusterIDs.reserve(events.size());
+		frameEvents.triggerClusterSizes.reserve(events.size());
+		frameEvents.partnerCounts.reserve(events.size());
+		frameEvents.commonPercentages.reserve(events.size());
+		for (const auto & event : events) {
+			StructureEvents::StructureEvent se;
+			se.x = event.x;
+			se.y = event.y;
+			se.z = event.z;
+			se.time = event.time;
+			se.type = StructureEvents::getEventType(event.type);
+			frameEvents.events.push_back(se);
+			frameEvents.triggerClusterIDs.push_back(event.triggerClusterID);
+			frameEvents.triggerClusterSizes.push_back(event.triggerClusterSize);
+			frameEvents.partnerCounts.push_back(event.partnerCount);
+			frameEvents.commonPercentages.push_back(event.commonPercentage);
+		}
+	}
+
+} /* end anonymous namespace */
+
+
+int main(int argc, char **argv) {
+	Options options;
+	for (int i = 1; i < argc; ++i) {
+		const std::string argument(argv[i]);
+		if (argument.compare(0, 2, "--") != 0 && options.inputFilename.empty()) {
+			options.inputFilename = argument;
+		}
+		else if (!parseOption(argument, options)) {
+			std::cerr << "secalc_batch: Unknown argument or value out of range \"" << argument << "\".\n";
+			printUsage();
+			return 1;
+		}
+	}
+	if (options.inputFilename.empty()) {
+		printUsage();
+		return 1;
+	}
+	TaskPool::SetDefaultThreadCount(options.threads);
+
+	MMPLDFile input;
+	if (!input.Open(options.inputFilename)) {
+		std::cerr << "secalc_batch: \"" << options.inputFilename << "\" is no MMPLD file.\n";
+		return 1;
+	}
+
+	// Periodic boundary condition and MMSE boxes from the data set, like the module.
+	const float *bbox = input.GetBoundingBox();
+	const float *cbox = input.GetClipBox();
+	std::copy(bbox, bbox + 3, options.parameters.bboxMin);
+	std::copy(bbox + 3, bbox + 6, options.parameters.bboxMax);
+	float mmseBBox[6];
+	float mmseCBox[6];
+	std::copy(bbox, bbox + 6, mmseBBox);
+	std::copy(cbox, cbox + 6, mmseCBox);
+
+	// Output.
+	AsyncOutputQueue outputQueue;
+	outputQueue.SetErrorCallback([](const std::string& message) {
+		std::cerr << "secalc_batch: " << message << "\n";
+	});
+	MMSEAppendWriter mmseWriter;
+	if (!mmseWriter.Open(options.mmseFilename, true, options.mmseCompressionLevel)) {
+		std::cerr << "secalc_batch: Unable to create \"" << options.mmseFilename << "\".\n";
+		return 1;
+	}
+	const std::string metricsFilename = "SECalc" + (options.label.empty() ? std::string() : " " + options.label)
+		+ (options.metricsFormat == 1 ? ".secm" : ".csv");
+	FrameMetrics metrics;
+	bool mmseFailed = false; // Only changed by the output thread.
+
+	// Load, neighbour and cluster stages, the sink runs steps 3 and 4 in frame order and queues the output.
+	FrameScheduler scheduler(options.frameWorkers, options.memoryBudget);
+	scheduler.SetLogCallback(&logPipelineMessage);
+	if (scheduler.GetWorkerCount() > 1 && options.parameters.neighbourSearch == StructureEventsPipeline::NEIGHBOURSEARCH_KDTREE)
+		std::cerr << "Warning: The kD-tree search runs one frame at a time, --NeighbourSearch::method=1 searches in parallel.\n";
+
+	StructureEventsPipeline pipeline;
+	pipeline.SetLogCallback(&logPipelineMessage);
+	std::vector<StructureEventsPipeline::Event> events;
+	float maxTime = 0;
+
+	// The spans point into the mapped file, getting frame t prefetches frame t + 1.
+	auto source = [&input](const unsigned int frameID, std::vector<StructureEventsPipeline::ParticleSpan>& spans) -> bool {
+		MMPLDFile::Frame frame;
+		if (!input.GetFrame(frameID, frame)) {
+			std::cerr << "secalc_batch: Unable to read frame " << frameID << ".\n";
+			return false;
+		}
+		getParticleSpans(frame, spans);
+		return true;
+	};
+
+	auto sink = [&](StructureEventsPipeline& clustered) -> bool {
+		const unsigned int frameID = clustered.GetFrameID();
+		const time_t now = time(0);
+		char timeString[32];
+		strftime(timeString, sizeof(timeString), "%Y-%m-%d %X", localtime(&now));
+		metrics.Reset(frameID, now, timeString);
+
+		///
+		/// Steps 3 and 4 on the clusters of this and the previous frame.
+		///
+		pipeline.AdoptFrame(clustered);
+		events.clear();
+		bool compared = false;
+		if (pipeline.previousClusterList.size() > 0 && pipeline.previousParticleList.size() > 0)
+			compared = pipeline.CompareClusters() && pipeline.DetermineStructureEvents(options.parameters, events);
+
+		setMetrics(pipeline, options.parameters, compared, metrics);
+
+		// Frames overlap, so the complete calculation is the sum of the steps.
+		const StructureEventsPipeline::Statistics& statistics = pipeline.GetStatistics();
+		metrics.Set(FrameMetrics::COMPLETE_CALCULATION_MS, static_cast<double>(statistics.particleListDuration
+			+ statistics.kdTreeDuration + statistics.neighboursDuration + statistics.fastDepthDuration + statistics.mergeDuration
+			+ (compared ? statistics.compareDuration + statistics.eventsDuration : 0)));
+
+		///
+		/// Output, the jobs own their data.
+		///
+		if (events.size() > 0) {
+			std::shared_ptr<FrameEvents> frameEvents = std::make_shared<FrameEvents>();
+			convertEvents(events, *frameEvents);
+			for (const auto & event : events)
+				maxTime = std::max(maxTime, event.time);
+			const float fileMaxTime = maxTime;
+			MMSEAppendWriter *writer = &mmseWriter;
+			bool *failed = &mmseFailed;
+			const std::string mmseFilename = options.mmseFilename;
+			outputQueue.Push([frameEvents, writer, failed, fileMaxTime, mmseBBox, mmseCBox, mmseFilename]() {
+				StructureEvents structureEvents;
+				structureEvents.setEvents(&frameEvents->events[0].x, &frameEvents->events[0].time, &frameEvents->events[0].type,
+					fileMaxTime, frameEvents->events.size());
+				structureEvents.setSideColumns(frameEvents->triggerClusterIDs.data(), frameEvents->triggerClusterSizes.data(),
+					frameEvents->partnerCounts.data(), frameEvents->commonPercentages.data());
+				if (!*failed && !writer->Append(structureEvents, mmseBBox, mmseCBox, fileMaxTime)) {
+					*failed = true;
+					std::cerr << "secalc_batch: Unable to write \"" << mmseFilename << "\".\n";
+				}
+			}, frameEvents->getBytes());
+		}
+
+		AsyncOutputFile metricsFile(outputQueue);
+		if (options.metricsFormat == 1) {
+			metricsFile.open(metricsFilename.c_str(), std::ios_base::app | std::ios_base::binary);
+			if (outputQueue.IsNewFile(metricsFilename))
+				metrics.WriteBinaryHeader(metricsFile, options.label);
+			metrics.WriteBinary(metricsFile);
+		}
+		else {
+			metricsFile.open(metricsFilename.c_str(), std::ios_base::app);
+			if (outputQueue.IsNewFile(metricsFilename))
+				metrics.WriteCSVHeader(metricsFile);
+			metrics.WriteCSV(metricsFile, options.label);
+		}
+		metricsFile.close();
+
+		std::cout << "Frame " << frameID << ": " << pipeline.particleList.size() << " particles, "
+			<< pipeline.clusterList.size() << " clusters, " << events.size() << " events ("
+			<< metrics.Get(FrameMetrics::COMPLETE_CALCULATION_MS) << " ms).\n";
+		return true;
+	};
+
+	input.Prefetch(0);
+	int result = scheduler.Run(0, input.GetFrameCount(), options.parameters, source, sink) ? 0 : 1;
+
+	outputQueue.Wait();
+	mmseWriter.Close();
+	if (mmseFailed)
+		result = 1;
+	return result;
+}
@@ -0,0 +1,79 @@
+/**
+ * secc_convert.cpp
+ *
+ * Copyright (C) 2009-2015 by MegaMol Team
+ * Copyright (C) 2015 by Richard Hhne, TU Dresden
+ * Alle Rechte vorbehalten.
+ */
+
+///
+/// Offline converter of SECC cluster comparison dumps to the text and CSV views.
+///
+/// Usage: secc_convert file.secc [file.secc ...]
+/// "SECC <name>.secc" is converted to "SECC All <name>.log",
+/// "SECC forward <name>.csv" and "SECC backwards <name>.csv" next to it.
+///
+
+#include "ClusterComparisonDump.h"
+
+#include <fstream>
+#include <iostream>
+#include <string>
+
+using megamol::mmvis_static::ClusterComparisonDump;
+
+namespace {
+
+	/// Converts one dump, false on error.
+	bool convert(const std::string& filename) {
+		std::ifstream in(filename.c_str(), std::ios_base::in | std::ios_base::binary);
+		ClusterComparisonDump dump;
+		if (!in || !dump.Read(in)) {
+			std::cerr << "secc_convert: \"" << filename << "\" is no SECC file.\n";
+			return false;
+		}
+
+		// Split into directory, name after "SECC" and extension.
+		const size_t nameBegin = filename.find_last_of("/\\") + 1;
+		const std::string directory = filename.substr(0, nameBegin);
+		std::string name = filename.substr(nameBegin);
+		if (name.size() > 5 && name.compare(name.size() - 5, 5, ".secc") == 0)
+			name.erase(name.size() - 5);
+		if (name.compare(0, 4, "SECC") == 0)
+			name.erase(0, 4);
+		else
+			name = " " + name;
+
+		std::ofstream allFile((directory + "SECC All" + name + ".log").c_str());
+		std::ofstream forwardFile((directory + "SECC forward" + name + ".csv").c_str());
+		std::ofstream backwardsFile((directory + "SECC backwards" + name + ".csv").c_str());
+		dump.WriteText(allFile);
+		dump.WriteCSV(forwardFile, ClusterComparisonDump::FORWARD);
+		dump.WriteCSV(backwardsFile, ClusterComparisonDump::BACKWARDS);
+		if (!allFile || !forwardFile || !backwardsFile) {
+			std::cerr << "secc_convert: Unable to write the views of \"" << filename << "\".\n";
+			return false;
+		}
+
+		std::cout << filename << ": " << dump.GetClusters(ClusterComparisonDump::FORWARD).size() << " forward, "
+			<< dump.GetClusters(ClusterComparisonDump::BACKWARDS).size() << " backwards clusters, "
+			<< dump.GetEdges().size() << " partners.\n";
+		return true;
+	}
+
+} /* end anonymous namespace */
+
+
+int main(int argc, char **argv) {
+	if (argc < 2) {
+		std::cerr << "Usage: secc_convert file.secc [file.secc ...]\n";
+		return 1;
+	}
+
+	int result = 0;
+	for (int i = 1; i < argc; ++i) {
+		if (!convert(argv[i]))
+			result = 1;
+	}
+	return result;
+}